@@ -20,6 +20,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <signal.h>
 #include <termios.h>
@@ -29,6 +30,9 @@
 typedef unsigned long ulong;
 typedef unsigned int uint;
 typedef unsigned char uchar;
+typedef unsigned long long uvlong;
+
+#define nelem(x)	(sizeof(x)/sizeof((x)[0]))
 
 enum {
 	Maxline = 8192,
@@ -63,6 +67,7 @@ enum {
 	Mrepl,		/* interactive REPL */
 	Mshell,		/* rc shell assistant */
 	Mcode,		/* code-only output */
+	Mbatch,		/* a question per record on stdin */
 };
 
 /* Dynamic string buffer */
@@ -73,8 +78,20 @@ struct Buf {
 	int	cap;
 };
 
+/* Buffer in pieces, gathered only on the way out */
+typedef struct Bufv Bufv;
+struct Bufv {
+	struct iovec *iov;
+	int	n;
+	int	cap;
+	long	len;		/* total bytes */
+	char	**own;		/* pieces freed with it */
+	int	nown;
+};
+
 /* JSON value */
 typedef struct Json Json;
+typedef struct Jarena Jarena;
 struct Json {
 	int	type;
 	char	*key;		/* field name if inside object */
@@ -83,6 +100,9 @@ struct Json {
 	int	bval;
 	Json	*child;		/* first child for object/array */
 	Json	*next;		/* next sibling */
+	Json	**idx;		/* object: hash of fields, built on demand */
+	int	nidx;		/* its size; -1 if too small to bother */
+	Jarena	*arena;		/* set if part of a jsondoc */
 };
 
 /* Chat message */
@@ -90,6 +110,10 @@ typedef struct Msg Msg;
 struct Msg {
 	char	*role;		/* system, user, assistant */
 	char	*content;
+	char	*json;		/* {"role":...,"content":...}, escaped once */
+	int	jsonlen;
+	int	contentoff;	/* where the escaped content starts in json */
+	int	ntok;		/* estimated tokens */
 	Msg	*next;
 };
 
@@ -99,6 +123,19 @@ struct Conv {
 	Msg	*head;
 	Msg	*tail;
 	int	n;
+	long	ntok;		/* sum of the messages' */
+	int	nedit;		/* changes other than appends, */
+	int	ndel;		/* and messages dropped, so far */
+};
+
+/* Token use, as the provider reports it */
+typedef struct Usage Usage;
+struct Usage {
+	long	in;		/* input not read from the prompt cache */
+	long	out;
+	long	cacheread;	/* input read from it */
+	long	cachewrite;	/* input written to it */
+	int	nreq;
 };
 
 /* LLM provider */
@@ -110,6 +147,8 @@ struct Provider {
 	char	*apikey;
 	char	*model;
 	int	maxtoken;
+	Usage	last;		/* of the last request */
+	Usage	total;
 };
 
 /* Role definition */
@@ -120,12 +159,53 @@ struct Role {
 	char	*model;
 };
 
-/* Session state */
+/* Session state; see session.c */
 typedef struct Session Session;
 struct Session {
 	char	*name;
-	char	*path;
+	char	*path;		/* the log */
 	Conv	conv;
+	int	named;		/* not a tmp- session */
+	int	old;		/* read from a .json */
+	int	nsaved;		/* messages of conv in the log; -1 if it is to be written */
+	int	nedit;		/* conv's counts when last saved */
+	int	ndel;
+	off_t	*off;		/* of each message in the log */
+	int	noff;
+	int	capoff;
+	off_t	end;		/* of the last whole line */
+	int	skip0;		/* messages skip0 to skip1 were not loaded */
+	int	skip1;
+};
+
+/* Context window of models with a name starting with model */
+typedef struct Ctxsize Ctxsize;
+struct Ctxsize {
+	char	*model;		/* "" for any */
+	long	ntok;
+};
+
+/* Names a stored answer; see cache.c */
+typedef struct Cachekey Cachekey;
+struct Cachekey {
+	uvlong	key;
+	uvlong	check;
+};
+
+/* Streamed text on its way out; see render.c */
+typedef struct Render Render;
+struct Render {
+	FILE	*f;
+	int	raw;		/* each piece as it comes */
+	Buf	pend;		/* the frame so far */
+	long	first;		/* ms: when its first byte came */
+	long	last;		/* when the last frame went */
+	int	fence;		/* stop after the first fenced block */
+	int	nfence;		/* fence lines so far */
+	Buf	line;		/* the start of the line so far */
+	int	done;		/* stopped at its end */
+	int	intr;		/* interrupted; see renderend */
+	struct sigaction oldint;
 };
 
 /* Configuration */
@@ -134,11 +214,23 @@ struct Config {
 	char	*dir;
 	char	*model;
 	int	stream;
+	int	unbuffered;	/* write streamed text a piece at a time */
 	int	temp;		/* temperature * 100 (e.g. 70 = 0.7) */
 	int	maxtoken;
+	Ctxsize	*ctx;		/* context lines, in file order */
+	int	nctx;
+	int	summarize;	/* summarize dropped turns, not just drop them */
+	int	cache;		/* mark prompt prefixes cacheable (Claude) */
+	long	cachettl;	/* seconds answers are kept; 0 is never */
+	long	cachemax;	/* kilobytes of them, at most */
+	int	fresh;		/* ask even if an answer is kept */
+	int	coproc;		/* run commands in one rc kept running */
 	Provider **provs;
 	int	nprov;
 	Provider *curprov;
+	Provider **alts;	/* to hedge with; see hedge.c */
+	int	nalt;
+	long	hedgeafter;	/* ms to wait for a first token before hedging */
 };
 
 /* buf.c */
@@ -151,9 +243,14 @@ void	bufaddfmt(Buf*, char*, ...);
 void	bufreset(Buf*);
 void	buffree(Buf*);
 char*	bufstr(Buf*);
+void	bufvinit(Bufv*);
+void	bufvadd(Bufv*, char*, int);
+void	bufvown(Bufv*, Buf*);
+void	bufvfree(Bufv*);
 
 /* json.c */
 Json*	jsonparse(char*);
+Json*	jsondoc(char*);
 void	jsonfree(Json*);
 Json*	jsonget(Json*, char*);
 Json*	jsonidx(Json*, int);
@@ -162,6 +259,8 @@ double	jsonnum(Json*);
 int	jsonbval(Json*);
 int	jsonlen(Json*);
 void	jsonesc(Buf*, char*);
+char*	jsonfind(char*, char*);
+int	jsonunq(char*);
 
 /* util.c */
 void*	emalloc(ulong);
@@ -170,6 +269,8 @@ char*	estrdup(char*);
 void	fatal(char*, ...);
 void	warn(char*, ...);
 char*	smprint(char*, ...);
+int	writen(int, char*, int);
+int	readn(int, char*, int);
 int	isterm(int);
 char*	homedir(void);
 char*	pathjoin(char*, char*);
@@ -177,9 +278,18 @@ int	mkdirp(char*);
 char*	readfile(char*);
 char*	trim(char*);
 
+/* hedge.c */
+int	hedgestream(Provider*, Conv*, Config*, void(*)(char*, int, void*), void*);
+
 /* http.c */
-int	httppost(char*, char**, int, char*, Buf*);
-int	httpstream(char*, char**, int, char*, void(*)(char*, int, void*), void*);
+int	httppost(char*, char**, int, Bufv*, Buf*);
+int	httpstream(char*, char**, int, Bufv*, void(*)(char*, int, void*), void*);
+int	httpstatus(long*);
+void	httpidle(long(*)(void*), void*);
+long	httpquiet(void);
+void	httpforget(void);
+void	httpstop(int);
+int	httpstopped(void);
 
 /* api.c */
 Provider*	provnew(int, char*, char*, char*);
@@ -187,6 +297,15 @@ void		provfree(Provider*);
 int		aicomplete(Provider*, Conv*, Config*, Buf*);
 int		aistream(Provider*, Conv*, Config*, void(*)(char*, int, void*), void*);
 char*		provurl(Provider*);
+long		provctx(Provider*, Config*);
+long		provbudget(Provider*, Config*);
+
+/* batch.c */
+int	batchrun(Config*, Provider*, char*, char*, int, int);
+
+/* cache.c */
+char*	cacheget(Config*, Provider*, Conv*, Cachekey*);
+void	cacheput(Config*, Cachekey*, char*, int);
 
 /* config.c */
 Config*	configload(char*);
@@ -198,27 +317,45 @@ Provider* configprov(Config*, char*);
 Conv*	convnew(void);
 void	convfree(Conv*);
 void	convadd(Conv*, char*, char*);
+void	convdel(Conv*, Msg*, Msg*);
+void	convins(Conv*, Msg*, char*, char*);
+void	convsys(Conv*, char*);
+void	convset(Conv*, Msg*, char*);
 Msg*	msgnew(char*, char*);
 void	msgfree(Msg*);
 char*	convjson(Conv*, Provider*);
 
+/* render.c */
+void	renderinit(Render*, FILE*, int, int);
+void	renderput(char*, int, void*);
+long	renderidle(void*);
+void	renderend(Render*);
+
 /* role.c */
 Role*	roleload(Config*, char*);
 void	rolefree(Role*);
 
 /* session.c */
 Session*	sessionnew(char*);
-Session*	sessionload(Config*, char*);
+Session*	sessionload(Config*, char*, long);
 int		sessionsave(Config*, Session*);
 void		sessionfree(Session*);
 
 /* shell.c */
 char*	shellprompt(void);
 int	shellexec(char*);
+void	shellkeep(int);
 int	shellconfirm(char*);
 char*	shelldetect(void);
 
 /* repl.c */
 void	replrun(Config*, Provider*, Session*, Role*);
 
+/* serve.c */
+int		serverun(Config*);
+Session*	servesession(Config*, char*, long);
+
+/* main.c */
+int	airun(Config*, int, char**, char*, int);
+
 #endif
@@ -66,6 +66,51 @@ provurl(Provider *p)
 	return p->apibase;
 }
 
+/* context windows by model name prefix */
+static Ctxsize ctxtab[] = {
+	{"gpt-4o", 128000},
+	{"gpt-4.1", 1000000},
+	{"gpt-4-turbo", 128000},
+	{"gpt-4", 8192},
+	{"gpt-3.5", 16385},
+	{"o1", 200000},
+	{"o3", 200000},
+	{"o4", 200000},
+	{"claude", 200000},
+	{"llama3", 8192},
+	{"", 8192},
+};
+
+static Ctxsize*
+ctxmatch(Ctxsize *c, int n, char *model)
+{
+	Ctxsize *best;
+	int i;
+
+	best = NULL;
+	for(i = 0; i < n; i++)
+		if(strncmp(model, c[i].model, strlen(c[i].model)) == 0
+		&& (best == NULL || strlen(c[i].model) > strlen(best->model)))
+			best = &c[i];
+	return best;
+}
+
+/*
+ * Context window of the provider's model in tokens:
+ * the config's context lines if one matches, else
+ * what we know of the model.
+ */
+long
+provctx(Provider *p, Config *cfg)
+{
+	Ctxsize *c;
+
+	c = ctxmatch(cfg->ctx, cfg->nctx, p->model);
+	if(c == NULL)
+		c = ctxmatch(ctxtab, nelem(ctxtab), p->model);
+	return c->ntok;
+}
+
 /*
  * Build HTTP headers for the provider.
  * Returns the number of headers written to hdrs[].
@@ -104,76 +149,87 @@ freehdrs(char **hdrs, int n)
 }
 
 /*
- * Build the JSON request body.
- * Caller must free the returned string.
+ * Anthropic caches a prompt up to each block marked with
+ * cache_control, and a later request that starts the same
+ * reads it back.  We mark the system prompt, which is the
+ * same on every call, and the newest message, so that the
+ * next turn finds all of this one's history cached.  (The
+ * window manager drops turns only now and then, so that
+ * the prefix holds from one turn to the next.)
  */
-static char*
-buildreq(Provider *p, Conv *conv, Config *cfg)
+static char cachemark[] = ",\"cache_control\":{\"type\":\"ephemeral\"}";
+static char textblk[] = "[{\"type\":\"text\",\"text\":";
+
+/* m's JSON, with its content as a cacheable text block */
+static void
+cachemsg(Bufv *v, Msg *m)
+{
+	bufvadd(v, m->json, m->contentoff);
+	bufvadd(v, textblk, sizeof textblk - 1);
+	bufvadd(v, m->json + m->contentoff, m->jsonlen - m->contentoff - 1);
+	bufvadd(v, cachemark, sizeof cachemark - 1);
+	bufvadd(v, "}]}", 3);
+}
+
+/*
+ * Build the JSON request body into v: a few bytes of
+ * our own around each message's ready-escaped JSON.
+ * Caller must bufvfree v.
+ */
+static void
+buildreq(Provider *p, Conv *conv, Config *cfg, Bufv *v)
 {
 	Buf b;
 	Msg *m;
 	int first;
 
+	bufvinit(v);
 	bufinit(&b);
 
-	if(p->type == Pclaude){
-		bufaddstr(&b, "{\"model\":");
-		jsonesc(&b, p->model);
+	bufaddstr(&b, "{\"model\":");
+	jsonesc(&b, p->model);
+	if(p->type == Pclaude)
 		bufaddfmt(&b, ",\"max_tokens\":%d", cfg->maxtoken);
 
-		if(cfg->temp >= 0)
-			bufaddfmt(&b, ",\"temperature\":%.2f", cfg->temp / 100.0);
+	if(cfg->temp >= 0)
+		bufaddfmt(&b, ",\"temperature\":%.2f", cfg->temp / 100.0);
 
+	if(p->type == Pclaude){
 		/* system message separate in Claude API */
 		for(m = conv->head; m != NULL; m = m->next){
 			if(strcmp(m->role, "system") == 0){
 				bufaddstr(&b, ",\"system\":");
-				jsonesc(&b, m->content);
+				if(cfg->cache)
+					bufaddstr(&b, textblk);
+				bufvown(v, &b);
+				bufvadd(v, m->json + m->contentoff,
+					m->jsonlen - m->contentoff - 1);
+				if(cfg->cache){
+					bufaddstr(&b, cachemark);
+					bufaddstr(&b, "}]");
+				}
 				break;
 			}
 		}
-
-		bufaddstr(&b, ",\"stream\":true");
-		bufaddstr(&b, ",\"messages\":[");
-		first = 1;
-		for(m = conv->head; m != NULL; m = m->next){
-			if(strcmp(m->role, "system") == 0)
-				continue;
-			if(!first)
-				bufaddc(&b, ',');
-			bufaddstr(&b, "{\"role\":");
-			jsonesc(&b, m->role);
-			bufaddstr(&b, ",\"content\":");
-			jsonesc(&b, m->content);
-			bufaddc(&b, '}');
-			first = 0;
-		}
-		bufaddstr(&b, "]}");
-	}else{
-		/* OpenAI / local format */
-		bufaddstr(&b, "{\"model\":");
-		jsonesc(&b, p->model);
-
-		if(cfg->temp >= 0)
-			bufaddfmt(&b, ",\"temperature\":%.2f", cfg->temp / 100.0);
-
-		bufaddstr(&b, ",\"stream\":true");
-		bufaddstr(&b, ",\"messages\":[");
-		first = 1;
-		for(m = conv->head; m != NULL; m = m->next){
-			if(!first)
-				bufaddc(&b, ',');
-			bufaddstr(&b, "{\"role\":");
-			jsonesc(&b, m->role);
-			bufaddstr(&b, ",\"content\":");
-			jsonesc(&b, m->content);
-			bufaddc(&b, '}');
-			first = 0;
-		}
-		bufaddstr(&b, "]}");
 	}
 
-	return estrdup(bufstr(&b));
+	bufaddstr(&b, ",\"stream\":true");
+	bufaddstr(&b, ",\"messages\":[");
+	bufvown(v, &b);
+	first = 1;
+	for(m = conv->head; m != NULL; m = m->next){
+		if(p->type == Pclaude && strcmp(m->role, "system") == 0)
+			continue;
+		if(!first)
+			bufvadd(v, ",", 1);
+		if(p->type == Pclaude && cfg->cache && m == conv->tail)
+			cachemsg(v, m);
+		else
+			bufvadd(v, m->json, m->jsonlen);
+		first = 0;
+	}
+	bufvadd(v, "]}", 2);
+	buffree(&b);
 }
 
 /*
@@ -284,42 +340,233 @@ struct Streamctx {
 	void	*useraux;
 };
 
+/*
+ * Pick the text out of a streaming chunk in place.
+ * Returns it, NUL-terminated, with its length in *np,
+ * or NULL if the chunk carries none.
+ */
+static char*
+deltatext(Provider *p, char *data, int *np)
+{
+	char *v;
+
+	switch(p->type){
+	case Popenai:
+	case Plocal:
+		v = jsonfind(data, "choices.0.delta.content");
+		break;
+	case Pclaude:
+		v = jsonfind(data, "type");
+		if(v == NULL || strncmp(v, "\"content_block_delta\"", 21) != 0)
+			return NULL;
+		v = jsonfind(data, "delta.text");
+		break;
+	default:
+		return NULL;
+	}
+	if(v == NULL || (*np = jsonunq(v)) < 0)
+		return NULL;
+	return v;
+}
+
+static long
+jsonlong(char *data, char *path)
+{
+	char *v;
+
+	v = jsonfind(data, path);
+	return v != NULL ? strtol(v, NULL, 10) : 0;
+}
+
+/*
+ * Claude reports input use, cache hits and misses
+ * in message_start, output (so far) in message_delta.
+ */
+static void
+claudeusage(Provider *p, char *data)
+{
+	char *v;
+
+	v = jsonfind(data, "type");
+	if(v == NULL)
+		return;
+	if(strncmp(v, "\"message_start\"", 15) == 0){
+		p->last.in = jsonlong(data, "message.usage.input_tokens");
+		p->last.cacheread = jsonlong(data, "message.usage.cache_read_input_tokens");
+		p->last.cachewrite = jsonlong(data, "message.usage.cache_creation_input_tokens");
+		p->last.out = jsonlong(data, "message.usage.output_tokens");
+	}else if(strncmp(v, "\"message_delta\"", 15) == 0)
+		p->last.out = jsonlong(data, "usage.output_tokens");
+}
+
+static void
+streamtext(Streamctx *ctx, char *text, int n)
+{
+	if(ctx->accum != NULL)
+		bufadd(ctx->accum, text, n);
+	if(ctx->usercb != NULL && n > 0)
+		ctx->usercb(text, n, ctx->useraux);
+}
+
+/*
+ * Called once per token, so the text is found
+ * without a parse tree or a copy.  Only the rare
+ * error event goes to the full parser.
+ */
 static void
 streamcb(char *data, int len, void *aux)
 {
 	Streamctx *ctx;
-	char *text, *tmp;
+	char *text;
+	int n;
 
 	ctx = aux;
+	(void)len;
 
-	/* null-terminate the data */
-	tmp = emalloc(len + 1);
-	memcpy(tmp, data, len);
-	tmp[len] = '\0';
+	text = deltatext(ctx->prov, data, &n);
+	if(text != NULL){
+		streamtext(ctx, text, n);
+		return;
+	}
+	if(ctx->prov->type == Pclaude)
+		claudeusage(ctx->prov, data);
+	if(jsonfind(data, "error") == NULL)
+		return;
 
 	switch(ctx->prov->type){
 	case Popenai:
 	case Plocal:
-		text = parseopenai(tmp);
+		text = parseopenai(data);
 		break;
 	case Pclaude:
-		text = parseclaude(tmp);
+		text = parseclaude(data);
 		break;
 	default:
 		text = NULL;
 		break;
 	}
-	free(tmp);
-
 	if(text != NULL){
-		if(ctx->accum != NULL)
-			bufaddstr(ctx->accum, text);
-		if(ctx->usercb != NULL)
-			ctx->usercb(text, strlen(text), ctx->useraux);
+		streamtext(ctx, text, strlen(text));
 		free(text);
 	}
 }
 
+static int
+airequest(Provider *p, Conv *conv, Config *cfg, Streamctx *ctx)
+{
+	char *hdrs[Maxhdr];
+	int nhdrs, ret;
+	Bufv body;
+
+	nhdrs = buildhdrs(p, hdrs, Maxhdr);
+	buildreq(p, conv, cfg, &body);
+	memset(&p->last, 0, sizeof p->last);
+	p->last.nreq = 1;
+	ret = httpstream(provurl(p), hdrs, nhdrs, &body, streamcb, ctx);
+	p->total.in += p->last.in;
+	p->total.out += p->last.out;
+	p->total.cacheread += p->last.cacheread;
+	p->total.cachewrite += p->last.cachewrite;
+	p->total.nreq++;
+	freehdrs(hdrs, nhdrs);
+	bufvfree(&body);
+	return ret;
+}
+
+static char *sumprompt =
+	"Summarize the conversation below in a few short paragraphs, "
+	"for your own later reference. Keep the facts, decisions, names, "
+	"commands and code that later turns may refer to.";
+
+/* the window, less room for the reply */
+long
+provbudget(Provider *p, Config *cfg)
+{
+	long budget;
+
+	budget = provctx(p, cfg) - cfg->maxtoken;
+	if(budget < provctx(p, cfg) / 2)
+		budget = provctx(p, cfg) / 2;
+	return budget;
+}
+
+/* ask the model to sum up text; NULL if it cannot */
+static char*
+summarize(Provider *p, Config *cfg, char *text)
+{
+	Conv *c;
+	Streamctx ctx;
+	Buf b;
+	char *s;
+
+	c = convnew();
+	convadd(c, "system", sumprompt);
+	convadd(c, "user", text);
+	bufinit(&b);
+	ctx.prov = p;
+	ctx.accum = &b;
+	ctx.usercb = NULL;
+	ctx.useraux = NULL;
+	s = NULL;
+	if(airequest(p, c, cfg, &ctx) == 0 && b.len > 0)
+		s = smprint("Summary of our conversation so far:\n\n%s", bufstr(&b));
+	buffree(&b);
+	convfree(c);
+	return s;
+}
+
+/*
+ * Fit the conversation to the model's context window,
+ * less room for the reply.  Once over, the oldest turns
+ * go (summarized, if so configured) down to three
+ * quarters of the budget, so that this is seldom done
+ * and requests stay about the same size.  The system
+ * prompt and the newest message always stay.
+ */
+static void
+convfit(Provider *p, Conv *conv, Config *cfg)
+{
+	long budget, low;
+	Msg *prev, *m;
+	Buf old;
+	char *sum;
+	int n;
+
+	budget = provbudget(p, cfg);
+	if(conv->ntok <= budget)
+		return;
+	low = budget * 3 / 4;
+
+	prev = NULL;
+	if(conv->head != NULL && strcmp(conv->head->role, "system") == 0)
+		prev = conv->head;
+	bufinit(&old);
+	n = 0;
+	while((m = prev != NULL ? prev->next : conv->head) != conv->tail){
+		/* stop below low water, at a user turn */
+		if(conv->ntok <= low && strcmp(m->role, "user") == 0)
+			break;
+		if(cfg->summarize){
+			bufaddstr(&old, m->role);
+			bufaddstr(&old, ": ");
+			bufaddstr(&old, m->content);
+			bufaddstr(&old, "\n\n");
+		}
+		convdel(conv, prev, m);
+		n++;
+	}
+	if(n > 0 && cfg->summarize){
+		fprintf(stderr, "(summarizing %d earlier messages)\n", n);
+		sum = summarize(p, cfg, bufstr(&old));
+		if(sum != NULL){
+			convins(conv, prev, "user", sum);
+			free(sum);
+		}else
+			warn("cannot summarize; %d earlier messages dropped", n);
+	}
+	buffree(&old);
+}
+
 /*
  * Send a completion request with streaming.
  * Calls cb for each text chunk received.
@@ -329,15 +576,11 @@ int
 aistream(Provider *p, Conv *conv, Config *cfg,
 	void (*cb)(char*, int, void*), void *aux)
 {
-	char *hdrs[Maxhdr];
-	int nhdrs;
-	char *body;
 	Streamctx ctx;
 	Buf accum;
 	int ret;
 
-	nhdrs = buildhdrs(p, hdrs, Maxhdr);
-	body = buildreq(p, conv, cfg);
+	convfit(p, conv, cfg);
 
 	bufinit(&accum);
 	ctx.prov = p;
@@ -345,15 +588,13 @@ aistream(Provider *p, Conv *conv, Config *cfg,
 	ctx.usercb = cb;
 	ctx.useraux = aux;
 
-	ret = httpstream(provurl(p), hdrs, nhdrs, body, streamcb, &ctx);
+	ret = airequest(p, conv, cfg, &ctx);
 
 	/* add assistant response to conversation */
 	if(accum.len > 0)
 		convadd(conv, "assistant", bufstr(&accum));
 
 	buffree(&accum);
-	freehdrs(hdrs, nhdrs);
-	free(body);
 	return ret;
 }
 
@@ -365,31 +606,15 @@ aistream(Provider *p, Conv *conv, Config *cfg,
 int
 aicomplete(Provider *p, Conv *conv, Config *cfg, Buf *resp)
 {
-	char *hdrs[Maxhdr];
-	int nhdrs;
-	char *body;
-	Buf raw;
-	int ret;
-	Json *j;
-
-	nhdrs = buildhdrs(p, hdrs, Maxhdr);
-	body = buildreq(p, conv, cfg);
+	Streamctx ctx;
 
-	/* modify body to disable streaming */
-	/* simpler: just use streaming and collect */
-	bufinit(&raw);
+	convfit(p, conv, cfg);
 
-	Streamctx ctx;
+	/* just use streaming and collect */
 	ctx.prov = p;
 	ctx.accum = resp;
 	ctx.usercb = NULL;
 	ctx.useraux = NULL;
 
-	ret = httpstream(provurl(p), hdrs, nhdrs, body, streamcb, &ctx);
-
-	buffree(&raw);
-	freehdrs(hdrs, nhdrs);
-	free(body);
-	(void)j;
-	return ret;
+	return airequest(p, conv, cfg, &ctx);
 }
@@ -0,0 +1,415 @@
+/*
+ * batch.c - many one-shot questions at once
+ *
+ * airc -b reads one question per record from stdin:
+ * JSON lines, or with -0 NUL-separated text.  A line
+ * starting with { is an object with "prompt" and,
+ * optionally, "system" and "id"; one starting with "
+ * is a JSON string; any other is the text itself.  Text
+ * given as arguments is an instruction applied to each
+ * record, as with piped input.
+ *
+ * -j workers (default 4) are forked, and each asks over
+ * its own kept-open connection.  A worker told to slow
+ * down (429, 5xx, or no response) waits as long as the
+ * server's Retry-After says, or backs off exponentially,
+ * and tries again.  Answers come out as JSON lines, in
+ * input order, each as soon as all before it are in:
+ *	{"index":1,"id":...,"output":"..."}
+ * with "error" in place of "output" if it failed.
+ */
+
+#include "airc.h"
+#include <poll.h>
+
+enum {
+	Maxtry = 6,
+	Backoff = 1000,		/* ms, doubled each try */
+	Maxbackoff = 60000,
+};
+
+typedef struct Rec Rec;
+struct Rec {
+	char	*prompt;
+	char	*system;
+	char	*id;		/* as JSON, or NULL */
+	char	*err;		/* the record is bad */
+	int	own;		/* prompt is not a slice of the input */
+};
+
+typedef struct Batch Batch;
+struct Batch {
+	Config	*cfg;
+	Provider *prov;
+	char	*system;	/* for records without their own */
+	char	*instr;		/* applied to each record, or NULL */
+	Rec	*rec;
+	int	nrec;
+};
+
+/* a worker's answer, as sent back to the parent */
+typedef struct Ans Ans;
+struct Ans {
+	int	index;
+	int	ok;
+	int	len;
+};
+
+typedef struct Worker Worker;
+struct Worker {
+	pid_t	pid;
+	int	cmd;		/* record indices go down this */
+	int	res;		/* and answers come back up this */
+	int	job;		/* -1 if idle */
+};
+
+static char*
+readall(int fd, int *np)
+{
+	Buf b;
+	char tmp[8192];
+	int n;
+
+	bufinit(&b);
+	while((n = read(fd, tmp, sizeof tmp)) != 0){
+		if(n < 0){
+			if(errno == EINTR)
+				continue;
+			break;
+		}
+		bufadd(&b, tmp, n);
+	}
+	*np = b.len;
+	bufstr(&b);
+	return b.s;
+}
+
+static void
+addrec(Batch *b, char *s)
+{
+	Rec *r;
+	Json *j, *v;
+
+	b->rec = erealloc(b->rec, (b->nrec + 1) * sizeof b->rec[0]);
+	r = &b->rec[b->nrec++];
+	memset(r, 0, sizeof *r);
+	if(*s == '"'){
+		if(jsonunq(s) < 0)
+			r->err = "bad JSON string";
+		r->prompt = s;
+		return;
+	}
+	if(*s != '{'){
+		r->prompt = s;
+		return;
+	}
+	j = jsonparse(s);
+	if(j == NULL || j->type != Jobject){
+		r->err = "bad JSON object";
+		jsonfree(j);
+		return;
+	}
+	if((v = jsonget(j, "prompt")) != NULL && jsonstr(v) != NULL){
+		r->prompt = estrdup(jsonstr(v));
+		r->own = 1;
+	}else
+		r->err = "no prompt";
+	if((v = jsonget(j, "system")) != NULL && jsonstr(v) != NULL)
+		r->system = estrdup(jsonstr(v));
+	if((v = jsonget(j, "id")) != NULL){
+		if(v->type == Jstring){
+			Buf e;
+			bufinit(&e);
+			jsonesc(&e, jsonstr(v));
+			r->id = estrdup(bufstr(&e));
+			buffree(&e);
+		}else if(v->type == Jnumber)
+			r->id = smprint("%.17g", jsonnum(v));
+	}
+	jsonfree(j);
+}
+
+/* split data into records, in place */
+static void
+splitrecs(Batch *b, char *data, int n, int nulsep)
+{
+	char *p, *e, *end;
+
+	end = data + n;
+	for(p = data; p < end; p = e + 1){
+		e = memchr(p, nulsep ? '\0' : '\n', end - p);
+		if(e == NULL)
+			e = end;
+		*e = '\0';
+		if(!nulsep)
+			p = trim(p);
+		if(*p != '\0')
+			addrec(b, p);
+	}
+}
+
+static void
+nap(long ms)
+{
+	struct timespec ts;
+
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000;
+	while(nanosleep(&ts, &ts) < 0 && errno == EINTR)
+		;
+}
+
+/*
+ * Ask record i's question, into out.
+ * Returns 0, or -1 with the reason in out.
+ */
+static int
+answer(Batch *b, int i, Buf *out)
+{
+	Rec *r;
+	Conv *conv;
+	Cachekey key;
+	char *text, *sys;
+	long wait;
+	int try, code, ret;
+
+	r = &b->rec[i];
+	bufreset(out);
+	if(r->err != NULL){
+		bufaddstr(out, r->err);
+		return -1;
+	}
+	conv = convnew();
+	sys = r->system != NULL ? r->system : b->system;
+	if(sys != NULL)
+		convadd(conv, "system", sys);
+	if(b->instr != NULL){
+		bufaddstr(out, "Input:\n```\n");
+		bufaddstr(out, r->prompt);
+		bufaddstr(out, "\n```\n\n");
+		bufaddstr(out, b->instr);
+		convadd(conv, "user", bufstr(out));
+		bufreset(out);
+	}else
+		convadd(conv, "user", r->prompt);
+
+	text = cacheget(b->cfg, b->prov, conv, &key);
+	if(text != NULL){
+		bufaddstr(out, text);
+		free(text);
+		convfree(conv);
+		return 0;
+	}
+
+	code = 0;
+	for(try = 0; ; try++){
+		bufreset(out);
+		ret = aicomplete(b->prov, conv, b->cfg, out);
+		if(ret == 0)
+			break;
+		code = httpstatus(&wait);
+		if(try == Maxtry - 1 || !(code == 0 || code == 429 || code / 100 == 5))
+			break;
+		if(wait < 0){
+			wait = Backoff << try;
+			if(wait > Maxbackoff)
+				wait = Maxbackoff;
+			wait += rand() % (wait / 2 + 1);	/* so the workers spread out */
+		}
+		warn("record %d: retrying in %.1fs", i + 1, wait / 1000.0);
+		nap(wait);
+	}
+	if(ret == 0)
+		cacheput(b->cfg, &key, bufstr(out), out->len);
+	else{
+		bufreset(out);
+		if(code != 0)
+			bufaddfmt(out, "http %d", code);
+		else
+			bufaddstr(out, "no response");
+	}
+	convfree(conv);
+	return ret;
+}
+
+static void
+work(Batch *b, int cmd, int res)
+{
+	Buf out;
+	Ans a;
+
+	srand(getpid());
+	bufinit(&out);
+	while(readn(cmd, (char*)&a.index, sizeof a.index) == 0){
+		a.ok = answer(b, a.index, &out) == 0;
+		a.len = out.len;
+		if(writen(res, (char*)&a, sizeof a) < 0 || writen(res, out.s, out.len) < 0)
+			break;
+	}
+	buffree(&out);
+	_exit(0);
+}
+
+static void
+emit(Batch *b, int i, int ok, char *text)
+{
+	Buf o;
+
+	bufinit(&o);
+	bufaddfmt(&o, "{\"index\":%d", i + 1);
+	if(b->rec[i].id != NULL)
+		bufaddfmt(&o, ",\"id\":%s", b->rec[i].id);
+	bufaddstr(&o, ok ? ",\"output\":" : ",\"error\":");
+	jsonesc(&o, text);
+	bufaddstr(&o, "}\n");
+	fwrite(o.s, 1, o.len, stdout);
+	buffree(&o);
+}
+
+/* start worker w on the next record, or let it go */
+static void
+dispatch(Worker *w, int *next, int nrec)
+{
+	if(*next < nrec && writen(w->cmd, (char*)next, sizeof *next) == 0){
+		w->job = (*next)++;
+		return;
+	}
+	w->job = -1;
+	close(w->cmd);
+	w->cmd = -1;
+}
+
+/*
+ * Answer every record on stdin with up to njob
+ * requests at once.  Returns the number that failed.
+ */
+int
+batchrun(Config *cfg, Provider *p, char *system, char *instr, int njob, int nulsep)
+{
+	Batch b;
+	Worker *w;
+	struct pollfd *pfd;
+	char **outs, *data;
+	int *oks, i, j, n, nw, next, flushed, nbusy, nfail;
+	int fds[4];
+	Ans a;
+
+	memset(&b, 0, sizeof b);
+	b.cfg = cfg;
+	b.prov = p;
+	b.system = system;
+	b.instr = instr != NULL && *instr != '\0' ? instr : NULL;
+	data = readall(0, &n);
+	splitrecs(&b, data, n, nulsep);
+	if(b.nrec == 0){
+		free(data);
+		return 0;
+	}
+
+	nw = njob < 1 ? 1 : njob;
+	if(nw > b.nrec)
+		nw = b.nrec;
+	w = emalloc(nw * sizeof w[0]);
+	pfd = emalloc(nw * sizeof pfd[0]);
+	outs = emalloc(b.nrec * sizeof outs[0]);
+	oks = emalloc(b.nrec * sizeof oks[0]);
+	fflush(stdout);
+	for(i = 0; i < nw; i++){
+		if(pipe(fds) < 0 || pipe(fds + 2) < 0)
+			fatal("pipe: %s", strerror(errno));
+		w[i].pid = fork();
+		if(w[i].pid < 0)
+			fatal("fork: %s", strerror(errno));
+		if(w[i].pid == 0){
+			/* the earlier workers' pipes are not ours */
+			for(j = 0; j < i; j++){
+				close(w[j].cmd);
+				close(w[j].res);
+			}
+			close(fds[1]);
+			close(fds[2]);
+			work(&b, fds[0], fds[3]);
+		}
+		close(fds[0]);
+		close(fds[3]);
+		w[i].cmd = fds[1];
+		w[i].res = fds[2];
+	}
+
+	/* a worker that dies must not take us with it */
+	signal(SIGPIPE, SIG_IGN);
+	next = 0;
+	for(i = 0; i < nw; i++)
+		dispatch(&w[i], &next, b.nrec);
+
+	flushed = 0;
+	nfail = 0;
+	for(;;){
+		nbusy = 0;
+		for(i = 0; i < nw; i++){
+			pfd[i].fd = w[i].job >= 0 ? w[i].res : -1;
+			pfd[i].events = POLLIN;
+			pfd[i].revents = 0;
+			nbusy += w[i].job >= 0;
+		}
+		if(nbusy == 0)
+			break;
+		if(poll(pfd, nw, -1) < 0){
+			if(errno == EINTR)
+				continue;
+			fatal("poll: %s", strerror(errno));
+		}
+		for(i = 0; i < nw; i++){
+			if(pfd[i].revents == 0)
+				continue;
+			j = w[i].job;
+			if(readn(w[i].res, (char*)&a, sizeof a) < 0 || a.index != j
+			|| a.len < 0){
+				/* it died; the rest go to the others */
+				outs[j] = estrdup("worker failed");
+				w[i].job = -1;
+				if(w[i].cmd >= 0)
+					close(w[i].cmd);
+				w[i].cmd = -1;
+				continue;
+			}
+			outs[j] = emalloc(a.len + 1);
+			if(readn(w[i].res, outs[j], a.len) < 0)
+				a.ok = 0;
+			oks[j] = a.ok;
+			dispatch(&w[i], &next, b.nrec);
+		}
+		for(; flushed < b.nrec && outs[flushed] != NULL; flushed++){
+			emit(&b, flushed, oks[flushed], outs[flushed]);
+			nfail += !oks[flushed];
+			free(outs[flushed]);
+		}
+		fflush(stdout);
+	}
+
+	/* records no worker was left to take */
+	for(; flushed < b.nrec; flushed++){
+		emit(&b, flushed, 0, outs[flushed] ? outs[flushed] : "not asked");
+		nfail++;
+		free(outs[flushed]);
+	}
+	fflush(stdout);
+	for(i = 0; i < nw; i++){
+		close(w[i].res);
+		waitpid(w[i].pid, NULL, 0);
+	}
+	signal(SIGPIPE, SIG_DFL);
+	for(i = 0; i < b.nrec; i++){
+		if(b.rec[i].own)
+			free(b.rec[i].prompt);
+		free(b.rec[i].system);
+		free(b.rec[i].id);
+	}
+	free(b.rec);
+	free(outs);
+	free(oks);
+	free(pfd);
+	free(w);
+	free(data);
+	return nfail;
+}
@@ -2,7 +2,8 @@
  * buf.c - dynamic string buffer
  *
  * Plan 9 style growable buffer for building strings,
- * JSON payloads, and accumulating output.
+ * JSON payloads, and accumulating output, and a list
+ * of pieces (Bufv) for sending without joining them.
  */
 
 #include "airc.h"
@@ -94,3 +95,47 @@ bufstr(Buf *b)
 {
 	return b->s;
 }
+
+void
+bufvinit(Bufv *v)
+{
+	memset(v, 0, sizeof *v);
+}
+
+/* add a piece by reference: p must outlive v */
+void
+bufvadd(Bufv *v, char *p, int n)
+{
+	if(n <= 0)
+		return;
+	if(v->n == v->cap){
+		v->cap = v->cap == 0 ? 16 : 2 * v->cap;
+		v->iov = erealloc(v->iov, sizeof v->iov[0] * v->cap);
+	}
+	v->iov[v->n].iov_base = p;
+	v->iov[v->n].iov_len = n;
+	v->n++;
+	v->len += n;
+}
+
+/* add b's contents, which v takes; b is left empty */
+void
+bufvown(Bufv *v, Buf *b)
+{
+	bufvadd(v, b->s, b->len);
+	v->own = erealloc(v->own, sizeof v->own[0] * (v->nown + 1));
+	v->own[v->nown++] = b->s;
+	bufinit(b);
+}
+
+void
+bufvfree(Bufv *v)
+{
+	int i;
+
+	for(i = 0; i < v->nown; i++)
+		free(v->own[i]);
+	free(v->own);
+	free(v->iov);
+	memset(v, 0, sizeof *v);
+}
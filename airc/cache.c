@@ -0,0 +1,234 @@
+/*
+ * cache.c - stored answers to one-shot queries
+ *
+ * Scripts tend to ask the same thing over and over
+ * (a retry loop, a key binding), so command and shell
+ * mode keep each answer in ~/.airc/cache/<key> and
+ * hand it back for the same question.  The key is a
+ * hash of everything that goes into the request:
+ * provider, endpoint, model, sampling settings and
+ * every message.  A file begins
+ *	airc cache 1 <check> <created>
+ * where check is a second, differently seeded hash
+ * of the same, to catch the odd collision.  Files
+ * older than response_ttl are stale; past
+ * response_max kilobytes in all, the least recently
+ * used go (a hit touches its file's mtime).
+ */
+
+#include "airc.h"
+#include <dirent.h>
+
+enum {
+	Keylen = 16,	/* hex digits */
+};
+
+typedef struct Entry Entry;
+struct Entry {
+	char	*path;
+	time_t	mtime;
+	long	size;
+};
+
+/* FNV-1a, twice over with different offset bases */
+static void
+hashadd(Cachekey *h, char *p, long n)
+{
+	uchar *s;
+
+	for(s = (uchar*)p; n-- > 0; s++){
+		h->key = (h->key ^ *s) * 0x100000001b3ULL;
+		h->check = (h->check ^ *s) * 0x100000001b3ULL;
+	}
+}
+
+static void
+hashstr(Cachekey *h, char *s)
+{
+	if(s == NULL)
+		s = "";
+	hashadd(h, s, strlen(s) + 1);
+}
+
+static void
+cachehash(Provider *p, Conv *conv, Config *cfg, Cachekey *h)
+{
+	char num[64];
+	Msg *m;
+
+	h->key = 0xcbf29ce484222325ULL;
+	h->check = 0x84222325cbf29ce4ULL;
+	snprintf(num, sizeof num, "%d %d %d", p->type, cfg->temp, cfg->maxtoken);
+	hashstr(h, num);
+	hashstr(h, p->apibase);
+	hashstr(h, p->model);
+	/* each message's JSON delimits itself */
+	for(m = conv->head; m != NULL; m = m->next)
+		hashadd(h, m->json, m->jsonlen);
+}
+
+static char*
+cachedir(Config *cfg)
+{
+	return pathjoin(cfg->dir, "cache");
+}
+
+static char*
+cachepath(Config *cfg, Cachekey *h)
+{
+	char *dir, *path, name[Keylen + 1];
+
+	snprintf(name, sizeof name, "%016llx", h->key);
+	dir = cachedir(cfg);
+	path = pathjoin(dir, name);
+	free(dir);
+	return path;
+}
+
+/*
+ * The stored answer to conv, or NULL; either way
+ * *h is set for a cacheput of the answer.  Caller
+ * frees.
+ */
+char*
+cacheget(Config *cfg, Provider *p, Conv *conv, Cachekey *h)
+{
+	char *path, *data, *body, *nl;
+	uvlong check;
+	long created;
+
+	cachehash(p, conv, cfg, h);
+	if(cfg->cachettl <= 0 || cfg->fresh)
+		return NULL;
+	path = cachepath(cfg, h);
+	data = readfile(path);
+	if(data == NULL){
+		free(path);
+		return NULL;
+	}
+	nl = strchr(data, '\n');
+	if(nl == NULL || sscanf(data, "airc cache 1 %llx %ld", &check, &created) != 2
+	|| check != h->check){
+		free(data);
+		free(path);
+		return NULL;
+	}
+	if(time(NULL) - created > cfg->cachettl){
+		unlink(path);
+		free(data);
+		free(path);
+		return NULL;
+	}
+	utimensat(AT_FDCWD, path, NULL, 0);
+	free(path);
+	body = estrdup(nl + 1);
+	free(data);
+	return body;
+}
+
+static int
+entrycmp(const void *a, const void *b)
+{
+	const Entry *x = a, *y = b;
+
+	if(x->mtime != y->mtime)
+		return x->mtime < y->mtime ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Drop stale entries, then the least recently
+ * used until the total is under the limit.
+ */
+static void
+cachetrim(Config *cfg)
+{
+	DIR *d;
+	struct dirent *de;
+	struct stat st;
+	Entry *e;
+	char *dir, *path;
+	long total;
+	int n, cap, i;
+	time_t now;
+
+	dir = cachedir(cfg);
+	d = opendir(dir);
+	if(d == NULL){
+		free(dir);
+		return;
+	}
+	now = time(NULL);
+	e = NULL;
+	n = cap = 0;
+	total = 0;
+	while((de = readdir(d)) != NULL){
+		if(strlen(de->d_name) != Keylen
+		|| strspn(de->d_name, "0123456789abcdef") != Keylen)
+			continue;
+		path = pathjoin(dir, de->d_name);
+		if(stat(path, &st) < 0){
+			free(path);
+			continue;
+		}
+		/* mtime is at least the creation time */
+		if(now - st.st_mtime > cfg->cachettl){
+			unlink(path);
+			free(path);
+			continue;
+		}
+		if(n == cap){
+			cap = cap ? 2*cap : 64;
+			e = erealloc(e, cap * sizeof e[0]);
+		}
+		e[n].path = path;
+		e[n].mtime = st.st_mtime;
+		e[n].size = st.st_size;
+		total += st.st_size;
+		n++;
+	}
+	closedir(d);
+	free(dir);
+
+	qsort(e, n, sizeof e[0], entrycmp);
+	for(i = 0; i < n; i++){
+		if(total > cfg->cachemax*1024L){
+			unlink(e[i].path);
+			total -= e[i].size;
+		}
+		free(e[i].path);
+	}
+	free(e);
+}
+
+/*
+ * Store resp as the answer for key h.
+ * Written whole or not at all.
+ */
+void
+cacheput(Config *cfg, Cachekey *h, char *resp, int len)
+{
+	FILE *f;
+	char *dir, *path, *tmp;
+	int ok;
+
+	if(cfg->cachettl <= 0 || cfg->cachemax <= 0)
+		return;
+	dir = cachedir(cfg);
+	mkdirp(dir);
+	free(dir);
+
+	path = cachepath(cfg, h);
+	tmp = smprint("%s.%d", path, (int)getpid());
+	f = fopen(tmp, "w");
+	if(f != NULL){
+		fprintf(f, "airc cache 1 %016llx %ld\n", h->check, (long)time(NULL));
+		fwrite(resp, 1, len, f);
+		ok = !ferror(f);
+		if(fclose(f) != 0 || !ok || rename(tmp, path) < 0)
+			unlink(tmp);
+	}
+	free(tmp);
+	free(path);
+	cachetrim(cfg);
+}
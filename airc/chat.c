@@ -3,10 +3,35 @@
  *
  * Manages linked lists of chat messages and
  * serializes conversations to JSON for API requests.
+ * Each message is escaped once, when it is made (or
+ * changed), so a long conversation costs nothing to
+ * send again but the new turn.  Its size in tokens is
+ * estimated then too, and the conversation keeps the
+ * total, for fitting it to the model (see api.c).
  */
 
 #include "airc.h"
 
+static void
+msgjson(Msg *m)
+{
+	Buf b;
+
+	bufinit(&b);
+	bufaddstr(&b, "{\"role\":");
+	jsonesc(&b, m->role);
+	bufaddstr(&b, ",\"content\":");
+	m->contentoff = b.len;
+	jsonesc(&b, m->content);
+	bufaddc(&b, '}');
+	free(m->json);
+	m->json = bufstr(&b);
+	m->jsonlen = b.len;
+
+	/* about four bytes a token, and a few for the framing */
+	m->ntok = (strlen(m->content) + 3) / 4 + 4;
+}
+
 Msg*
 msgnew(char *role, char *content)
 {
@@ -16,6 +41,7 @@ msgnew(char *role, char *content)
 	m->role = estrdup(role);
 	m->content = estrdup(content);
 	m->next = NULL;
+	msgjson(m);
 	return m;
 }
 
@@ -26,6 +52,7 @@ msgfree(Msg *m)
 		return;
 	free(m->role);
 	free(m->content);
+	free(m->json);
 	free(m);
 }
 
@@ -38,6 +65,9 @@ convnew(void)
 	c->head = NULL;
 	c->tail = NULL;
 	c->n = 0;
+	c->ntok = 0;
+	c->nedit = 0;
+	c->ndel = 0;
 	return c;
 }
 
@@ -69,6 +99,68 @@ convadd(Conv *c, char *role, char *content)
 		c->tail = m;
 	}
 	c->n++;
+	c->ntok += m->ntok;
+}
+
+/* unlink and free m, which follows prev (NULL if m is first) */
+void
+convdel(Conv *c, Msg *prev, Msg *m)
+{
+	if(prev != NULL)
+		prev->next = m->next;
+	else
+		c->head = m->next;
+	if(c->tail == m)
+		c->tail = prev;
+	c->n--;
+	c->ndel++;
+	c->ntok -= m->ntok;
+	msgfree(m);
+}
+
+/* replace a message's content */
+void
+convset(Conv *c, Msg *m, char *content)
+{
+	if(strcmp(m->content, content) == 0)
+		return;
+	c->nedit++;
+	c->ntok -= m->ntok;
+	free(m->content);
+	m->content = estrdup(content);
+	msgjson(m);
+	c->ntok += m->ntok;
+}
+
+/* add a message after prev (first if prev is NULL) */
+void
+convins(Conv *c, Msg *prev, char *role, char *content)
+{
+	Msg *m;
+
+	m = msgnew(role, content);
+	if(prev != NULL){
+		m->next = prev->next;
+		prev->next = m;
+	}else{
+		m->next = c->head;
+		c->head = m;
+	}
+	if(c->tail == prev)
+		c->tail = m;
+	c->n++;
+	c->nedit++;
+	c->ntok += m->ntok;
+}
+
+/* set the system prompt, adding it first if there is none */
+void
+convsys(Conv *c, char *prompt)
+{
+	if(c->head != NULL && strcmp(c->head->role, "system") == 0)
+		convset(c, c->head, prompt);
+	else
+		convins(c, NULL, "system", prompt);
 }
 
 /*
@@ -100,7 +192,8 @@ convjson(Conv *c, Provider *p)
 		for(m = c->head; m != NULL; m = m->next){
 			if(strcmp(m->role, "system") == 0){
 				bufaddstr(&b, ",\"system\":");
-				jsonesc(&b, m->content);
+				bufadd(&b, m->json + m->contentoff,
+					m->jsonlen - m->contentoff - 1);
 				break;
 			}
 		}
@@ -112,11 +205,7 @@ convjson(Conv *c, Provider *p)
 				continue;
 			if(!first)
 				bufaddc(&b, ',');
-			bufaddstr(&b, "{\"role\":");
-			jsonesc(&b, m->role);
-			bufaddstr(&b, ",\"content\":");
-			jsonesc(&b, m->content);
-			bufaddc(&b, '}');
+			bufadd(&b, m->json, m->jsonlen);
 			first = 0;
 		}
 		bufaddstr(&b, "],\"stream\":true}");
@@ -133,11 +222,7 @@ convjson(Conv *c, Provider *p)
 		for(m = c->head; m != NULL; m = m->next){
 			if(!first)
 				bufaddc(&b, ',');
-			bufaddstr(&b, "{\"role\":");
-			jsonesc(&b, m->role);
-			bufaddstr(&b, ",\"content\":");
-			jsonesc(&b, m->content);
-			bufaddc(&b, '}');
+			bufadd(&b, m->json, m->jsonlen);
 			first = 0;
 		}
 		bufaddstr(&b, "],\"stream\":true}");
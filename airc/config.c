@@ -5,6 +5,15 @@
  *   key value
  *   # comments
  *
+ * context takes a window size in tokens, optionally
+ * after a model name prefix:
+ *   context gpt-4o 64000
+ *
+ * hedge names a provider to race the chosen one with
+ * (see hedge.c), and may be given more than once:
+ *   hedge claude:claude-sonnet-4-20250514
+ *   hedge_after 1500
+ *
  * Provider keys in ~/.airc/keys:
  *   openai sk-xxx gpt-4o
  *   claude sk-ant-xxx claude-sonnet-4-20250514
@@ -12,6 +21,8 @@
 
 #include "airc.h"
 
+static Provider *configalt(Config*, char*);
+
 static char*
 cfgdir(void)
 {
@@ -28,6 +39,26 @@ configdir(void)
 	return cfgdir();
 }
 
+/* "context [model] tokens" */
+static void
+addctx(Config *cfg, char *val)
+{
+	char *sp;
+	Ctxsize *c;
+
+	cfg->ctx = erealloc(cfg->ctx, sizeof cfg->ctx[0] * (cfg->nctx + 1));
+	c = &cfg->ctx[cfg->nctx++];
+	sp = strpbrk(val, " \t");
+	if(sp == NULL){
+		c->model = estrdup("");
+		c->ntok = atol(val);
+		return;
+	}
+	*sp++ = '\0';
+	c->model = estrdup(val);
+	c->ntok = atol(trim(sp));
+}
+
 static void
 loadkeys(Config *cfg)
 {
@@ -84,8 +115,10 @@ Config*
 configload(char *path)
 {
 	Config *cfg;
+	Provider *alt;
 	char *data, *line, *next;
-	char *key, *val;
+	char *key, *val, **hedge;
+	int i, nhedge;
 
 	cfg = emalloc(sizeof *cfg);
 	cfg->dir = cfgdir();
@@ -93,9 +126,16 @@ configload(char *path)
 	cfg->stream = True;
 	cfg->temp = 70;		/* 0.7 */
 	cfg->maxtoken = 4096;
+	cfg->cache = True;
+	cfg->cachettl = 600;
+	cfg->cachemax = 8192;
+	cfg->coproc = True;
 	cfg->provs = NULL;
 	cfg->nprov = 0;
 	cfg->curprov = NULL;
+	cfg->hedgeafter = 2000;
+	hedge = NULL;
+	nhedge = 0;
 
 	/* load config file */
 	if(path == NULL)
@@ -126,10 +166,29 @@ configload(char *path)
 				cfg->model = estrdup(val);
 			}else if(strcmp(key, "stream") == 0){
 				cfg->stream = (strcmp(val, "true") == 0);
+			}else if(strcmp(key, "unbuffered") == 0){
+				cfg->unbuffered = (strcmp(val, "true") == 0);
 			}else if(strcmp(key, "temperature") == 0){
 				cfg->temp = (int)(atof(val) * 100);
 			}else if(strcmp(key, "max_tokens") == 0){
 				cfg->maxtoken = atoi(val);
+			}else if(strcmp(key, "context") == 0){
+				addctx(cfg, val);
+			}else if(strcmp(key, "summarize") == 0){
+				cfg->summarize = (strcmp(val, "true") == 0);
+			}else if(strcmp(key, "cache") == 0){
+				cfg->cache = (strcmp(val, "true") == 0);
+			}else if(strcmp(key, "response_ttl") == 0){
+				cfg->cachettl = atol(val);
+			}else if(strcmp(key, "response_max") == 0){
+				cfg->cachemax = atol(val);
+			}else if(strcmp(key, "coproc") == 0){
+				cfg->coproc = (strcmp(val, "true") == 0);
+			}else if(strcmp(key, "hedge") == 0){
+				hedge = erealloc(hedge, (nhedge + 1) * sizeof hedge[0]);
+				hedge[nhedge++] = estrdup(val);
+			}else if(strcmp(key, "hedge_after") == 0){
+				cfg->hedgeafter = atol(val);
 			}
 		}
 		free(data);
@@ -164,9 +223,55 @@ configload(char *path)
 		}
 	}
 
+	/* the providers to hedge with, now that all are known */
+	for(i = 0; i < nhedge; i++){
+		alt = configalt(cfg, hedge[i]);
+		if(alt == NULL)
+			warn("hedge %s: no such provider", hedge[i]);
+		else{
+			cfg->alts = erealloc(cfg->alts, (cfg->nalt + 1) * sizeof cfg->alts[0]);
+			cfg->alts[cfg->nalt++] = alt;
+		}
+		free(hedge[i]);
+	}
+	free(hedge);
+
 	return cfg;
 }
 
+/*
+ * The provider named by spec ("openai:gpt-4o", "claude"),
+ * or nil; *mname is set to the model part, or nil.
+ * spec is cut at the colon.
+ */
+static Provider*
+findprov(Config *cfg, char *spec, char **mname)
+{
+	char *colon;
+	int i;
+
+	colon = strchr(spec, ':');
+	if(colon != NULL){
+		*colon = '\0';
+		*mname = *++colon != '\0' ? colon : NULL;
+	}else
+		*mname = NULL;
+
+	for(i = 0; i < cfg->nprov; i++)
+		if(strcmp(cfg->provs[i]->name, spec) == 0)
+			return cfg->provs[i];
+
+	/* try type prefix match */
+	for(i = 0; i < cfg->nprov; i++){
+		Provider *p = cfg->provs[i];
+		if((strcmp(spec, "openai") == 0 && p->type == Popenai)
+		|| (strcmp(spec, "claude") == 0 && p->type == Pclaude)
+		|| (strcmp(spec, "local") == 0 && p->type == Plocal))
+			return p;
+	}
+	return NULL;
+}
+
 /*
  * Resolve a model spec like "openai:gpt-4o" or "claude"
  * to a provider, optionally overriding the model.
@@ -174,50 +279,45 @@ configload(char *path)
 Provider*
 configprov(Config *cfg, char *spec)
 {
-	char *colon, *pname, *mname;
-	int i;
+	Provider *p;
+	char *pname, *mname;
 
 	if(spec == NULL)
 		spec = cfg->model;
 
 	pname = estrdup(spec);
-	colon = strchr(pname, ':');
-	if(colon != NULL){
-		*colon = '\0';
-		mname = colon + 1;
-	}else{
-		mname = NULL;
+	p = findprov(cfg, pname, &mname);
+	if(p != NULL && mname != NULL){
+		free(p->model);
+		p->model = estrdup(mname);
 	}
+	free(pname);
+	if(p == NULL && cfg->nprov > 0)
+		p = cfg->provs[0];
+	return p;
+}
 
-	for(i = 0; i < cfg->nprov; i++){
-		if(strcmp(cfg->provs[i]->name, pname) == 0){
-			Provider *p = cfg->provs[i];
-			if(mname != NULL && *mname != '\0'){
-				free(p->model);
-				p->model = estrdup(mname);
-			}
-			free(pname);
-			return p;
-		}
-	}
+/*
+ * A provider of its own for spec, to hedge with, so that
+ * its model is not changed under the one it copies.
+ * Returns nil if spec names no provider.
+ */
+static Provider*
+configalt(Config *cfg, char *spec)
+{
+	Provider *b, *p;
+	char *pname, *mname;
 
-	/* try type prefix match */
-	for(i = 0; i < cfg->nprov; i++){
-		Provider *p = cfg->provs[i];
-		if((strcmp(pname, "openai") == 0 && p->type == Popenai)
-		|| (strcmp(pname, "claude") == 0 && p->type == Pclaude)
-		|| (strcmp(pname, "local") == 0 && p->type == Plocal)){
-			if(mname != NULL && *mname != '\0'){
-				free(p->model);
-				p->model = estrdup(mname);
-			}
-			free(pname);
-			return p;
-		}
+	pname = estrdup(spec);
+	b = findprov(cfg, pname, &mname);
+	p = NULL;
+	if(b != NULL){
+		p = provnew(b->type, b->name, b->type == Plocal ? b->apibase : b->apikey,
+			mname != NULL ? mname : b->model);
+		p->maxtoken = b->maxtoken;
 	}
-
 	free(pname);
-	return cfg->nprov > 0 ? cfg->provs[0] : NULL;
+	return p;
 }
 
 void
@@ -229,8 +329,14 @@ configfree(Config *cfg)
 		return;
 	free(cfg->dir);
 	free(cfg->model);
+	for(i = 0; i < cfg->nctx; i++)
+		free(cfg->ctx[i].model);
+	free(cfg->ctx);
 	for(i = 0; i < cfg->nprov; i++)
 		provfree(cfg->provs[i]);
 	free(cfg->provs);
+	for(i = 0; i < cfg->nalt; i++)
+		provfree(cfg->alts[i]);
+	free(cfg->alts);
 	free(cfg);
 }
@@ -0,0 +1,379 @@
+/*
+ * hedge.c - racing providers for a streamed reply
+ *
+ * With "hedge spec" lines in the config, a streamed
+ * request is not left to one provider.  The primary is
+ * asked first; if no text has come from it hedge_after
+ * ms later (default 2000), the next provider is asked as
+ * well, and so on down the list, and one that fails hands
+ * over to the next at once.  The first to send text wins;
+ * the others are killed, and with them their connections.
+ *
+ * Each contestant is a forked child, streaming with
+ * aistream on connections of its own and passing the
+ * text up a pipe in frames: a length and that many bytes,
+ * then 0 and the Usage at the end, or -1 if it failed.
+ *
+ * How each provider has done is kept in configdir()/health:
+ * the time to its first text, averaged, and its failures
+ * in a row.  One that has failed Maxfail times in the last
+ * Downtime seconds is tried after the others, and a first
+ * choice whose average is over hedge_after is raced from
+ * the start.
+ */
+
+#include "airc.h"
+#include <poll.h>
+
+enum {
+	Maxfail = 2,
+	Downtime = 60,		/* s */
+	Maxrace = 8,
+};
+
+typedef struct Health Health;
+struct Health {
+	char	*name;		/* provider:model */
+	long	ms;		/* to first text, averaged; 0 if not known */
+	int	nfail;		/* in a row */
+	long	lastfail;	/* time(2) of the last */
+	Health	*next;
+};
+
+typedef struct Runner Runner;
+struct Runner {
+	Provider *p;
+	Health	*h;
+	pid_t	pid;
+	int	fd;		/* -1 once done with */
+	long	start;		/* ms */
+};
+
+static Health *health;
+static int healthread;
+
+static long
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000L + ts.tv_nsec / 1000000;
+}
+
+static void
+healthload(Config *cfg)
+{
+	char *path, *data, *line, *next, *name, *ms, *nfail, *last;
+	Health *h;
+
+	path = pathjoin(cfg->dir, "health");
+	data = readfile(path);
+	free(path);
+	if(data == NULL)
+		return;
+	for(line = data; line != NULL && *line != '\0'; line = next){
+		next = strchr(line, '\n');
+		if(next != NULL)
+			*next++ = '\0';
+		name = strtok(line, " \t");
+		ms = strtok(NULL, " \t");
+		nfail = strtok(NULL, " \t");
+		last = strtok(NULL, " \t");
+		if(name == NULL || last == NULL)
+			continue;
+		h = emalloc(sizeof *h);
+		h->name = estrdup(name);
+		h->ms = atol(ms);
+		h->nfail = atoi(nfail);
+		h->lastfail = atol(last);
+		h->next = health;
+		health = h;
+	}
+	free(data);
+}
+
+static void
+healthsave(Config *cfg)
+{
+	char *path, *tmp;
+	Health *h;
+	FILE *f;
+
+	path = pathjoin(cfg->dir, "health");
+	tmp = smprint("%s.%d", path, (int)getpid());
+	if((f = fopen(tmp, "w")) != NULL){
+		for(h = health; h != NULL; h = h->next)
+			fprintf(f, "%s %ld %d %ld\n", h->name, h->ms, h->nfail, h->lastfail);
+		if(fclose(f) != 0 || rename(tmp, path) < 0)
+			unlink(tmp);
+	}
+	free(tmp);
+	free(path);
+}
+
+static Health*
+healthof(Provider *p)
+{
+	Health *h;
+	char *name;
+
+	name = smprint("%s:%s", p->name, p->model);
+	for(h = health; h != NULL; h = h->next)
+		if(strcmp(h->name, name) == 0){
+			free(name);
+			return h;
+		}
+	h = emalloc(sizeof *h);
+	h->name = name;
+	h->next = health;
+	health = h;
+	return h;
+}
+
+static int
+isdown(Health *h)
+{
+	return h->nfail >= Maxfail && time(NULL) - h->lastfail < Downtime;
+}
+
+/* fold a time to first text into the average */
+static void
+healthms(Health *h, long ms)
+{
+	if(ms < 1)
+		ms = 1;
+	h->ms = h->ms == 0 ? ms : (3 * h->ms + ms) / 4;
+}
+
+static void
+childcb(char *text, int len, void *aux)
+{
+	int fd;
+
+	fd = *(int*)aux;
+	if(writen(fd, (char*)&len, sizeof len) < 0 || writen(fd, text, len) < 0)
+		_exit(1);
+}
+
+/* the child: stream p's reply up fd */
+static void
+contest(Provider *p, Conv *conv, Config *cfg, int fd)
+{
+	int n;
+
+	httpforget();
+	signal(SIGPIPE, SIG_DFL);
+	if(aistream(p, conv, cfg, childcb, &fd) < 0){
+		n = -1;
+		writen(fd, (char*)&n, sizeof n);
+		_exit(1);
+	}
+	n = 0;
+	writen(fd, (char*)&n, sizeof n);
+	writen(fd, (char*)&p->last, sizeof p->last);
+	_exit(0);
+}
+
+static int
+start(Runner *r, Conv *conv, Config *cfg, Runner *all, int nall)
+{
+	int fds[2], i;
+
+	fflush(stdout);
+	fflush(stderr);
+	if(pipe(fds) < 0)
+		return -1;
+	r->pid = fork();
+	if(r->pid < 0){
+		close(fds[0]);
+		close(fds[1]);
+		return -1;
+	}
+	if(r->pid == 0){
+		/* the others' pipes are not ours */
+		for(i = 0; i < nall; i++)
+			if(all[i].fd >= 0)
+				close(all[i].fd);
+		close(fds[0]);
+		contest(r->p, conv, cfg, fds[1]);
+	}
+	close(fds[1]);
+	r->fd = fds[0];
+	r->start = now();
+	return 0;
+}
+
+static void
+stop(Runner *r, int force)
+{
+	if(r->fd < 0)
+		return;
+	if(force)
+		kill(r->pid, SIGKILL);
+	close(r->fd);
+	r->fd = -1;
+	waitpid(r->pid, NULL, 0);
+}
+
+static void
+failed(Runner *r)
+{
+	r->h->nfail++;
+	r->h->lastfail = time(NULL);
+	stop(r, 1);
+	warn("%s:%s failed", r->p->name, r->p->model);
+}
+
+/*
+ * Stream a reply as aistream does, but racing p against
+ * cfg's hedges.  Without any, it is just aistream.
+ */
+int
+hedgestream(Provider *p, Conv *conv, Config *cfg,
+	void (*cb)(char*, int, void*), void *aux)
+{
+	Runner run[Maxrace], t;
+	struct pollfd pfd[Maxrace];
+	Buf text, piece;
+	void (*opipe)(int);
+	Usage u;
+	long due, ms, wait;
+	int nrun, next, win, busy, i, j, n, ret;
+
+	if(cfg->nalt == 0)
+		return aistream(p, conv, cfg, cb, aux);
+
+	if(!healthread){
+		healthload(cfg);
+		healthread = True;
+	}
+	nrun = 0;
+	run[nrun++].p = p;
+	for(i = 0; i < cfg->nalt && nrun < Maxrace; i++)
+		if(strcmp(cfg->alts[i]->name, p->name) != 0
+		|| strcmp(cfg->alts[i]->model, p->model) != 0)
+			run[nrun++].p = cfg->alts[i];
+	for(i = 0; i < nrun; i++){
+		run[i].h = healthof(run[i].p);
+		run[i].fd = -1;
+		run[i].pid = -1;
+	}
+	/* those that are down go to the back, in order */
+	for(i = 1; i < nrun; i++)
+		for(j = i; j > 0 && isdown(run[j-1].h) && !isdown(run[j].h); j--){
+			t = run[j];
+			run[j] = run[j-1];
+			run[j-1] = t;
+		}
+
+	opipe = signal(SIGPIPE, SIG_IGN);
+	bufinit(&text);
+	bufinit(&piece);
+	next = 0;
+	win = -1;
+	ret = -1;
+	due = now();
+	for(;;){
+		busy = 0;
+		for(i = 0; i < next; i++)
+			busy += run[i].fd >= 0;
+		/* the next when it is due, or at once if all have failed */
+		if(win < 0 && next < nrun && (busy == 0 || now() >= due)){
+			if(start(&run[next], conv, cfg, run, next) == 0){
+				busy++;
+				ms = run[next].h->ms;
+				due = now() + (ms > cfg->hedgeafter ? 0 : cfg->hedgeafter);
+			}
+			next++;
+			continue;
+		}
+		if(busy == 0)
+			break;
+		for(i = 0; i < next; i++){
+			pfd[i].fd = run[i].fd;
+			pfd[i].events = POLLIN;
+			pfd[i].revents = 0;
+		}
+		wait = -1;
+		if(win < 0 && next < nrun && (wait = due - now()) < 0)
+			wait = 0;
+		ms = httpquiet();
+		if(ms >= 0 && (wait < 0 || ms < wait))
+			wait = ms;
+		if(httpstopped()){
+			ret = 0;
+			break;
+		}
+		if(poll(pfd, next, wait < 0 ? -1 : (int)wait) < 0){
+			if(errno == EINTR)
+				continue;
+			break;
+		}
+		for(i = 0; i < next; i++){
+			if(pfd[i].revents == 0 || run[i].fd < 0)
+				continue;
+			if(readn(run[i].fd, (char*)&n, sizeof n) < 0 || n < 0){
+				failed(&run[i]);
+				if(i == win)
+					goto out;
+				continue;
+			}
+			if(n == 0){
+				if(readn(run[i].fd, (char*)&u, sizeof u) == 0){
+					run[i].p->last = u;
+					run[i].p->total.in += u.in;
+					run[i].p->total.out += u.out;
+					run[i].p->total.cacheread += u.cacheread;
+					run[i].p->total.cachewrite += u.cachewrite;
+					run[i].p->total.nreq++;
+				}
+				run[i].h->nfail = 0;
+				stop(&run[i], 0);
+				if(win < 0)
+					healthms(run[i].h, now() - run[i].start);
+				ret = 0;
+				goto out;
+			}
+			bufreset(&piece);
+			bufgrow(&piece, n);
+			if(readn(run[i].fd, piece.s, n) < 0){
+				failed(&run[i]);
+				if(i == win)
+					goto out;
+				continue;
+			}
+			piece.s[n] = '\0';
+			if(win < 0){
+				win = i;
+				run[i].h->nfail = 0;
+				healthms(run[i].h, now() - run[i].start);
+				for(j = 0; j < next; j++)
+					if(j != win && run[j].fd >= 0){
+						/* slower than this, at least */
+						if(now() - run[j].start > run[j].h->ms)
+							healthms(run[j].h, now() - run[j].start);
+						stop(&run[j], 1);
+					}
+				if(win > 0)
+					warn("answered by %s:%s", run[win].p->name, run[win].p->model);
+			}
+			bufadd(&text, piece.s, n);
+			cb(piece.s, n, aux);
+			if(httpstopped()){
+				ret = 0;
+				goto out;
+			}
+		}
+	}
+out:
+	for(i = 0; i < next; i++)
+		stop(&run[i], 1);
+	if(text.len > 0)
+		convadd(conv, "assistant", bufstr(&text));
+	buffree(&text);
+	buffree(&piece);
+	signal(SIGPIPE, opipe);
+	healthsave(cfg);
+	return ret;
+}
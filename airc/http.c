@@ -1,26 +1,236 @@
 /*
- * http.c - HTTP client via curl subprocess
+ * http.c - HTTP/1.1 client
  *
- * Plan 9 philosophy: compose with existing tools.
- * Uses curl(1) as a subprocess for HTTPS transport.
- * On Plan 9 proper, replace with dial()/webfs.
+ * Requests are written straight to a socket that is kept
+ * open between calls, one per scheme, host and port, so a
+ * repl or shell session connects (and shakes hands) once.
+ *
+ * https needs OpenSSL (see the Makefile).  The TLS session
+ * is kept with the connection and saved in configdir()/tls,
+ * so the next airc resumes it instead of a full handshake.
+ * Built without OpenSSL, https goes through curl(1), which
+ * is handed the body on stdin.
+ *
+ * A request can be stopped part way (see httpstop), from a
+ * signal handler or from the stream's callback: the reply
+ * is not read on, and its connection is closed (or curl
+ * killed), since what is left of it is still to come.
  */
 
 #include "airc.h"
 
+#include <strings.h>
+#include <limits.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifdef HAVE_OPENSSL
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 16
+#endif
+
+enum {
+	Maxconn = 4,
+	Iosize = 16384,
+};
+
+/* a parsed url */
+typedef struct Url Url;
+struct Url {
+	int	tls;
+	char	*host;
+	char	*port;
+	char	*path;
+};
+
+/* a kept-open connection */
+typedef struct Conn Conn;
+struct Conn {
+	int	tls;
+	char	*host;
+	char	*port;
+	int	fd;		/* -1 if the slot is free */
+	int	nreq;		/* requests carried so far */
+	int	off, len;	/* unread part of buf */
+	char	buf[Iosize];
+#ifdef HAVE_OPENSSL
+	SSL	*ssl;
+	SSL_SESSION *sess;
+#endif
+};
+
+/* where response bytes go */
+typedef struct Sink Sink;
+struct Sink {
+	void	(*fn)(Sink*, char*, int);
+	Buf	*resp;		/* httppost: whole body; httpstream: error reply */
+	Buf	line;		/* httpstream: partial SSE line */
+	void	(*cb)(char*, int, void*);
+	void	*aux;
+};
+
+static Conn conns[Maxconn];
+static int nconns;
+
+/* of the last request; see httpstatus */
+static int lastcode;
+static long lastretry;
+
+/* see httpidle */
+static long (*idlefn)(void*);
+static void *idleaux;
+
+/* see httpstop */
+static volatile sig_atomic_t stopped;
+
+/*
+ * Before each wait for input, call idlefn for as long
+ * as none comes by the time it asks to be called again.
+ */
+static void
+waitin(int fd)
+{
+	struct pollfd pfd;
+	long ms;
+
+	if(idlefn == NULL)
+		return;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	while((ms = httpquiet()) >= 0
+	&& poll(&pfd, 1, ms < INT_MAX ? (int)ms : INT_MAX) == 0)
+		;
+}
+
+static void
+bufsink(Sink *s, char *p, int n)
+{
+	bufadd(s->resp, p, n);
+}
+
 /*
- * Build a curl command and execute it.
+ * Split an event stream into lines, calling cb
+ * for each data line.  SSE format: "data: {...}\n"
+ */
+static void
+sseline(Sink *s)
+{
+	char *l;
+
+	l = bufstr(&s->line);
+	if(s->line.len > 0 && l[s->line.len-1] == '\r')
+		l[--s->line.len] = '\0';
+	if(strncmp(l, "data: ", 6) == 0 && strcmp(l + 6, "[DONE]") != 0)
+		s->cb(l + 6, s->line.len - 6, s->aux);
+	bufreset(&s->line);
+}
+
+static void
+ssesink(Sink *s, char *p, int n)
+{
+	char *nl;
+
+	while(n > 0){
+		nl = memchr(p, '\n', n);
+		if(nl == NULL){
+			bufadd(&s->line, p, n);
+			return;
+		}
+		bufadd(&s->line, p, nl - p);
+		sseline(s);
+		n -= nl + 1 - p;
+		p = nl + 1;
+	}
+}
+
+static void
+sseflush(Sink *s)
+{
+	if(s->line.len > 0)
+		sseline(s);
+}
+
+/*
+ * Writes to a peer that has gone away must fail
+ * with EPIPE, not kill us.
+ */
+static void
+nopipe(struct sigaction *old)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof sa);
+	sa.sa_handler = SIG_IGN;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGPIPE, &sa, old);
+}
+
+/*
+ * Gather head (if any) and body into one iovec
+ * array, which writevn may then use up.
+ */
+static struct iovec*
+iovdup(Buf *head, Bufv *body, int *np)
+{
+	struct iovec *v;
+	int n;
+
+	v = emalloc(sizeof v[0] * (body->n + 1));
+	n = 0;
+	if(head != NULL){
+		v[n].iov_base = head->s;
+		v[n++].iov_len = head->len;
+	}
+	memcpy(v + n, body->iov, sizeof v[0] * body->n);
+	*np = n + body->n;
+	return v;
+}
+
+static int
+writevn(int fd, struct iovec *v, int n)
+{
+	ssize_t w;
+
+	while(n > 0){
+		w = writev(fd, v, n < IOV_MAX ? n : IOV_MAX);
+		if(w < 0 && errno == EINTR)
+			continue;
+		if(w <= 0)
+			return -1;
+		for(; n > 0 && (size_t)w >= v->iov_len; v++, n--)
+			w -= v->iov_len;
+		if(w > 0){
+			v->iov_base = (char*)v->iov_base + w;
+			v->iov_len -= w;
+		}
+	}
+	return 0;
+}
+
+#ifndef HAVE_OPENSSL
+
+/*
+ * Run curl, writing body to its stdin.
  * Returns the child's stdout via pipe.
  */
 static pid_t
-curlexec(char *url, char **hdrs, int nhdrs, char *body, int streaming, int *fdp)
+curlexec(char *url, char **hdrs, int nhdrs, Bufv *body, int streaming, int *fdp)
 {
-	int pfd[2];
+	int pfd[2], ifd[2];
 	pid_t pid;
 	char **argv;
-	int argc, i;
+	int argc, i, n;
+	struct iovec *v;
+	struct sigaction old;
 
-	if(pipe(pfd) < 0)
+	if(pipe(pfd) < 0 || pipe(ifd) < 0)
 		fatal("pipe: %s", strerror(errno));
 
 	pid = fork();
@@ -30,14 +240,18 @@ curlexec(char *url, char **hdrs, int nhdrs, char *body, int streaming, int *fdp)
 	if(pid == 0){
 		/* child: curl process */
 		close(pfd[0]);
+		close(ifd[1]);
+		dup2(ifd[0], 0);
 		dup2(pfd[1], 1);
 		dup2(pfd[1], 2);
+		if(ifd[0] > 2)
+			close(ifd[0]);
 		if(pfd[1] > 2)
 			close(pfd[1]);
 
 		/*
 		 * Build argv:
-		 * curl -sS [-N] -X POST -d body [-H hdr]... url
+		 * curl -sS [-N] -X POST --data-binary @- [-H hdr]... url
 		 */
 		argc = 6 + nhdrs * 2 + (streaming ? 1 : 0) + 2;
 		argv = emalloc(sizeof(char*) * (argc + 1));
@@ -48,8 +262,8 @@ curlexec(char *url, char **hdrs, int nhdrs, char *body, int streaming, int *fdp)
 			argv[i++] = "-N";	/* unbuffered for SSE */
 		argv[i++] = "-X";
 		argv[i++] = "POST";
-		argv[i++] = "-d";
-		argv[i++] = body;
+		argv[i++] = "--data-binary";
+		argv[i++] = "@-";
 		for(int h = 0; h < nhdrs; h++){
 			argv[i++] = "-H";
 			argv[i++] = hdrs[h];
@@ -62,85 +276,805 @@ curlexec(char *url, char **hdrs, int nhdrs, char *body, int streaming, int *fdp)
 		_exit(1);
 	}
 
-	/* parent */
+	/* parent: curl reads all of stdin before it sends anything */
 	close(pfd[1]);
+	close(ifd[0]);
+	v = iovdup(NULL, body, &n);
+	nopipe(&old);
+	writevn(ifd[1], v, n);
+	sigaction(SIGPIPE, &old, NULL);
+	free(v);
+	close(ifd[1]);
 	*fdp = pfd[0];
 	return pid;
 }
 
-/*
- * POST request, read entire response into buf.
- * Returns 0 on success, -1 on error.
- */
-int
-httppost(char *url, char **hdrs, int nhdrs, char *body, Buf *resp)
+static int
+curlrun(char *url, char **hdrs, int nhdrs, Bufv *body, Sink *s)
 {
 	int fd, n, status;
 	pid_t pid;
 	char tmp[4096];
 
-	pid = curlexec(url, hdrs, nhdrs, body, 0, &fd);
-
-	bufreset(resp);
-	while((n = read(fd, tmp, sizeof tmp - 1)) > 0)
-		bufadd(resp, tmp, n);
+	pid = curlexec(url, hdrs, nhdrs, body, s->fn == ssesink, &fd);
+	while(!stopped){
+		waitin(fd);
+		if((n = read(fd, tmp, sizeof tmp)) < 0 && errno == EINTR)
+			continue;
+		if(n <= 0)
+			break;
+		s->fn(s, tmp, n);
+	}
+	if(stopped)
+		kill(pid, SIGTERM);
 	close(fd);
 
 	waitpid(pid, &status, 0);
+	if(stopped)
+		return 0;
 	if(WIFEXITED(status) && WEXITSTATUS(status) != 0)
 		return -1;
 	return 0;
 }
 
+#endif
+
+/*
+ * Split "scheme://host[:port]/path".
+ * Returns 0 on success, -1 if the url is not http(s).
+ */
+static int
+urlparse(char *url, Url *u)
+{
+	char *p, *h, *e, *c;
+
+	if(strncmp(url, "https://", 8) == 0){
+		u->tls = 1;
+		h = url + 8;
+	}else if(strncmp(url, "http://", 7) == 0){
+		u->tls = 0;
+		h = url + 7;
+	}else
+		return -1;
+
+	p = strchr(h, '/');
+	if(p == NULL)
+		p = h + strlen(h);
+	if(*h == '['){
+		/* [v6addr]:port */
+		e = memchr(h, ']', p - h);
+		if(e == NULL)
+			return -1;
+		u->host = smprint("%.*s", (int)(e - h - 1), h + 1);
+		c = e + 1 < p && e[1] == ':' ? e + 1 : NULL;
+	}else{
+		c = memchr(h, ':', p - h);
+		e = c != NULL ? c : p;
+		u->host = smprint("%.*s", (int)(e - h), h);
+	}
+	if(c != NULL && c + 1 < p)
+		u->port = smprint("%.*s", (int)(p - c - 1), c + 1);
+	else
+		u->port = estrdup(u->tls ? "443" : "80");
+	u->path = estrdup(*p ? p : "/");
+	return 0;
+}
+
+static void
+urlfree(Url *u)
+{
+	free(u->host);
+	free(u->port);
+	free(u->path);
+}
+
+#ifdef HAVE_OPENSSL
+
+static SSL_CTX *tlsctx;
+
+static char*
+sesspath(Conn *c)
+{
+	char *dir, *path, *name;
+
+	dir = configdir();
+	path = pathjoin(dir, "tls");
+	free(dir);
+	name = smprint("%s:%s", c->host, c->port);
+	dir = pathjoin(path, name);
+	free(path);
+	free(name);
+	return dir;
+}
+
 /*
- * POST request with streaming (SSE).
- * Reads line-by-line, calling cb for each data line.
- * SSE format: "data: {...}\n"
+ * Save a session ticket for the next airc.  The
+ * file is private, and written whole or not at all.
  */
-int
-httpstream(char *url, char **hdrs, int nhdrs, char *body,
-	void (*cb)(char*, int, void*), void *aux)
+static void
+sesssave(Conn *c, SSL_SESSION *sess)
 {
-	int fd, n, status;
-	pid_t pid;
-	char tmp[4096];
-	Buf line;
-
-	pid = curlexec(url, hdrs, nhdrs, body, 1, &fd);
-	bufinit(&line);
-
-	while((n = read(fd, tmp, sizeof tmp - 1)) > 0){
-		int i;
-		for(i = 0; i < n; i++){
-			if(tmp[i] == '\n'){
-				char *s = bufstr(&line);
-				if(strncmp(s, "data: ", 6) == 0){
-					char *data = s + 6;
-					int dlen = line.len - 6;
-					if(strcmp(data, "[DONE]") != 0)
-						cb(data, dlen, aux);
+	char *path, *dir, *tmp;
+	uchar *der, *p;
+	int n, fd;
+
+	n = i2d_SSL_SESSION(sess, NULL);
+	if(n <= 0)
+		return;
+	der = p = emalloc(n);
+	i2d_SSL_SESSION(sess, &p);
+
+	dir = configdir();
+	path = pathjoin(dir, "tls");
+	mkdirp(path);
+	free(path);
+	free(dir);
+
+	path = sesspath(c);
+	tmp = smprint("%s.%d", path, (int)getpid());
+	fd = open(tmp, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+	if(fd >= 0){
+		if(writen(fd, (char*)der, n) < 0 || close(fd) < 0 || rename(tmp, path) < 0)
+			unlink(tmp);
+	}
+	free(tmp);
+	free(path);
+	free(der);
+}
+
+static SSL_SESSION*
+sessload(Conn *c)
+{
+	char *path;
+	uchar buf[Iosize];
+	const uchar *p;
+	int fd, n;
+
+	path = sesspath(c);
+	fd = open(path, O_RDONLY);
+	free(path);
+	if(fd < 0)
+		return NULL;
+	n = read(fd, buf, sizeof buf);
+	close(fd);
+	if(n <= 0)
+		return NULL;
+	p = buf;
+	return d2i_SSL_SESSION(NULL, &p, n);
+}
+
+/*
+ * Servers hand out (TLS 1.3: several) tickets after
+ * the handshake; keep the latest.
+ */
+static int
+newsess(SSL *ssl, SSL_SESSION *sess)
+{
+	Conn *c;
+
+	c = SSL_get_app_data(ssl);
+	if(c == NULL)
+		return 0;
+	if(c->sess != NULL)
+		SSL_SESSION_free(c->sess);
+	c->sess = sess;
+	sesssave(c, sess);
+	return 1;
+}
+
+static SSL_CTX*
+tlsinit(void)
+{
+	if(tlsctx != NULL)
+		return tlsctx;
+	tlsctx = SSL_CTX_new(TLS_client_method());
+	if(tlsctx == NULL)
+		return NULL;
+	SSL_CTX_set_min_proto_version(tlsctx, TLS1_2_VERSION);
+	SSL_CTX_set_default_verify_paths(tlsctx);
+	SSL_CTX_set_verify(tlsctx, SSL_VERIFY_PEER, NULL);
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+	SSL_CTX_set_options(tlsctx, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+	SSL_CTX_set_session_cache_mode(tlsctx,
+		SSL_SESS_CACHE_CLIENT|SSL_SESS_CACHE_NO_INTERNAL_STORE);
+	SSL_CTX_sess_set_new_cb(tlsctx, newsess);
+	return tlsctx;
+}
+
+static int
+tlsdial(Conn *c)
+{
+	SSL_CTX *ctx;
+
+	ctx = tlsinit();
+	if(ctx == NULL || (c->ssl = SSL_new(ctx)) == NULL){
+		warn("%s: cannot set up tls", c->host);
+		return -1;
+	}
+	SSL_set_app_data(c->ssl, c);
+	SSL_set_fd(c->ssl, c->fd);
+	SSL_set_tlsext_host_name(c->ssl, c->host);
+	SSL_set1_host(c->ssl, c->host);
+	if(c->sess == NULL)
+		c->sess = sessload(c);
+	if(c->sess != NULL)
+		SSL_set_session(c->ssl, c->sess);
+	if(SSL_connect(c->ssl) != 1){
+		warn("%s: tls handshake: %s", c->host,
+			ERR_reason_error_string(ERR_get_error()));
+		return -1;
+	}
+	return 0;
+}
+
+#endif
+
+static void
+connclose(Conn *c)
+{
+	if(c->fd < 0)
+		return;
+#ifdef HAVE_OPENSSL
+	if(c->ssl != NULL){
+		SSL_free(c->ssl);
+		c->ssl = NULL;
+	}
+#endif
+	close(c->fd);
+	c->fd = -1;
+}
+
+static int
+tcpdial(Conn *c)
+{
+	struct addrinfo hints, *ai, *a;
+	int r, one;
+
+	memset(&hints, 0, sizeof hints);
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	r = getaddrinfo(c->host, c->port, &hints, &ai);
+	if(r != 0){
+		warn("%s: %s", c->host, gai_strerror(r));
+		return -1;
+	}
+	for(a = ai; a != NULL; a = a->ai_next){
+		c->fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+		if(c->fd < 0)
+			continue;
+		if(connect(c->fd, a->ai_addr, a->ai_addrlen) == 0)
+			break;
+		close(c->fd);
+		c->fd = -1;
+	}
+	freeaddrinfo(ai);
+	if(c->fd < 0){
+		warn("%s:%s: %s", c->host, c->port, strerror(errno));
+		return -1;
+	}
+	fcntl(c->fd, F_SETFD, FD_CLOEXEC);
+	one = 1;
+	setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+	return 0;
+}
+
+/*
+ * Find the open connection for u, or make one,
+ * evicting the oldest if the table is full.
+ */
+static Conn*
+connget(Url *u)
+{
+	Conn *c;
+	int i;
+
+	c = NULL;
+	for(i = 0; i < nconns; i++){
+		c = &conns[i];
+		if(c->tls == u->tls && strcmp(c->host, u->host) == 0
+		&& strcmp(c->port, u->port) == 0)
+			break;
+	}
+	if(i == nconns){
+		if(nconns == Maxconn){
+			c = &conns[0];
+			connclose(c);
+			free(c->host);
+			free(c->port);
+#ifdef HAVE_OPENSSL
+			if(c->sess != NULL)
+				SSL_SESSION_free(c->sess);
+#endif
+			memmove(&conns[0], &conns[1], sizeof conns[0] * --nconns);
+		}
+		c = &conns[nconns++];
+		memset(c, 0, sizeof *c);
+		c->tls = u->tls;
+		c->host = estrdup(u->host);
+		c->port = estrdup(u->port);
+		c->fd = -1;
+	}
+	if(c->fd >= 0)
+		return c;
+
+	c->nreq = 0;
+	c->off = c->len = 0;
+	if(tcpdial(c) < 0)
+		return NULL;
+#ifdef HAVE_OPENSSL
+	if(c->tls && tlsdial(c) < 0){
+		connclose(c);
+		return NULL;
+	}
+#endif
+	return c;
+}
+
+/*
+ * Send the request head and body.  Plain sockets take
+ * the pieces as they are; for TLS they are packed into
+ * records of up to Iosize, not one record per piece.
+ */
+static int
+connsend(Conn *c, Buf *head, Bufv *body)
+{
+	struct sigaction old;
+	struct iovec *v;
+	int n, r;
+
+	v = iovdup(head, body, &n);
+	nopipe(&old);
+#ifdef HAVE_OPENSSL
+	if(c->ssl != NULL){
+		char *p;
+		int i, len, m;
+
+		p = emalloc(Iosize);
+		len = 0;
+		r = 0;
+		for(i = 0; i <= n && r == 0; i++){
+			if(i < n && len + (int)v[i].iov_len <= Iosize){
+				memcpy(p + len, v[i].iov_base, v[i].iov_len);
+				len += v[i].iov_len;
+				continue;
+			}
+			/* flush what is packed; a big piece goes as is */
+			if(len > 0 && SSL_write(c->ssl, p, len) != len)
+				r = -1;
+			len = 0;
+			if(i < n && r == 0){
+				m = v[i].iov_len;
+				if(m > Iosize / 2){
+					if(SSL_write(c->ssl, v[i].iov_base, m) != m)
+						r = -1;
+				}else{
+					memcpy(p, v[i].iov_base, m);
+					len = m;
 				}
-				bufreset(&line);
-			}else{
-				bufaddc(&line, tmp[i]);
 			}
 		}
+		free(p);
+	}else
+#endif
+	r = writevn(c->fd, v, n);
+	sigaction(SIGPIPE, &old, NULL);
+	free(v);
+	return r;
+}
+
+/* refill buf; returns bytes read, 0 at eof, -1 on error */
+static int
+connfill(Conn *c)
+{
+	int n;
+
+	c->off = 0;
+	c->len = 0;
+	if(stopped)
+		return -1;
+#ifdef HAVE_OPENSSL
+	if(c->ssl != NULL){
+		if(SSL_pending(c->ssl) == 0)
+			waitin(c->fd);
+		n = SSL_read(c->ssl, c->buf, sizeof c->buf);
+		if(n <= 0)
+			n = SSL_get_error(c->ssl, n) == SSL_ERROR_ZERO_RETURN ? 0 : -1;
+		c->len = n > 0 ? n : 0;
+		return n;
 	}
-	/* flush last line */
-	if(line.len > 0){
-		char *s = bufstr(&line);
-		if(strncmp(s, "data: ", 6) == 0){
-			char *data = s + 6;
-			int dlen = line.len - 6;
-			if(strcmp(data, "[DONE]") != 0)
-				cb(data, dlen, aux);
+#endif
+	waitin(c->fd);
+	do
+		n = read(c->fd, c->buf, sizeof c->buf);
+	while(n < 0 && errno == EINTR && !stopped);
+	c->len = n > 0 ? n : 0;
+	return n;
+}
+
+/*
+ * Read a header line into l, without the CRLF.
+ * Returns its length, or -1 at eof or on error.
+ */
+static int
+connline(Conn *c, Buf *l)
+{
+	char *nl;
+	int n;
+
+	bufreset(l);
+	for(;;){
+		if(c->off == c->len && connfill(c) <= 0)
+			return -1;
+		n = c->len - c->off;
+		nl = memchr(c->buf + c->off, '\n', n);
+		if(nl != NULL)
+			n = nl - (c->buf + c->off);
+		bufadd(l, c->buf + c->off, n);
+		c->off += n;
+		if(l->len > Maxline)
+			return -1;
+		if(nl != NULL){
+			c->off++;
+			if(l->len > 0 && l->s[l->len-1] == '\r')
+				l->s[--l->len] = '\0';
+			return l->len;
 		}
 	}
-	buffree(&line);
-	close(fd);
+}
 
-	waitpid(pid, &status, 0);
-	if(WIFEXITED(status) && WEXITSTATUS(status) != 0)
-		return -1;
+/*
+ * Pass n bytes of body to the sink, or all of it
+ * up to eof if n < 0.  Returns 0, or -1 if cut short.
+ */
+static int
+connfeed(Conn *c, long n, Sink *s)
+{
+	int m;
+
+	while(n != 0){
+		if(c->off == c->len){
+			m = connfill(c);
+			if(m < 0 || (m == 0 && n > 0))
+				return -1;
+			if(m == 0)
+				return 0;
+		}
+		m = c->len - c->off;
+		if(n > 0 && m > n)
+			m = n;
+		s->fn(s, c->buf + c->off, m);
+		c->off += m;
+		if(n > 0)
+			n -= m;
+		if(stopped)
+			return -1;
+	}
 	return 0;
 }
+
+/* response header fields we act on */
+typedef struct Resp Resp;
+struct Resp {
+	int	code;
+	long	length;		/* -1: until eof */
+	int	chunked;
+	int	close;
+	long	retry;		/* ms the server asks us to wait; -1 if it did not */
+};
+
+/*
+ * Read the status line and headers, skipping 1xx.
+ * Returns 1, 0 if the peer closed before replying
+ * (an idle connection the server dropped), or -1.
+ */
+static int
+readhead(Conn *c, Resp *r)
+{
+	Buf l;
+	char *v;
+	int minor, n;
+
+	bufinit(&l);
+	do{
+		if(connline(c, &l) < 0){
+			n = l.len == 0 && c->len == 0 ? 0 : -1;
+			buffree(&l);
+			return n;
+		}
+		if(sscanf(l.s, "HTTP/1.%d %d", &minor, &r->code) != 2){
+			buffree(&l);
+			return -1;
+		}
+		r->length = -1;
+		r->chunked = 0;
+		r->close = minor == 0;
+		r->retry = -1;
+		while((n = connline(c, &l)) > 0){
+			v = strchr(l.s, ':');
+			if(v == NULL)
+				continue;
+			for(*v++ = '\0'; *v == ' ' || *v == '\t'; v++)
+				;
+			if(strcasecmp(l.s, "content-length") == 0)
+				r->length = strtol(v, NULL, 10);
+			else if(strcasecmp(l.s, "transfer-encoding") == 0)
+				r->chunked = strstr(v, "chunked") != NULL;
+			else if(strcasecmp(l.s, "retry-after-ms") == 0)
+				r->retry = strtol(v, NULL, 10);
+			else if(strcasecmp(l.s, "retry-after") == 0 && r->retry < 0
+			&& isdigit((uchar)*v))
+				r->retry = strtol(v, NULL, 10) * 1000;	/* not an http-date */
+			else if(strcasecmp(l.s, "connection") == 0){
+				if(strcasecmp(v, "close") == 0)
+					r->close = 1;
+				else if(strcasecmp(v, "keep-alive") == 0)
+					r->close = 0;
+			}
+		}
+		if(n < 0){
+			buffree(&l);
+			return -1;
+		}
+	}while(r->code / 100 == 1);
+	buffree(&l);
+	return 1;
+}
+
+static int
+readbody(Conn *c, Resp *r, Sink *s)
+{
+	Buf l;
+	long n;
+
+	if(r->chunked){
+		bufinit(&l);
+		for(;;){
+			if(connline(c, &l) < 0)
+				break;
+			n = strtol(l.s, NULL, 16);
+			if(n <= 0){
+				/* trailers */
+				while(connline(c, &l) > 0)
+					;
+				buffree(&l);
+				return 0;
+			}
+			if(connfeed(c, n, s) < 0 || connline(c, &l) != 0)
+				break;
+		}
+		buffree(&l);
+		return -1;
+	}
+	if(r->length >= 0)
+		return r->length > 0 ? connfeed(c, r->length, s) : 0;
+	r->close = 1;
+	return connfeed(c, -1, s);
+}
+
+/*
+ * POST body to url over a kept connection.  A
+ * connection that was closed while idle is only
+ * found out when the reply does not come, so then
+ * the request is sent again on a fresh one.
+ */
+static int
+httpdo(Url *u, char **hdrs, int nhdrs, Bufv *body, Sink *s, int *code)
+{
+	Conn *c;
+	Resp r;
+	Buf req;
+	int tries, reused, ret;
+
+	c = NULL;
+	bufinit(&req);
+	bufaddstr(&req, "POST ");
+	bufaddstr(&req, u->path);
+	bufaddstr(&req, " HTTP/1.1\r\nHost: ");
+	bufaddstr(&req, u->host);
+	if(strcmp(u->port, u->tls ? "443" : "80") != 0){
+		bufaddc(&req, ':');
+		bufaddstr(&req, u->port);
+	}
+	bufaddstr(&req, "\r\nUser-Agent: airc\r\n");
+	for(int h = 0; h < nhdrs; h++){
+		bufaddstr(&req, hdrs[h]);
+		bufaddstr(&req, "\r\n");
+	}
+	bufaddfmt(&req, "Content-Length: %ld\r\n\r\n", body->len);
+
+	ret = -1;
+	for(tries = 0; tries < 2; tries++){
+		c = connget(u);
+		if(c == NULL)
+			break;
+		reused = c->nreq > 0;
+		if(connsend(c, &req, body) < 0)
+			ret = 0;
+		else
+			ret = readhead(c, &r);
+		if(ret > 0)
+			break;
+		connclose(c);
+		if(!reused || stopped)
+			break;
+	}
+	buffree(&req);
+	if(ret <= 0 && stopped)
+		return 0;
+	if(ret <= 0){
+		if(c != NULL)
+			warn("%s: no response", u->host);
+		return -1;
+	}
+
+	*code = lastcode = r.code;
+	lastretry = r.retry;
+	if(r.code / 100 != 2)
+		s->fn = bufsink;
+	ret = readbody(c, &r, s);
+	if(stopped){
+		connclose(c);
+		return 0;
+	}
+	if(ret < 0)
+		warn("%s: response cut short", u->host);
+	if(ret < 0 || r.close)
+		connclose(c);
+	else
+		c->nreq++;
+	return ret;
+}
+
+/*
+ * Send the request natively if we can,
+ * else through curl.
+ */
+static int
+httpsend(char *url, char **hdrs, int nhdrs, Bufv *body, Sink *s, int *code)
+{
+	Url u;
+	int ret;
+
+	*code = 200;
+	lastcode = 0;
+	lastretry = -1;
+	if(urlparse(url, &u) < 0){
+		warn("bad url: %s", url);
+		return -1;
+	}
+#ifndef HAVE_OPENSSL
+	if(u.tls){
+		urlfree(&u);
+		ret = curlrun(url, hdrs, nhdrs, body, s);
+		lastcode = ret == 0 ? 200 : 0;
+		return ret;
+	}
+#endif
+	ret = httpdo(&u, hdrs, nhdrs, body, s, code);
+	urlfree(&u);
+	return ret;
+}
+
+/*
+ * POST request, read entire response into buf.
+ * The body goes out in its pieces, unjoined.
+ * Returns 0 on success, -1 on error.
+ */
+int
+httppost(char *url, char **hdrs, int nhdrs, Bufv *body, Buf *resp)
+{
+	Sink s;
+	int code;
+
+	bufreset(resp);
+	memset(&s, 0, sizeof s);
+	s.fn = bufsink;
+	s.resp = resp;
+	return httpsend(url, hdrs, nhdrs, body, &s, &code);
+}
+
+/*
+ * POST request with streaming (SSE).
+ * Calls cb for each data line as it arrives;
+ * the line is NUL-terminated, and cb may write
+ * over it.
+ * An error reply is not an event stream, so
+ * it is reported instead.  Stopped, it returns
+ * 0, having passed on what came before.
+ */
+int
+httpstream(char *url, char **hdrs, int nhdrs, Bufv *body,
+	void (*cb)(char*, int, void*), void *aux)
+{
+	Sink s;
+	Buf err;
+	int code, ret;
+
+	memset(&s, 0, sizeof s);
+	bufinit(&err);
+	bufinit(&s.line);
+	s.fn = ssesink;
+	s.resp = &err;
+	s.cb = cb;
+	s.aux = aux;
+	ret = httpsend(url, hdrs, nhdrs, body, &s, &code);
+	if(ret == 0 && code / 100 != 2){
+		warn("%s: http %d: %s", url, code, trim(bufstr(&err)));
+		ret = -1;
+	}else if(!stopped)
+		sseflush(&s);
+	buffree(&s.line);
+	buffree(&err);
+	return ret;
+}
+
+/*
+ * While a reply is awaited, fn(aux) is called each time
+ * the input would be waited for.  It returns how many ms
+ * it may go before it is called again, or -1 if it need
+ * not be.  fn nil stops it.
+ */
+void
+httpidle(long (*fn)(void*), void *aux)
+{
+	idlefn = fn;
+	idleaux = aux;
+}
+
+/*
+ * For one that waits for a reply some other way (hedge.c):
+ * calls the idle fn, and returns what it did, or -1.
+ */
+long
+httpquiet(void)
+{
+	return idlefn != NULL ? idlefn(idleaux) : -1;
+}
+
+/*
+ * In a forked child, leave the kept-open connections,
+ * and the idle fn, to the parent.  Our copies of the
+ * sockets are closed, without a word to the server.
+ */
+void
+httpforget(void)
+{
+	int i;
+
+	for(i = 0; i < nconns; i++)
+		connclose(&conns[i]);
+	idlefn = NULL;
+	idleaux = NULL;
+}
+
+/*
+ * httpstop(1) stops the request in progress, or the
+ * next; it may be called from a signal handler, which
+ * should be installed without SA_RESTART, so that a
+ * read waiting for the reply returns.  httpstop(0)
+ * lets requests run again.
+ */
+void
+httpstop(int on)
+{
+	stopped = on;
+}
+
+int
+httpstopped(void)
+{
+	return stopped;
+}
+
+/*
+ * The status code of the last reply, 0 if
+ * there was none, and in *retry how many ms
+ * it asked us to wait (Retry-After), or -1.
+ */
+int
+httpstatus(long *retry)
+{
+	*retry = lastretry;
+	return lastcode;
+}
@@ -1,7 +1,9 @@
 /*
  * json.c - minimal JSON parser and builder
  *
- * Recursive descent parser for JSON values.
+ * Recursive descent parser for JSON values, and a
+ * pull scanner that finds one value without a tree.
+ * jsondoc parses a whole document into one arena.
  * Builder helpers for constructing API request bodies.
  * No external dependencies.
  */
@@ -16,6 +18,82 @@ static Json *parsearray(char**);
 static Json *parsebool(char**);
 static Json *parsenull(char**);
 
+/*
+ * A document from jsondoc lives in an arena: its nodes
+ * come from a few large blocks, its strings are the
+ * source text unescaped in place, and jsonfree of the
+ * root gives back the lot.
+ */
+struct Jarena {
+	Json	*root;
+	char	*src;
+	char	*blk;		/* current block; first word links to the last */
+	char	*p, *e;		/* free part of it */
+	ulong	blksize;
+};
+
+enum {
+	Jblkmin = 4096,
+	Jblkmax = 1<<20,
+	Jhashmin = 16,		/* objects this big get a hash index */
+};
+
+static Jarena *arena;		/* set while jsondoc parses */
+
+static void*
+jalloc(Jarena *a, ulong n)
+{
+	char *b, *v;
+	ulong sz;
+
+	if(a == NULL)
+		return emalloc(n);
+	n = (n + sizeof(double) - 1) & ~(ulong)(sizeof(double) - 1);
+	if(a->p == NULL || (ulong)(a->e - a->p) < n){
+		if(a->blksize < Jblkmax)
+			a->blksize = a->blksize == 0 ? Jblkmin : 2 * a->blksize;
+		sz = a->blksize;
+		if(sz < n + sizeof(double))
+			sz = n + sizeof(double);
+		b = emalloc(sz);
+		*(char**)b = a->blk;
+		a->blk = b;
+		a->p = b + sizeof(double);
+		a->e = b + sz;
+	}
+	v = a->p;
+	a->p += n;
+	memset(v, 0, n);
+	return v;
+}
+
+static void
+jarenafree(Jarena *a)
+{
+	char *b, *next;
+
+	for(b = a->blk; b != NULL; b = next){
+		next = *(char**)b;
+		free(b);
+	}
+	free(a->src);
+	free(a);
+}
+
+static Json*
+jnew(int type)
+{
+	Json *j;
+
+	j = jalloc(arena, sizeof *j);
+	j->type = type;
+	j->arena = arena;
+	return j;
+}
+
+static char*
+skipstr(char*);
+
 static char*
 skipws(char *s)
 {
@@ -24,12 +102,58 @@ skipws(char *s)
 	return s;
 }
 
+/* UTF-8 encode u into s; returns the length */
+static int
+runeput(char *s, uint u)
+{
+	if(u < 0x80){
+		s[0] = u;
+		return 1;
+	}
+	if(u < 0x800){
+		s[0] = 0xC0 | (u >> 6);
+		s[1] = 0x80 | (u & 0x3F);
+		return 2;
+	}
+	if(u < 0x10000){
+		s[0] = 0xE0 | (u >> 12);
+		s[1] = 0x80 | ((u >> 6) & 0x3F);
+		s[2] = 0x80 | (u & 0x3F);
+		return 3;
+	}
+	s[0] = 0xF0 | (u >> 18);
+	s[1] = 0x80 | ((u >> 12) & 0x3F);
+	s[2] = 0x80 | ((u >> 6) & 0x3F);
+	s[3] = 0x80 | (u & 0x3F);
+	return 4;
+}
+
+static int
+hex4(char *s, uint *up)
+{
+	int i;
+
+	*up = 0;
+	for(i = 0; i < 4; i++){
+		*up <<= 4;
+		if(s[i] >= '0' && s[i] <= '9')
+			*up |= s[i] - '0';
+		else if(s[i] >= 'a' && s[i] <= 'f')
+			*up |= s[i] - 'a' + 10;
+		else if(s[i] >= 'A' && s[i] <= 'F')
+			*up |= s[i] - 'A' + 10;
+		else
+			return -1;
+	}
+	return 0;
+}
+
 static char*
 parseesc(char **sp, Buf *b)
 {
 	char *s;
 	int i;
-	unsigned u;
+	uint u, lo;
 	char utf[8];
 
 	s = *sp;
@@ -60,20 +184,12 @@ parseesc(char **sp, Buf *b)
 					else if(*s >= 'A' && *s <= 'F')
 						u |= *s - 'A' + 10;
 				}
-				/* simple UTF-8 encode */
-				if(u < 0x80){
-					utf[0] = u;
-					bufadd(b, utf, 1);
-				}else if(u < 0x800){
-					utf[0] = 0xC0 | (u >> 6);
-					utf[1] = 0x80 | (u & 0x3F);
-					bufadd(b, utf, 2);
-				}else{
-					utf[0] = 0xE0 | (u >> 12);
-					utf[1] = 0x80 | ((u >> 6) & 0x3F);
-					utf[2] = 0x80 | (u & 0x3F);
-					bufadd(b, utf, 3);
+				if(u >= 0xD800 && u < 0xDC00 && s[0] == '\\' && s[1] == 'u'
+				&& hex4(s + 2, &lo) == 0 && lo >= 0xDC00 && lo < 0xE000){
+					u = 0x10000 + ((u - 0xD800) << 10) + (lo - 0xDC00);
+					s += 6;
 				}
+				bufadd(b, utf, runeput(utf, u));
 				continue; /* already advanced s */
 			default:
 				bufaddc(b, *s);
@@ -91,18 +207,44 @@ parseesc(char **sp, Buf *b)
 	return bufstr(b);
 }
 
-static Json*
-parsestring(char **sp)
+/*
+ * Read a string: a copy, or in a document, the
+ * source itself, unescaped where it stands.
+ */
+static char*
+parsestr(char **sp)
 {
-	Json *j;
+	char *s, *e;
 	Buf b;
 
+	if(arena != NULL){
+		s = *sp;
+		e = skipstr(s);
+		if(e == NULL)
+			e = s + strlen(s);
+		*sp = e;
+		if(memchr(s + 1, '\\', e - s - 1) == NULL && e[-1] == '"' && e - 1 > s){
+			e[-1] = '\0';	/* no escapes: just the slice */
+			return s + 1;
+		}
+		if(jsonunq(s) < 0)
+			*s = '\0';
+		return s;
+	}
 	bufinit(&b);
-	j = emalloc(sizeof *j);
-	j->type = Jstring;
 	parseesc(sp, &b);
-	j->str = estrdup(bufstr(&b));
+	s = estrdup(bufstr(&b));
 	buffree(&b);
+	return s;
+}
+
+static Json*
+parsestring(char **sp)
+{
+	Json *j;
+
+	j = jnew(Jstring);
+	j->str = parsestr(sp);
 	return j;
 }
 
@@ -113,8 +255,7 @@ parsenumber(char **sp)
 	char *s, *end;
 
 	s = *sp;
-	j = emalloc(sizeof *j);
-	j->type = Jnumber;
+	j = jnew(Jnumber);
 	j->num = strtod(s, &end);
 	*sp = end;
 	return j;
@@ -124,16 +265,14 @@ static Json*
 parseobject(char **sp)
 {
 	Json *j, *field, *tail;
-	char *s;
-	Buf kb;
+	char *s, *key;
 
 	s = *sp;
 	if(*s != '{')
 		return NULL;
 	s++;
 
-	j = emalloc(sizeof *j);
-	j->type = Jobject;
+	j = jnew(Jobject);
 	tail = NULL;
 
 	s = skipws(s);
@@ -143,8 +282,7 @@ parseobject(char **sp)
 			continue;
 		}
 		/* parse key */
-		bufinit(&kb);
-		parseesc(&s, &kb);
+		key = parsestr(&s);
 
 		s = skipws(s);
 		if(*s == ':')
@@ -154,14 +292,14 @@ parseobject(char **sp)
 		/* parse value */
 		field = parsevalue(&s);
 		if(field != NULL){
-			field->key = estrdup(bufstr(&kb));
+			field->key = key;
 			if(tail == NULL)
 				j->child = field;
 			else
 				tail->next = field;
 			tail = field;
-		}
-		buffree(&kb);
+		}else if(arena == NULL)
+			free(key);
 
 		s = skipws(s);
 		if(*s == ',')
@@ -185,8 +323,7 @@ parsearray(char **sp)
 		return NULL;
 	s++;
 
-	j = emalloc(sizeof *j);
-	j->type = Jarray;
+	j = jnew(Jarray);
 	tail = NULL;
 
 	s = skipws(s);
@@ -217,8 +354,7 @@ parsebool(char **sp)
 	char *s;
 
 	s = *sp;
-	j = emalloc(sizeof *j);
-	j->type = Jbool;
+	j = jnew(Jbool);
 	if(strncmp(s, "true", 4) == 0){
 		j->bval = 1;
 		*sp = s + 4;
@@ -234,8 +370,7 @@ parsenull(char **sp)
 {
 	Json *j;
 
-	j = emalloc(sizeof *j);
-	j->type = Jnull;
+	j = jnew(Jnull);
 	*sp += 4;
 	return j;
 }
@@ -276,28 +411,112 @@ jsonparse(char *s)
 	return parsevalue(&s);
 }
 
+/*
+ * Parse s, which must be malloc'd, as a document:
+ * see Jarena.  s belongs to the document from then
+ * on, and is freed with it.
+ */
+Json*
+jsondoc(char *s)
+{
+	Jarena *a;
+	Json *j;
+	char *p;
+
+	if(s == NULL)
+		return NULL;
+	a = emalloc(sizeof *a);
+	a->src = s;
+	arena = a;
+	p = skipws(s);
+	j = parsevalue(&p);
+	arena = NULL;
+	if(j == NULL){
+		jarenafree(a);
+		return NULL;
+	}
+	a->root = j;
+	return j;
+}
+
 void
 jsonfree(Json *j)
 {
 	Json *next;
 
+	if(j != NULL && j->arena != NULL){
+		if(j->arena->root == j)
+			jarenafree(j->arena);
+		return;
+	}
 	while(j != NULL){
 		next = j->next;
 		free(j->key);
 		free(j->str);
+		free(j->idx);
 		jsonfree(j->child);
 		free(j);
 		j = next;
 	}
 }
 
+static uint
+jhash(char *s)
+{
+	uint h;
+
+	for(h = 2166136261u; *s != '\0'; s++)
+		h = (h ^ (uchar)*s) * 16777619u;
+	return h;
+}
+
+/*
+ * Index a big object's fields by key, the first
+ * time one is looked up.  Small objects are left
+ * to the linear search (nidx < 0).
+ */
+static void
+jsonindex(Json *j)
+{
+	Json *c;
+	int n, h;
+
+	n = jsonlen(j);
+	if(n < Jhashmin){
+		j->nidx = -1;
+		return;
+	}
+	for(j->nidx = 1; j->nidx < 2 * n; j->nidx <<= 1)
+		;
+	j->idx = jalloc(j->arena, sizeof(Json*) * j->nidx);
+	for(c = j->child; c != NULL; c = c->next){
+		if(c->key == NULL)
+			continue;
+		h = jhash(c->key) & (j->nidx - 1);
+		while(j->idx[h] != NULL && strcmp(j->idx[h]->key, c->key) != 0)
+			h = (h + 1) & (j->nidx - 1);
+		if(j->idx[h] == NULL)
+			j->idx[h] = c;	/* the first of a repeated key wins */
+	}
+}
+
 Json*
 jsonget(Json *j, char *key)
 {
 	Json *c;
+	int h;
 
 	if(j == NULL || j->type != Jobject)
 		return NULL;
+	if(j->nidx == 0)
+		jsonindex(j);
+	if(j->nidx > 0){
+		h = jhash(key) & (j->nidx - 1);
+		for(; (c = j->idx[h]) != NULL; h = (h + 1) & (j->nidx - 1))
+			if(strcmp(c->key, key) == 0)
+				return c;
+		return NULL;
+	}
 	for(c = j->child; c != NULL; c = c->next)
 		if(c->key != NULL && strcmp(c->key, key) == 0)
 			return c;
@@ -363,6 +582,166 @@ jsonlen(Json *j)
 	return n;
 }
 
+/*
+ * Pull scanning.  jsonfind follows path, object keys and
+ * array indices separated by dots ("choices.0.delta.content"),
+ * through the text at s, skipping over everything else.
+ * Nothing is built or allocated, so a streamed chunk can
+ * be picked at in place.  Keys are matched as written.
+ * Returns the start of the value, or NULL.
+ */
+static char*
+skipstr(char *s)
+{
+	for(s++; *s != '"'; s++)
+		if(*s == '\0' || (*s == '\\' && *++s == '\0'))
+			return NULL;
+	return s + 1;
+}
+
+static char*
+skipval(char *s)
+{
+	int depth;
+
+	depth = 0;
+	do{
+		s = skipws(s);
+		switch(*s){
+		case '\0':
+			return NULL;
+		case '"':
+			if((s = skipstr(s)) == NULL)
+				return NULL;
+			break;
+		case '{':
+		case '[':
+			depth++;
+			s++;
+			break;
+		case '}':
+		case ']':
+			if(depth-- == 0)
+				return NULL;
+			s++;
+			break;
+		case ',':
+		case ':':
+			if(depth == 0)
+				return NULL;
+			s++;
+			break;
+		default:
+			/* number, true, false, null */
+			while(*s != '\0' && strchr(",:]} \t\r\n", *s) == NULL)
+				s++;
+			break;
+		}
+	}while(depth > 0);
+	return s;
+}
+
+char*
+jsonfind(char *s, char *path)
+{
+	char *e, *k;
+	int klen, i;
+
+	s = skipws(s);
+	while(*path != '\0'){
+		for(e = path; *e != '\0' && *e != '.'; e++)
+			;
+		klen = e - path;
+		if(*s == '{'){
+			s = skipws(s + 1);
+			for(;;){
+				if(*s != '"')
+					return NULL;
+				k = s + 1;
+				if((s = skipstr(s)) == NULL)
+					return NULL;
+				i = s - 1 - k == klen && memcmp(k, path, klen) == 0;
+				s = skipws(s);
+				if(*s++ != ':')
+					return NULL;
+				s = skipws(s);
+				if(i)
+					break;
+				if((s = skipval(s)) == NULL)
+					return NULL;
+				s = skipws(s);
+				if(*s++ != ',')
+					return NULL;
+				s = skipws(s);
+			}
+		}else if(*s == '[' && isdigit((uchar)*path)){
+			s = skipws(s + 1);
+			for(i = atoi(path); i > 0; i--){
+				if((s = skipval(s)) == NULL)
+					return NULL;
+				s = skipws(s);
+				if(*s++ != ',')
+					return NULL;
+				s = skipws(s);
+			}
+			if(*s == ']')
+				return NULL;
+		}else
+			return NULL;
+		path = *e != '\0' ? e + 1 : e;
+	}
+	return s;
+}
+
+/*
+ * Unescape the string value at s in place (it only
+ * gets shorter), leaving it NUL-terminated at s.
+ * Returns its length, or -1 if s is not a string.
+ */
+int
+jsonunq(char *s)
+{
+	char *r, *w;
+	uint u, lo;
+
+	if(*s != '"')
+		return -1;
+	w = s;
+	for(r = s + 1; *r != '"'; r++){
+		if(*r == '\0')
+			return -1;
+		if(*r != '\\'){
+			*w++ = *r;
+			continue;
+		}
+		switch(*++r){
+		case '\0': return -1;
+		case 'b':  *w++ = '\b'; break;
+		case 'f':  *w++ = '\f'; break;
+		case 'n':  *w++ = '\n'; break;
+		case 'r':  *w++ = '\r'; break;
+		case 't':  *w++ = '\t'; break;
+		case 'u':
+			if(hex4(r + 1, &u) < 0)
+				return -1;
+			r += 4;
+			/* a surrogate pair is one rune */
+			if(u >= 0xD800 && u < 0xDC00 && r[1] == '\\' && r[2] == 'u'
+			&& hex4(r + 3, &lo) == 0 && lo >= 0xDC00 && lo < 0xE000){
+				u = 0x10000 + ((u - 0xD800) << 10) + (lo - 0xDC00);
+				r += 6;
+			}
+			w += runeput(w, u);
+			break;
+		default:
+			*w++ = *r;
+			break;
+		}
+	}
+	*w = '\0';
+	return w - s;
+}
+
 /*
  * Escape a string for JSON output.
  * Writes the quoted, escaped string into buf.
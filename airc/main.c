@@ -12,6 +12,8 @@
  *   airc -e "description"    rc shell assistant
  *   airc -c "request"        code-only output
  *   echo text | airc "prompt" pipe mode
+ *   airc -b "prompt" < recs  batch mode
+ *   airc -S                  serve requests (see serve.c)
  */
 
 #include "airc.h"
@@ -32,6 +34,12 @@ usage(void)
 		"  -t temp     temperature (0.0 - 2.0, default 0.7)\n"
 		"  -n tokens   max response tokens (default 4096)\n"
 		"  -1          disable streaming (wait for complete response)\n"
+		"  -u          unbuffered: write streamed text as it comes\n"
+		"  -F          ask afresh, not from the answer cache\n"
+		"  -b          batch: answer each JSON line (or -0 record) on stdin\n"
+		"  -j n        batch: up to n requests at once (default 4)\n"
+		"  -0          batch: records are NUL-separated text\n"
+		"  -S          serve requests on a socket, for rc's srv -c\n"
 		"  -h          show this help\n"
 		"\n"
 		"environment:\n"
@@ -42,19 +50,57 @@ usage(void)
 		"\n"
 		"config: ~/.airc/config, ~/.airc/keys\n"
 		"roles: ~/.airc/roles/<name>\n"
-		"sessions: ~/.airc/sessions/<name>.json\n"
+		"sessions: ~/.airc/sessions/<name>.log\n"
 	);
 	exit(1);
 }
 
-/* streaming output callback */
-static void
-printchunk(char *text, int len, void *aux)
+/*
+ * Answer conv, from the cache if it holds the answer,
+ * and print it.  A new answer is kept for next time,
+ * and either way ends up as conv's tail.  With fence,
+ * a streamed answer ends with its first fenced block.
+ * Returns 0 on success, 1 if interrupted (what came
+ * of the answer is in conv), -1 on error.
+ */
+static int
+ask(Config *cfg, Provider *p, Conv *conv, int stream, int fence)
 {
-	(void)len;
-	(void)aux;
-	fputs(text, stdout);
-	fflush(stdout);
+	Cachekey key;
+	Render r;
+	Buf resp;
+	char *text;
+	int ret;
+
+	text = cacheget(cfg, p, conv, &key);
+	if(text != NULL){
+		/* as one chunk: nothing to wait for */
+		fputs(text, stdout);
+		fflush(stdout);
+		convadd(conv, "assistant", text);
+		free(text);
+		return 0;
+	}
+
+	if(stream){
+		renderinit(&r, stdout, cfg->unbuffered, fence);
+		ret = hedgestream(p, conv, cfg, renderput, &r);
+		renderend(&r);
+		if(r.intr)
+			return 1;
+	}else{
+		bufinit(&resp);
+		ret = aicomplete(p, conv, cfg, &resp);
+		if(ret == 0 && resp.len > 0){
+			fputs(bufstr(&resp), stdout);
+			convadd(conv, "assistant", bufstr(&resp));
+		}
+		buffree(&resp);
+	}
+	if(ret == 0 && conv->tail != NULL
+	&& strcmp(conv->tail->role, "assistant") == 0)
+		cacheput(cfg, &key, conv->tail->content, strlen(conv->tail->content));
+	return ret;
 }
 
 /*
@@ -83,23 +129,23 @@ readstdin(void)
 }
 
 /*
- * Run a single-shot query.
+ * Run a single-shot query, as the next turn
+ * of sess if there is one.
  */
 static void
-cmdmode(Config *cfg, Provider *p, char *text, char *sysprompt,
+cmdmode(Config *cfg, Provider *p, Session *sess, char *text, char *sysprompt,
 	char *filedata, int codeonly)
 {
 	Conv *conv;
 	Buf input;
 
-	conv = convnew();
+	conv = sess != NULL ? &sess->conv : convnew();
 
+	if(codeonly && sysprompt == NULL)
+		sysprompt = "Respond with only code. No explanations, no markdown "
+			"fences, no commentary. Just the raw code.";
 	if(sysprompt != NULL)
-		convadd(conv, "system", sysprompt);
-	else if(codeonly)
-		convadd(conv, "system",
-			"Respond with only code. No explanations, no markdown "
-			"fences, no commentary. Just the raw code.");
+		convsys(conv, sysprompt);
 
 	/* build user message with optional file and stdin */
 	bufinit(&input);
@@ -113,18 +159,11 @@ cmdmode(Config *cfg, Provider *p, char *text, char *sysprompt,
 	convadd(conv, "user", bufstr(&input));
 	buffree(&input);
 
-	if(cfg->stream)
-		aistream(p, conv, cfg, printchunk, NULL);
-	else{
-		Buf resp;
-		bufinit(&resp);
-		if(aicomplete(p, conv, cfg, &resp) == 0)
-			fputs(bufstr(&resp), stdout);
-		buffree(&resp);
-	}
+	ask(cfg, p, conv, cfg->stream, codeonly);
 	fputs("\n", stdout);
 
-	convfree(conv);
+	if(sess == NULL)
+		convfree(conv);
 }
 
 /*
@@ -136,6 +175,7 @@ shellmode(Config *cfg, Provider *p, char *text)
 {
 	Conv *conv;
 	char *prompt;
+	int ret;
 
 	prompt = shellprompt();
 	conv = convnew();
@@ -143,8 +183,11 @@ shellmode(Config *cfg, Provider *p, char *text)
 	convadd(conv, "user", text);
 
 	/* generate the command (streaming to show progress) */
-	if(aistream(p, conv, cfg, printchunk, NULL) < 0){
-		warn("command generation failed");
+	if((ret = ask(cfg, p, conv, True, True)) != 0){
+		if(ret < 0)
+			warn("command generation failed");
+		else
+			fputs("\n", stdout);
 		free(prompt);
 		convfree(conv);
 		return;
@@ -163,16 +206,23 @@ shellmode(Config *cfg, Provider *p, char *text)
 	convfree(conv);
 }
 
+/*
+ * Do what airc's arguments say, with the config
+ * loaded; in is what came on stdin, or NULL.  For
+ * serve.c, serving, it neither exits nor runs the
+ * repl or a batch, and the session is kept warm.
+ * Returns the exit status.
+ */
 int
-main(int argc, char *argv[])
+airun(Config *cfg, int argc, char *argv[], char *in, int serving)
 {
-	Config *cfg;
 	Provider *p;
 	Session *sess;
 	Role *role;
 	char *modelspec, *rolename, *sessname, *filepath;
-	char *text, *stdindata, *filedata, *envmodel;
-	int mode, opt;
+	char *text, *filedata, *envmodel;
+	int mode, opt, njob, nulsep, exitcode;
+	int temp, maxtoken, stream, fresh, unbuffered;
 	Buf textbuf;
 
 	modelspec = NULL;
@@ -180,8 +230,23 @@ main(int argc, char *argv[])
 	sessname = NULL;
 	filepath = NULL;
 	mode = Mcmd;
-
-	while((opt = getopt(argc, argv, "m:r:s:ecf:t:n:1h")) != -1){
+	njob = 4;
+	exitcode = 0;
+	nulsep = 0;
+
+	/* a request's overrides last only for it */
+	temp = cfg->temp;
+	maxtoken = cfg->maxtoken;
+	stream = cfg->stream;
+	fresh = cfg->fresh;
+	unbuffered = cfg->unbuffered;
+
+#ifdef __GLIBC__
+	optind = 0;	/* start afresh, not where the last request left off */
+#else
+	optind = 1;
+#endif
+	while((opt = getopt(argc, argv, "m:r:s:ecbf:t:n:j:01FuSh")) != -1){
 		switch(opt){
 		case 'm':
 			modelspec = optarg;
@@ -198,32 +263,18 @@ main(int argc, char *argv[])
 		case 'c':
 			mode = Mcode;
 			break;
-		case 'f':
-			filepath = optarg;
+		case 'b':
+			mode = Mbatch;
 			break;
-		case 't':
-			/* handled after config load */
+		case 'j':
+			njob = atoi(optarg);
 			break;
-		case 'n':
-			/* handled after config load */
+		case '0':
+			nulsep = 1;
 			break;
-		case '1':
-			/* handled after config load */
+		case 'f':
+			filepath = optarg;
 			break;
-		case 'h':
-		default:
-			usage();
-		}
-	}
-
-	/* load configuration */
-	cfg = configload(NULL);
-
-	/* apply command-line overrides */
-	/* re-parse for numeric options */
-	optind = 1;
-	while((opt = getopt(argc, argv, "m:r:s:ecf:t:n:1h")) != -1){
-		switch(opt){
 		case 't':
 			cfg->temp = (int)(atof(optarg) * 100);
 			break;
@@ -233,9 +284,28 @@ main(int argc, char *argv[])
 		case '1':
 			cfg->stream = False;
 			break;
+		case 'F':
+			cfg->fresh = True;
+			break;
+		case 'u':
+			cfg->unbuffered = True;
+			break;
+		case 'S':
+			if(!serving)
+				break;
+			/* fall through */
+		case 'h':
+		default:
+			if(!serving)
+				usage();
+			warn("bad request; see airc -h");
+			exitcode = 1;
+			goto out;
 		}
 	}
 
+	shellkeep(cfg->coproc);
+
 	/* environment variable overrides */
 	envmodel = getenv("AIRC_MODEL");
 	if(envmodel != NULL && *envmodel != '\0')
@@ -247,9 +317,12 @@ main(int argc, char *argv[])
 	else
 		p = configprov(cfg, NULL);
 
-	if(p == NULL)
-		fatal("no API provider configured\n"
+	if(p == NULL){
+		warn("no API provider configured\n"
 			"set OPENAI_API_KEY or ANTHROPIC_API_KEY, or create ~/.airc/keys");
+		exitcode = 1;
+		goto out;
+	}
 
 	/* ensure config directory exists */
 	mkdirp(cfg->dir);
@@ -265,24 +338,27 @@ main(int argc, char *argv[])
 	/* load session if specified */
 	sess = NULL;
 	if(sessname != NULL){
-		sess = sessionload(cfg, sessname);
-		if(sess == NULL)
-			sess = sessionnew(sessname);
+		/* no more than fits without trimming */
+		if(serving)
+			sess = servesession(cfg, sessname, provbudget(p, cfg) * 3 / 4);
+		else{
+			sess = sessionload(cfg, sessname, provbudget(p, cfg) * 3 / 4);
+			if(sess == NULL)
+				sess = sessionnew(sessname);
+		}
 	}
 
 	/* load file if specified */
 	filedata = NULL;
 	if(filepath != NULL){
 		filedata = readfile(filepath);
-		if(filedata == NULL)
-			fatal("cannot read file: %s", filepath);
+		if(filedata == NULL){
+			warn("cannot read file: %s", filepath);
+			exitcode = 1;
+			goto done;
+		}
 	}
 
-	/* read stdin if piped */
-	stdindata = NULL;
-	if(!isterm(0) && mode != Mrepl)
-		stdindata = readstdin();
-
 	/* collect remaining args as text */
 	bufinit(&textbuf);
 	{
@@ -295,42 +371,45 @@ main(int argc, char *argv[])
 	}
 
 	/* merge stdin with text */
-	if(stdindata != NULL){
+	if(in != NULL && mode != Mbatch){
 		if(textbuf.len > 0){
 			/* stdin as context, args as instruction */
 			char *combined = smprint("Input:\n```\n%s\n```\n\n%s",
-				stdindata, bufstr(&textbuf));
+				in, bufstr(&textbuf));
 			bufreset(&textbuf);
 			bufaddstr(&textbuf, combined);
 			free(combined);
 		}else{
-			bufaddstr(&textbuf, stdindata);
+			bufaddstr(&textbuf, in);
 		}
-		free(stdindata);
 	}
 
 	text = bufstr(&textbuf);
 
 	/* dispatch based on mode */
-	if(textbuf.len == 0 && mode == Mcmd){
+	if(mode == Mbatch && !serving){
+		if(batchrun(cfg, p, role ? role->prompt : NULL, text, njob, nulsep) > 0)
+			exitcode = 1;
+	}else if(textbuf.len == 0 && mode == Mcmd && !serving){
 		/* no text: enter REPL */
 		replrun(cfg, p, sess, role);
-	}else if(textbuf.len == 0){
-		fatal("no input text provided");
+	}else if(textbuf.len == 0 || mode == Mbatch){
+		warn(mode == Mbatch ? "no batches served" : "no input text provided");
+		exitcode = 1;
 	}else{
 		switch(mode){
 		case Mshell:
 			shellmode(cfg, p, text);
 			break;
 		case Mcode:
-			cmdmode(cfg, p, text,
+			cmdmode(cfg, p, sess, text,
 				"Respond with only code. No explanations, "
 				"no markdown fences, no commentary.",
 				filedata, 1);
 			break;
 		case Mcmd:
 		default:
-			cmdmode(cfg, p, text,
+			cmdmode(cfg, p, sess, text,
 				role ? role->prompt : NULL,
 				filedata, 0);
 			break;
@@ -341,11 +420,54 @@ main(int argc, char *argv[])
 	if(sess != NULL && sessname != NULL)
 		sessionsave(cfg, sess);
 
-	/* cleanup */
 	buffree(&textbuf);
+done:
 	free(filedata);
 	rolefree(role);
-	sessionfree(sess);
+	if(!serving)
+		sessionfree(sess);
+out:
+	cfg->temp = temp;
+	cfg->maxtoken = maxtoken;
+	cfg->stream = stream;
+	cfg->fresh = fresh;
+	cfg->unbuffered = unbuffered;
+	return exitcode;
+}
+
+int
+main(int argc, char *argv[])
+{
+	Config *cfg;
+	char *in;
+	int opt, serve, batch, exitcode;
+
+	serve = False;
+	batch = False;
+	opterr = 0;
+	while((opt = getopt(argc, argv, "m:r:s:ecbf:t:n:j:01FuSh")) != -1){
+		if(opt == 'S')
+			serve = True;
+		else if(opt == 'b')
+			batch = True;
+	}
+	opterr = 1;
+
+	/* load configuration */
+	cfg = configload(NULL);
+	if(serve){
+		exitcode = serverun(cfg);
+		configfree(cfg);
+		return exitcode;
+	}
+
+	/* read stdin if piped */
+	in = NULL;
+	if(!isterm(0) && !batch)
+		in = readstdin();
+
+	exitcode = airun(cfg, argc, argv, in, False);
+	free(in);
 	configfree(cfg);
-	return 0;
+	return exitcode;
 }
@@ -0,0 +1,201 @@
+/*
+ * render.c - streamed replies out to the terminal
+ *
+ * A reply streams in a few bytes at a time, and writing
+ * each piece as it comes costs a system call a token and,
+ * over a slow link, a packet too.  The pieces are gathered
+ * into frames instead.  A frame goes out when it finishes a
+ * line, unless one went out less than a frame time ago, and
+ * otherwise once its first byte has waited a frame time;
+ * http.c calls renderidle while the input is quiet, so that
+ * this happens even if nothing more comes.
+ *
+ * The frame time adapts to the terminal.  A write that
+ * blocks, as one does when the link is backed up, doubles
+ * it, up to Maxframe; quick ones bring it back down.
+ *
+ * Unbuffered (-u), each piece is written as it comes, for a
+ * reader that wants them one by one.
+ *
+ * While a reply is rendered, an interrupt stops it (see
+ * httpstop) rather than airc: what came is kept, and the
+ * caller told.  For a command or code, the reply may also
+ * be stopped at the end of its first fenced block, since
+ * whatever the model says after it is not wanted.
+ */
+
+#include "airc.h"
+
+enum {
+	Minframe = 16,		/* ms */
+	Maxframe = 250,
+	Maxpend = 16384,	/* bytes a frame holds at most */
+};
+
+/* kept from one reply to the next */
+static long frametime = Minframe;
+
+static volatile sig_atomic_t intr;
+
+static void
+onintr(int sig)
+{
+	(void)sig;
+	intr = 1;
+	httpstop(1);
+}
+
+static long
+now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000L + ts.tv_nsec / 1000000;
+}
+
+/* with no one to read the rest, it is not asked for */
+static void
+gone(Render *r)
+{
+	if(ferror(r->f)){
+		r->done = True;
+		httpstop(1);
+	}
+}
+
+static void
+frameout(Render *r)
+{
+	long t, dt;
+
+	t = now();
+	fwrite(r->pend.s, 1, r->pend.len, r->f);
+	fflush(r->f);
+	gone(r);
+	bufreset(&r->pend);
+	r->last = now();
+	dt = r->last - t;
+	if(dt > frametime / 2)
+		frametime = frametime * 2 < Maxframe ? frametime * 2 : Maxframe;
+	else if(frametime > Minframe)
+		frametime -= (frametime - Minframe + 7) / 8;
+}
+
+void
+renderinit(Render *r, FILE *f, int raw, int fence)
+{
+	struct sigaction sa;
+
+	memset(r, 0, sizeof *r);
+	r->f = f;
+	r->raw = raw;
+	r->fence = fence;
+	bufinit(&r->pend);
+	bufinit(&r->line);
+	if(!raw)
+		httpidle(renderidle, r);
+	intr = 0;
+	httpstop(0);
+	memset(&sa, 0, sizeof sa);
+	sa.sa_handler = onintr;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, &r->oldint);
+}
+
+/*
+ * How much of text to write, if a fenced block ends
+ * in it; then the reply is stopped.  Only a line's
+ * start, less its indent, is kept: enough to say if
+ * it is a fence.
+ */
+static int
+fencecut(Render *r, char *text, int len)
+{
+	int i, fence;
+
+	for(i = 0; i < len; i++){
+		if(text[i] != '\n'){
+			if(r->line.len < 3
+			&& (r->line.len > 0 || (text[i] != ' ' && text[i] != '\t')))
+				bufaddc(&r->line, text[i]);
+			continue;
+		}
+		fence = strcmp(bufstr(&r->line), "```") == 0;
+		bufreset(&r->line);
+		if(fence && ++r->nfence == 2){
+			r->done = True;
+			httpstop(1);
+			return i + 1;
+		}
+	}
+	return len;
+}
+
+/* the callback for aistream; aux is the Render */
+void
+renderput(char *text, int len, void *aux)
+{
+	Render *r;
+	long t;
+
+	r = aux;
+	if(r->done)
+		return;
+	if(r->fence)
+		len = fencecut(r, text, len);
+	if(r->raw){
+		fwrite(text, 1, len, r->f);
+		fflush(r->f);
+		gone(r);
+		return;
+	}
+	t = now();
+	if(r->pend.len == 0)
+		r->first = t;
+	bufadd(&r->pend, text, len);
+	if(r->pend.len >= Maxpend || t - r->first >= frametime
+	|| (memchr(text, '\n', len) != NULL && t - r->last >= frametime))
+		frameout(r);
+}
+
+/*
+ * Called while the input is quiet: writes the frame if
+ * it is due, and returns how many ms until it will be,
+ * or -1 if there is none.
+ */
+long
+renderidle(void *aux)
+{
+	Render *r;
+	long t;
+
+	r = aux;
+	if(r->pend.len == 0)
+		return -1;
+	t = now();
+	if(t - r->first < frametime)
+		return r->first + frametime - t;
+	frameout(r);
+	return -1;
+}
+
+/*
+ * Writes what is left, and puts the interrupt back;
+ * r->intr is then set if the reply was interrupted.
+ */
+void
+renderend(Render *r)
+{
+	if(r->pend.len > 0)
+		frameout(r);
+	if(!r->raw)
+		httpidle(NULL, NULL);
+	sigaction(SIGINT, &r->oldint, NULL);
+	r->intr = intr;
+	httpstop(0);
+	if(r->intr)
+		fprintf(stderr, "\n(interrupted)");
+	buffree(&r->pend);
+	buffree(&r->line);
+}
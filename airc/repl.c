@@ -8,14 +8,27 @@
 
 #include "airc.h"
 
-/* print streaming text to stdout */
+/*
+ * Stream a reply to stdout; see render.c.  Returns 0,
+ * 1 if interrupted, with what came of it kept, or -1.
+ */
+static int
+streamout(Config *cfg, Provider *p, Conv *conv, int fence)
+{
+	Render r;
+	int ret;
+
+	renderinit(&r, stdout, cfg->unbuffered, fence);
+	ret = hedgestream(p, conv, cfg, renderput, &r);
+	renderend(&r);
+	return r.intr ? 1 : ret;
+}
+
+/* an interrupt at the prompt drops the line, not the repl */
 static void
-printcb(char *text, int len, void *aux)
+onintr(int sig)
 {
-	(void)aux;
-	(void)len;
-	fputs(text, stdout);
-	fflush(stdout);
+	(void)sig;
 }
 
 /* history ring buffer */
@@ -42,8 +55,13 @@ readline_simple(char *prompt)
 
 	fprintf(stderr, "%s", prompt);
 	fflush(stderr);
-	if(fgets(line, sizeof line, stdin) == NULL)
-		return NULL;
+	if(fgets(line, sizeof line, stdin) == NULL){
+		if(!ferror(stdin) || errno != EINTR)
+			return NULL;
+		clearerr(stdin);
+		fputs("\n", stderr);
+		line[0] = '\0';
+	}
 
 	/* strip trailing newline */
 	{
@@ -87,6 +105,15 @@ showinfo(Config *cfg, Provider *p, Session *s, Role *r)
 	fprintf(stderr, "stream:   %s\n", cfg->stream ? "true" : "false");
 	fprintf(stderr, "temp:     %.2f\n", cfg->temp / 100.0);
 	fprintf(stderr, "messages: %d\n", s ? s->conv.n : 0);
+	if(p != NULL)
+		fprintf(stderr, "context:  ~%ld of %ld tokens\n",
+			s ? s->conv.ntok : 0, provctx(p, cfg));
+	if(p != NULL && p->total.nreq > 0 && p->type == Pclaude)
+		fprintf(stderr, "usage:    %d requests, %ld in (%ld cached, %ld to cache), "
+			"%ld out; last %ld in (%ld cached, %ld to cache), %ld out\n",
+			p->total.nreq, p->total.in, p->total.cacheread, p->total.cachewrite,
+			p->total.out, p->last.in, p->last.cacheread, p->last.cachewrite,
+			p->last.out);
 }
 
 /*
@@ -99,7 +126,7 @@ replshell(Config *cfg, Provider *p, char *text)
 	Conv *conv;
 	Buf resp;
 	char *prompt;
-	int action;
+	int action, ret;
 
 	prompt = shellprompt();
 	conv = convnew();
@@ -110,8 +137,11 @@ replshell(Config *cfg, Provider *p, char *text)
 	bufinit(&resp);
 	fprintf(stderr, "\n");
 
-	if(aistream(p, conv, cfg, printcb, NULL) < 0){
-		warn("shell command generation failed");
+	if((ret = streamout(cfg, p, conv, True)) != 0){
+		if(ret < 0)
+			warn("shell command generation failed");
+		else
+			fputs("\n", stdout);
 		buffree(&resp);
 		convfree(conv);
 		return;
@@ -155,6 +185,7 @@ loadfile(char *path)
 void
 replrun(Config *cfg, Provider *p, Session *s, Role *r)
 {
+	struct sigaction sa, oldint;
 	char *line, *input;
 	Conv *conv;
 	int multiline;
@@ -175,7 +206,12 @@ replrun(Config *cfg, Provider *p, Session *s, Role *r)
 
 	/* apply role as system message */
 	if(r != NULL && r->prompt != NULL)
-		convadd(conv, "system", r->prompt);
+		convsys(conv, r->prompt);
+
+	memset(&sa, 0, sizeof sa);
+	sa.sa_handler = onintr;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, &oldint);
 
 	fprintf(stderr, "airc - type .help for commands, Ctrl-D to exit\n");
 	multiline = 0;
@@ -236,18 +272,11 @@ replrun(Config *cfg, Provider *p, Session *s, Role *r)
 				prev = NULL;
 				for(m = conv->head; m != NULL; m = next){
 					next = m->next;
-					if(strcmp(m->role, "system") != 0){
-						msgfree(m);
-						if(prev != NULL)
-							prev->next = next;
-						else
-							conv->head = next;
-						conv->n--;
-					}else{
+					if(strcmp(m->role, "system") != 0)
+						convdel(conv, prev, m);
+					else
 						prev = m;
-					}
 				}
-				conv->tail = prev;
 				fprintf(stderr, "conversation cleared\n");
 				continue;
 			}
@@ -272,19 +301,7 @@ replrun(Config *cfg, Provider *p, Session *s, Role *r)
 					rolefree(r);
 					r = nr;
 					/* add/replace system message */
-					if(conv->head != NULL
-					&& strcmp(conv->head->role, "system") == 0){
-						free(conv->head->content);
-						conv->head->content = estrdup(r->prompt);
-					}else{
-						/* prepend system message */
-						Msg *sm = msgnew("system", r->prompt);
-						sm->next = conv->head;
-						conv->head = sm;
-						if(conv->tail == NULL)
-							conv->tail = sm;
-						conv->n++;
-					}
+					convsys(conv, r->prompt);
 					fprintf(stderr, "role: %s\n", r->name);
 				}
 				continue;
@@ -307,14 +324,15 @@ replrun(Config *cfg, Provider *p, Session *s, Role *r)
 			}
 			if(strncmp(line, ".session ", 8) == 0){
 				char *sname = trim(line + 8);
-				Session *ns = sessionload(cfg, sname);
+				Session *ns = sessionload(cfg, sname,
+					provbudget(p, cfg) * 3 / 4);
 				if(ns == NULL)
 					ns = sessionnew(sname);
 				/* preserve system message */
 				if(r != NULL && r->prompt != NULL
 				&& (ns->conv.head == NULL
 				|| strcmp(ns->conv.head->role, "system") != 0))
-					convadd(&ns->conv, "system", r->prompt);
+					convsys(&ns->conv, r->prompt);
 				s = ns;
 				conv = &s->conv;
 				fprintf(stderr, "session: %s (%d messages)\n",
@@ -350,11 +368,16 @@ send:
 
 		/* stream response */
 		fprintf(stdout, "\n");
-		if(aistream(p, conv, cfg, printcb, NULL) < 0)
+		if(streamout(cfg, p, conv, False) < 0)
 			warn("request failed");
 		fprintf(stdout, "\n\n");
+
+		/* a turn costs an append, so keep named sessions as we go */
+		if(s->named)
+			sessionsave(cfg, s);
 	}
 
+	sigaction(SIGINT, &oldint, NULL);
 	buffree(&mlbuf);
 	free(filebuf);
 	filebuf = NULL;
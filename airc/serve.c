@@ -0,0 +1,277 @@
+/*
+ * serve.c - airc kept running, for rc
+ *
+ * Each airc reads the config, the keys, a role and a
+ * session, and dials the provider (shaking hands, for
+ * https), before its question goes out.  airc -S does
+ * that once: it listens on a Unix socket in rc's srv
+ * directory, /tmp/rc-srv/airc ($AIRC_SRV to put it
+ * elsewhere), so that srv lists it and
+ *
+ *	echo -e find large files | srv -c airc
+ *
+ * is answered on connections already open, straight
+ * into the shell's standard output.
+ *
+ * A request is what the client sends before it shuts
+ * down its side.  If its first line starts with '-', the
+ * line is split at blanks into arguments, as airc's
+ * would be; what follows is the input, as if piped in.
+ * The answer, and any complaint, come back on the
+ * connection, which is then closed.
+ *
+ * Requests are answered one at a time, by the one
+ * process, in the order they come; the others wait to
+ * be accepted.  A session asked for stays loaded, and is
+ * read again only if its log has changed under us.  The
+ * socket is the user's alone.  Removed (srv -r airc),
+ * it is noticed within Checkgone seconds, and airc exits.
+ */
+
+#include "airc.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+enum {
+	Maxarg = 64,
+	Maxwarm = 16,
+	Checkgone = 60,		/* s */
+	Reqwait = 30,		/* s a client may leave us waiting */
+	Maxreq = 4<<20,
+};
+
+static Session *warm[Maxwarm];
+static int nwarm;
+
+/*
+ * The session name for this request, kept from the last
+ * if its log is as we left it.
+ */
+Session*
+servesession(Config *cfg, char *name, long ntok)
+{
+	struct stat st;
+	Session *s;
+	int i;
+
+	for(i = 0; i < nwarm; i++)
+		if(strcmp(warm[i]->name, name) == 0)
+			break;
+	if(i < nwarm){
+		s = warm[i];
+		if(s->path != NULL && stat(s->path, &st) == 0 && st.st_size == s->end)
+			return s;
+		sessionfree(s);
+		warm[i] = warm[--nwarm];
+	}
+	s = sessionload(cfg, name, ntok);
+	if(s == NULL)
+		s = sessionnew(name);
+	if(nwarm == Maxwarm){
+		sessionfree(warm[0]);
+		warm[0] = warm[--nwarm];
+	}
+	warm[nwarm++] = s;
+	return s;
+}
+
+static int
+srvaddr(char *path, struct sockaddr_un *sa)
+{
+	if(strlen(path) >= sizeof sa->sun_path){
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	memset(sa, 0, sizeof *sa);
+	sa->sun_family = AF_UNIX;
+	strcpy(sa->sun_path, path);
+	return socket(AF_UNIX, SOCK_STREAM, 0);
+}
+
+/* a socket listening at path, unless one is already */
+static int
+srvlisten(char *path)
+{
+	struct sockaddr_un sa;
+	mode_t mask;
+	int fd, e;
+
+	if((fd = srvaddr(path, &sa)) < 0)
+		return -1;
+	if(connect(fd, (struct sockaddr*)&sa, sizeof sa) == 0){
+		close(fd);
+		errno = EADDRINUSE;
+		return -1;
+	}
+	close(fd);
+	if((fd = srvaddr(path, &sa)) < 0)
+		return -1;
+	unlink(path);
+	mask = umask(077);
+	if(bind(fd, (struct sockaddr*)&sa, sizeof sa) < 0 || listen(fd, SOMAXCONN) < 0){
+		e = errno;
+		umask(mask);
+		close(fd);
+		errno = e;
+		return -1;
+	}
+	umask(mask);
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+	return fd;
+}
+
+/* all the client sends; NULL if it is too slow or too much */
+static char*
+readreq(int fd)
+{
+	struct pollfd pfd;
+	Buf b;
+	char tmp[4096];
+	int n;
+
+	bufinit(&b);
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	for(;;){
+		if((n = poll(&pfd, 1, Reqwait * 1000)) < 0 && errno == EINTR)
+			continue;
+		if(n <= 0)
+			break;
+		if((n = read(fd, tmp, sizeof tmp)) < 0 && errno == EINTR)
+			continue;
+		if(n == 0)
+			return bufstr(&b);	/* the client's end; ours now */
+		if(n < 0 || b.len + n > Maxreq)
+			break;
+		bufadd(&b, tmp, n);
+	}
+	buffree(&b);
+	return NULL;
+}
+
+/* answer the request on fd, as airc would with it for arguments and stdin */
+static void
+serveconn(Config *cfg, int fd)
+{
+	char *req, *in, *av[Maxarg + 1], *nl, *w;
+	int ac, o1, o2;
+
+	req = readreq(fd);
+	if(req == NULL){
+		close(fd);
+		return;
+	}
+	ac = 0;
+	av[ac++] = "airc";
+	in = req;
+	if(*req == '-'){
+		nl = strchr(req, '\n');
+		if(nl != NULL)
+			*nl++ = '\0';
+		in = nl;
+		for(w = strtok(req, " \t"); w != NULL && ac < Maxarg; w = strtok(NULL, " \t"))
+			av[ac++] = w;
+	}
+	av[ac] = NULL;
+	if(in != NULL && *in == '\0')
+		in = NULL;
+
+	fflush(stdout);
+	fflush(stderr);
+	o1 = dup(1);
+	o2 = dup(2);
+	dup2(fd, 1);
+	dup2(fd, 2);
+	close(fd);
+	airun(cfg, ac, av, in, True);
+	fflush(stdout);
+	fflush(stderr);
+	clearerr(stdout);
+	clearerr(stderr);
+	dup2(o1, 1);
+	dup2(o2, 2);
+	close(o1);
+	close(o2);
+	free(req);
+}
+
+/*
+ * Serve requests until the socket is removed.
+ * Returns the exit status.
+ */
+int
+serverun(Config *cfg)
+{
+	struct pollfd pfd;
+	struct stat st;
+	char *path, **models;
+	ino_t ino;
+	int lfd, fd, i, n;
+
+	path = getenv("AIRC_SRV");
+	if(path == NULL || *path == '\0'){
+		mkdir("/tmp/rc-srv", 0755);
+		path = "/tmp/rc-srv/airc";
+	}
+	if(configprov(cfg, NULL) == NULL){
+		warn("no API provider configured");
+		return 1;
+	}
+	if((lfd = srvlisten(path)) < 0){
+		warn("%s: %s", path, errno == EADDRINUSE ? "already served" : strerror(errno));
+		return 1;
+	}
+	if(stat(path, &st) < 0){
+		warn("%s: %s", path, strerror(errno));
+		return 1;
+	}
+	ino = st.st_ino;
+	mkdirp(cfg->dir);
+
+	/* requests may change a provider's model; each starts afresh */
+	models = emalloc(sizeof models[0] * (cfg->nprov + 1));
+	for(i = 0; i < cfg->nprov; i++)
+		models[i] = estrdup(cfg->provs[i]->model);
+
+	signal(SIGPIPE, SIG_IGN);
+	if((fd = open("/dev/null", O_RDONLY)) >= 0){
+		dup2(fd, 0);
+		if(fd > 0)
+			close(fd);
+	}
+	pfd.fd = lfd;
+	pfd.events = POLLIN;
+	for(;;){
+		if((n = poll(&pfd, 1, Checkgone * 1000)) < 0 && errno != EINTR){
+			warn("poll: %s", strerror(errno));
+			break;
+		}
+		if(stat(path, &st) < 0 || st.st_ino != ino)
+			break;
+		if(n <= 0)
+			continue;
+		if((fd = accept(lfd, NULL, NULL)) < 0){
+			if(errno == EINTR || errno == ECONNABORTED)
+				continue;
+			warn("accept: %s", strerror(errno));
+			break;
+		}
+		serveconn(cfg, fd);
+		for(i = 0; i < cfg->nprov; i++)
+			if(strcmp(cfg->provs[i]->model, models[i]) != 0){
+				free(cfg->provs[i]->model);
+				cfg->provs[i]->model = estrdup(models[i]);
+			}
+	}
+	if(stat(path, &st) == 0 && st.st_ino == ino)
+		unlink(path);
+	close(lfd);
+	for(i = 0; i < cfg->nprov; i++)
+		free(models[i]);
+	free(models);
+	for(i = 0; i < nwarm; i++)
+		sessionfree(warm[i]);
+	nwarm = 0;
+	return 0;
+}
@@ -1,19 +1,92 @@
 /*
  * session.c - conversation session persistence
  *
- * Sessions store conversation history to disk as JSON,
- * allowing conversations to be resumed across invocations.
- * Stored in ~/.airc/sessions/<name>.json
+ * A session is a log, ~/.airc/sessions/<name>.log: a
+ * header line, then one line of JSON per message, as it
+ * is sent.  Saving appends the new messages with one
+ * write and one fsync, so a turn costs only itself.  If
+ * the conversation was edited instead (turns trimmed or
+ * cleared, a new role), the log is compacted: written
+ * whole to a new file renamed over the old.  A line cut
+ * short by a crash is ignored, and written over.
+ *
+ * <name>.idx holds the offset of each message, so that
+ * resuming reads the system prompt and only as many of
+ * the newest turns as fit the budget given; the older
+ * ones stay on disk, and are kept by compaction unless
+ * turns were dropped.  The index is only a cache, checked
+ * against the log's inode and size, and extended or
+ * rebuilt from the log when they do not match.
+ *
+ * Sessions in the old format, <name>.json, are read whole
+ * and saved as a log.
  */
 
 #include "airc.h"
 
+#define LOGMAGIC	"{\"airc\":\"session\",\"name\":"
+#define IDXMAGIC	"airc-ix1"
+
+/* the index file: this, then an offset per message */
+typedef struct Idxhdr Idxhdr;
+struct Idxhdr {
+	char	magic[8];
+	uvlong	ino;		/* of the log */
+	uvlong	size;		/* bytes of it indexed */
+};
+
+static int
+preadn(int fd, char *p, long n, off_t off)
+{
+	long r;
+
+	while(n > 0){
+		r = pread(fd, p, n, off);
+		if(r < 0 && errno == EINTR)
+			continue;
+		if(r <= 0)
+			return -1;
+		p += r;
+		n -= r;
+		off += r;
+	}
+	return 0;
+}
+
+static char*
+sesspath(Config *cfg, char *name, char *ext)
+{
+	return smprint("%s/sessions/%s.%s", cfg->dir, name, ext);
+}
+
+static char*
+idxpath(Session *s)
+{
+	char *p;
+
+	p = emalloc(strlen(s->path) + 1);
+	strcpy(p, s->path);
+	strcpy(p + strlen(p) - 3, "idx");	/* .log */
+	return p;
+}
+
+static void
+addoff(Session *s, off_t off)
+{
+	if(s->noff == s->capoff){
+		s->capoff = s->capoff ? 2 * s->capoff : 64;
+		s->off = erealloc(s->off, s->capoff * sizeof s->off[0]);
+	}
+	s->off[s->noff++] = off;
+}
+
 Session*
 sessionnew(char *name)
 {
 	Session *s;
 
 	s = emalloc(sizeof *s);
+	s->named = name != NULL;
 	if(name != NULL)
 		s->name = estrdup(name);
 	else
@@ -22,50 +95,51 @@ sessionnew(char *name)
 	s->conv.head = NULL;
 	s->conv.tail = NULL;
 	s->conv.n = 0;
+	s->conv.ntok = 0;
 	return s;
 }
 
-/*
- * Load a session from disk.
- * Returns NULL if session doesn't exist.
- */
-Session*
-sessionload(Config *cfg, char *name)
+/* in step with the log as of now */
+static void
+sesssync(Session *s)
+{
+	s->nsaved = s->conv.n;
+	s->nedit = s->conv.nedit;
+	s->ndel = s->conv.ndel;
+}
+
+/* the whole of an old-format session */
+static Session*
+jsonload(Config *cfg, char *name)
 {
 	Session *s;
 	char *path, *data;
 	Json *j, *msgs, *m;
-	int i, n;
 
-	path = smprint("%s/sessions/%s.json", cfg->dir, name);
+	path = sesspath(cfg, name, "json");
 	data = readfile(path);
-	if(data == NULL){
-		free(path);
+	free(path);
+	if(data == NULL)
 		return NULL;
-	}
 
-	j = jsonparse(data);
-	free(data);
-	if(j == NULL){
-		free(path);
+	/* one arena for the lot; the strings are data's own bytes */
+	j = jsondoc(data);
+	if(j == NULL)
 		return NULL;
-	}
 
 	s = sessionnew(name);
-	s->path = path;
+	s->path = sesspath(cfg, name, "log");
+	s->old = True;
+	s->nsaved = -1;
 
 	msgs = jsonget(j, "messages");
-	if(msgs != NULL){
-		n = jsonlen(msgs);
-		for(i = 0; i < n; i++){
-			m = jsonidx(msgs, i);
-			if(m != NULL){
-				Json *role = jsonget(m, "role");
-				Json *content = jsonget(m, "content");
-				if(role != NULL && content != NULL
-				&& jsonstr(role) != NULL && jsonstr(content) != NULL)
-					convadd(&s->conv, jsonstr(role), jsonstr(content));
-			}
+	if(msgs != NULL && msgs->type == Jarray){
+		for(m = msgs->child; m != NULL; m = m->next){
+			Json *role = jsonget(m, "role");
+			Json *content = jsonget(m, "content");
+			if(role != NULL && content != NULL
+			&& jsonstr(role) != NULL && jsonstr(content) != NULL)
+				convadd(&s->conv, jsonstr(role), jsonstr(content));
 		}
 	}
 
@@ -74,66 +148,398 @@ sessionload(Config *cfg, char *name)
 }
 
 /*
- * Save session to disk as JSON.
+ * Index the whole lines of the log from off on,
+ * and set s->end past the last of them.
+ */
+static int
+logscan(Session *s, int fd, off_t off, off_t size)
+{
+	char *buf, *p, *nl, *e;
+	off_t n;
+
+	s->end = off;
+	if(off >= size)
+		return 0;
+	n = size - off;
+	buf = emalloc(n);
+	if(preadn(fd, buf, n, off) < 0){
+		free(buf);
+		return -1;
+	}
+	e = buf + n;
+	for(p = buf; p < e && (nl = memchr(p, '\n', e - p)) != NULL; p = nl + 1){
+		if(s->end > 0)
+			addoff(s, s->end);
+		s->end = off + (nl + 1 - buf);
+	}
+	free(buf);
+	return 0;
+}
+
+/* offsets from the index, if it is of this log */
+static int
+idxload(Session *s, struct stat *st)
+{
+	Idxhdr h;
+	char *path;
+	uvlong *v;
+	int fd, n, i;
+	struct stat ist;
+
+	path = idxpath(s);
+	fd = open(path, O_RDONLY);
+	free(path);
+	if(fd < 0)
+		return 0;
+	if(fstat(fd, &ist) < 0 || readn(fd, (char*)&h, sizeof h) < 0
+	|| memcmp(h.magic, IDXMAGIC, 8) != 0 || h.ino != (uvlong)st->st_ino
+	|| h.size > (uvlong)st->st_size){
+		close(fd);
+		return 0;
+	}
+	n = (ist.st_size - sizeof h) / sizeof v[0];
+	v = emalloc((n + 1) * sizeof v[0]);
+	if(readn(fd, (char*)v, n * sizeof v[0]) < 0){
+		free(v);
+		close(fd);
+		return 0;
+	}
+	close(fd);
+	/* entries past the indexed size were not finished */
+	for(i = 0; i < n && v[i] < h.size; i++)
+		addoff(s, v[i]);
+	free(v);
+	s->end = h.size;
+	return 1;
+}
+
+/* write all of s's offsets to a new index */
+static void
+idxsave(Session *s, int logfd)
+{
+	Idxhdr h;
+	struct stat st;
+	char *path, *tmp;
+	uvlong *v;
+	int fd, i, ok;
+
+	if(fstat(logfd, &st) < 0)
+		return;
+	memcpy(h.magic, IDXMAGIC, 8);
+	h.ino = st.st_ino;
+	h.size = s->end;
+	v = emalloc((s->noff + 1) * sizeof v[0]);
+	for(i = 0; i < s->noff; i++)
+		v[i] = s->off[i];
+
+	path = idxpath(s);
+	tmp = smprint("%s.%d", path, (int)getpid());
+	fd = open(tmp, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if(fd >= 0){
+		ok = writen(fd, (char*)&h, sizeof h) == 0
+			&& writen(fd, (char*)v, s->noff * sizeof v[0]) == 0;
+		if(close(fd) < 0 || !ok || rename(tmp, path) < 0)
+			unlink(tmp);
+	}
+	free(tmp);
+	free(path);
+	free(v);
+}
+
+/* add the log's records from offset i to n to the conversation */
+static int
+logread(Session *s, int fd, int i, int n)
+{
+	char *buf, *p, *nl;
+	off_t len;
+	Json *j, *role, *content;
+
+	if(i >= n)
+		return 0;
+	len = (n < s->noff ? s->off[n] : s->end) - s->off[i];
+	buf = emalloc(len + 1);
+	if(preadn(fd, buf, len, s->off[i]) < 0){
+		free(buf);
+		return -1;
+	}
+	for(p = buf; p < buf + len; p = nl + 1){
+		nl = memchr(p, '\n', buf + len - p);
+		*nl = '\0';
+		j = jsonparse(p);
+		role = jsonget(j, "role");
+		content = jsonget(j, "content");
+		if(jsonstr(role) != NULL && jsonstr(content) != NULL)
+			convadd(&s->conv, jsonstr(role), jsonstr(content));
+		jsonfree(j);
+	}
+	free(buf);
+	return 0;
+}
+
+static int
+isrole(Session *s, int fd, int i, char *role)
+{
+	char want[64], got[64];
+	int n;
+
+	n = snprintf(want, sizeof want, "{\"role\":\"%s\"", role);
+	return preadn(fd, got, n, s->off[i]) == 0 && memcmp(got, want, n) == 0;
+}
+
+/*
+ * Load a session from disk, with as many of the
+ * newest turns as come to about ntok tokens (all
+ * of them if ntok is 0).
+ * Returns NULL if session doesn't exist.
+ */
+Session*
+sessionload(Config *cfg, char *name, long ntok)
+{
+	Session *s;
+	struct stat st;
+	char *hdr;
+	int fd, first, k, nidx;
+	long tok;
+	off_t next;
+
+	s = sessionnew(name);
+	s->path = sesspath(cfg, name, "log");
+	fd = open(s->path, O_RDONLY);
+	if(fd < 0){
+		sessionfree(s);
+		return jsonload(cfg, name);
+	}
+	hdr = emalloc(sizeof LOGMAGIC);
+	if(fstat(fd, &st) < 0
+	|| preadn(fd, hdr, sizeof LOGMAGIC - 1, 0) < 0
+	|| memcmp(hdr, LOGMAGIC, sizeof LOGMAGIC - 1) != 0){
+		warn("%s: not a session log", s->path);
+		free(hdr);
+		close(fd);
+		sessionfree(s);
+		return NULL;
+	}
+	free(hdr);
+
+	/* whatever the index does not cover, from the log */
+	nidx = idxload(s, &st);
+	if(!nidx){
+		s->noff = 0;
+		s->end = 0;
+		if(logscan(s, fd, 0, st.st_size) < 0)
+			goto Bad;
+	}else{
+		nidx = s->noff;
+		if(logscan(s, fd, s->end, st.st_size) < 0)
+			goto Bad;
+	}
+
+	/* the system prompt, then the newest that fit */
+	first = s->noff > 0 && isrole(s, fd, 0, "system");
+	k = s->noff;
+	if(ntok > 0){
+		tok = 0;
+		while(k > first){
+			next = k < s->noff ? s->off[k] : s->end;
+			tok += (next - s->off[k-1]) / 4 + 4;
+			if(tok > ntok && k < s->noff)
+				break;
+			k--;
+		}
+		/* begin the tail at a user turn */
+		while(k < s->noff - 1 && !isrole(s, fd, k, "user"))
+			k++;
+	}else
+		k = first;
+	if(logread(s, fd, 0, first) < 0 || logread(s, fd, k, s->noff) < 0)
+		goto Bad;
+	s->skip0 = first;
+	s->skip1 = k;
+	sesssync(s);
+	close(fd);
+
+	/* the next load need not scan again */
+	if(nidx != s->noff){
+		fd = open(s->path, O_RDONLY);
+		if(fd >= 0){
+			idxsave(s, fd);
+			close(fd);
+		}
+	}
+	return s;
+
+Bad:
+	warn("cannot read session: %s", strerror(errno));
+	close(fd);
+	sessionfree(s);
+	return NULL;
+}
+
+static void
+addmsg(Session *s, Buf *b, off_t base, Msg *m)
+{
+	addoff(s, base + b->len);
+	bufadd(b, m->json, m->jsonlen);
+	bufaddc(b, '\n');
+}
+
+/* append the messages saved since */
+static int
+logappend(Session *s)
+{
+	Buf b;
+	Msg *m;
+	int fd, i, ok;
+
+	fd = open(s->path, O_WRONLY);
+	if(fd < 0)
+		return -1;
+	bufinit(&b);
+	for(m = s->conv.head, i = 0; m != NULL; m = m->next, i++)
+		if(i >= s->nsaved)
+			addmsg(s, &b, s->end, m);
+	/* over any line a crash cut short */
+	ok = ftruncate(fd, s->end) == 0
+		&& lseek(fd, s->end, SEEK_SET) == s->end
+		&& writen(fd, b.s, b.len) == 0
+		&& fsync(fd) == 0;
+	if(ok){
+		s->end += b.len;
+		idxsave(s, fd);
+	}
+	close(fd);
+	buffree(&b);
+	return ok ? 0 : -1;
+}
+
+/*
+ * Write the log afresh: the conversation, and the
+ * turns not loaded unless any were dropped since.
+ */
+static int
+logcompact(Session *s)
+{
+	Buf b;
+	Msg *m;
+	Session was;
+	char *tmp, *mid;
+	off_t *old, midlen, delta;
+	int fd, ofd, i, j, nold, ok;
+
+	/* the middle of the old log, if it goes on */
+	mid = NULL;
+	midlen = 0;
+	old = s->off;
+	nold = s->noff;
+	if(s->conv.ndel == s->ndel && s->skip1 > s->skip0){
+		ofd = open(s->path, O_RDONLY);
+		if(ofd < 0)
+			return -1;
+		midlen = (s->skip1 < nold ? old[s->skip1] : s->end) - old[s->skip0];
+		mid = emalloc(midlen);
+		if(preadn(ofd, mid, midlen, old[s->skip0]) < 0){
+			close(ofd);
+			free(mid);
+			return -1;
+		}
+		close(ofd);
+	}
+
+	bufinit(&b);
+	bufaddstr(&b, LOGMAGIC);
+	jsonesc(&b, s->name);
+	bufaddstr(&b, "}\n");
+	was = *s;
+	s->off = NULL;
+	s->noff = s->capoff = 0;
+	m = s->conv.head;
+	j = 0;
+	if(m != NULL && strcmp(m->role, "system") == 0){
+		addmsg(s, &b, 0, m);
+		m = m->next;
+		j = 1;
+	}
+	if(mid != NULL){
+		delta = b.len - old[s->skip0];
+		for(i = s->skip0; i < s->skip1; i++)
+			addoff(s, old[i] + delta);
+		bufadd(&b, mid, midlen);
+		free(mid);
+		s->skip1 = s->noff;
+	}else
+		s->skip1 = j;
+	s->skip0 = j;
+	for(; m != NULL; m = m->next)
+		addmsg(s, &b, 0, m);
+
+	tmp = smprint("%s.%d", s->path, (int)getpid());
+	fd = open(tmp, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+	ok = fd >= 0;
+	if(ok){
+		ok = writen(fd, b.s, b.len) == 0 && fsync(fd) == 0;
+		if(ok){
+			s->end = b.len;
+			idxsave(s, fd);
+		}
+		if(close(fd) < 0 || !ok || rename(tmp, s->path) < 0){
+			unlink(tmp);
+			ok = 0;
+		}
+	}
+	free(tmp);
+	buffree(&b);
+	if(!ok){
+		/* still the old log's */
+		free(s->off);
+		s->off = was.off;
+		s->noff = was.noff;
+		s->capoff = was.capoff;
+		s->skip0 = was.skip0;
+		s->skip1 = was.skip1;
+		s->end = was.end;
+		return -1;
+	}
+	free(old);
+	return 0;
+}
+
+/*
+ * Save the session: append what is new
+ * if we can, rewrite the log if we must.
  */
 int
 sessionsave(Config *cfg, Session *s)
 {
 	char *dir, *path;
-	FILE *f;
-	Msg *m;
-	int first;
+	int ret;
 
 	dir = smprint("%s/sessions", cfg->dir);
 	mkdirp(dir);
-
-	if(s->path != NULL)
-		path = s->path;
-	else
-		path = smprint("%s/%s.json", dir, s->name);
 	free(dir);
 
-	f = fopen(path, "w");
-	if(f == NULL){
+	if(s->path == NULL){
+		s->path = sesspath(cfg, s->name, "log");
+		s->nsaved = -1;
+	}
+	if(s->nsaved >= 0 && s->nsaved <= s->conv.n
+	&& s->conv.nedit == s->nedit && s->conv.ndel == s->ndel
+	&& access(s->path, F_OK) == 0){
+		if(s->nsaved == s->conv.n)
+			return 0;
+		ret = logappend(s);
+	}else
+		ret = logcompact(s);
+	if(ret < 0){
 		warn("cannot save session: %s", strerror(errno));
-		if(path != s->path)
-			free(path);
 		return -1;
 	}
-
-	fprintf(f, "{\"name\":");
-	{
-		Buf b;
-		bufinit(&b);
-		jsonesc(&b, s->name);
-		fprintf(f, "%s", bufstr(&b));
-		buffree(&b);
-	}
-	fprintf(f, ",\"messages\":[");
-
-	first = 1;
-	for(m = s->conv.head; m != NULL; m = m->next){
-		Buf b;
-		bufinit(&b);
-		if(!first)
-			fprintf(f, ",");
-		fprintf(f, "{\"role\":");
-		jsonesc(&b, m->role);
-		fprintf(f, "%s", bufstr(&b));
-		bufreset(&b);
-		fprintf(f, ",\"content\":");
-		jsonesc(&b, m->content);
-		fprintf(f, "%s}", bufstr(&b));
-		buffree(&b);
-		first = 0;
-	}
-	fprintf(f, "]}\n");
-	fclose(f);
-
-	if(s->path == NULL)
-		s->path = path;
-	else if(path != s->path)
+	sesssync(s);
+	if(s->old){
+		path = sesspath(cfg, s->name, "json");
+		unlink(path);
 		free(path);
+		s->old = False;
+	}
 	return 0;
 }
 
@@ -146,15 +552,10 @@ sessionfree(Session *s)
 		return;
 	free(s->name);
 	free(s->path);
+	free(s->off);
 	for(m = s->conv.head; m != NULL; m = next){
 		next = m->next;
 		msgfree(m);
 	}
 	free(s);
 }
-
-char*
-sessiondir(Config *cfg)
-{
-	return smprint("%s/sessions", cfg->dir);
-}
@@ -4,9 +4,31 @@
  * Generates rc shell commands from natural language,
  * executes them via the rc shell, and provides
  * shell-aware prompting for the LLM.
+ *
+ * Unless "coproc false", commands run in one rc kept
+ * running for the life of airc, so that cd, variables
+ * and functions carry over from one to the next, and
+ * the user's .rcrc is read once.  It is a login rc
+ * running ". -i" (so that an error does not end it) of
+ * a pipe on its fd 3; its stdin, stdout and stderr are
+ * ours, as a fresh rc's would be, so a command may use
+ * the terminal as it likes.  Each command goes down the
+ * pipe as
+ *	~ 0 1; eval 'cmd'
+ *	echo <tag> $status >[1=4]
+ * (the false ~ leaves $status set should eval fail to
+ * parse cmd), and the tag and status come back on a
+ * pipe of their own, its fd 4.  The tag is random, so
+ * no command mistakes for it.  Once "." has opened
+ * /dev/fd/3, which it marks close-on-exec, the rc closes
+ * its fd 3, so commands cannot read what follows them.
+ * (A redirection of eval's own would run it in a child.)
+ * If the rc dies (the command was exit, say), the next
+ * command starts another.
  */
 
 #include "airc.h"
+#include <poll.h>
 
 /*
  * Detect the current operating system for
@@ -67,26 +89,218 @@ shellprompt(void)
 }
 
 /*
- * Execute a command using rc shell.
- * Tries ./rc first (from this repo), then rc in PATH,
- * then falls back to /bin/sh.
- * Returns the exit status.
+ * Find rc: ./rc first (from this repo),
+ * then /usr/local/bin/rc, then rc in PATH.
  */
-int
-shellexec(char *cmd)
+static char*
+shellpath(void)
+{
+	if(access("./rc", X_OK) == 0)
+		return "./rc";
+	if(access("/usr/local/bin/rc", X_OK) == 0)
+		return "/usr/local/bin/rc";
+	return "rc";
+}
+
+/* the coprocess */
+static struct {
+	int	keep;		/* use it at all */
+	pid_t	pid;		/* 0 if not running */
+	int	in;		/* its fd 3, for commands */
+	int	st;		/* its fd 4, for their status */
+	char	tag[33];
+} co;
+
+void
+shellkeep(int on)
+{
+	co.keep = on;
+}
+
+static void
+coclose(int *status)
+{
+	close(co.in);
+	close(co.st);
+	if(waitpid(co.pid, status, 0) < 0)
+		*status = -1;
+	co.pid = 0;
+}
+
+static void
+mktag(void)
+{
+	uchar r[16];
+	int fd, i, ok;
+
+	fd = open("/dev/urandom", O_RDONLY);
+	ok = fd >= 0 && readn(fd, (char*)r, sizeof r) == 0;
+	if(fd >= 0)
+		close(fd);
+	if(!ok)
+		for(i = 0; i < (int)sizeof r; i++)
+			r[i] = rand() ^ getpid() ^ time(NULL) >> i;
+	for(i = 0; i < (int)sizeof r; i++)
+		sprintf(co.tag + 2*i, "%02x", r[i]);
+}
+
+/* in rc quotes */
+static void
+rcquote(Buf *b, char *s)
+{
+	bufaddc(b, '\'');
+	for(; *s != '\0'; s++){
+		if(*s == '\'')
+			bufaddc(b, '\'');
+		bufaddc(b, *s);
+	}
+	bufaddc(b, '\'');
+}
+
+/*
+ * Send cmd, framed, and wait for the tag's line.
+ * Returns its status, or -1 if the rc died (with
+ * its exit status in *st).
+ */
+static int
+cosend(char *cmd, int *st)
+{
+	struct pollfd pfd[2];
+	struct sigaction old, ign;
+	Buf frame, b;
+	char tmp[256], *v;
+	int ret, r, tl;
+
+	bufinit(&frame);
+	if(cmd != NULL){
+		/* quoted, so that no command can break the frame */
+		bufaddstr(&frame, "~ 0 1; eval ");
+		rcquote(&frame, cmd);
+		bufaddc(&frame, '\n');
+	}
+	bufaddfmt(&frame, "echo %s $status >[1=4]\n", co.tag);
+
+	memset(&ign, 0, sizeof ign);
+	ign.sa_handler = SIG_IGN;
+	sigaction(SIGPIPE, &ign, &old);
+	r = writen(co.in, frame.s, frame.len);
+	sigaction(SIGPIPE, &old, NULL);
+	buffree(&frame);
+	*st = 0;
+	if(r < 0){
+		coclose(st);
+		return -1;
+	}
+
+	bufinit(&b);
+	ret = 0;
+	while(memchr(b.s, '\n', b.len) == NULL){
+		/* co.in errs once the rc, its only reader, is gone */
+		pfd[0].fd = co.st;
+		pfd[0].events = POLLIN;
+		pfd[1].fd = co.in;
+		pfd[1].events = 0;
+		pfd[0].revents = pfd[1].revents = 0;
+		if(poll(pfd, 2, -1) < 0){
+			if(errno == EINTR)
+				continue;
+			ret = -1;
+			break;
+		}
+		if(pfd[0].revents == 0 && pfd[1].revents != 0){
+			ret = -1;
+			break;
+		}
+		if(pfd[0].revents == 0)
+			continue;
+		r = read(co.st, tmp, sizeof tmp);
+		if(r < 0 && errno == EINTR)
+			continue;
+		if(r <= 0){
+			ret = -1;
+			break;
+		}
+		bufadd(&b, tmp, r);
+	}
+	tl = strlen(co.tag);
+	if(ret == 0 && (b.len < tl || memcmp(b.s, co.tag, tl) != 0))
+		ret = -1;
+	if(ret == 0){
+		/* "<tag> 0 1" for a pipeline: true if all are */
+		for(v = b.s + tl; *v != '\n'; v++)
+			if(*v != ' ' && *v != '0' && *v != '|')
+				ret = 1;
+	}else
+		coclose(st);
+	buffree(&b);
+	return ret;
+}
+
+/* start the coprocess; -1 if we cannot */
+static int
+costart(void)
+{
+	/* quiet prompts, and keep our commands out of the history */
+	static char init[] = "prompt=('' ''); fn prompt; history=(); . -i /dev/fd/3";
+	int in[2], st[2], s;
+	char *shell;
+
+	if(pipe(in) < 0 || pipe(st) < 0){
+		warn("pipe: %s", strerror(errno));
+		return -1;
+	}
+	/* clear of 3 and 4, so the dup2s below cannot overwrite them */
+	if(in[0] < 5 && (s = fcntl(in[0], F_DUPFD, 5)) >= 0){
+		close(in[0]);
+		in[0] = s;
+	}
+	if(st[1] < 5 && (s = fcntl(st[1], F_DUPFD, 5)) >= 0){
+		close(st[1]);
+		st[1] = s;
+	}
+	shell = shellpath();
+	co.pid = fork();
+	if(co.pid < 0){
+		warn("fork: %s", strerror(errno));
+		co.pid = 0;
+		return -1;
+	}
+	if(co.pid == 0){
+		close(in[1]);
+		close(st[0]);
+		dup2(in[0], 3);
+		dup2(st[1], 4);
+		close(in[0]);
+		close(st[1]);
+		execlp(shell, shell, "-l", "-c", init, (char*)NULL);
+		_exit(127);
+	}
+	close(in[0]);
+	close(st[1]);
+	co.in = in[1];
+	co.st = st[0];
+	fcntl(co.in, F_SETFD, FD_CLOEXEC);
+	fcntl(co.st, F_SETFD, FD_CLOEXEC);
+	mktag();
+
+	/* once the .rcrc is read; "." reads its own descriptor */
+	if(cosend("exec <[3=]", &s) < 0){
+		if(co.pid != 0)
+			coclose(&s);
+		return -1;
+	}
+	return 0;
+}
+
+/* run cmd in a fresh rc (or sh) */
+static int
+forkexec(char *cmd)
 {
 	int status;
 	pid_t pid;
 	char *shell;
 
-	/* try to find rc */
-	if(access("./rc", X_OK) == 0)
-		shell = "./rc";
-	else if(access("/usr/local/bin/rc", X_OK) == 0)
-		shell = "/usr/local/bin/rc";
-	else
-		shell = "rc";
-
+	shell = shellpath();
 	pid = fork();
 	if(pid < 0){
 		warn("fork: %s", strerror(errno));
@@ -106,6 +320,31 @@ shellexec(char *cmd)
 	return -1;
 }
 
+/*
+ * Execute a command using rc shell, in the
+ * coprocess if we keep one, else in a fresh rc.
+ * Returns the exit status.
+ */
+int
+shellexec(char *cmd)
+{
+	int ret, st;
+
+	if(!co.keep)
+		return forkexec(cmd);
+	if(co.pid == 0 && costart() < 0){
+		warn("cannot keep an rc running; forking one");
+		co.keep = 0;
+		return forkexec(cmd);
+	}
+	fflush(stdout);
+	fflush(stderr);
+	ret = cosend(cmd, &st);
+	if(ret < 0 && st >= 0 && WIFEXITED(st))
+		return WEXITSTATUS(st);
+	return ret;
+}
+
 /*
  * Display a generated command and ask the user
  * what to do with it.
@@ -77,6 +77,42 @@ smprint(char *fmt, ...)
 	return estrdup(tmp);
 }
 
+/* write all n bytes; 0 on success, -1 on error */
+int
+writen(int fd, char *p, int n)
+{
+	int w;
+
+	while(n > 0){
+		w = write(fd, p, n);
+		if(w < 0 && errno == EINTR)
+			continue;
+		if(w <= 0)
+			return -1;
+		p += w;
+		n -= w;
+	}
+	return 0;
+}
+
+/* read all n bytes; 0 on success, -1 on error or early eof */
+int
+readn(int fd, char *p, int n)
+{
+	int r;
+
+	while(n > 0){
+		r = read(fd, p, n);
+		if(r < 0 && errno == EINTR)
+			continue;
+		if(r <= 0)
+			return -1;
+		p += r;
+		n -= r;
+	}
+	return 0;
+}
+
 int
 isterm(int fd)
 {
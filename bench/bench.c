@@ -0,0 +1,156 @@
+/* bench.c: time rc on the benchmark scripts in bench/.
+
+   Each script does one thing $1 times; its first line says how many times
+   by default, as "# bench N". It is run -k times under the rc given with
+   -r, with standard output thrown away, and one line of JSON per script
+   goes to standard output:
+
+	{"name":"var","rc":"1.7.4","n":20000,"runs":5,"min":0.0123,"median":0.0130,"ns":615}
+
+   "min" and "median" are the wall-clock seconds of a whole run, and "ns"
+   is the median divided by n, in nanoseconds: the cost of one iteration,
+   including rc's start-up and the loop itself. The "loop" script gives
+   those on their own. A script that fails gets "error" and no times.
+*/
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAXRUNS 100
+
+static char *rc = "./rc";
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int cmpd(const void *a, const void *b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return x < y ? -1 : x > y;
+}
+
+/* run argv with stdout to /dev/null (or to the pipe out, if not -1); its exit status, or -1 */
+static int run(char **argv, int out) {
+	pid_t pid;
+	int status;
+	switch (pid = fork()) {
+	case -1:
+		perror("fork");
+		return -1;
+	case 0:
+		if (out == -1)
+			out = open("/dev/null", O_WRONLY);
+		dup2(out, 1);
+		execv(argv[0], argv);
+		perror(argv[0]);
+		_exit(127);
+	}
+	while (waitpid(pid, &status, 0) < 0)
+		if (errno != EINTR)
+			return -1;
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/* $version of the rc under test */
+static void version(char *buf, size_t size) {
+	char *argv[] = { rc, "-c", "echo -n $version", NULL };
+	int p[2];
+	ssize_t n = 0;
+	buf[0] = '\0';
+	if (pipe(p) < 0)
+		return;
+	run(argv, p[1]);
+	close(p[1]);
+	if ((n = read(p[0], buf, size - 1)) < 0)
+		n = 0;
+	close(p[0]);
+	buf[n] = '\0';
+	buf[strcspn(buf, "\"\\\n")] = '\0';
+}
+
+/* "var" for "bench/var.rc" */
+static void benchname(char *script, char *buf, size_t size) {
+	char *p = strrchr(script, '/'), *dot;
+	snprintf(buf, size, "%s", p == NULL ? script : p + 1);
+	if ((dot = strrchr(buf, '.')) != NULL)
+		*dot = '\0';
+}
+
+static long defaultn(char *script) {
+	FILE *f;
+	long n = 1;
+	if ((f = fopen(script, "r")) == NULL)
+		return -1;
+	if (fscanf(f, "# bench %ld", &n) != 1 || n < 1)
+		n = 1;
+	fclose(f);
+	return n;
+}
+
+int main(int argc, char **argv) {
+	char ver[64], name[64], nbuf[32];
+	double t[MAXRUNS], scale = 1, start;
+	long n;
+	int c, i, runs = 5, status = 0;
+	while ((c = getopt(argc, argv, "k:r:s:")) != -1)
+		switch (c) {
+		case 'k':
+			runs = atoi(optarg);
+			if (runs < 1 || runs > MAXRUNS) {
+				fprintf(stderr, "bench: -k must be from 1 to %d\n", MAXRUNS);
+				return 2;
+			}
+			break;
+		case 'r':
+			rc = optarg;
+			break;
+		case 's':
+			scale = atof(optarg);
+			break;
+		default:
+			fprintf(stderr, "usage: bench [-k runs] [-r rc] [-s scale] script ...\n");
+			return 2;
+		}
+	setenv("BENCH_RC", rc, 1); /* for startup.rc */
+	version(ver, sizeof ver);
+	for (; optind < argc; optind++) {
+		char *script = argv[optind];
+		char *rargv[] = { rc, script, nbuf, NULL };
+		benchname(script, name, sizeof name);
+		if ((n = defaultn(script)) < 0) {
+			printf("{\"name\":\"%s\",\"rc\":\"%s\",\"error\":\"cannot open\"}\n", name, ver);
+			status = 1;
+			continue;
+		}
+		if ((n = n * scale) < 1)
+			n = 1;
+		snprintf(nbuf, sizeof nbuf, "%ld", n);
+		for (i = 0; i < runs; i++) {
+			start = now();
+			if (run(rargv, -1) != 0)
+				break;
+			t[i] = now() - start;
+		}
+		if (i < runs) {
+			printf("{\"name\":\"%s\",\"rc\":\"%s\",\"n\":%ld,\"error\":\"failed\"}\n", name, ver, n);
+			status = 1;
+		} else {
+			qsort(t, runs, sizeof *t, cmpd);
+			printf("{\"name\":\"%s\",\"rc\":\"%s\",\"n\":%ld,\"runs\":%d,\"min\":%.6f,\"median\":%.6f,\"ns\":%.0f}\n",
+				name, ver, n, runs, t[0], t[runs / 2], t[runs / 2] / n * 1e9);
+		}
+		fflush(stdout);
+	}
+	return status;
+}
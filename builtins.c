@@ -11,13 +11,18 @@
 
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 #include <setjmp.h>
 #include <errno.h>
+#include <stdio.h>
+#include <time.h>
 
 #include "input.h"
 #include "jbwrap.h"
 #include "rlimit.h"
 #include "sigmsgs.h"
+#include "wait.h"
 
 #if RC_ADDON
 #include "addon.c"
@@ -27,9 +32,9 @@
 #include "dist.h"
 #endif
 
-static void b_break(char **), b_cd(char **), b_continue(char **), b_eval(char **), b_flag(char **),
-	b_exit(char **), b_newpgrp(char **), b_return(char **), b_shift(char **), b_umask(char **),
-	b_wait(char **), b_whatis(char **);
+static void b_apply(char **), b_break(char **), b_cd(char **), b_continue(char **), b_eval(char **), b_flag(char **),
+	b_exit(char **), b_hash(char **), b_jobs(char **), b_newpgrp(char **), b_return(char **), b_shift(char **),
+	b_umask(char **), b_wait(char **), b_whatis(char **);
 
 #if HAVE_SETRLIMIT
 static void b_limit(char **);
@@ -43,6 +48,7 @@ static struct {
 	builtin_t *p;
 	char *name;
 } builtins[] = {
+	{ b_apply,	"apply" },
 	{ b_break,	"break" },
 	{ b_builtin,	"builtin" },
 	{ b_cd,		"cd" },
@@ -54,12 +60,20 @@ static struct {
 	{ b_exec,	"exec" },
 	{ b_exit,	"exit" },
 	{ b_flag,	"flag" },
+	{ b_hash,	"hash" },
+	{ b_jobs,	"jobs" },
 #if HAVE_SETRLIMIT
 	{ b_limit,	"limit" },
 #endif
+	{ b_load,	"load" },
+	{ b_math,	"math" },
 	{ b_newpgrp,	"newpgrp" },
+	{ b_read,	"read" },
+	{ b_regex,	"regex" },
 	{ b_return,	"return" },
 	{ b_shift,	"shift" },
+	{ b_string,	"string" },
+	{ b_time,	"time" },
 	{ b_umask,	"umask" },
 	{ b_wait,	"wait" },
 	{ b_whatis,	"whatis" },
@@ -80,31 +94,68 @@ static struct {
 #endif
 };
 
+/*
+   Builtins are found by binary search through an index of the table
+   sorted by name; the table itself stays in the order it is written,
+   which is the order whatis -b lists it in. Which builtins there are
+   depends on config.h, so the index is sorted the first time it is used.
+*/
+
+static int byname[arraysize(builtins)];
+
+static int namecmp(const void *a, const void *b) {
+	return strcmp(builtins[*(const int *) a].name, builtins[*(const int *) b].name);
+}
+
 extern builtin_t *isbuiltin(char *s) {
-    int i;
-    for (i = 0; i < arraysize(builtins); i++)
-	if (streq(builtins[i].name, s))
-	    return builtins[i].p;
-    return NULL;
+	static bool sorted = FALSE;
+	int lo, hi, mid, c;
+	if (!sorted) {
+		for (lo = 0; lo < arraysize(builtins); lo++)
+			byname[lo] = lo;
+		qsort(byname, arraysize(builtins), sizeof byname[0], namecmp);
+		sorted = TRUE;
+	}
+	for (lo = 0, hi = arraysize(builtins) - 1; lo <= hi;) {
+		mid = (lo + hi) / 2;
+		if ((c = strcmp(s, builtins[byname[mid]].name)) == 0)
+			return builtins[byname[mid]].p;
+		if (c < 0)
+			hi = mid - 1;
+		else
+			lo = mid + 1;
+	}
+	return NULL;
 }
 
 /* funcall() is the wrapper used to invoke shell functions. pushes $*, and "return" returns here. */
 
+/*
+   The function body is walked in place. The eTree exception marks it
+   as busy, so that if the function is redefined or deleted while it
+   runs, freeing the old body is put off until the call is over.
+*/
+
 extern void funcall(char **av) {
-	Jbwrap j;
-	Estack e1, e2;
-	Edata jreturn, star;
-	if (sigsetjmp(j.j, 1))
-		return;
+	Estack e1, e2, e3;
+	Edata jreturn, star, tree;
+	Prof prof;
 	starassign(*av, av+1, TRUE);
-	jreturn.jb = &j;
+	jreturn.jb = NULL; /* see rc_flow() */
 	star.name = "*";
+	tree.tree = fnlookup(*av);
+	profenter(&prof, *av);
 	except(eReturn, jreturn, &e1);
 	except(eVarstack, star, &e2);
-	walk(treecpy(fnlookup(*av), nalloc), TRUE);
+	except(eTree, tree, &e3);
+	walk(tree.tree, TRUE);
+	unexcept(eTree);
 	varrm("*", TRUE);
 	unexcept(eVarstack);
 	unexcept(eReturn);
+	if (flow == &e1)
+		flow = NULL;
+	profleave(&prof, *av);
 }
 
 static void arg_count(char *name) {
@@ -138,6 +189,48 @@ static void b_echo(char **av) {
 }
 #endif
 
+/*
+   The current directory, as getcwd() has it, for $cwd: asked for the
+   first time it is wanted after a cd, so that a prompt can show it
+   without running pwd, and a script that never looks costs nothing.
+*/
+
+static char *cwd = NULL;
+
+extern List *sgetcwd() {
+	size_t n = 256;
+	char *buf = NULL;
+	if (cwd == NULL) {
+		for (;;) {
+			buf = erealloc(buf, n);
+			if (getcwd(buf, n) != NULL)
+				break;
+			if (errno != ERANGE) {
+				efree(buf);
+				return NULL;
+			}
+			n *= 2;
+		}
+		cwd = buf;
+	}
+	return word(cwd, NULL);
+}
+
+/* chdir through the namespace: to the first directory of a union that will do */
+
+static int cdto(char *dir) {
+	char *p;
+	int i;
+	for (i = 0; (p = ns_try(dir, i)) != NULL; i++)
+		if (chdir(p) >= 0) {
+			efree(cwd);
+			cwd = NULL;
+			cmdhash_cd();
+			return 0;
+		}
+	return -1;
+}
+
 /* cd. traverse $cdpath if the directory given is not an absolute pathname */
 
 static void b_cd(char **av) {
@@ -152,7 +245,7 @@ static void b_cd(char **av) {
 	return;
     }
     if (isabsolute(*av) || streq(*av, ".") || streq(*av, "..")) { /* absolute pathname? */
-	if (chdir(*av) < 0) {
+	if (cdto(*av) < 0) {
 	    set(FALSE);
 	    uerror(*av);
 	} else
@@ -177,7 +270,7 @@ static void b_cd(char **av) {
 		pathlen = 0;
 		path = *av;
 	    }
-	    if (chdir(path) >= 0) {
+	    if (cdto(path) >= 0) {
 		set(TRUE);
 		if (interactive && *s->w != '\0' && !streq(s->w, "."))
 		    fprint(1, "%s\n", path);
@@ -286,32 +379,32 @@ flag_usage:
 	set(FALSE);
 }
 
-/* raise a "return" exception, i.e., return from a function. if an integer argument is present, set $status to it */
+/* return from a function. if an integer argument is present, set $status to it */
 
 static void b_return(char **av) {
 	if (*++av != NULL)
 		ssetstatus(av);
-	rc_raise(eReturn);
+	rc_flow(eReturn);
 }
 
-/* raise a "break" exception for breaking out of for and while loops */
+/* break out of for and while loops */
 
 static void b_break(char **av) {
 	if (av[1] != NULL) {
 		arg_count("break");
 		return;
 	}
-	rc_raise(eBreak);
+	rc_flow(eBreak);
 }
 
-/* raise a "continue" exception to finish early an iteration of 'for' and 'while' loops */
+/* finish early an iteration of 'for' and 'while' loops */
 
 static void b_continue(char **av) {
 	if (av[1] != NULL) {
 		arg_count("continue");
 		return;
 	}
-	rc_raise(eContinue);
+	rc_flow(eContinue);
 }
 
 /* shift $* n places (default 1) */
@@ -357,6 +450,236 @@ static void b_wait(char **av) {
         sigchk();
 }
 
+/*
+   time command [arg ...] runs the command as rc would have, and says
+   how long it took and what it used: the real, user and system seconds,
+   the largest resident set in kilobytes (that of rc itself if nothing
+   was forked), the minor and major page faults and the voluntary and
+   involuntary context switches. The same figures, and the CPU seconds
+   of each stage of the last pipeline to finish, if one did, are left
+   in $timing as name-value pairs. The command's status is left alone.
+   Everything comes from getrusage and wait3, so no process is spent.
+*/
+
+static double tv2sec(struct timeval *tv) {
+	return tv->tv_sec + tv->tv_usec / 1e6;
+}
+
+/* rc's own print has no floating point */
+static char *secs(double t) {
+	char buf[32];
+	snprintf(buf, sizeof buf, "%.6f", t);
+	return ncpy(buf);
+}
+
+static List *pair(char *name, char *value, List *rest) {
+	List *v = word(value, NULL);
+	v->n = rest;
+	rest = word(name, NULL);
+	rest->n = v;
+	return rest;
+}
+
+extern void b_time(char **av) {
+	struct rusage s0, c0, s1, c1;
+	struct timespec t0, t1;
+	List *cmd, **tail, *v;
+	double real, user, sys, *stage;
+	long rss, oldrss, minflt, majflt, nvcsw, nivcsw;
+	unsigned long gen0, gen1;
+	char line[512], **a;
+	int i, n, k;
+	if (*++av == NULL) {
+		fprint(2, RC "time: no command\n");
+		set(FALSE);
+		return;
+	}
+	for (cmd = NULL, tail = &cmd, a = av; *a != NULL; a++) {
+		*tail = word(*a, NULL);
+		tail = &(*tail)->n;
+	}
+	pipecpu(&stage, &gen0);
+	oldrss = childrss;
+	childrss = 0;
+	getrusage(RUSAGE_SELF, &s0);
+	getrusage(RUSAGE_CHILDREN, &c0);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	exec(cmd, TRUE);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	getrusage(RUSAGE_SELF, &s1);
+	getrusage(RUSAGE_CHILDREN, &c1);
+	n = pipecpu(&stage, &gen1);
+	real = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	user = tv2sec(&s1.ru_utime) - tv2sec(&s0.ru_utime) + tv2sec(&c1.ru_utime) - tv2sec(&c0.ru_utime);
+	sys = tv2sec(&s1.ru_stime) - tv2sec(&s0.ru_stime) + tv2sec(&c1.ru_stime) - tv2sec(&c0.ru_stime);
+	rss = childrss > 0 ? childrss : s1.ru_maxrss;
+	if (oldrss > childrss)
+		childrss = oldrss;
+	minflt = s1.ru_minflt - s0.ru_minflt + c1.ru_minflt - c0.ru_minflt;
+	majflt = s1.ru_majflt - s0.ru_majflt + c1.ru_majflt - c0.ru_majflt;
+	nvcsw = s1.ru_nvcsw - s0.ru_nvcsw + c1.ru_nvcsw - c0.ru_nvcsw;
+	nivcsw = s1.ru_nivcsw - s0.ru_nivcsw + c1.ru_nivcsw - c0.ru_nivcsw;
+
+	k = snprintf(line, sizeof line, "%.2fu %.2fs %.2fr %ldk %ld+%ldpf %ld+%ldcs\t",
+		user, sys, real, rss, minflt, majflt, nvcsw, nivcsw);
+	for (a = av; *a != NULL && k < (int) sizeof line; a++)
+		k += snprintf(line + k, sizeof line - k, a == av ? "%s" : " %s", *a);
+	fprint(2, "%s\n", line);
+
+	v = NULL;
+	if (gen1 != gen0)
+		for (i = 0; i < n; i++)
+			v = pair("stage", secs(stage[i]), v);
+	v = pair("nivcsw", nprint("%ld", nivcsw), v);
+	v = pair("nvcsw", nprint("%ld", nvcsw), v);
+	v = pair("majflt", nprint("%ld", majflt), v);
+	v = pair("minflt", nprint("%ld", minflt), v);
+	v = pair("maxrss", nprint("%ld", rss), v);
+	v = pair("sys", secs(sys), v);
+	v = pair("user", secs(user), v);
+	v = pair("real", secs(real), v);
+	varassign("timing", v, FALSE);
+}
+
+/*
+   apply [-n max] [-a fixed] [-p] command [arg ...] runs command with as
+   many of the args at a time as fit in ARG_MAX (or at most max of
+   them), after the first fixed ones, which every run gets. With no args
+   past those, the command is run once, as xargs runs it. The command
+   is looked up on $path and the environment built just once; with -p
+   the runs go on in parallel, as many at once as a parallel for.
+*/
+
+static pid_t applyrun(char *path, char **av, char **ev) {
+	pid_t pid;
+#if HAVE_POSIX_SPAWN
+	pid = rc_spawn(path, av, ev);
+#else
+	pid = rc_fork();
+#endif
+	if (pid == 0) {
+		setsigdefaults(FALSE);
+		rc_execve(path, av, ev);
+		uerror(*av);
+		exit(1);
+	}
+	return pid;
+}
+
+static void b_apply(char **av) {
+	bool pee = FALSE;
+	char *path, **ev, **e, **args, **run, **end;
+	int ac, c, i, n, fixed = 0, max = -1;
+	long room, left;
+	pid_t *pids;
+	int *stats;
+	double *cpus;
+	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
+		; /* count the arguments for getopt */
+	while ((c = rc_getopt(ac, av, "n:a:p")) != -1)
+		switch (c) {
+		default: set(FALSE); return;
+		case 'n':
+			if ((max = a2u(rc_optarg)) < 1) {
+				badnum(rc_optarg);
+				return;
+			}
+			break;
+		case 'a':
+			if ((fixed = a2u(rc_optarg)) < 0) {
+				badnum(rc_optarg);
+				return;
+			}
+			break;
+		case 'p': pee = TRUE; break;
+		}
+	av += rc_optind;
+	ac -= rc_optind;
+	if (ac == 0) {
+		fprint(2, RC "apply: no command\n");
+		set(FALSE);
+		return;
+	}
+	if (fixed > ac - 1) {
+		fprint(2, RC "apply: -a %d, but %d arg%s\n", fixed, ac - 1, ac == 2 ? "" : "s");
+		set(FALSE);
+		return;
+	}
+	if ((path = which(*av, TRUE)) == NULL) {
+		set(FALSE);
+		return;
+	}
+	path = ncpy(path);
+	ev = makeenv();
+	room = sysconf(_SC_ARG_MAX);
+	if (room <= 0)
+		room = 4096; /* the least POSIX allows */
+	room -= 2048; /* as xargs leaves, for the loader's use */
+	for (e = ev; *e != NULL; e++)
+		room -= strlen(*e) + 1 + sizeof *e;
+	for (i = 0; i <= fixed; i++)
+		room -= strlen(av[i]) + 1 + sizeof *av;
+	args = av + fixed + 1;
+	n = ac - fixed - 1;
+	run = nalloc((fixed + 1 + n + 1) * sizeof *run);
+	memcpy(run, av, (fixed + 1) * sizeof *run);
+	if (n == 0)
+		n = 1; /* the one run, with the fixed args alone */
+	pids = nalloc(n * sizeof *pids);
+	stats = nalloc(n * sizeof *stats);
+	cpus = nalloc(n * sizeof *cpus);
+	i = 0;
+	do {
+		end = run + fixed + 1;
+		for (left = room; *args != NULL && (max < 0 || end - run - fixed - 1 < max); args++) {
+			left -= strlen(*args) + 1 + sizeof *args;
+			if (left < 0 && end > run + fixed + 1)
+				break; /* a word too long to fit even alone is run alone, for exec to refuse */
+			*end++ = *args;
+		}
+		*end = NULL;
+		if (pee)
+			jobslot(joblimit());
+		pids[i] = applyrun(path, run, ev);
+		if (!pee)
+			rc_waitall(&pids[i], &stats[i], &cpus[i], 1);
+		i++;
+	} while (*args != NULL);
+	if (pee)
+		rc_waitall(pids, stats, cpus, i);
+	setpipestatuslength(i);
+	for (n = 0; n < i; n++)
+		setpipestatus(i - n - 1, -1, stats[n], cpus[n]);
+	sigchk();
+}
+
+/* cap the number of background commands that run at once; 0 for no cap */
+
+static void b_jobs(char **av) {
+	int ac, c, n = -1;
+	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
+		; /* count the arguments for getopt */
+	while ((c = rc_getopt(ac, av, "j:")) != -1)
+		switch (c) {
+		default: set(FALSE); return;
+		case 'j':
+			if ((n = a2u(rc_optarg)) < 0) {
+				badnum(rc_optarg);
+				return;
+			}
+			break;
+		}
+	if (av[rc_optind] != NULL) {
+		arg_count("jobs");
+		return;
+	}
+	if (n < 0)
+		fprint(1, "jobs -j %d\n", jobmax);
+	else
+		jobmax = n;
+	set(TRUE);
+}
+
 /*
    whatis without arguments prints all variables and functions. Otherwise, check to see if a name
    is defined as a variable, function or pathname.
@@ -374,7 +697,7 @@ static bool issig(char *s) {
 }
 
 static void b_whatis(char **av) {
-	bool ess, eff, vee, pee, bee;
+	bool ess, eff, vee, pee, bee, tee;
 	bool f, found;
 	int i, ac, c;
 	List *s;
@@ -382,8 +705,8 @@ static void b_whatis(char **av) {
 	char *e;
 	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
 		; /* count the arguments for getopt */
-	ess = eff = vee = pee = bee = FALSE;
-	while ((c = rc_getopt(ac, av, "sfvpb")) != -1)
+	ess = eff = vee = pee = bee = tee = FALSE;
+	while ((c = rc_getopt(ac, av, "sfvpbt")) != -1)
 		switch (c) {
 		default: set(FALSE); return;
 		case 's': ess = TRUE; break;
@@ -391,8 +714,14 @@ static void b_whatis(char **av) {
 		case 'v': vee = TRUE; break;
 		case 'p': pee = TRUE; break;
 		case 'b': bee = TRUE; break;
+		case 't': tee = TRUE; break;
 		}
 	av += rc_optind;
+	if (tee) {
+		whatare_profiles(av);
+		set(TRUE);
+		return;
+	}
 	if (*av == NULL) {
 		if (vee|eff)
 			whatare_all_vars(eff, vee);
@@ -437,6 +766,39 @@ static void b_whatis(char **av) {
 	set(found);
 }
 
+/*
+   hash manipulates the cache of command locations kept by which().
+   Without arguments it lists the cache; -r flushes it, -d forgets the
+   named commands, and otherwise each name is looked up and entered.
+*/
+
+static void b_hash(char **av) {
+	bool ar = FALSE, dee = FALSE, ok = TRUE;
+	int ac, c;
+	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
+		; /* count the arguments for getopt */
+	while ((c = rc_getopt(ac, av, "dr")) != -1)
+		switch (c) {
+		default: set(FALSE); return;
+		case 'd': dee = TRUE; break;
+		case 'r': ar = TRUE; break;
+		}
+	av += rc_optind;
+	if (ar)
+		cmdhash_flush();
+	else if (*av == NULL && !dee)
+		cmdhash_print(1);
+	for (; *av != NULL; av++)
+		if (dee) {
+			if (!cmdhash_forget(*av)) {
+				fprint(2, "%s not hashed\n", *av);
+				ok = FALSE;
+			}
+		} else if (which(*av, TRUE) == NULL)
+			ok = FALSE;
+	set(ok);
+}
+
 /* push a string to be eval'ed onto the input stack. evaluate it */
 
 static void b_eval(char **av) {
@@ -567,9 +929,11 @@ static void printlimit(const struct Limit *limit, bool hard) {
 
 static bool parselimit(const struct Limit *resource, rlim_t *limit, char *s) {
 	char *t;
-	int len = strlen(s);
+	int len;
 	const struct Suffix *suf = resource->suffix;
 
+	s = ncpy(s); /* cut below; the word may be a function body's */
+	len = strlen(s);
 	*limit = 1;
 	if (streq(s, "unlimited")) {
 		*limit = RLIM_INFINITY;
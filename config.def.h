@@ -44,6 +44,30 @@
 /* Define if your system can execute script files starting with '#!' */
 #define HASH_BANG 1
 
+/* Define if you have posix_spawn(), used to start simple external commands. */
+#define HAVE_POSIX_SPAWN 1
+
+/* Define if you have memfd_create(), used to hold here documents. */
+#ifdef __linux__
+#define HAVE_MEMFD_CREATE 1
+#endif
+
+/* Define if you have pipe2(), used to make pipes close-on-exec. */
+#ifdef __linux__
+#define HAVE_PIPE2 1
+#endif
+
+/* Define to a size in bytes to enlarge the pipes in pipelines to, where
+   the system allows it (F_SETPIPE_SZ). */
+/* #undef PIPE_SIZE */
+
+/* Define to the number of distinct commands from $history a line editor
+   is started with; older ones, and repeats, are left out. */
+#define EDIT_HISTORY 10000
+
+/* Define if you have mmap(), used to read script files. */
+#define HAVE_MMAP 1
+
 /* Define if you want rc to encode strange characters in the environment. */
 #define PROTECT_ENV 1
 
@@ -6,9 +6,9 @@
  *   mount [-abc] [-s spec] srv mp  - mount a 9P or remote filesystem
  *   unmount [from] mountpoint - remove a namespace binding or mount
  *   ns [-r]                   - display current namespace
- *   cpu [-h host] [-u user] cmd - execute command on remote host
+ *   cpu [-h host ...] [-j max] [-B] [-E] [-u user] cmd - execute command on remote hosts
  *   import [-abc] host path [mp] - import remote file tree
- *   srv [-r] [name [cmd ...]] - manage named services
+ *   srv [-rsc] [-p n] [name [cmd ...]] - manage named services
  *   rfork [cCeEnNsfF]         - fork with Plan 9-style flags
  *   addns from to             - add a namespace entry (union append)
  *
@@ -22,31 +22,54 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+
+#include "input.h"
+#include "wait.h"
 
 #if RC_DIST
 
+#ifdef __linux__
+#include <sys/mount.h>
+#include <sys/syscall.h>
+#endif
+
 #include "dist.h"
 
 /* ========== Namespace Bind Table ========== */
 
-static Bind *bindtab[BIND_MAX];
+/*
+   The bind table is a trie of path components, with each mountpoint's
+   union on the node for its last component, in the order it is
+   searched. A union that did not start with a replacing bind includes
+   the mountpoint's own directory; that entry is flagged BIND_MOUNT,
+   as are mounts made with mount(8) and the like, since the kernel
+   already resolves paths through them.
+*/
+
+typedef struct Nsnode Nsnode;
+struct Nsnode {
+	char *name;		/* path component */
+	Nsnode *kids, *sib;
+	Bind *binds;		/* the union at this mountpoint, if any */
+};
+
+static Nsnode nsroot;
 static int nbinds = 0;
+static bool nsdirty = FALSE;	/* $ns is out of date */
+static List *nsdef = NULL;	/* the value ns_export() gave it */
 
 /* ========== Internal Helpers ========== */
 
-/* hash a path to a bind table index */
-static unsigned int pathhash(const char *s) {
-	unsigned int h = 0;
-	while (*s)
-		h = h * 31 + (unsigned char)*s++;
-	return h % BIND_MAX;
-}
-
 /* canonicalize a path (remove trailing slashes, resolve . and ..) */
 static char *cleanpath(char *path) {
 	char *resolved;
@@ -99,89 +122,155 @@ static void ensure_srvdir(void) {
 		mkdir(SRV_DIR, 0755);
 }
 
-/* find a bind entry for a given mountpoint */
-static Bind *find_bind(const char *to) {
-	unsigned int h = pathhash(to);
-	Bind *b;
-	for (b = bindtab[h]; b != NULL; b = b->n)
-		if (streq(b->to, (char *)to))
-			return b;
-	return NULL;
+/* find the trie node for an absolute mountpoint, making it if make */
+static Nsnode *find_node(const char *to, bool make) {
+	Nsnode *node = &nsroot, *k;
+	const char *p = to, *q;
+	size_t len;
+	for (;;) {
+		while (*p == '/')
+			p++;
+		if (*p == '\0')
+			return node;
+		if ((q = strchr(p, '/')) == NULL)
+			q = p + strlen(p);
+		len = q - p;
+		for (k = node->kids; k != NULL; k = k->sib)
+			if (strncmp(k->name, p, len) == 0 && k->name[len] == '\0')
+				break;
+		if (k == NULL) {
+			if (!make)
+				return NULL;
+			k = enew(Nsnode);
+			k->name = ealloc(len + 1);
+			memcpy(k->name, p, len);
+			k->name[len] = '\0';
+			k->kids = NULL;
+			k->binds = NULL;
+			k->sib = node->kids;
+			node->kids = k;
+		}
+		node = k;
+		p = q;
+	}
 }
 
-/* add a bind entry */
-static Bind *add_bind(const char *from, const char *to, int mode) {
-	unsigned int h = pathhash(to);
-	Bind *b, *existing;
+/* find the union for a given mountpoint */
+static Bind *find_bind(const char *to) {
+	Nsnode *node = find_node(to, FALSE);
+	return node == NULL ? NULL : node->binds;
+}
 
-	b = enew(Bind);
+static Bind *new_bind(const char *from, const char *to, int mode) {
+	Bind *b = enew(Bind);
 	b->from = ecpy((char *)from);
 	b->to = ecpy((char *)to);
-	b->mode = mode & (BIND_BEFORE | BIND_AFTER | BIND_REPLACE);
+	b->mode = mode;
 	b->n = NULL;
+	return b;
+}
 
-	existing = find_bind(to);
-	if (existing != NULL) {
-		if (mode & BIND_BEFORE) {
-			/* insert before existing */
-			b->n = bindtab[h];
-			bindtab[h] = b;
-		} else if (mode & BIND_AFTER) {
-			/* insert after existing, at end */
-			Bind *p = existing;
-			while (p->n != NULL)
-				p = p->n;
-			p->n = b;
-		} else {
-			/* replace: remove old, insert new */
-			Bind **pp = &bindtab[h];
-			while (*pp != NULL) {
-				if (streq((*pp)->to, (char *)to)) {
-					Bind *old = *pp;
-					*pp = old->n;
-					efree(old->from);
-					efree(old->to);
-					efree(old);
-				} else {
-					pp = &(*pp)->n;
-				}
-			}
-			b->n = bindtab[h];
-			bindtab[h] = b;
-		}
+static void free_binds(Bind *b) {
+	Bind *next;
+	for (; b != NULL; b = next) {
+		next = b->n;
+		efree(b->from);
+		efree(b->to);
+		efree(b);
+	}
+}
+
+/* is b the mountpoint's own directory at the head of a union? */
+static bool isself(Bind *b) {
+	return (b->mode & BIND_MOUNT) && streq(b->from, b->to);
+}
+
+/* empty the union at a mountpoint */
+static void drop_binds(Nsnode *node) {
+	Bind *old;
+	for (old = node->binds; old != NULL; old = old->n)
+		nbinds--;
+	free_binds(node->binds);
+	node->binds = NULL;
+	nsdirty = TRUE;
+}
+
+/* add a bind entry, as Plan 9 does: replace the union, or add to either end */
+static Bind *add_bind(const char *from, const char *to, int mode) {
+	Nsnode *node = find_node(to, TRUE);
+	Bind *b, **pp;
+
+	mode &= BIND_BEFORE | BIND_AFTER | BIND_MOUNT | BIND_KERNEL;
+	b = new_bind(from, to, mode);
+	if (node->binds == NULL && (mode & (BIND_BEFORE | BIND_AFTER))) {
+		node->binds = new_bind(to, to, BIND_MOUNT);
+		nbinds++;
+	}
+	if (mode & BIND_BEFORE) {
+		b->n = node->binds;
+		node->binds = b;
+	} else if (mode & BIND_AFTER) {
+		for (pp = &node->binds; *pp != NULL; pp = &(*pp)->n)
+			;
+		*pp = b;
 	} else {
-		b->n = bindtab[h];
-		bindtab[h] = b;
+		drop_binds(node);
+		node->binds = b;
 	}
 	nbinds++;
+	nsdirty = TRUE;
+	cmdhash_flush(); /* commands may now be found elsewhere */
 	return b;
 }
 
 /* remove a bind entry */
 static int remove_bind(const char *from, const char *to) {
-	unsigned int h = pathhash(to);
-	Bind **pp = &bindtab[h];
+	char *cto = cleanpath((char *)to), *cfrom = NULL;
+	Nsnode *node = find_node(cto, FALSE);
+	Bind **pp, *b;
 	int found = 0;
 
-	while (*pp != NULL) {
-		Bind *b = *pp;
-		if (streq(b->to, (char *)to) &&
-		    (from == NULL || streq(b->from, (char *)from))) {
+	if (from != NULL)
+		cfrom = cleanpath((char *)from);
+	for (pp = (node == NULL) ? NULL : &node->binds; pp != NULL && *pp != NULL;) {
+		b = *pp;
+		if (!isself(b) && (cfrom == NULL || streq(b->from, cfrom))) {
 			*pp = b->n;
-			efree(b->from);
-			efree(b->to);
-			efree(b);
+			b->n = NULL;
+			free_binds(b);
 			nbinds--;
 			found = 1;
-			if (from != NULL)
+			if (cfrom != NULL)
 				break; /* only remove specific binding */
 		} else {
 			pp = &(*pp)->n;
 		}
 	}
+	if (found && node->binds != NULL && node->binds->n == NULL && isself(node->binds)) {
+		free_binds(node->binds); /* nothing left bound here */
+		node->binds = NULL;
+		nbinds--;
+	}
+	if (found) {
+		nsdirty = TRUE;
+		cmdhash_flush();
+	}
+	efree(cto);
+	efree(cfrom);
 	return found;
 }
 
+/*
+   execvp() in the environment as it stands. main() points environ at
+   makeenv()'s array only once, and that may since have been moved.
+*/
+
+static void distexec(char **argv) {
+	extern char **environ;
+	environ = makeenv();
+	execvp(argv[0], argv);
+}
+
 /* execute a command and wait for it (helper for mount/import/cpu) */
 static int run_cmd(char **argv) {
 	int stat;
@@ -190,7 +279,7 @@ static int run_cmd(char **argv) {
 	pid = rc_fork();
 	if (pid == 0) {
 		setsigdefaults(FALSE);
-		execvp(argv[0], argv);
+		distexec(argv);
 		uerror(argv[0]);
 		_exit(127);
 	}
@@ -202,6 +291,94 @@ static int run_cmd(char **argv) {
 	return stat;
 }
 
+/* ========== Kernel namespaces ========== */
+
+/*
+   Once rfork n has given the shell a mount namespace of its own, bind
+   makes real mounts with mount(2), and so does mount where it can,
+   for every program run from then on to see, with no fork and exec of
+   mount(8) each time. A union is a read-only overlay of its members in
+   search order, put back whole each time it changes. The entries stay
+   in the table, flagged BIND_KERNEL, for ns and unmount, but rc leaves
+   the paths through them to the kernel. As on Plan 9, the namespace
+   is then shared with the shell's children, until they rfork n again.
+*/
+
+#ifdef __linux__
+
+static bool nskernel = FALSE;
+
+static bool kernelat(Nsnode *node) {
+	return node != NULL && node->binds != NULL && (node->binds->mode & BIND_KERNEL);
+}
+
+/* a path for overlayfs's lowerdir=, with its separators escaped */
+static char *ovlpath(char *s) {
+	char *r = nalloc(2 * strlen(s) + 1), *p = r;
+	for (; *s != '\0'; s++) {
+		if (*s == ':' || *s == ',' || *s == '\\')
+			*p++ = '\\';
+		*p++ = *s;
+	}
+	*p = '\0';
+	return r;
+}
+
+/*
+   Put the union at to into the kernel, in place of the one rc put
+   there before, if there was. On failure the union is emptied, since
+   the old one is gone too.
+*/
+
+static char *kdir(Bind *b) {
+	return isself(b) ? b->to : b->from;
+}
+
+static bool kbind(char *to, bool was) {
+	Nsnode *node = find_node(to, FALSE);
+	char *opts = "lowerdir=", *sep = "";
+	Bind *b, *c;
+	int r, n = 0;
+
+	if (was)
+		umount2(to, MNT_DETACH);
+	if (node == NULL || node->binds == NULL)
+		return TRUE;
+	for (b = node->binds; b != NULL; b = b->n) {
+		for (c = node->binds; c != b && !streq(kdir(c), kdir(b)); c = c->n)
+			;
+		if (c != b)
+			continue; /* overlayfs takes a layer once; the first is the one searched */
+		opts = nprint("%s%s%s", opts, sep, ovlpath(kdir(b)));
+		sep = ":";
+		n++;
+	}
+	if (n == 1)
+		r = mount(kdir(node->binds), to, NULL, MS_BIND | MS_REC, NULL);
+	else
+		r = mount("overlay", to, "overlay", MS_RDONLY, opts);
+	if (r < 0) {
+		drop_binds(node);
+		cmdhash_flush();
+		return FALSE;
+	}
+	for (b = node->binds; b != NULL; b = b->n)
+		b->mode |= BIND_KERNEL;
+	nsdirty = TRUE;
+	return TRUE;
+}
+
+/* TRUE if the union at node has a mount in it, which overlayfs cannot take */
+static bool hasmount(Nsnode *node) {
+	Bind *b;
+	for (b = (node == NULL) ? NULL : node->binds; b != NULL; b = b->n)
+		if ((b->mode & BIND_MOUNT) && !isself(b))
+			return TRUE;
+	return FALSE;
+}
+
+#endif
+
 /* ========== bind [-abcr] from to ========== */
 
 /*
@@ -215,7 +392,10 @@ static int run_cmd(char **argv) {
    (default is replace)
 
    The bind table is maintained in-shell and exported to children
-   via the $ns variable.
+   via the $ns variable. rc itself looks through it when it opens a
+   file for redirection, searches for a command, changes directory or
+   expands a pattern; other programs see only the directories as they
+   are, unless rfork n has been run (see above).
 */
 
 extern void b_bind(char **av) {
@@ -273,6 +453,27 @@ extern void b_bind(char **av) {
 
 	cfrom = cleanpath(from);
 	cto = cleanpath(to);
+#ifdef __linux__
+	if (nskernel) {
+		Nsnode *node = find_node(cto, FALSE);
+		bool was = kernelat(node);
+		if ((mode & (BIND_BEFORE | BIND_AFTER)) && hasmount(node)) {
+			fprint(2, RC "bind: %s: cannot make a union with a mount\n", cto);
+			efree(cfrom);
+			efree(cto);
+			set(FALSE);
+			return;
+		}
+		add_bind(cfrom, cto, mode);
+		if (!kbind(cto, was)) {
+			fprint(2, RC "bind: %s: %s\n", cto, strerror(errno));
+			efree(cfrom);
+			efree(cto);
+			set(FALSE);
+			return;
+		}
+	} else
+#endif
 	add_bind(cfrom, cto, mode);
 
 	/* export namespace to environment */
@@ -375,7 +576,7 @@ extern void b_mount(char **av) {
 		if (WIFEXITED(stat) && WEXITSTATUS(stat) == 0) {
 			char *cfrom = cleanpath(addr);
 			char *cto = cleanpath(mountpoint);
-			add_bind(cfrom, cto, mode);
+			add_bind(cfrom, cto, mode | BIND_MOUNT);
 			efree(cfrom);
 			efree(cto);
 			set(TRUE);
@@ -384,6 +585,29 @@ extern void b_mount(char **av) {
 		fprint(2, RC "mount: sshfs failed, trying mount(8)\n");
 	}
 
+#ifdef __linux__
+	/* with a type, or a directory to bind, mount(2) will do */
+	if (nskernel && !(mode & (BIND_BEFORE | BIND_AFTER)) && (spec != NULL || isdir(addr))) {
+		char *cfrom = cleanpath(addr);
+		char *cto = cleanpath(mountpoint);
+		Nsnode *node = find_node(cto, FALSE);
+		if (kernelat(node)) {
+			umount2(cto, MNT_DETACH);
+			drop_binds(node);
+			cmdhash_flush();
+		}
+		if (mount(addr, cto, spec, spec != NULL ? 0 : MS_BIND | MS_REC, NULL) == 0) {
+			add_bind(cfrom, cto, BIND_MOUNT | BIND_KERNEL);
+			efree(cfrom);
+			efree(cto);
+			set(TRUE);
+			return;
+		}
+		efree(cfrom);
+		efree(cto);
+	}
+#endif
+
 	/* try system mount for 9P or local */
 	argc = 0;
 	mountcmd[argc++] = "mount";
@@ -399,7 +623,7 @@ extern void b_mount(char **av) {
 	if (WIFEXITED(stat) && WEXITSTATUS(stat) == 0) {
 		char *cfrom = cleanpath(addr);
 		char *cto = cleanpath(mountpoint);
-		add_bind(cfrom, cto, mode);
+		add_bind(cfrom, cto, mode | BIND_MOUNT);
 		efree(cfrom);
 		efree(cto);
 		set(TRUE);
@@ -440,6 +664,24 @@ extern void b_unmount(char **av) {
 		mp = av[0];
 	}
 
+#ifdef __linux__
+	if (nskernel) {
+		char *cmp = cleanpath(mp);
+		if (kernelat(find_node(cmp, FALSE))) {
+			found = remove_bind(from, cmp);
+			if (found && !kbind(cmp, TRUE)) {
+				fprint(2, RC "unmount: %s: %s\n", cmp, strerror(errno));
+				efree(cmp);
+				set(FALSE);
+				return;
+			}
+			efree(cmp);
+			goto done;
+		}
+		efree(cmp);
+	}
+#endif
+
 	/* try to remove from our bind table */
 	found = remove_bind(from, mp);
 
@@ -466,6 +708,9 @@ extern void b_unmount(char **av) {
 		}
 	}
 
+#ifdef __linux__
+done:
+#endif
 	if (!found) {
 		fprint(2, RC "unmount: %s: not mounted\n", mp);
 		set(FALSE);
@@ -479,6 +724,57 @@ extern void b_unmount(char **av) {
 
 /* ========== ns [-r] ========== */
 
+/*
+   With -r, a union is printed as the binds that would make it: the
+   entries ahead of the mountpoint's own directory as bind -b, nearest
+   first, and those after it as bind -a. Mounts cannot be remade with
+   bind, so they are left out.
+*/
+
+static void print_before(Bind *b, Bind *self) {
+	if (b == self)
+		return;
+	print_before(b->n, self);
+	if (!(b->mode & BIND_MOUNT))
+		fprint(1, "bind -b %S %S\n", b->from, b->to);
+}
+
+static int ns_print(Nsnode *node, int recreate) {
+	Bind *b, *self;
+	int count = 0;
+	for (; node != NULL; node = node->sib) {
+		for (self = node->binds; self != NULL && !isself(self); self = self->n)
+			;
+		if (recreate && node->binds != NULL) {
+			b = node->binds;
+			if (self != NULL)
+				print_before(b, self);
+			else if (!(b->mode & BIND_MOUNT))
+				fprint(1, "bind %S %S\n", b->from, b->to);
+			for (b = (self != NULL) ? self->n : b->n; b != NULL; b = b->n)
+				if (!(b->mode & BIND_MOUNT))
+					fprint(1, "bind -a %S %S\n", b->from, b->to);
+		}
+		for (b = node->binds; b != NULL; b = b->n) {
+			if (isself(b))
+				continue;
+			if (!recreate) {
+				char *mstr;
+				if (b->mode & BIND_BEFORE)
+					mstr = "before";
+				else if (b->mode & BIND_AFTER)
+					mstr = "after";
+				else
+					mstr = "replace";
+				fprint(1, "%S\t%S\t(%s)\n", b->from, b->to, mstr);
+			}
+			count++;
+		}
+		count += ns_print(node->kids, recreate);
+	}
+	return count;
+}
+
 /*
    Display the current namespace. Shows all bind table entries
    and active mounts. With -r, output is in a form that can be
@@ -487,8 +783,7 @@ extern void b_unmount(char **av) {
 
 extern void b_ns(char **av) {
 	int recreate = 0;
-	int i, count = 0;
-	Bind *b;
+	int count;
 
 	for (++av; *av != NULL && **av == '-'; av++) {
 		char *f = *av + 1;
@@ -509,26 +804,7 @@ extern void b_ns(char **av) {
 	}
 
 	/* print bind table entries */
-	for (i = 0; i < BIND_MAX; i++) {
-		for (b = bindtab[i]; b != NULL; b = b->n) {
-			if (recreate) {
-				fprint(1, "bind %s%S %S\n",
-				       (b->mode & BIND_BEFORE) ? "-b " :
-				       (b->mode & BIND_AFTER)  ? "-a " : "",
-				       b->from, b->to);
-			} else {
-				char *mstr;
-				if (b->mode & BIND_BEFORE)
-					mstr = "before";
-				else if (b->mode & BIND_AFTER)
-					mstr = "after";
-				else
-					mstr = "replace";
-				fprint(1, "%S\t%S\t(%s)\n", b->from, b->to, mstr);
-			}
-			count++;
-		}
-	}
+	count = ns_print(&nsroot, recreate);
 
 	/* also show system mounts from /proc if no bind entries */
 	if (count == 0 && !recreate) {
@@ -553,7 +829,7 @@ extern void b_ns(char **av) {
 	set(TRUE);
 }
 
-/* ========== cpu [-h host] [-u user] [-A] cmd [args...] ========== */
+/* ========== cpu [-h host ...] [-j max] [-B] [-E] [-u user] [-A] cmd [args...] ========== */
 
 /*
    Execute a command on a remote host, in the spirit of Plan 9's
@@ -561,40 +837,591 @@ extern void b_ns(char **av) {
    but provides Plan 9-like semantics:
 
    - Exports the current $path to the remote
-   - Exports shell functions to the remote
-   - Sets up the remote environment to match local
+   - With -E, exports variables and shell functions to the remote
    - Returns the remote exit status
 
-   -h host   specify remote host (or set $cpu variable)
+   -h host   specify remote host (or set $cpu variable); may be repeated
+   -j max    with several hosts, run on at most max at once
+   -B        with several hosts, print each host's output all together
+   -E        run the command with rc, in the exported environment
    -u user   specify remote user
    -A        forward SSH agent
+
+   The first cpu to a host (as a user) leaves an ssh ControlMaster
+   behind, and later ones run over it, saving the connection setup
+   and authentication. The shell that made a master closes it on
+   exit; it also closes by itself after CPU_PERSIST idle seconds, in
+   case the shell dies without. The masters' sockets are named after
+   the shell's pid, so they go in a directory of the user's own,
+   $XDG_RUNTIME_DIR/rc or else $home/.ssh, made 0700 if need be; cpu
+   refuses one that another user owns or that others can get into.
+
+   With -E, the remote needs rc too. Each host keeps the exported
+   variables and functions in a state file under $HOME/.cache/rc there,
+   which the remote rc reads before running the command. Only the first
+   cpu from a shell sends them all: later ones send the definitions
+   that changed since the last (and remove those since unset), found by
+   comparing makeenv()'s strings with a copy of those last sent, and
+   append them to the file. Once the appended changes outgrow the
+   environment itself the whole lot is sent afresh. Names that describe
+   the local login (HOME, USER, SSH_* and so on) are not sent.
 */
 
+#define CPU_PERSIST "600"
+#define CPU_MARK "RC_CPU_ENV"
+
+static Conn *conns = NULL;
+static int cpuids = 0;
+static char *cpudir = NULL;
+
+/* the environment names that belong to the local login */
+static char *cpulocal[] = {
+	"DISPLAY", "HOME", "HOSTNAME", "LOGNAME", "OLDPWD", "PWD",
+	"SHELL", "SHLVL", "TMPDIR", "USER", "_"
+};
+
+typedef struct {
+	char *s;
+	size_t len, size;
+} Strbuf;
+
+static void sbadd(Strbuf *b, const char *s, size_t n) {
+	if (b->len + n + 1 > b->size)
+		b->s = erealloc(b->s, b->size = 2 * (b->len + n) + 256);
+	memcpy(b->s + b->len, s, n);
+	b->s[b->len += n] = '\0';
+}
+
+static void sbputs(Strbuf *b, const char *s) {
+	sbadd(b, s, strlen(s));
+}
+
+/* append s quoted for sh */
+static void sbquote(Strbuf *b, const char *s) {
+	sbputs(b, "'");
+	for (; *s != '\0'; s++)
+		if (*s == '\'')
+			sbputs(b, "'\\''");
+		else
+			sbadd(b, s, 1);
+	sbputs(b, "'");
+}
+
+static void freeenv(char **e, int n) {
+	while (n > 0)
+		efree(e[--n]);
+	efree(e);
+}
+
+/* set cpudir to where the control sockets go; FALSE, having said why, if nowhere safe */
+static bool cpusockdir(void) {
+	struct stat st;
+	List *s;
+	char *dir;
+
+	if ((s = varlookup("XDG_RUNTIME_DIR")) != NULL && *s->w != '\0')
+		dir = nprint("%s/rc", s->w);
+	else if ((s = varlookup("home")) != NULL && *s->w != '\0')
+		dir = nprint("%s/.ssh", s->w);
+	else {
+		fprint(2, RC "cpu: no $home for ssh's control sockets\n");
+		return FALSE;
+	}
+	if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+		uerror(dir);
+		return FALSE;
+	}
+	if (lstat(dir, &st) < 0) {
+		uerror(dir);
+		return FALSE;
+	}
+	if (!S_ISDIR(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & 077) != 0) {
+		fprint(2, RC "cpu: %s is not a directory of yours alone\n", dir);
+		return FALSE;
+	}
+	if (cpudir == NULL || !streq(cpudir, dir)) {
+		efree(cpudir);
+		cpudir = ecpy(dir);
+	}
+	return TRUE;
+}
+
+/* find the connection to host as user, or make a new one */
+static Conn *cpuconn(char *host, char *user) {
+	Conn *c;
+	for (c = conns; c != NULL; c = c->n)
+		if (streq(c->host, host) && (user == NULL ? c->user == NULL : c->user != NULL && streq(c->user, user)))
+			return c;
+	c = enew(Conn);
+	c->host = ecpy(host);
+	c->user = (user == NULL) ? NULL : ecpy(user);
+	c->owner = getpid();
+	c->id = cpuids++;
+	c->sent = c->next = NULL;
+	c->nsent = c->nnext = 0;
+	c->sender = 0;
+	c->grown = 0;
+	/* %C, ssh's hash of host, port and user, keeps the socket name short */
+	c->path = mprint("ControlPath=%s/cpu-%d-%%C", cpudir, (int) c->owner);
+	c->n = conns;
+	conns = c;
+	return c;
+}
+
+/* the name of the state file pid keeps for c on the remote, in $HOME/.cache/rc */
+static char *cpustate(Conn *c, pid_t pid) {
+	static char host[256];
+	if (*host == '\0' && (gethostname(host, sizeof host - 1) < 0 || *host == '\0'))
+		strcpy(host, "local");
+	return nprint("cpu-%s-%d-%d", host, (int) pid, c->id);
+}
+
+/* run cmd over c's master, quietly */
+static void cpuctl(Conn *c, char *op, char *cmd) {
+	char *argv[12];
+	int argc = 0, stat;
+	pid_t pid;
+
+	argv[argc++] = "ssh";
+	argv[argc++] = "-o";
+	argv[argc++] = c->path;
+	argv[argc++] = "-o";
+	argv[argc++] = "BatchMode=yes";
+	if (op != NULL) {
+		argv[argc++] = "-O";
+		argv[argc++] = op;
+	}
+	if (c->user != NULL) {
+		argv[argc++] = "-l";
+		argv[argc++] = c->user;
+	}
+	argv[argc++] = c->host;
+	if (cmd != NULL)
+		argv[argc++] = cmd;
+	argv[argc] = NULL;
+	if ((pid = rc_fork()) == 0) {
+		int fd = open("/dev/null", O_RDWR);
+		if (fd >= 0) {
+			dup2(fd, 0);
+			dup2(fd, 2); /* no "Exit request sent." */
+		}
+		distexec(argv);
+		_exit(127);
+	}
+	if (pid > 0)
+		rc_wait4(pid, &stat, TRUE);
+}
+
+/* close the masters this shell made, and remove the state it left */
+static void cpuclose(void) {
+	Conn *c, *next;
+
+	for (c = conns; c != NULL; c = next) {
+		next = c->n;
+		if (c->sent != NULL && c->sender == getpid())
+			cpuctl(c, NULL, nprint("rm -f \"$HOME/.cache/rc/%s\"", cpustate(c, getpid())));
+		if (c->owner == getpid())
+			cpuctl(c, "exit", NULL);
+		if (c->sent != NULL)
+			freeenv(c->sent, c->nsent);
+		if (c->next != NULL)
+			freeenv(c->next, c->nnext);
+		efree(c->host);
+		efree(c->user);
+		efree(c->path);
+		efree(c);
+	}
+	conns = NULL;
+}
+
+/* whether env entry e is to be sent: a real variable or function, not the login's */
+static bool cpuwanted(char *e) {
+	size_t len = strcspn(e, "=");
+	char *name;
+	int i;
+	if (strncmp(e, "fn_", conststrlen("fn_")) == 0)
+		return (name = get_name(e + conststrlen("fn_"))) != NULL && fnlookup_string(name) == e;
+	if (strncmp(e, "SSH_", conststrlen("SSH_")) == 0 || strncmp(e, "XDG_", conststrlen("XDG_")) == 0)
+		return FALSE;
+	for (i = 0; i < arraysize(cpulocal); i++)
+		if (strlen(cpulocal[i]) == len && strncmp(e, cpulocal[i], len) == 0)
+			return FALSE;
+	/* not an entry rc could not import, which it passes on as is */
+	return (name = get_name(e)) != NULL && varlookup_string(name) == e;
+}
+
+/* append the rc to define env entry e, or to remove it */
+static void cpudef(Strbuf *b, char *e, bool def) {
+	char *name;
+	if (strncmp(e, "fn_", conststrlen("fn_")) == 0) {
+		name = get_name(e + conststrlen("fn_"));
+		sbputs(b, def ? nprint("fn %#S {%T}\n", name, fnlookup(name)) : nprint("fn %#S\n", name));
+	} else {
+		name = get_name(e);
+		sbputs(b, def ? nprint("%#S=(%L)\n", name, varlookup(name), " ") : nprint("%#S=()\n", name));
+	}
+}
+
+/*
+   Append the sh to bring c's state file up to date with the
+   environment, and return the file's name. The copy of what was sent
+   becomes c->sent in cpudone(), if ssh got as far as the remote. A
+   subshell (such as that for a redirected cpu) starts its own file
+   from a copy of its parent's, so that the parent's stays as the
+   parent last left it.
+*/
+
+static char *cpuenv(Strbuf *b, Conn *c) {
+	Strbuf body = { NULL, 0, 0 };
+	char **env = makeenv(), *mark, *state;
+	size_t total = 0;
+	int i, j, n, cmp;
+	bool whole;
+
+	if (c->next != NULL)
+		freeenv(c->next, c->nnext);
+	for (n = 0; env[n] != NULL; n++)
+		;
+	c->next = ealloc((n + 1) * sizeof *c->next);
+	for (i = c->nnext = 0; i < n; i++)
+		if (cpuwanted(env[i])) {
+			c->next[c->nnext++] = ecpy(env[i]);
+			total += strlen(env[i]);
+		}
+	whole = (c->sent == NULL);
+	if (!whole) {
+		Strbuf defs = { NULL, 0, 0 };
+		/* both are in makeenv()'s order, so the changes are found in one pass */
+		for (i = j = 0; i < c->nsent || j < c->nnext; )
+			if ((cmp = (i == c->nsent) ? 1 : (j == c->nnext) ? -1 : strcmp(c->sent[i], c->next[j])) < 0) {
+				n = strcspn(c->sent[i], "=") + 1;
+				if (j == c->nnext || strncmp(c->sent[i], c->next[j], n) != 0)
+					cpudef(&body, c->sent[i], FALSE); /* not just redefined */
+				i++;
+			} else if (cmp > 0)
+				cpudef(&defs, c->next[j++], TRUE);
+			else
+				i++, j++;
+		if (defs.len > 0)
+			sbadd(&body, defs.s, defs.len);
+		efree(defs.s);
+		if (c->grown + body.len > total) {
+			whole = TRUE;
+			body.len = 0;
+		}
+	}
+	if (whole)
+		for (j = 0; j < c->nnext; j++)
+			cpudef(&body, c->next[j], TRUE);
+	state = cpustate(c, getpid());
+	if (whole || body.len > 0 || c->sender != getpid()) {
+		mark = CPU_MARK;
+		for (i = 0; body.len > 0 && (strncmp(body.s, nprint("%s\n", mark), strlen(mark) + 1) == 0
+				|| strstr(body.s, nprint("\n%s\n", mark)) != NULL); i++)
+			mark = nprint("%s%d", CPU_MARK, i);
+		sbputs(b, "mkdir -p \"$HOME/.cache/rc\" && ");
+		if (!whole && c->sender != getpid())
+			sbputs(b, nprint("cp \"$HOME/.cache/rc/%s\" \"$HOME/.cache/rc/%s\" && ", cpustate(c, c->sender), state));
+		sbputs(b, nprint("cat %s\"$HOME/.cache/rc/%s\" <<'%s' || exit 255\n", whole ? ">" : ">>", state, mark));
+		if (body.len > 0)
+			sbadd(b, body.s, body.len);
+		sbputs(b, nprint("%s\n", mark));
+	}
+	c->grown = whole ? 0 : c->grown + body.len;
+	efree(body.s);
+	return state;
+}
+
+/* keep the environment just sent to c, unless ssh itself failed */
+static void cpudone(Conn *c, int stat) {
+	if (c->next == NULL)
+		return;
+	if (stat == -1 || (WIFEXITED(stat) && WEXITSTATUS(stat) == 255)) {
+		freeenv(c->next, c->nnext);
+	} else {
+		if (c->sent != NULL)
+			freeenv(c->sent, c->nsent);
+		c->sent = c->next;
+		c->nsent = c->nnext;
+		c->sender = getpid();
+	}
+	c->next = NULL;
+	c->nnext = 0;
+}
+
+/* the command line for the remote sh to run av, with $path and maybe the environment */
+static char *cpucmd(Conn *c, char **av, bool shipenv) {
+	Strbuf b = { NULL, 0, 0 }, rc = { NULL, 0, 0 };
+	char *state = NULL, *r, **p;
+	List *s;
+
+	if ((s = varlookup("path")) != NULL) {
+		sbputs(&b, "PATH=");
+		for (; s != NULL; s = s->n) {
+			sbquote(&b, s->w);
+			if (s->n != NULL)
+				sbputs(&b, ":");
+		}
+		sbputs(&b, "; ");
+	}
+	if (shipenv)
+		state = cpuenv(&b, c);
+	for (p = av; *p != NULL; p++) {
+		Strbuf *to = shipenv ? &rc : &b;
+		if (p != av)
+			sbputs(to, " ");
+		/* quote args with spaces */
+		if (strpbrk(*p, " \t\n") == NULL)
+			sbputs(to, *p);
+		else if (shipenv)
+			sbputs(to, nprint("%#S", *p));
+		else
+			sbquote(to, *p);
+	}
+	if (shipenv) {
+		sbputs(&b, nprint("exec rc -c \". '$HOME/.cache/rc/%s'; \"", state));
+		sbquote(&b, rc.s);
+		efree(rc.s);
+	}
+	r = nalloc(b.len + 1);
+	memcpy(r, b.s, b.len + 1);
+	efree(b.s);
+	return r;
+}
+
+/* build the ssh command line for running remote_cmd on host */
+static void cpuargv(char **sshcmd, Conn *c, int forward_agent, char *remote_cmd) {
+	int argc = 0;
+	sshcmd[argc++] = "ssh";
+	if (forward_agent)
+		sshcmd[argc++] = "-A";
+	sshcmd[argc++] = "-o";
+	sshcmd[argc++] = "BatchMode=yes";
+	sshcmd[argc++] = "-o";
+	sshcmd[argc++] = "ControlMaster=auto";
+	sshcmd[argc++] = "-o";
+	sshcmd[argc++] = c->path;
+	sshcmd[argc++] = "-o";
+	sshcmd[argc++] = "ControlPersist=" CPU_PERSIST;
+	if (c->user != NULL) {
+		sshcmd[argc++] = "-l";
+		sshcmd[argc++] = c->user;
+	}
+	sshcmd[argc++] = c->host;
+	sshcmd[argc++] = remote_cmd;
+	sshcmd[argc] = NULL;
+}
+
+/*
+   Run av on many hosts at once, at most max at a time (0 for
+   no limit), with their output gathered through pipes. Each line a
+   host writes is passed on whole, after the host's name; with -B a
+   host's output is held back instead, and printed all together, the
+   hosts in the order they were given. $status is the list of the
+   hosts' statuses, in the same order.
+*/
+
+#define FAN_REAP 100 /* ms between looks for hosts whose ssh has exited */
+
+typedef struct {
+	pid_t pid;
+	int fd[2];		/* its stdout and stderr, or -1 once closed */
+	char *buf[2];
+	size_t len[2], size[2];
+	bool done;
+} Fan;
+
+/* pass on the whole lines in f's buffer for stream i, or all of it at the end */
+static void fanflush(Fan *f, char *host, int i, bool end) {
+	char *p = f->buf[i], *nl;
+	size_t left = f->len[i];
+	while (left > 0 && ((nl = memchr(p, '\n', left)) != NULL || end)) {
+		size_t n = (nl != NULL) ? (size_t) (nl - p) + 1 : left;
+		fprint(i + 1, "%s: ", host);
+		writeall(i + 1, p, n);
+		if (nl == NULL)
+			writeall(i + 1, "\n", 1);
+		p += n;
+		left -= n;
+	}
+	memmove(f->buf[i], p, left);
+	f->len[i] = left;
+}
+
+static void fanstart(Fan *f, Conn *c, int forward_agent, char **av, bool shipenv) {
+	char *sshcmd[64];
+	int out[2], err[2];
+	cpuargv(sshcmd, c, forward_agent, cpucmd(c, av, shipenv));
+	if (rc_pipe(out) < 0 || rc_pipe(err) < 0) {
+		uerror("pipe");
+		rc_error(NULL);
+	}
+	if ((f->pid = rc_fork()) == 0) {
+		setsigdefaults(FALSE);
+		mvfd(rc_open("/dev/null", rFrom), 0);
+		mvfd(out[1], 1);
+		mvfd(err[1], 2);
+		distexec(sshcmd);
+		uerror(sshcmd[0]);
+		_exit(127);
+	}
+	close(out[1]);
+	close(err[1]);
+	f->fd[0] = out[0];
+	f->fd[1] = err[0];
+}
+
+/* read what f's fd j has; the result is read()'s */
+static ssize_t fanread(Fan *f, char *host, int j, bool buffered) {
+	ssize_t r;
+	if (f->len[j] + 4096 > f->size[j])
+		f->buf[j] = erealloc(f->buf[j], f->size[j] = 2 * f->len[j] + 4096);
+	if ((r = read(f->fd[j], f->buf[j] + f->len[j], f->size[j] - f->len[j])) > 0) {
+		f->len[j] += r;
+		if (!buffered)
+			fanflush(f, host, j, FALSE);
+	}
+	return r;
+}
+
+/* stop watching f's fd j; TRUE if that was the last of f */
+static bool fanclose(Fan *f, char *host, int j, bool buffered) {
+	close(f->fd[j]);
+	f->fd[j] = -1;
+	if (!buffered)
+		fanflush(f, host, j, TRUE);
+	if (f->fd[1 - j] >= 0)
+		return FALSE;
+	f->done = TRUE;
+	return TRUE;
+}
+
+static void cpufan(char **hosts, int n, int max, bool buffered, char *user, int forward_agent, char **av, bool shipenv) {
+	Fan *fan = nalloc(n * sizeof *fan);
+	Conn **cs = nalloc(n * sizeof *cs);
+	struct pollfd *pfd = nalloc(2 * n * sizeof *pfd);
+	int *who = nalloc(2 * n * sizeof *who);
+	pid_t *pids = nalloc(n * sizeof *pids);
+	int *stats = nalloc(n * sizeof *stats);
+	double *cpus = nalloc(n * sizeof *cpus);
+	int i, j, np, next = 0, running = 0, printed = 0;
+	ssize_t r;
+	Fan *f;
+
+	memzero(fan, n * sizeof *fan);
+	while (next < n || running > 0) {
+		for (; next < n && (max == 0 || running < max); next++, running++)
+			fanstart(&fan[next], cs[next] = cpuconn(hosts[next], user), forward_agent, av, shipenv);
+		for (i = np = 0; i < next; i++)
+			for (j = 0; j < 2; j++)
+				if (fan[i].fd[j] >= 0 && !fan[i].done) {
+					pfd[np].fd = fan[i].fd[j];
+					pfd[np].events = POLLIN;
+					who[np++] = 2 * i + j;
+				}
+		if (poll(pfd, np, FAN_REAP) < 0) {
+			if (errno == EINTR) {
+				sigchk();
+				continue;
+			}
+			uerror("poll");
+			break;
+		}
+		for (i = 0; i < np; i++) {
+			if (pfd[i].revents == 0)
+				continue;
+			f = &fan[who[i] / 2];
+			j = who[i] % 2;
+			if (f->fd[j] < 0)
+				continue;
+			if ((r = fanread(f, hosts[who[i] / 2], j, buffered)) > 0 || (r < 0 && errno == EINTR))
+				continue;
+			if (fanclose(f, hosts[who[i] / 2], j, buffered))
+				running--;
+		}
+		/*
+		   A host is done once its ssh is, even if something it left
+		   running holds the pipes open: what is in them is read, and
+		   the rest let go.
+		*/
+		for (i = 0; i < next; i++) {
+			f = &fan[i];
+			if (f->done || !rc_exited(f->pid))
+				continue;
+			for (j = 0; j < 2; j++) {
+				if (f->fd[j] < 0)
+					continue;
+				fcntl(f->fd[j], F_SETFL, fcntl(f->fd[j], F_GETFL) | O_NONBLOCK);
+				while ((r = fanread(f, hosts[i], j, buffered)) > 0 || (r < 0 && errno == EINTR))
+					;
+				if (fanclose(f, hosts[i], j, buffered))
+					running--;
+			}
+		}
+		for (; buffered && printed < next && fan[printed].done; printed++) {
+			fanflush(&fan[printed], hosts[printed], 0, TRUE);
+			fanflush(&fan[printed], hosts[printed], 1, TRUE);
+		}
+	}
+	for (i = 0; i < next; i++) {
+		for (j = 0; j < 2; j++) {
+			if (fan[i].fd[j] >= 0)
+				close(fan[i].fd[j]);
+			efree(fan[i].buf[j]);
+		}
+		pids[i] = fan[i].pid;
+	}
+	rc_waitall(pids, stats, cpus, next);
+	setpipestatuslength(next);
+	for (i = 0; i < next; i++) {
+		cpudone(cs[i], stats[i]);
+		setpipestatus(next - i - 1, -1, stats[i], cpus[i]);
+	}
+	sigchk();
+}
+
 extern void b_cpu(char **av) {
-	char *host = NULL, *user = NULL;
+	char *user = NULL, **hosts;
 	int forward_agent = 0;
 	char *sshcmd[64];
-	int argc = 0;
-	int stat;
+	int stat, nhosts = 0, max = jobmax;
+	bool buffered = FALSE;
 	List *s;
+	bool shipenv = FALSE;
+	Conn *c;
 	char *remote_cmd;
-	char envbuf[8192];
-	int envlen = 0;
 
+	for (stat = 0; av[stat] != NULL; stat++)
+		; /* no more hosts than arguments */
+	hosts = nalloc(stat * sizeof *hosts);
 	for (++av; *av != NULL && **av == '-'; av++) {
 		char *f = *av + 1;
 		switch (*f) {
 		case 'h':
 			if (f[1] != '\0')
-				host = f + 1;
+				hosts[nhosts++] = f + 1;
 			else if (*++av != NULL)
-				host = *av;
+				hosts[nhosts++] = *av;
 			else {
 				fprint(2, RC "cpu: -h requires argument\n");
 				set(FALSE);
 				return;
 			}
 			break;
+		case 'j':
+			max = (f[1] != '\0') ? a2u(f + 1) : (*++av != NULL) ? a2u(*av) : -1;
+			if (max < 1) {
+				fprint(2, RC "cpu: -j requires a positive number\n");
+				set(FALSE);
+				return;
+			}
+			break;
+		case 'B':
+			buffered = TRUE;
+			break;
+		case 'E':
+			shipenv = TRUE;
+			break;
 		case 'u':
 			if (f[1] != '\0')
 				user = f + 1;
@@ -616,83 +1443,39 @@ extern void b_cpu(char **av) {
 		}
 	}
 
-	/* host from argument or $cpu variable */
-	if (host == NULL) {
+	/* hosts from arguments or $cpu variable */
+	if (nhosts == 0) {
 		s = varlookup("cpu");
-		if (s != NULL)
-			host = s->w;
+		if (s != NULL) {
+			hosts = nalloc(listnel(s) * sizeof *hosts);
+			for (; s != NULL; s = s->n)
+				hosts[nhosts++] = s->w;
+		}
 	}
-	if (host == NULL) {
+	if (nhosts == 0) {
 		fprint(2, RC "cpu: no host specified (use -h or set $cpu)\n");
 		set(FALSE);
 		return;
 	}
 
 	if (*av == NULL) {
-		fprint(2, RC "usage: cpu [-h host] [-u user] [-A] cmd [args...]\n");
+		fprint(2, RC "usage: cpu [-h host ...] [-j max] [-B] [-E] [-u user] [-A] cmd [args...]\n");
 		set(FALSE);
 		return;
 	}
-
-	/* build the remote command with environment export */
-	envlen = 0;
-
-	/* export $path as PATH */
-	s = varlookup("path");
-	if (s != NULL) {
-		envlen += snprintf(envbuf + envlen, sizeof(envbuf) - envlen,
-				   "PATH=");
-		while (s != NULL) {
-			envlen += snprintf(envbuf + envlen, sizeof(envbuf) - envlen,
-					   "%s%s", s->w, s->n ? ":" : "");
-			s = s->n;
-		}
-		envlen += snprintf(envbuf + envlen, sizeof(envbuf) - envlen, "; ");
-	}
-
-	/* build the actual command string */
-	{
-		char cmdbuf[4096];
-		int cmdlen = 0;
-		char **p;
-
-		/* prepend environment */
-		cmdlen = snprintf(cmdbuf, sizeof(cmdbuf), "%s", envbuf);
-
-		/* append the command and args */
-		for (p = av; *p != NULL; p++) {
-			if (p != av)
-				cmdlen += snprintf(cmdbuf + cmdlen,
-						   sizeof(cmdbuf) - cmdlen, " ");
-			/* quote args with spaces */
-			if (strchr(*p, ' ') != NULL || strchr(*p, '\t') != NULL)
-				cmdlen += snprintf(cmdbuf + cmdlen,
-						   sizeof(cmdbuf) - cmdlen,
-						   "'%s'", *p);
-			else
-				cmdlen += snprintf(cmdbuf + cmdlen,
-						   sizeof(cmdbuf) - cmdlen,
-						   "%s", *p);
-		}
-		remote_cmd = nalloc(cmdlen + 1);
-		strcpy(remote_cmd, cmdbuf);
+	if (!cpusockdir()) {
+		set(FALSE);
+		return;
 	}
 
-	/* build ssh command */
-	argc = 0;
-	sshcmd[argc++] = "ssh";
-	if (forward_agent)
-		sshcmd[argc++] = "-A";
-	sshcmd[argc++] = "-o";
-	sshcmd[argc++] = "BatchMode=yes";
-	if (user != NULL) {
-		sshcmd[argc++] = "-l";
-		sshcmd[argc++] = user;
+	if (nhosts > 1) {
+		cpufan(hosts, nhosts, max, buffered, user, forward_agent, av, shipenv);
+		return;
 	}
-	sshcmd[argc++] = host;
-	sshcmd[argc++] = remote_cmd;
-	sshcmd[argc] = NULL;
 
+	c = cpuconn(hosts[0], user);
+	remote_cmd = cpucmd(c, av, shipenv);
+	cpuargv(sshcmd, c, forward_agent, remote_cmd);
 	if (dashex) {
 		int i;
 		fprint(2, "cpu:");
@@ -702,6 +1485,7 @@ extern void b_cpu(char **av) {
 	}
 
 	stat = run_cmd(sshcmd);
+	cpudone(c, stat);
 	setstatus(-1, stat);
 	sigchk();
 }
@@ -776,7 +1560,7 @@ extern void b_import(char **av) {
 	if (WIFEXITED(stat) && WEXITSTATUS(stat) == 0) {
 		char *cfrom = cleanpath(addr);
 		char *cto = cleanpath(mp);
-		add_bind(cfrom, cto, mode);
+		add_bind(cfrom, cto, mode | BIND_MOUNT);
 		efree(cfrom);
 		efree(cto);
 		set(TRUE);
@@ -794,7 +1578,7 @@ extern void b_import(char **av) {
 	if (WIFEXITED(stat) && WEXITSTATUS(stat) == 0) {
 		char *cfrom = cleanpath(addr);
 		char *cto = cleanpath(mp);
-		add_bind(cfrom, cto, mode);
+		add_bind(cfrom, cto, mode | BIND_MOUNT);
 		efree(cfrom);
 		efree(cto);
 		set(TRUE);
@@ -805,32 +1589,342 @@ extern void b_import(char **av) {
 	set(FALSE);
 }
 
-/* ========== srv [-r] [name [cmd [args...]]] ========== */
+/* ========== srv [-r] [-s [-p n]] [-c] [name [cmd [args...]]] ========== */
 
 /*
    Post or list named services, inspired by Plan 9's /srv.
-   Services are named pipes (FIFOs) in a well-known directory
-   that allow processes to rendezvous.
+   Services are named pipes (FIFOs) or Unix sockets in a well-known
+   directory that allow processes to rendezvous.
 
-   srv              - list all services (scans srv directory)
-   srv name         - open/connect to named service
-   srv name cmd ... - create service running cmd, post as name
-   srv -r name      - remove a service
+   srv                    - list all services
+   srv name               - open/connect to named service
+   srv name cmd ...       - create service running cmd, post as name
+   srv -s name cmd ...    - serve cmd on a socket, once per connection
+   srv -s -p n name cmd   - the same, from a pool of n workers
+   srv -c name            - talk to a socket service over stdin/stdout
+   srv -r name            - remove a service
 
    State is on the filesystem (SRV_DIR), not in memory, so services
-   persist across redirections and subshells.
+   persist across redirections and subshells, and other shells see
+   them. The directory is mirrored in a table sorted by name, which is
+   read afresh only when the directory has changed.
+
+   A socket service is a process of its own, listening on the socket.
+   Without -p it forks for each connection, as inetd does. With -p it
+   forks n workers once, all blocking in accept() on the one socket,
+   and the kernel hands each connection to one of them. A worker runs
+   cmd with the connection as its stdin and stdout and then takes the
+   next. If cmd is an rc function it runs in the worker itself, so a
+   connection costs neither a fork nor an exec. A worker that exits
+   (an rc error in it does that too) is replaced. The service and its
+   workers are a process group, which srv -r kills.
 */
 
+#define SRV_RACY 2	/* a directory this recently changed may change again and not show it */
+
+static Srv *srvtab = NULL;
+static int nsrv = 0, srvalloc = 0;
+static time_t srvmtime = -1;
+
+static int srvcmp(const void *a, const void *b) {
+	return strcmp(((const Srv *) a)->name, ((const Srv *) b)->name);
+}
+
+/* the index of name in srvtab, or -1 less the index it would go at */
+static int srvindex(const char *name) {
+	int lo = 0, hi = nsrv - 1, mid, cmp;
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if ((cmp = strcmp(name, srvtab[mid].name)) == 0)
+			return mid;
+		if (cmp < 0)
+			hi = mid - 1;
+		else
+			lo = mid + 1;
+	}
+	return -lo - 1;
+}
+
+static Srv *srvfind(const char *name) {
+	int i = srvindex(name);
+	return (i >= 0) ? &srvtab[i] : NULL;
+}
+
+/* make room for an entry at i */
+static Srv *srvslot(int i, const char *name) {
+	if (nsrv == srvalloc)
+		srvtab = erealloc(srvtab, (srvalloc = 2 * srvalloc + 16) * sizeof *srvtab);
+	memmove(&srvtab[i + 1], &srvtab[i], (nsrv - i) * sizeof *srvtab);
+	nsrv++;
+	srvtab[i].name = ecpy(name);
+	srvtab[i].path = mprint("%s/%s", SRV_DIR, name);
+	return &srvtab[i];
+}
+
+/* enter name in the table, or update it */
+static void srventer(const char *name, int type, pid_t pid) {
+	int i = srvindex(name);
+	Srv *s = (i >= 0) ? &srvtab[i] : srvslot(-i - 1, name);
+	s->type = type;
+	s->pid = pid;
+	srvmtime = -1; /* the directory has changed under us */
+	nsdirty = TRUE;
+}
+
+static void srvdelete(const char *name) {
+	int i = srvindex(name);
+	if (i < 0)
+		return;
+	efree(srvtab[i].name);
+	efree(srvtab[i].path);
+	memmove(&srvtab[i], &srvtab[i + 1], (--nsrv - i) * sizeof *srvtab);
+	srvmtime = -1;
+	nsdirty = TRUE;
+}
+
+/* bring the table up to date with the directory */
+static void srvsync(void) {
+	struct stat st, dst;
+	struct dirent *ent;
+	Srv *old, *s;
+	int nold, i;
+	DIR *d;
+
+	if (stat(SRV_DIR, &dst) < 0 || (d = opendir(SRV_DIR)) == NULL) {
+		dst.st_mtime = -1;
+		d = NULL;
+	} else if (dst.st_mtime == srvmtime && dst.st_mtime + SRV_RACY <= time(NULL)) {
+		closedir(d);
+		return;
+	}
+	old = srvtab;
+	nold = nsrv;
+	srvtab = NULL;
+	nsrv = srvalloc = 0;
+	while (d != NULL && (ent = readdir(d)) != NULL) {
+		if (ent->d_name[0] == '.')
+			continue;
+		if (nsrv == srvalloc)
+			srvtab = erealloc(srvtab, (srvalloc = 2 * srvalloc + 16) * sizeof *srvtab);
+		s = &srvtab[nsrv];
+		s->path = mprint("%s/%s", SRV_DIR, ent->d_name);
+		if (stat(s->path, &st) != 0) {
+			efree(s->path);
+			continue;
+		}
+		s->name = ecpy(ent->d_name);
+		s->type = S_ISFIFO(st.st_mode) ? SRV_FIFO : S_ISSOCK(st.st_mode) ? SRV_SOCK : SRV_FILE;
+		s->pid = 0;
+		nsrv++;
+	}
+	if (d != NULL)
+		closedir(d);
+	qsort(srvtab, nsrv, sizeof *srvtab, srvcmp);
+	for (i = 0; i < nold; i++) {
+		/* keep track of the services this shell started */
+		if ((s = srvfind(old[i].name)) != NULL && s->type == old[i].type)
+			s->pid = old[i].pid;
+		efree(old[i].name);
+		efree(old[i].path);
+	}
+	efree(old);
+	srvmtime = dst.st_mtime;
+	nsdirty = TRUE;
+}
+
+static int srvsocket(char *path, struct sockaddr_un *sa) {
+	if (strlen(path) >= sizeof sa->sun_path) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	memzero(sa, sizeof *sa);
+	sa->sun_family = AF_UNIX;
+	strcpy(sa->sun_path, path);
+	return socket(AF_UNIX, SOCK_STREAM, 0);
+}
+
+/* a socket listening at path */
+static int srvlisten(char *path) {
+	struct sockaddr_un sa;
+	int fd, e;
+	if ((fd = srvsocket(path, &sa)) < 0)
+		return -1;
+	unlink(path); /* remove old one if exists */
+	if (bind(fd, (struct sockaddr *) &sa, sizeof sa) < 0 || listen(fd, SOMAXCONN) < 0) {
+		e = errno;
+		close(fd);
+		errno = e;
+		return -1;
+	}
+	fcntl(fd, F_SETFD, FD_CLOEXEC); /* not for the commands run */
+	return fd;
+}
+
+static int srvdial(char *path) {
+	struct sockaddr_un sa;
+	int fd, e;
+	if ((fd = srvsocket(path, &sa)) < 0)
+		return -1;
+	if (connect(fd, (struct sockaddr *) &sa, sizeof sa) < 0) {
+		e = errno;
+		close(fd);
+		errno = e;
+		return -1;
+	}
+	return fd;
+}
+
+/* run av with connection fd as its stdin and stdout */
+static void srvconn(int fd, char **av) {
+	Edata block;
+	Estack e;
+	pid_t pid;
+	int stat, nul;
+
+	flushout();
+	dup2(fd, 0);
+	dup2(fd, 1);
+	if (fd > 1)
+		close(fd);
+	block.b = newblock();
+	except(eArena, block, &e);
+	if (fnlookup(*av) != NULL) {
+		funcall(av);
+	} else if ((pid = rc_fork()) == 0) {
+		distexec(av);
+		uerror(*av);
+		_exit(127);
+	} else {
+		rc_wait4(pid, &stat, TRUE);
+		setstatus(-1, stat);
+	}
+	unexcept(eArena);
+	/* let go of the connection, so that the client sees its end */
+	flushout();
+	if ((nul = open("/dev/null", O_RDWR)) >= 0) {
+		dup2(nul, 0);
+		dup2(nul, 1);
+		if (nul > 1)
+			close(nul);
+	}
+}
+
+/* take connections on lfd for ever */
+static void srvworker(int lfd, char **av) {
+	int fd;
+	while (1) {
+		if ((fd = accept(lfd, NULL, NULL)) < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			uerror("accept");
+			exit(1);
+		}
+		srvconn(fd, av);
+	}
+}
+
+/*
+   The service process. Its children are forked with fork() rather
+   than rc_fork(): it never waits for them through rc, so there is
+   nothing for rc to keep track of.
+*/
+
+static void srvserve(int lfd, int pool, char **av) {
+	pid_t pid;
+	time_t started;
+	int fd, n;
+
+	mvfd(rc_open("/dev/null", rFrom), 0);
+	if (pool == 0) {
+		while (1) {
+			while (waitpid(-1, NULL, WNOHANG) > 0)
+				;
+			if ((fd = accept(lfd, NULL, NULL)) < 0) {
+				if (errno == EINTR || errno == ECONNABORTED)
+					continue;
+				uerror("accept");
+				exit(1);
+			}
+			if ((pid = fork()) == 0) {
+				close(lfd);
+				srvconn(fd, av);
+				exit(getstatus());
+			}
+			close(fd);
+		}
+	}
+	for (n = 0; ; n--) {
+		for (started = time(NULL); n < pool; n++)
+			if ((pid = fork()) == 0)
+				srvworker(lfd, av);
+			else if (pid < 0)
+				break;
+		if (waitpid(-1, NULL, 0) < 0 && errno == ECHILD)
+			exit(1);
+		if (time(NULL) == started)
+			sleep(1); /* don't spin on a worker that dies at once */
+	}
+}
+
+/* pass stdin to connection fd, and what comes back to stdout */
+static void srvrelay(int fd) {
+	struct pollfd p[2];
+	char buf[8192];
+	ssize_t n;
+	bool in = TRUE;
+
+	while (1) {
+		p[0].fd = in ? 0 : -1;
+		p[0].events = POLLIN;
+		p[1].fd = fd;
+		p[1].events = POLLIN;
+		if (poll(p, 2, -1) < 0) {
+			if (errno == EINTR) {
+				sigchk();
+				continue;
+			}
+			uerror("poll");
+			break;
+		}
+		if (p[0].revents != 0) {
+			if ((n = read(0, buf, sizeof buf)) > 0) {
+				writeall(fd, buf, n);
+			} else if (n == 0 || errno != EINTR) {
+				in = FALSE;
+				shutdown(fd, SHUT_WR);
+			}
+		}
+		if (p[1].revents != 0) {
+			if ((n = read(fd, buf, sizeof buf)) > 0)
+				writeall(1, buf, n);
+			else if (n == 0 || errno != EINTR)
+				break;
+		}
+	}
+}
+
 extern void b_srv(char **av) {
-	int remove = 0;
-	char *name;
-	char srvpath[4096];
+	int remove = 0, sock = 0, dial = 0, pool = 0;
+	char *name, *srvpath;
+	Srv *s;
 
 	for (++av; *av != NULL && **av == '-'; av++) {
 		char *f = *av + 1;
 		while (*f) {
 			switch (*f++) {
 			case 'r': remove = 1; break;
+			case 's': sock = 1; break;
+			case 'c': dial = 1; break;
+			case 'p':
+				pool = (*f != '\0') ? a2u(f) : (av[1] != NULL) ? a2u(*++av) : -1;
+				if (pool < 1) {
+					fprint(2, RC "srv: -p requires a positive number\n");
+					set(FALSE);
+					return;
+				}
+				f += strlen(f);
+				sock = 1;
+				break;
 			default:
 				fprint(2, RC "srv: unknown flag -%c\n", f[-1]);
 				set(FALSE);
@@ -840,76 +1934,72 @@ extern void b_srv(char **av) {
 	}
 
 	ensure_srvdir();
+	srvsync();
 
-	/* list services by scanning the srv directory */
-	if (*av == NULL && !remove) {
-		DIR *d;
-		struct dirent *ent;
-		int found = 0;
-
-		d = opendir(SRV_DIR);
-		if (d != NULL) {
-			while ((ent = readdir(d)) != NULL) {
-				struct stat st;
-				if (ent->d_name[0] == '.')
-					continue;
-				snprintf(srvpath, sizeof(srvpath), "%s/%s",
-					 SRV_DIR, ent->d_name);
-				if (stat(srvpath, &st) == 0) {
-					char *type;
-					if (S_ISFIFO(st.st_mode))
-						type = "fifo";
-					else if (S_ISSOCK(st.st_mode))
-						type = "sock";
-					else
-						type = "file";
-					fprint(1, "%s\t%s\t(%s)\n",
-					       ent->d_name, srvpath, type);
-					found = 1;
-				}
-			}
-			closedir(d);
-		}
-		if (!found)
+	/* list services */
+	if (*av == NULL && !remove && !sock && !dial) {
+		int i;
+		static char *types[] = { "file", "fifo", "sock" };
+		for (i = 0; i < nsrv; i++)
+			fprint(1, "%s\t%s\t(%s)\n", srvtab[i].name, srvtab[i].path, types[srvtab[i].type]);
+		if (nsrv == 0)
 			fprint(1, "# no services (srv dir: %s)\n", SRV_DIR);
 		set(TRUE);
 		return;
 	}
 
-	if (*av == NULL) {
-		fprint(2, RC "usage: srv [-r] [name [cmd ...]]\n");
+	if (*av == NULL || (sock && av[1] == NULL) || ((dial || remove) && av[1] != NULL)) {
+		fprint(2, RC "usage: srv [-r] [name [cmd ...]] | srv -s [-p n] name cmd ... | srv -c name\n");
 		set(FALSE);
 		return;
 	}
 
 	name = *av++;
-
-	snprintf(srvpath, sizeof(srvpath), "%s/%s", SRV_DIR, name);
+	if (*name == '\0' || strchr(name, '/') != NULL) {
+		fprint(2, RC "srv: bad service name `%s'\n", name);
+		set(FALSE);
+		return;
+	}
+	s = srvfind(name);
+	srvpath = nprint("%s/%s", SRV_DIR, name);
 
 	/* remove a service */
 	if (remove) {
-		struct stat st;
-		if (stat(srvpath, &st) != 0) {
+		if (s == NULL) {
 			fprint(2, RC "srv: %s: not found\n", name);
 			set(FALSE);
 			return;
 		}
+		if (s->type == SRV_SOCK && s->pid > 0)
+			kill(-s->pid, SIGTERM); /* the service and its workers */
 		unlink(srvpath);
+		srvdelete(name);
 		if (dashex)
 			fprint(2, "srv: removed %s\n", name);
 		set(TRUE);
 		return;
 	}
 
+	/* talk to a socket service */
+	if (dial) {
+		int fd;
+		if ((fd = srvdial(srvpath)) < 0) {
+			fprint(2, RC "srv: %s: %s\n", name, strerror(errno));
+			set(FALSE);
+			return;
+		}
+		srvrelay(fd);
+		close(fd);
+		set(TRUE);
+		return;
+	}
+
 	/* connect to existing service */
 	if (*av == NULL) {
-		struct stat st;
-		if (stat(srvpath, &st) == 0) {
+		if (s != NULL) {
 			/* export the service path as $srv_<name> */
-			char varname[256];
-			snprintf(varname, sizeof(varname), "srv_%s", name);
-			varassign(varname, word(srvpath, NULL), FALSE);
-			fprint(1, "%s\n", srvpath);
+			varassign(nprint("srv_%s", name), word(s->path, NULL), FALSE);
+			fprint(1, "%s\n", s->path);
 			set(TRUE);
 		} else {
 			fprint(2, RC "srv: %s: not found\n", name);
@@ -918,6 +2008,30 @@ extern void b_srv(char **av) {
 		return;
 	}
 
+	/* serve cmd on a socket */
+	if (sock) {
+		int lfd;
+		pid_t pid;
+		if ((lfd = srvlisten(srvpath)) < 0) {
+			fprint(2, RC "srv: cannot create %s: %s\n", srvpath, strerror(errno));
+			set(FALSE);
+			return;
+		}
+		if ((pid = rc_fork()) == 0) {
+			setsigdefaults(FALSE);
+			setpgid(0, 0);
+			srvserve(lfd, pool, av);
+		}
+		setpgid(pid, pid);
+		close(lfd);
+		srventer(name, SRV_SOCK, pid);
+		if (dashex)
+			fprint(2, "srv: %s -> %s (pid %d)\n", name, srvpath, pid);
+		varassign("apid", word(nprint("%d", pid), NULL), FALSE);
+		set(TRUE);
+		return;
+	}
+
 	/* create new service: make FIFO and run command */
 
 	/* create FIFO */
@@ -940,7 +2054,7 @@ extern void b_srv(char **av) {
 			if (fd != 0) { dup2(fd, 0); }
 			if (fd != 1) { dup2(fd, 1); }
 			if (fd > 1) close(fd);
-			execvp(*av, av);
+			distexec(av);
 			uerror(*av);
 			_exit(127);
 		}
@@ -951,6 +2065,7 @@ extern void b_srv(char **av) {
 			return;
 		}
 
+		srventer(name, SRV_FIFO, pid);
 		if (dashex)
 			fprint(2, "srv: %s -> %s (pid %d)\n", name, srvpath, pid);
 
@@ -959,6 +2074,59 @@ extern void b_srv(char **av) {
 	}
 }
 
+/* ========== File descriptor groups ========== */
+
+/* close the descriptors from lo to hi */
+static void closerange(int lo, int hi) {
+	struct dirent *ent;
+	int *fds = NULL, nfds = 0, room = 0, fd, i;
+	DIR *d;
+#if defined(__linux__) && defined(SYS_close_range)
+	if (syscall(SYS_close_range, (unsigned) lo, hi == INT_MAX ? ~0U : (unsigned) hi, 0) == 0)
+		return;
+#endif
+	if ((d = opendir("/proc/self/fd")) != NULL) {
+		/* the ones that are open, noted first, since closing them changes the directory */
+		while ((ent = readdir(d)) != NULL)
+			if ((fd = a2u(ent->d_name)) >= lo && fd <= hi && fd != dirfd(d)) {
+				if (nfds == room)
+					fds = erealloc(fds, (room = 2 * room + 16) * sizeof *fds);
+				fds[nfds++] = fd;
+			}
+		closedir(d);
+		for (i = 0; i < nfds; i++)
+			close(fds[i]);
+		efree(fds);
+		return;
+	}
+	if ((fd = sysconf(_SC_OPEN_MAX)) > 0 && fd - 1 < hi)
+		hi = fd - 1;
+	for (fd = lo; fd <= hi; fd++)
+		close(fd);
+}
+
+/*
+   Close every descriptor above 2 but the scripts rc is reading (and
+   its signal pipe), with a call for each gap between those.
+*/
+
+static void newfdgroup(void) {
+	int keep[64], nkeep, lo, i, j, k;
+	nkeep = inputfds(keep, arraysize(keep) - 2);
+	nkeep += sigfds(keep + nkeep);
+	for (i = 1; i < nkeep; i++)
+		for (j = i; j > 0 && keep[j - 1] > keep[j]; j--) {
+			k = keep[j];
+			keep[j] = keep[j - 1];
+			keep[j - 1] = k;
+		}
+	for (lo = 3, i = 0; i < nkeep; lo = keep[i++] + 1)
+		if (keep[i] > lo)
+			closerange(lo, keep[i] - 1);
+	closerange(lo, INT_MAX);
+	histclose();
+}
+
 /* ========== rfork [cCeEnNsfF] ========== */
 
 /*
@@ -970,17 +2138,25 @@ extern void b_srv(char **av) {
    Flags:
      c - new cgroup/namespace (mount namespace, Linux only)
      C - copy namespace (no-op on Unix, already default)
-     e - new environment (clear all env vars)
+     e - new environment (drop what rc did not import; default $path)
      E - copy environment (no-op on Unix, already default)
      n - new namespace group (mount namespace via unshare)
      N - copy namespace group (no-op on Unix)
      s - new process group (setpgid)
-     f - new fd group (close non-std fds)
+     f - new fd group (close all fds above 2 but rc's scripts)
      F - copy fd group (no-op on Unix, already default)
 
    Without arguments, rfork creates a new process group.
 */
 
+/* the $path a new rc starts with */
+static char *defpath[] = {
+#ifdef DEFAULTPATH
+	DEFAULTPATH,
+#endif
+	NULL
+};
+
 extern void b_rfork(char **av) {
 	int flags = 0;
 	char *f;
@@ -1036,6 +2212,9 @@ extern void b_rfork(char **av) {
 			set(FALSE);
 			return;
 		}
+		/* binds from now on must not leak back to the old namespace */
+		nskernel = (mount(NULL, "/", NULL, MS_REC | MS_PRIVATE, NULL) == 0);
+		nsdirty = TRUE;
 	}
 #else
 	if (flags & RFNAMEG) {
@@ -1045,26 +2224,24 @@ extern void b_rfork(char **av) {
 	}
 #endif
 
-	/* clear environment */
+	/* clear environment: what rc did not import, and $path */
 	if (flags & RFENVG) {
 		extern char **environ;
-		static char *empty_env[] = { NULL };
-		List *defpath;
-		environ = empty_env;
-		/* also reset rc's internal path */
-		defpath = append(word("/usr/local/bin", NULL),
-			  append(word("/usr/bin", NULL),
-			  word("/bin", NULL)));
-		varassign("path", defpath, FALSE);
+		List *path = NULL, **tail = &path;
+		char **p;
+		clearbozo();
+		for (p = defpath; *p != NULL; p++) {
+			*tail = word(*p, NULL);
+			tail = &(*tail)->n;
+		}
+		varassign("path", path, FALSE);
 		alias("path", varlookup("path"), FALSE);
+		environ = makeenv();
 	}
 
 	/* close non-standard file descriptors */
-	if (flags & RFFDG) {
-		int fd;
-		for (fd = 3; fd < 256; fd++)
-			close(fd);
-	}
+	if (flags & RFFDG)
+		newfdgroup();
 
 	set(TRUE);
 }
@@ -1095,29 +2272,67 @@ extern void b_addns(char **av) {
 /* ========== Namespace Resolution ========== */
 
 /*
-   Resolve a path through the bind table. Used internally
-   to translate paths through the shell's namespace.
+   Resolve a path through the bind table: the union at the longest
+   mountpoint that is a prefix of path, found by walking the trie one
+   component at a time. ns_try() gives the i'th place to look for
+   path, in union order, or NULL when there are no more; a path under
+   no mountpoint is its own only place. Relative paths are not
+   resolved. The result is in a buffer reused by the next call.
 */
 
-extern char *ns_resolve(char *path) {
-	unsigned int h;
+extern char *ns_try(char *path, int i) {
+	static char *buf = NULL;
+	static size_t buflen = 0;
+	Nsnode *node = &nsroot, *best = NULL, *k;
+	char *p = path, *q, *rest = NULL, *dir;
+	size_t len, need;
 	Bind *b;
-	char *clean;
-
-	if (path == NULL)
-		return NULL;
-
-	clean = cleanpath(path);
-	h = pathhash(clean);
 
-	for (b = bindtab[h]; b != NULL; b = b->n) {
-		if (streq(b->to, clean)) {
-			efree(clean);
-			return b->from;
+	if (nbinds == 0 || *path != '/')
+		return (i == 0) ? path : NULL;
+	for (;;) {
+		while (*p == '/')
+			p++;
+		if (node->binds != NULL) {
+			best = node;
+			rest = p;
 		}
+		if (*p == '\0')
+			break;
+		if ((q = strchr(p, '/')) == NULL)
+			q = p + strlen(p);
+		len = q - p;
+		for (k = node->kids; k != NULL; k = k->sib)
+			if (strncmp(k->name, p, len) == 0 && k->name[len] == '\0')
+				break;
+		if (k == NULL)
+			break;
+		node = k;
+		p = q;
+	}
+	if (best == NULL || (best->binds->mode & BIND_KERNEL))
+		return (i == 0) ? path : NULL;
+	for (b = best->binds; b != NULL && i > 0; b = b->n)
+		i--;
+	if (b == NULL)
+		return NULL;
+	dir = (b->mode & BIND_MOUNT) ? b->to : b->from;
+	need = strlen(dir) + strlen(rest) + 2;
+	if (need > buflen)
+		buf = erealloc(buf, buflen = need);
+	strcpy(buf, dir);
+	if (*rest != '\0') {
+		if (!streq(dir, "/")) /* "//" is special to POSIX */
+			strcat(buf, "/");
+		strcat(buf, rest);
 	}
-	efree(clean);
-	return path; /* no binding, return original */
+	return buf;
+}
+
+extern char *ns_resolve(char *path) {
+	if (path == NULL)
+		return NULL;
+	return ns_try(path, 0);
 }
 
 extern Bind *ns_lookup(char *mountpoint) {
@@ -1128,27 +2343,157 @@ extern int ns_count(void) {
 	return nbinds;
 }
 
+/* ========== Namespace snapshots ========== */
+
+/*
+   The bind table and the service table go to child shells whole, in
+   $ns, which is brought up to date when the environment is made (so
+   that a local ns=() does not hide them), and which a new rc loads in
+   one step, without running a bind for each entry. It is a list:
+
+	rcns1 kernel srvmtime nbind (mode from to)... nsrv (type name)...
+
+   kernel is the inode of the mount namespace that rfork n made, or 0.
+   Entries made with mount(2) are kept only by a shell in that same
+   namespace; elsewhere, as on the far side of a cpu -E, the kernel
+   does not have them. The services are a copy of the directory as of
+   srvmtime, and are read afresh if it has changed since; a child does
+   not own any of them.
+*/
+
+#define NSMAGIC "rcns1"
+
+static List *nsword(char *w, List *n) {
+	List *l = word(w, NULL);
+	l->n = n;
+	return l;
+}
+
+/* last sibling first, since find_node() puts each new one at the front */
+static List **ns_save(Nsnode *node, List **tail) {
+	Bind *b;
+	if (node == NULL)
+		return tail;
+	tail = ns_save(node->sib, tail);
+	for (b = node->binds; b != NULL; b = b->n) {
+		*tail = nsword(nprint("%d", b->mode), nsword(b->from, nsword(b->to, NULL)));
+		tail = &(*tail)->n->n->n;
+	}
+	return ns_save(node->kids, tail);
+}
+
+static unsigned long mntns(void) {
+	struct stat st;
+	return stat("/proc/self/ns/mnt", &st) == 0 ? (unsigned long) st.st_ino : 0;
+}
+
+/* called by makeenv() */
+extern void ns_export(void) {
+	List *top = NULL, **tail = &top;
+	unsigned long kernel = 0;
+	int i;
+	if (!nsdirty && varlookup("ns") == nsdef)
+		return; /* as it was left, or as a local assignment of it found it */
+	nsdirty = FALSE;
+	if (nbinds == 0 && nsrv == 0) {
+		if (varlookup("ns") != NULL)
+			varrm("ns", FALSE);
+		nsdef = NULL;
+		return;
+	}
+#ifdef __linux__
+	if (nskernel)
+		kernel = mntns();
+#endif
+	*tail = nsword(NSMAGIC, nsword(nprint("%ld", (long) kernel), nsword(nprint("%ld", (long) srvmtime), NULL)));
+	tail = &(*tail)->n->n->n;
+	*tail = nsword(nprint("%d", nbinds), NULL);
+	tail = ns_save(&nsroot, &(*tail)->n);
+	*tail = nsword(nprint("%d", nsrv), NULL);
+	tail = &(*tail)->n;
+	for (i = 0; i < nsrv; i++) {
+		*tail = nsword(nprint("%d", srvtab[i].type), nsword(srvtab[i].name, NULL));
+		tail = &(*tail)->n->n;
+	}
+	varassign("ns", top, FALSE);
+	nsdef = varlookup("ns");
+}
+
+/* the count at the head of l, and l past it, or -1 if it is not one */
+static int nscount(List **l) {
+	int n;
+	if (*l == NULL || (n = a2u((*l)->w)) < 0)
+		return -1;
+	*l = (*l)->n;
+	return n;
+}
+
+static void ns_load(List *l) {
+	unsigned long kernel;
+	bool here;
+	Nsnode *node;
+	Bind **pp;
+	int i, n, mode;
+
+	if (l == NULL || !streq(l->w, NSMAGIC) || (l = l->n) == NULL || l->n == NULL)
+		return;
+	kernel = strtoul(l->w, NULL, 10);
+	srvmtime = strtol(l->n->w, NULL, 10);
+	l = l->n->n;
+	here = kernel != 0 && kernel == mntns();
+#ifdef __linux__
+	nskernel = here;
+#endif
+	if ((n = nscount(&l)) < 0)
+		return;
+	for (i = 0; i < n && l != NULL && l->n != NULL && l->n->n != NULL; i++, l = l->n->n->n) {
+		mode = a2u(l->w);
+		if (mode < 0 || ((mode & BIND_KERNEL) && !here))
+			continue;
+		node = find_node(l->n->n->w, TRUE);
+		for (pp = &node->binds; *pp != NULL; pp = &(*pp)->n)
+			;
+		*pp = new_bind(l->n->w, l->n->n->w, mode);
+		nbinds++;
+	}
+	if (i < n || (n = nscount(&l)) < 0)
+		return;
+	for (i = 0; i < n && l != NULL && l->n != NULL; i++, l = l->n->n) {
+		if (nsrv == srvalloc)
+			srvtab = erealloc(srvtab, (srvalloc = 2 * srvalloc + 16) * sizeof *srvtab);
+		srvtab[nsrv].name = ecpy(l->n->w);
+		srvtab[nsrv].path = mprint("%s/%s", SRV_DIR, l->n->w);
+		srvtab[nsrv].type = a2u(l->w);
+		srvtab[nsrv++].pid = 0;
+	}
+}
+
 /* ========== Init/Cleanup ========== */
 
+static void free_nodes(Nsnode *node) {
+	Nsnode *next;
+	for (; node != NULL; node = next) {
+		next = node->sib;
+		free_nodes(node->kids);
+		free_binds(node->binds);
+		efree(node->name);
+		efree(node);
+	}
+}
+
+/* called once the environment is in */
 extern void dist_init(void) {
-	memzero(bindtab, sizeof(bindtab));
+	memzero(&nsroot, sizeof nsroot);
 	nbinds = 0;
+	ns_load(nsdef = varlookup("ns"));
+	nsdirty = FALSE;
 }
 
 extern void dist_cleanup(void) {
-	int i;
-	Bind *b, *next;
-
-	/* free bind table */
-	for (i = 0; i < BIND_MAX; i++) {
-		for (b = bindtab[i]; b != NULL; b = next) {
-			next = b->n;
-			efree(b->from);
-			efree(b->to);
-			efree(b);
-		}
-		bindtab[i] = NULL;
-	}
+	cpuclose();
+	free_nodes(nsroot.kids);
+	free_binds(nsroot.binds);
+	memzero(&nsroot, sizeof nsroot);
 	nbinds = 0;
 }
 
@@ -8,12 +8,16 @@
    BIND_BEFORE  - new directory appears before old (union mount, priority)
    BIND_AFTER   - new directory appears after old (union mount, fallback)
    BIND_REPLACE - new directory replaces old (default)
+   BIND_MOUNT   - a real mount, which the kernel resolves already
+   BIND_KERNEL  - made with mount(2) in a namespace of rc's own (rfork n)
 */
 enum {
 	BIND_REPLACE = 0,
 	BIND_BEFORE  = 1,
 	BIND_AFTER   = 2,
-	BIND_CREATE  = 4
+	BIND_CREATE  = 4,
+	BIND_MOUNT   = 8,
+	BIND_KERNEL  = 16
 };
 
 /*
@@ -40,12 +44,6 @@ enum {
 	RFNOWAIT = (1 << 8)
 };
 
-/* maximum bind table entries */
-#define BIND_MAX 256
-
-/* maximum service entries */
-#define SRV_MAX 64
-
 /* default service directory */
 #define SRV_DIR "/tmp/rc-srv"
 
@@ -54,21 +52,45 @@ typedef struct Bind Bind;
 struct Bind {
 	char *from;		/* source path */
 	char *to;		/* mount point */
-	int mode;		/* BIND_BEFORE, BIND_AFTER, BIND_REPLACE */
+	int mode;		/* BIND_BEFORE, BIND_AFTER, BIND_REPLACE, BIND_MOUNT */
 	Bind *n;		/* next entry (for union directories) */
 };
 
+/* kinds of service */
+enum {
+	SRV_FILE = 0,
+	SRV_FIFO = 1,
+	SRV_SOCK = 2
+};
+
 /* Service registry entry */
 typedef struct Srv Srv;
 struct Srv {
 	char *name;		/* service name */
 	char *path;		/* path to FIFO or socket */
-	pid_t pid;		/* owning process (0 if none) */
+	int type;		/* SRV_FIFO, SRV_SOCK or SRV_FILE */
+	pid_t pid;		/* owning process (0 if none, or not ours) */
+};
+
+/* cpu connection: an ssh ControlMaster kept open for reuse */
+typedef struct Conn Conn;
+struct Conn {
+	char *host;		/* remote host */
+	char *user;		/* remote user, or NULL */
+	char *path;		/* ssh ControlPath option */
+	pid_t owner;		/* the shell that tears it down */
+	int id;			/* names its state file on the remote */
+	char **sent, **next;	/* the environment last shipped with -E, and that being shipped */
+	int nsent, nnext;
+	pid_t sender;		/* the shell that shipped it */
+	size_t grown;		/* bytes of state the remote has had since it was last sent whole */
+	Conn *n;
 };
 
 /* dist.c prototypes */
 extern void dist_init(void);
 extern void dist_cleanup(void);
+extern void ns_export(void);
 
 /* builtin implementations */
 extern void b_bind(char **);
@@ -82,6 +104,7 @@ extern void b_rfork(char **);
 extern void b_addns(char **);
 
 /* namespace query */
+extern char *ns_try(char *path, int i);
 extern char *ns_resolve(char *path);
 extern Bind *ns_lookup(char *mountpoint);
 extern int ns_count(void);
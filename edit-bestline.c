@@ -3,7 +3,6 @@
 #include <ctype.h>
 #include <errno.h>
 #include <stdio.h>
-#include <dirent.h>
 #include <sys/stat.h>
 #include <bestline.h>
 
@@ -15,15 +14,6 @@ struct cookie {
 	char *buffer;
 };
 
-/* Join two strings with a "/" between them, into a malloc string */
-static char *dir_join(const char *a, const char *b) {
-	size_t l;
-	if (!a) a = "";
-	if (!b) b = "";
-	l = strlen(a);
-	return mprint("%s%s%s", a, l && a[l-1] != '/' ? "/" : "", b);
-}
-
 static char *quote(char *str) {
 	size_t quotecount = 0;
 	for (char *p = str; *p; p++)
@@ -66,121 +56,22 @@ static void strip_quotes(char *str) {
 	}
 }
 
-/* Decide if this directory entry is a completion candidate, either executable
- * or a directory. "dname" is the absolute path of the directory, "name" is the
- * current entry. "subdirs" is the name being completed up to and including the
- * last slash (or NULL if there is no slash), "prefix" is the remainder of the
- * name being completed, "len" is the length of "prefix".
- */
-static char *entry(char *dname, char *name, char *subdirs,
-			char *prefix, size_t len) {
-	char *full;
-	struct stat st;
-
-	if (strncmp(name, prefix, len) != 0)
-		return NULL;
-	if (streq(name, ".") || streq(name, ".."))
-		return NULL;
-	full = dir_join(dname, name);
-	int exe = rc_access(full, FALSE, &st);
-	efree(full);
-	if (exe || S_ISDIR(st.st_mode))
-		return dir_join(subdirs, name);
-	return NULL;
-}
-
-/* Split a string "text" after the last "/" into "pre" and "post". If there is
- * no "/", "pre" will be NULL. */
-static void split_last_slash(const char *text, char **pre, char **post) {
-	char *last_slash = strrchr(text, '/');
-	if (last_slash) {
-		size_t l = last_slash + 1 - text;
-		*pre = ealloc(l + 1);
-		memcpy(*pre, text, l);
-		(*pre)[l] = '\0';
-		*post = last_slash + 1;
-	} else {
-		*pre = NULL;
-		*post = (char *)text;
-	}
-}
-
 static char *compl_extcmd(const char *text, int state) {
-	static char *dname, *prefix, *subdirs;
-	static DIR *d;
-	static List nil, *path;
-	static size_t len;
-
-	if (!state) {
-		split_last_slash(text, &subdirs, &prefix);
-		d = NULL;
-		if (subdirs && isabsolute(subdirs))
-			path = &nil;
-		else
-			path = varlookup("path");
-		len = strlen(prefix);
-	}
-	while (d || path) {
-		if (!d) {
-			dname = dir_join(path->w, subdirs);
-			d = opendir(dname);
-			path = path->n;
-			if (!d) efree(dname);
-		} else {
-			struct dirent *e;
-			while ((e = readdir(d))) {
-				char *x;
-				x = entry(dname, e->d_name, subdirs,
-						prefix, len);
-				if (x) return x;
-			}
-			closedir(d);
-			efree(dname);
-			d = NULL;
-		}
-	}
-	efree(subdirs);
-	return NULL;
+	bool isdir;
+	return compl_path(text, state, &isdir);
 }
 
 static char *compl_filename(const char *text, int state) {
-	static char *textnoquotes, *dname, *prefix, *subdirs;
-	static DIR *d;
-	static size_t len;
-	if (!state) {
-		textnoquotes = strdup(text);
-		strip_quotes(textnoquotes);
-		text = textnoquotes;
-		split_last_slash(text, &subdirs, &prefix);
-		len = strlen(prefix);
-		d = opendir(subdirs ? subdirs : ".");
-		if (!d) {
-			efree(subdirs);
-			efree(textnoquotes);
-			return NULL;
-		}
+	char *t = ecpy(text), *name;
+	strip_quotes(t);
+	name = compl_file(t, state);
+	efree(t);
+	if (name != NULL && strstr(name, " ")) {
+		char *quoted = quote(name);
+		efree(name);
+		name = quoted;
 	}
-	struct dirent *e;
-	while ((e = readdir(d))) {
-		if (streq(e->d_name, ".") || streq(e->d_name, ".."))
-			continue;
-		dname = NULL;
-		if (strncmp(e->d_name, prefix, len) == 0) {
-			dname = subdirs ? dir_join(subdirs, e->d_name) : strdup(e->d_name);
-			if (strstr(dname, " ")) {
-				char *quoted = quote(dname);
-				efree(dname);
-				dname = quoted;
-			}
-			return dname;
-		}
-	}
-	closedir(d);
-	d = NULL;
-	efree(subdirs);
-	efree(dname);
-	efree(textnoquotes);
-	return NULL;
+	return name;
 }
 
 static char compl_prefix(const char *buf, int index) {
@@ -275,6 +166,10 @@ static void completion(const char *buf, int pos, bestlineCompletions *lc) {
 	efree(expandedbuf);
 }
 
+static void histadd(const char *s) {
+	bestlineHistoryAdd(s);
+}
+
 void *edit_begin(int fd) {
 	List *hist;
 	struct cookie *c;
@@ -283,7 +178,7 @@ void *edit_begin(int fd) {
 
 	hist = varlookup("history");
 	if (hist != NULL)
-		if (bestlineHistoryLoad(hist->w) != 0 &&
+		if (edit_history(hist->w, histadd) != 0 &&
 				errno != ENOENT) /* ignore if missing */
 			uerror(hist->w);
 
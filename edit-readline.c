@@ -2,7 +2,6 @@
 
 #include <errno.h>
 #include <stdio.h>
-#include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <readline/readline.h>
@@ -19,15 +18,6 @@ struct cookie {
 	char *buffer;
 };
 
-/* Join two strings with a "/" between them, into a malloc string */
-static char *dir_join(const char *a, const char *b) {
-	size_t l;
-	if (!a) a = "";
-	if (!b) b = "";
-	l = strlen(a);
-	return mprint("%s%s%s", a, l && a[l-1] != '/' ? "/" : "", b);
-}
-
 char *quote(char *p, int open) {
 	if (strpbrk(p, quote_chars)) {
 		char *r = mprint("%#S", p);
@@ -52,83 +42,12 @@ static char *unquote(const char *text) {
 	return r;
 }
 
-/* Decide if this directory entry is a completion candidate, either executable
- * or a directory. "dname" is the absolute path of the directory, "name" is the
- * current entry. "subdirs" is the name being completed up to and including the
- * last slash (or NULL if there is no slash), "prefix" is the remainder of the
- * name being completed, "len" is the length of "prefix".
- */
-static char *entry(char *dname, char *name, char *subdirs,
-			char *prefix, size_t len) {
-	char *full;
-	struct stat st;
-
-	if (strncmp(name, prefix, len) != 0)
-		return NULL;
-	if (streq(name, ".") || streq(name, ".."))
-		return NULL;
-	full = dir_join(dname, name);
-	int exe = rc_access(full, FALSE, &st);
-	efree(full);
-	if (S_ISDIR(st.st_mode))
-		rl_completion_append_character = '/';
-	if (exe || S_ISDIR(st.st_mode))
-		return dir_join(subdirs, name);
-	return NULL;
-}
-
-/* Split a string "text" after the last "/" into "pre" and "post". If there is
- * no "/", "pre" will be NULL. */
-void split_last_slash(const char *text, char **pre, char **post) {
-	char *last_slash = strrchr(text, '/');
-	if (last_slash) {
-		size_t l = last_slash + 1 - text;
-		*pre = ealloc(l + 1);
-		memcpy(*pre, text, l);
-		(*pre)[l] = '\0';
-		*post = last_slash + 1;
-	} else {
-		*pre = NULL;
-		*post = (char *)text;
-	}
-}
-
 static char *compl_extcmd(const char *text, int state) {
-	static char *dname, *prefix, *subdirs;
-	static DIR *d;
-	static List nil, *path;
-	static size_t len;
-
-	if (!state) {
-		split_last_slash(text, &subdirs, &prefix);
-		d = NULL;
-		if (subdirs && isabsolute(subdirs))
-			path = &nil;
-		else
-			path = varlookup("path");
-		len = strlen(prefix);
-	}
-	while (d || path) {
-		if (!d) {
-			dname = dir_join(path->w, subdirs);
-			d = opendir(dname);
-			path = path->n;
-			if (!d) efree(dname);
-		} else {
-			struct dirent *e;
-			while ((e = readdir(d))) {
-				char *x;
-				x = entry(dname, e->d_name, subdirs,
-						prefix, len);
-				if (x) return x;
-			}
-			closedir(d);
-			efree(dname);
-			d = NULL;
-		}
-	}
-	efree(subdirs);
-	return NULL;
+	bool isdir;
+	char *name = compl_path(text, state, &isdir);
+	if (name != NULL && isdir)
+		rl_completion_append_character = '/';
+	return name;
 }
 
 static rl_compentry_func_t *const compl_cmd_funcs[] = {
@@ -280,7 +199,7 @@ void *edit_begin(int fd) {
 
 	hist = varlookup("history");
 	if (hist != NULL)
-		if (read_history(hist->w) != 0 &&
+		if (edit_history(hist->w, add_history) != 0 &&
 				errno != ENOENT) /* ignore if missing */
 			uerror(hist->w);
 
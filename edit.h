@@ -10,3 +10,5 @@ extern void edit_prompt(void *, char *);
 extern void edit_end(void *);
 
 extern void edit_reset(void *);
+
+extern int edit_history(char *, void (*)(const char *));
@@ -0,0 +1,123 @@
+/* edithist.c: the history a line editor starts with */
+
+#include "rc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#include "edit.h"
+
+#ifndef EDIT_HISTORY
+#define EDIT_HISTORY 10000
+#endif
+
+/*
+   Handing an editor the whole of $history makes its start-up, and every
+   search through it, take time in proportion to the file, which only ever
+   grows. So it is given the last EDIT_HISTORY distinct commands instead:
+   the file is mapped and scanned back from its end, and a command already
+   seen later on is left out. The cost is bounded however long the file
+   gets, and a search never steps through the same command twice.
+*/
+
+typedef struct {
+	char *s;
+	size_t len;
+	unsigned long h;
+} Line;
+
+static unsigned long linehash(char *s, size_t len) {
+	unsigned long h = 2166136261UL;
+	while (len-- > 0)
+		h = (h ^ (unsigned char) *s++) * 16777619UL;
+	return h;
+}
+
+/* add s to the table (of size a power of 2) unless it is there already */
+static bool seen(Line **tab, size_t mask, Line *l) {
+	size_t i;
+	for (i = l->h & mask; tab[i] != NULL; i = (i + 1) & mask)
+		if (tab[i]->h == l->h && tab[i]->len == l->len && memcmp(tab[i]->s, l->s, l->len) == 0)
+			return TRUE;
+	tab[i] = l;
+	return FALSE;
+}
+
+/* give add() the recent distinct commands in file, oldest first. -1 (and errno) on failure */
+extern int edit_history(char *file, void (*add)(const char *)) {
+	struct stat st;
+	Line *lines, **tab;
+	size_t size, mask, n, len;
+	char *buf, *p, *end, *s;
+	bool mapped = FALSE;
+	int fd, e;
+	if ((fd = rc_open(file, rFrom)) < 0)
+		return -1;
+	if (fstat(fd, &st) < 0) {
+		e = errno;
+		close(fd);
+		errno = e;
+		return -1;
+	}
+	if (st.st_size == 0) {
+		close(fd);
+		return 0;
+	}
+	size = st.st_size;
+#if HAVE_MMAP
+	if ((buf = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0)) != MAP_FAILED)
+		mapped = TRUE;
+	else
+#endif
+	{
+		ssize_t r;
+		buf = ealloc(size);
+		for (n = 0; n < size; n += r)
+			if ((r = rc_read(fd, buf + n, size - n)) <= 0)
+				break;
+		size = n;
+	}
+	close(fd);
+
+	for (mask = 1; mask < 2 * EDIT_HISTORY; mask <<= 1)
+		;
+	tab = ealloc(mask * sizeof *tab);
+	memzero(tab, mask * sizeof *tab);
+	mask--;
+	lines = ealloc(EDIT_HISTORY * sizeof *lines);
+	n = 0;
+	for (end = buf + size; end > buf && n < EDIT_HISTORY; end = p) {
+		if (end[-1] == '\n')
+			--end;
+		for (p = end; p > buf && p[-1] != '\n'; --p)
+			;
+		if (p == end)
+			continue; /* empty line */
+		lines[n].s = p;
+		lines[n].len = end - p;
+		lines[n].h = linehash(p, end - p);
+		if (!seen(tab, mask, &lines[n]))
+			n++;
+	}
+	while (n-- > 0) {
+		len = lines[n].len;
+		s = ealloc(len + 1);
+		memcpy(s, lines[n].s, len);
+		s[len] = '\0';
+		(*add)(s);
+		efree(s);
+	}
+	efree(lines);
+	efree(tab);
+#if HAVE_MMAP
+	if (mapped)
+		munmap(buf, size);
+	else
+#endif
+		efree(buf);
+	return 0;
+}
@@ -45,10 +45,24 @@ extern void unexcept(ecodes e) {
 	case eFd:
 		close(estack->data.fd);
 		break;
+	case eTree:
+		estack->data.tree = NULL;
+		reaptrees();
+		break;
 	}
 	estack = estack->prev;
 }
 
+/* is t the body of a function which is being executed? */
+
+extern bool treebusy(Node *t) {
+	Estack *e;
+	for (e = estack; e != NULL; e = e->prev)
+		if (e->e == eTree && e->data.tree == t)
+			return TRUE;
+	return FALSE;
+}
+
 /*
    Raise an exception. The rules are pretty complicated: you can return
    from a loop inside a function, but you can't break from a function
@@ -88,6 +102,10 @@ extern void rc_raise(ecodes e) {
 			case eFd:
 				close(estack->data.fd);
 				break;
+			case eTree:
+				estack->data.tree = NULL;
+				reaptrees();
+				break;
 			}
 		} else {
 			if (e == eError && !estack->interactive) {
@@ -103,6 +121,31 @@ extern void rc_raise(ecodes e) {
 	rc_exit(1); /* top of exception stack */
 }
 
+/*
+   break, continue and return do not jump. The frame that rc_raise()
+   would unwind to is found with the same rules, and left in flow; walk()
+   does nothing more while it is set, and so returns up to the loop or
+   function that owns the frame, which clears it. Unwinding the frames on
+   the way is left to their owners too, which would have popped them on
+   a normal return anyway.
+*/
+
+Estack *flow = NULL;
+
+extern void rc_flow(ecodes e) {
+	Estack *ex;
+	for (ex = estack; ex != NULL && ex->e != e; ex = ex->prev)
+		if (e == eBreak && (ex->e != eArena && ex->e != eVarstack && ex->e != eContinue))
+			rc_error("break outside of loop");
+		else if (e == eContinue && (ex->e != eVarstack))
+			rc_error("continue outside of loop");
+		else if (e == eReturn && ex->e == eError)
+			rc_error("return outside of function");
+	if (ex == NULL)
+		rc_exit(1); /* top of exception stack */
+	flow = ex;
+}
+
 extern void clearflow() {
 	Estack **e = &estack;
 	while (*e != NULL)
@@ -129,6 +172,8 @@ extern void pop_cmdarg(bool remove) {
 		case eFd:
 			if (remove)
 				close(estack->data.fd);
+			else
+				keeponexec(estack->data.fd); /* see mkcmdarg() */
 			break;
 		default:
 			return;
@@ -27,6 +27,7 @@ extern void exec(List *s, bool parent) {
 	char *path = NULL;
 	bool didfork, returning, saw_exec, saw_builtin;
 	struct termios t;
+	double start = tracenow();
 	av = list2array(s, dashex);
 	saw_builtin = saw_exec = FALSE;
 	do {
@@ -52,6 +53,10 @@ extern void exec(List *s, bool parent) {
 			saw_builtin = TRUE;
 		}
 	} while (b == b_exec || b == b_builtin);
+	if (b == b_time && parent) { /* time's redirections are its command's */
+		b_time(av);
+		return;
+	}
 	if (*av == NULL && saw_exec) { /* do redirs and return on a null exec */
 		doredirs();
 		return;
@@ -75,6 +80,15 @@ extern void exec(List *s, bool parent) {
 	   If the fifoq is nonnull, then it must be emptied at the end so we
 	   must fork no matter what.
 	 */
+#if HAVE_POSIX_SPAWN
+	/* an external command with no redirections can skip the fork */
+	if (parent && b == NULL && *av != NULL && redirq == NULL && !outstanding_cmdarg()) {
+		if (interactive)
+			tcgetattr(0, &t);
+		pid = rc_spawn(path, av, ev);
+		didfork = TRUE;
+	} else
+#endif
 	if ((parent && (b == NULL || redirq != NULL)) || outstanding_cmdarg()) {
 		if (interactive)
 			tcgetattr(0, &t);
@@ -100,10 +114,16 @@ extern void exec(List *s, bool parent) {
 		if (*av == NULL || b != NULL) {
 			if (b != NULL)
 				(*b)(av);
-			if (returning)
+			if (returning) {
+				if (b != funcall) /* which has its own */
+					trace("cmd", *av, start);
 				return;
+			}
 			rc_exit(getstatus());
 		}
+		tracemark("proc", path);
+		traceflush();
+		flushout();
 		rc_execve(path, av, ev);
 
 #ifdef DEFAULTINTERP
@@ -139,5 +159,7 @@ extern void exec(List *s, bool parent) {
 		sigchk();
 		nl_on_intr = TRUE;
 		pop_cmdarg(TRUE);
+		if (b != funcall)
+			trace("cmd", *av, start);
 	}
 }
@@ -114,6 +114,9 @@ extern void rc_exit(int stat) {
 		funcall(sig);
 		stat = getstatus();
 	}
+#if RC_DIST
+	dist_cleanup();
+#endif
 	exit(stat);
 }
 
@@ -142,7 +145,7 @@ static void dud_handler(int ignore) {
 */
 
 extern void fnassign(char *name, Node *def) {
-	Node *newdef = treecpy(def == NULL ? &null : def, ealloc); /* important to do the treecopy first */
+	Node *newdef = treestore(def == NULL ? &null : def); /* important to do the treecopy first */
 	rc_Function *new = get_fn_place(name);
 	int i;
 	new->def = newdef;
@@ -173,7 +176,7 @@ extern void fnassign_string(char *extdef) {
 		return;
 	new = get_fn_place(name);
 	new->def = NULL;
-	new->extdef = ecpy(extdef);
+	new->extdef = extcpy(extdef);
 }
 
 /* Return a function in Node form, evaluating an entry from the environment if necessary */
@@ -189,11 +192,12 @@ extern Node *fnlookup(char *name) {
 		return &null;
 	ret = parse_fn(look->extdef);
 	if (ret == NULL) {
-		efree(look->extdef);
+		extfree(look->extdef);
 		look->extdef = NULL;
 		return &null;
 	} else {
-		return look->def = treecpy(ret, ealloc); /* Need to take it out of nalloc space */
+		look->def = treestore(ret); /* Need to take it out of nalloc space */
+		return look->def;
 	}
 }
 
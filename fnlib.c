@@ -0,0 +1,293 @@
+/* fnlib.c: libraries of functions, stored parsed and mapped shared */
+
+#include "rc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "version.h"
+
+/*
+   A function imported from the environment is parsed, and its tree
+   copied to malloc space, in every rc that calls it. `load -c file
+   name...' writes the named functions (all of them, by default) to a
+   library instead: their trees, laid out as treestore() lays them out,
+   with the pointers made for a fixed address. `load file' maps the
+   library read-only and shared, at that address if it is free, and
+   points the functions' table entries into it, so that however many rc
+   processes load it there is one copy of the trees, in the page cache,
+   and nothing is parsed at all. Where the address is taken the file is
+   mapped privately instead, and its pointers moved (see treereloc()).
+
+   A library that has been loaded is named in $fnlib, which children
+   inherit. At startup the functions of each library named there take
+   the place of those imported with the same text; one the parent has
+   since redefined or deleted is left as the environment has it.
+
+   The library is trusted as a script would be: its trees are checked
+   no more than its header. A new one is written beside the old one and
+   renamed over it, since changing a mapped file under a running rc
+   would change its functions, or kill it on a bus error.
+
+   The address is picked from a hash of the functions' text, so that
+   different libraries are unlikely to want the same place.
+*/
+
+#define LIBMAGIC "rc fnlib 2\n"
+#if ULONG_MAX > 0xffffffffUL
+#define LIBBASE 0x300000000000UL
+#define LIBSLOT 0x4000000UL
+#define NLIBSLOT 4096
+#else
+#define LIBBASE 0x60000000UL
+#define LIBSLOT 0x1000000UL
+#define NLIBSLOT 16
+#endif
+#define libround(n) (((n) + sizeof (align_t) - 1) & ~(sizeof (align_t) - 1))
+
+typedef struct {
+	char *name;
+	char *extdef;	/* as fnlookup_string() has it */
+	Node *def;
+} Libfn;
+
+typedef struct {
+	char magic[sizeof LIBMAGIC];
+	char version[32];
+	Treelayout layout;
+	unsigned long base;	/* the address the pointers are for */
+	size_t size;		/* of the whole file */
+	int nfn;
+	Libfn *fn;
+} Libhdr;
+
+typedef struct Lib {
+	dev_t dev;
+	ino_t ino;
+	long mtime;
+	char *addr;
+	size_t size;
+	struct Lib *n;
+} Lib;
+
+static Lib *libs;
+
+extern bool inlib(void *p) {
+	Lib *l;
+	for (l = libs; l != NULL; l = l->n)
+		if ((char *) p >= l->addr && (char *) p < l->addr + l->size)
+			return TRUE;
+	return FALSE;
+}
+
+static void mkheader(Libhdr *h) {
+	memzero(h, sizeof *h);
+	strcpy(h->magic, LIBMAGIC);
+	strncpy(h->version, VERSION, sizeof h->version - 1);
+	treelayout(&h->layout);
+}
+
+/* map the library in file; NULL, with errno or *why set, on failure */
+
+static Libhdr *libmap(char *file, char **why) {
+	struct stat st;
+	Libhdr h, want, *m;
+	ptrdiff_t d;
+	Lib *l;
+	int fd, i;
+	*why = NULL;
+	if ((fd = rc_open(file, rFrom)) < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return NULL;
+	}
+	for (l = libs; l != NULL; l = l->n)
+		if (l->dev == st.st_dev && l->ino == st.st_ino && l->mtime == (long) st.st_mtime) {
+			close(fd);
+			return (Libhdr *) l->addr;
+		}
+	mkheader(&want);
+	if (pread(fd, &h, sizeof h, 0) != sizeof h
+			|| memcmp(&h, &want, offsetof(Libhdr, base)) != 0
+			|| h.size != (size_t) st.st_size || h.nfn < 0
+			|| sizeof h + h.nfn * sizeof (Libfn) > h.size
+			|| h.fn != (Libfn *) (h.base + sizeof h)) {
+		close(fd);
+		*why = "not a function library, or not for this rc";
+		return NULL;
+	}
+	m = mmap((void *) h.base, h.size, PROT_READ, MAP_SHARED, fd, 0);
+	if (m != MAP_FAILED && m != (Libhdr *) h.base) {
+		munmap(m, h.size);
+		m = mmap(NULL, h.size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (m != MAP_FAILED) {
+			d = (char *) m - (char *) h.base;
+			m->fn = (Libfn *) (m + 1);
+			for (i = 0; i < h.nfn; i++) {
+				m->fn[i].name += d;
+				m->fn[i].extdef += d;
+				m->fn[i].def = (Node *) ((char *) m->fn[i].def + d);
+				treereloc(m->fn[i].def, d);
+			}
+			mprotect(m, h.size, PROT_READ);
+		}
+	}
+	close(fd);
+	if (m == MAP_FAILED)
+		return NULL;
+	l = enew(Lib);
+	l->dev = st.st_dev;
+	l->ino = st.st_ino;
+	l->mtime = st.st_mtime;
+	l->addr = (char *) m;
+	l->size = h.size;
+	l->n = libs;
+	libs = l;
+	return m;
+}
+
+static unsigned long fnv(unsigned long h, char *s) {
+	while (*s != '\0')
+		h = (h ^ (unsigned char) *s++) * 16777619UL;
+	return h;
+}
+
+/* write the named functions to file; FALSE, with errno set, on failure */
+
+static bool libwrite(char *file, char **names) {
+	Libhdr *m;
+	Node **defs;
+	char **exts, *p, *tmp;
+	size_t size, *lens;
+	unsigned long h = 2166136261UL;
+	int i, n, fd;
+	bool ok;
+	for (n = 0; names[n] != NULL; n++)
+		;
+	defs = nalloc((n + 1) * sizeof *defs);
+	exts = nalloc((n + 1) * sizeof *exts);
+	lens = nalloc((n + 1) * sizeof *lens);
+	size = libround(sizeof *m + n * sizeof (Libfn));
+	for (i = 0; i < n; i++) {
+		exts[i] = fnlookup_string(names[i]);
+		defs[i] = fnlookup(names[i]);
+		size += libround(strlen(names[i]) + 1) + libround(strlen(exts[i]) + 1);
+		size += lens[i] = libround(treelen(defs[i]));
+		h = fnv(h, exts[i]);
+	}
+	m = mmap((void *) (LIBBASE + h % NLIBSLOT * LIBSLOT), size, PROT_READ|PROT_WRITE,
+		MAP_PRIVATE|MAP_ANON, -1, 0);
+	if (m == MAP_FAILED)
+		return FALSE;
+	mkheader(m);
+	m->base = (unsigned long) m;
+	m->size = size;
+	m->nfn = n;
+	m->fn = (Libfn *) (m + 1);
+	p = (char *) m + libround(sizeof *m + n * sizeof (Libfn));
+	for (i = 0; i < n; i++) {
+		m->fn[i].name = strcpy(p, names[i]);
+		p += libround(strlen(p) + 1);
+		m->fn[i].extdef = strcpy(p, exts[i]);
+		p += libround(strlen(p) + 1);
+		m->fn[i].def = treeat(defs[i], p);
+		p += lens[i];
+	}
+	tmp = nprint("%s.%d", file, rc_pid);
+	if ((fd = open(tmp, O_WRONLY | O_CREAT | O_EXCL, 0666)) < 0) {
+		munmap(m, size);
+		return FALSE;
+	}
+	writeall(fd, (char *) m, size);
+	ok = lseek(fd, 0, SEEK_END) == (off_t) size;
+	if (close(fd) < 0 || !ok || rename(tmp, file) < 0) {
+		i = errno;
+		unlink(tmp);
+		errno = ok ? i : ENOSPC;
+		ok = FALSE;
+	}
+	munmap(m, size);
+	return ok;
+}
+
+/* the functions of a library loaded at startup replace their imported text */
+
+extern void libinit() {
+	List *l;
+	Libhdr *m;
+	rc_Function *f;
+	char *why;
+	int i;
+	for (l = varlookup("fnlib"); l != NULL; l = l->n)
+		if ((m = libmap(l->w, &why)) != NULL)
+			for (i = 0; i < m->nfn; i++)
+				if ((f = lookup_fn(m->fn[i].name)) != NULL && f->def == NULL
+						&& f->extdef != NULL && streq(f->extdef, m->fn[i].extdef))
+					f->def = m->fn[i].def;
+}
+
+extern void b_load(char **av) {
+	bool compile = FALSE;
+	List *libl, *l;
+	Libhdr *m;
+	rc_Function *f;
+	char *why;
+	int ac, c, i;
+	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
+		; /* count the arguments for getopt */
+	while ((c = rc_getopt(ac, av, "c")) != -1)
+		switch (c) {
+		default: set(FALSE); return;
+		case 'c': compile = TRUE; break;
+		}
+	av += rc_optind;
+	if (*av == NULL) {
+		fprint(2, RC "usage: load file ... | load -c file [name ...]\n");
+		set(FALSE);
+		return;
+	}
+	if (compile) {
+		for (i = 1; av[i] != NULL; i++)
+			if (fnlookup(av[i]) == NULL) {
+				fprint(2, RC "load: `%s' is not a function\n", av[i]);
+				set(FALSE);
+				return;
+			}
+		if (!libwrite(av[0], av[1] != NULL ? av + 1 : fnnames())) {
+			uerror(av[0]);
+			set(FALSE);
+			return;
+		}
+		set(TRUE);
+		return;
+	}
+	for (set(TRUE); *av != NULL; av++) {
+		if ((m = libmap(*av, &why)) == NULL) {
+			if (why != NULL)
+				fprint(2, RC "%s: %s\n", *av, why);
+			else
+				uerror(*av);
+			set(FALSE);
+			continue;
+		}
+		for (i = 0; i < m->nfn; i++)
+			if (strncmp(m->fn[i].name, "sig", conststrlen("sig")) == 0) {
+				fnassign(m->fn[i].name, m->fn[i].def); /* sets the handler, from a copy */
+			} else {
+				f = get_fn_place(m->fn[i].name);
+				f->def = m->fn[i].def;
+				f->extdef = m->fn[i].extdef;
+			}
+		libl = varlookup("fnlib");
+		for (l = libl; l != NULL && !streq(l->w, *av); l = l->n)
+			;
+		if (l == NULL)
+			varassign("fnlib", append(libl, word(*av, NULL)), FALSE);
+	}
+}
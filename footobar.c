@@ -72,7 +72,12 @@ static bool Tconv(Format *f, int ignore) {
 	case nSwitch:	fmtprint(f, "switch(%T){%T}", n->u[0].p, n->u[1].p);	break;
 	case nMatch:	fmtprint(f, "~ %T %T", n->u[0].p, n->u[1].p);		break;
 	case nWhile:	fmtprint(f, "while(%T)%T", n->u[0].p, n->u[1].p);	break;
-	case nForin:	fmtprint(f, "for(%T in %T)%T", n->u[0].p, n->u[1].p, n->u[2].p); break;
+	case nForin:
+		if (n->u[2].p != NULL && n->u[2].p->type == nNowait)
+			fmtprint(f, "for(%T in %T&)%T", n->u[0].p, n->u[1].p, n->u[2].p->u[0].p);
+		else
+			fmtprint(f, "for(%T in %T)%T", n->u[0].p, n->u[1].p, n->u[2].p);
+		break;
 	case nVarsub:	fmtprint(f, "$%T(%T)", n->u[0].p, n->u[1].p);		break;
 	case nWord:
 		fmtprint(f, n->u[2].i && quotep(n->u[0].s, dollar) ?
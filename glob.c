@@ -3,6 +3,8 @@
 #include "rc.h"
 #include "stat.h"
 
+#include <time.h>
+
 /* Lifted from autoconf documentation.*/
 #if HAVE_DIRENT_H
 # include <dirent.h>
@@ -25,6 +27,7 @@ static List *dmatch(char *, char *, char *);
 static List *doglob(char *, char *);
 static List *lglob(List *, char *, char *, size_t);
 static List *sort(List *);
+static struct dirlist *readlist(char *, struct stat *);
 
 /*
    Matches a list of words s against a list of patterns p. Returns true iff
@@ -34,6 +37,7 @@ static List *sort(List *);
 
 extern bool lmatch(List *s, List *p) {
 	List *q;
+	Matcher *x;
 	if (s == NULL) {
 		if (p == NULL) /* null matches null */
 			return TRUE;
@@ -43,10 +47,18 @@ extern bool lmatch(List *s, List *p) {
 				return TRUE;
 		return FALSE;
 	}
-	for (; s != NULL; s = s->n)
-		for (q = p; q != NULL; q = q->n)
-			if (match(q->w, q->m, s->w))
+	for (; p != NULL; p = p->n) {
+		if (p->m == NULL) {
+			for (q = s; q != NULL; q = q->n)
+				if (streq(p->w, q->w))
+					return TRUE;
+			continue;
+		}
+		x = patcomp(p->w, p->m);
+		for (q = s; q != NULL; q = q->n)
+			if (patmatch(x, q->w))
 				return TRUE;
+	}
 	return FALSE;
 }
 
@@ -83,14 +95,108 @@ extern List *glob(List *s) {
 	return top;
 }
 
-/* Matches a pattern p against the contents of directory d */
+/*
+   Directory listings are cached, keyed on the device, inode, and the
+   modification and change times of the directory, so a pattern that
+   visits the same directory many times (or a script that globs it over
+   and over) reads it once. Because timestamps are coarse, a listing is
+   only cached if the directory has not changed for RACY seconds; any later
+   change must then give it a new mtime. Cached listings are sorted, so
+   they come out of dmatch() as sorted runs for sort() to merge.
+*/
+
+#define DIRCACHE 64		/* directories remembered */
+#define DIRCACHEMAX 262144	/* bytes of names beyond which a listing is not cached */
+#define RACY 2
+
+static struct dirlist {
+	dev_t dev;
+	ino_t ino;
+	time_t mtime, ctime;
+	char *names;		/* the names, each terminated by '\0' */
+	size_t *off;		/* the offset in names of each name */
+	size_t n, used;		/* number of names, bytes of names */
+	size_t nalloc, size;	/* space for n, and for used */
+} dircache[DIRCACHE], scratch;
+
+static char *sortnames;
+
+static int offcmp(const void *a, const void *b) {
+	return strcmp(&sortnames[*(const size_t *) a], &sortnames[*(const size_t *) b]);
+}
+
+/* Read the listing of directory d, which has been stat'ed into s, from the cache if possible */
+
+static struct dirlist *readlist(char *d, struct stat *s) {
+	struct dirlist *l, t;
+	DIR *dirp;
+	struct dirent *dp;
+	size_t len;
+	time_t now;
+
+	l = &dircache[((unsigned long) s->st_ino ^ (unsigned long) s->st_dev) % DIRCACHE];
+	if (l->names != NULL && l->dev == s->st_dev && l->ino == s->st_ino &&
+			l->mtime == s->st_mtime && l->ctime == s->st_ctime)
+		return l;
+	if ((dirp = opendir(d)) == NULL)
+		return NULL;
+	scratch.n = scratch.used = 0;
+	while ((dp = readdir(dirp)) != NULL) {
+		len = NAMLEN(dp) + 1;
+		if (scratch.used + len > scratch.size) {
+			scratch.size = 2 * (scratch.used + len);
+			scratch.names = erealloc(scratch.names, scratch.size);
+		}
+		if (scratch.n == scratch.nalloc) {
+			scratch.nalloc = 2 * scratch.n + 32;
+			scratch.off = erealloc(scratch.off, scratch.nalloc * sizeof(size_t));
+		}
+		memcpy(&scratch.names[scratch.used], dp->d_name, len);
+		scratch.off[scratch.n++] = scratch.used;
+		scratch.used += len;
+	}
+	closedir(dirp);
+	now = time(NULL);
+	if (scratch.used > DIRCACHEMAX || now - s->st_mtime <= RACY || now - s->st_ctime <= RACY)
+		return &scratch;
+	sortnames = scratch.names;
+	qsort(scratch.off, scratch.n, sizeof(size_t), offcmp);
+	t = *l;		/* swap buffers with the slot being replaced */
+	*l = scratch;
+	scratch = t;
+	l->dev = s->st_dev;
+	l->ino = s->st_ino;
+	l->mtime = s->st_mtime;
+	l->ctime = s->st_ctime;
+	return l;
+}
+
+/* drop the repeats from a sorted list */
+
+static List *uniq(List *s) {
+	List *r;
+	for (r = s; r != NULL && r->n != NULL; )
+		if (streq(r->w, r->n->w))
+			r->n = r->n->n;
+		else
+			r = r->n;
+	return s;
+}
+
+/*
+   Matches a pattern p against the contents of directory d. If d is a
+   union in the namespace, each of its directories is read, and a name
+   found in more than one is listed once.
+*/
 
 static List *dmatch(char *d, char *p, char *m) {
 	bool matched;
 	List *top, *r;
-	static DIR *dirp;
-	static struct dirent *dp;
+	struct dirlist *l;
+	Matcher *x;
 	static struct stat s;
+	char *name, *place;
+	size_t j;
 	int i;
 
 	/*
@@ -107,7 +213,10 @@ static List *dmatch(char *d, char *p, char *m) {
 
 	if (matched) {
 		char *path = nprint("%s/%s", d, p);
-		if (lstat(path, &s) < 0)
+		for (i = 0; (place = ns_try(path, i)) != NULL; i++)
+			if (lstat(place, &s) == 0)
+				break;
+		if (place == NULL)
 			return NULL;
 		r = nnew(List);
 		r->w = ncpy(p);
@@ -118,27 +227,30 @@ static List *dmatch(char *d, char *p, char *m) {
 
 	top = r = NULL;
 	if (*d == '\0') d = "/";
-	if ((dirp = opendir(d)) == NULL)
-		return NULL;
-	/* opendir succeeds on regular files on some systems, so the stat() call is necessary (sigh) */
-	if (stat(d, &s) < 0 || (s.st_mode & S_IFMT) != S_IFDIR) {
-		closedir(dirp);
-		return NULL;
-	}
-	while ((dp = readdir(dirp)) != NULL)
-		if ((*dp->d_name != '.' || *p == '.') && match(p, m, dp->d_name)) { /* match ^. explicitly */
-			matched = TRUE;
-			if (top == NULL)
-				top = r = nnew(List);
-			else
-				r = r->n = nnew(List);
-			r->w = ncpy(dp->d_name);
-			r->m = NULL;
+	x = patcomp(p, m);
+	for (i = 0; (place = ns_try(d, i)) != NULL; i++) {
+		/* opendir succeeds on regular files on some systems, so the stat() call is necessary (sigh) */
+		if (stat(place, &s) < 0 || (s.st_mode & S_IFMT) != S_IFDIR)
+			continue;
+		if ((l = readlist(place, &s)) == NULL)
+			continue;
+		for (j = 0; j < l->n; j++) {
+			name = &l->names[l->off[j]];
+			if ((*name != '.' || *p == '.') && patmatch(x, name)) { /* match ^. explicitly */
+				if (top == NULL)
+					top = r = nnew(List);
+				else
+					r = r->n = nnew(List);
+				r->w = ncpy(name);
+				r->m = NULL;
+			}
 		}
-	closedir(dirp);
-	if (!matched)
+	}
+	if (top == NULL)
 		return NULL;
 	r->n = NULL;
+	if (i > 1)
+		top = uniq(sort(top));
 	return top;
 }
 
@@ -253,14 +365,54 @@ end:	if (matched == NULL) {
 	return matched;
 }
 
+/*
+   A natural merge sort: the ascending runs already in the list (each
+   directory read from the cache supplies one) are merged pairwise until
+   only one is left, so sorted input costs a single pass.
+*/
+
+static List *merge(List *a, List *b) {
+	List *top, **tail;
+	for (tail = &top; a != NULL && b != NULL; tail = &(*tail)->n)
+		if (strcmp(a->w, b->w) <= 0) {
+			*tail = a;
+			a = a->n;
+		} else {
+			*tail = b;
+			b = b->n;
+		}
+	*tail = (a != NULL) ? a : b;
+	return top;
+}
+
+/* detach the ascending run at the head of *sp */
+
+static List *run(List **sp) {
+	List *top, *t;
+	for (top = t = *sp; t->n != NULL && strcmp(t->w, t->n->w) <= 0; t = t->n)
+		;
+	*sp = t->n;
+	t->n = NULL;
+	return top;
+}
+
 static List *sort(List *s) {
-	size_t nel = listnel(s);
-	if (nel > 1) {
-		char **a;
-		List *t;
-		qsort(a = list2array(s, FALSE), nel, sizeof(char *), starstrcmp);
-		for (t = s; t != NULL; t = t->n)
-			t->w = *a++;
-	}
+	List *top, **tail, *a;
+	bool again;
+	if (s == NULL)
+		return s;
+	do {
+		again = FALSE;
+		for (top = NULL, tail = &top; s != NULL; ) {
+			a = run(&s);
+			if (s != NULL) {
+				a = merge(a, run(&s));
+				again = TRUE;
+			}
+			for (*tail = a; *tail != NULL; tail = &(*tail)->n)
+				;
+		}
+		s = top;
+	} while (again);
 	return s;
 }
@@ -12,7 +12,7 @@
 
 static List *backq(Node *, Node *);
 static List *bqinput(List *, int);
-static List *count(List *);
+static List *count(List *, int);
 static List *mkcmdarg(Node *);
 
 Rq *redirq = NULL;
@@ -49,58 +49,102 @@ extern List *append(List *s1, List *s2) {
 	return top;
 }
 
+/*
+   Measure the words of s into lens, returning their total. meta is set
+   if any of them has a meta mask.
+*/
+
+static size_t measure(List *s, size_t *lens, bool *meta) {
+	size_t size;
+	int i;
+	for (size = 0, i = 0; s != NULL; s = s->n, i++) {
+		size += lens[i] = strlen(s->w);
+		if (s->m != NULL)
+			*meta = TRUE;
+	}
+	return size;
+}
+
+/*
+   The whole result goes in one block: the cells, then the words, then
+   their masks (if any). Each word's length is found just once.
+*/
+
 extern List *concat(List *s1, List *s2) {
-	int n1, n2;
+	int n1, n2, n, i;
+	size_t *len1, *len2, size, x, y;
+	bool meta = FALSE;
 	List *r, *top;
+	char *w, *m;
 	if (s1 == NULL)
 		return s2;
 	if (s2 == NULL)
 		return s1;
 	if ((n1 = listnel(s1)) != (n2 = listnel(s2)) && n1 != 1 && n2 != 1)
 		rc_error("bad concatenation");
-	for (r = top = nnew(List); 1; r = r->n = nnew(List)) {
-		size_t x = strlen(s1->w);
-		size_t y = strlen(s2->w);
-		size_t z = x + y + 1;
-		r->w = nalloc(z);
-		strcpy(r->w, s1->w);
-		strcat(r->w, s2->w);
-		if (s1->m == NULL && s2->m == NULL) {
+	n = (n1 > n2) ? n1 : n2;
+	len1 = nalloc((n1 + n2) * sizeof *len1);
+	len2 = &len1[n1];
+	size = measure(s1, len1, &meta) * (n / n1);
+	size += measure(s2, len2, &meta) * (n / n2);
+	size += n;
+	top = nalloc(n * sizeof (List) + (meta ? 2 * size : size));
+	w = (char *) &top[n];
+	m = w + size;
+	for (r = top, i = 0; i < n; r++, i++) {
+		x = len1[n1 > 1 ? i : 0];
+		y = len2[n2 > 1 ? i : 0];
+		r->w = w;
+		memcpy(w, s1->w, x);
+		memcpy(w + x, s2->w, y);
+		w[x + y] = '\0';
+		w += x + y + 1;
+		if (!meta) {
 			r->m = NULL;
 		} else {
-			r->m = nalloc(z);
+			r->m = m;
 			if (s1->m == NULL)
-				memzero(r->m, x);
+				memzero(m, x);
 			else
-				memcpy(r->m, s1->m, x);
+				memcpy(m, s1->m, x);
 			if (s2->m == NULL)
-				memzero(&r->m[x], y);
+				memzero(m + x, y);
 			else
-				memcpy(&r->m[x], s2->m, y);
-			r->m[z] = 0;
+				memcpy(m + x, s2->m, y);
+			m[x + y] = 0;
+			m += x + y + 1;
 		}
+		r->n = r + 1;
 		if (n1 > 1)
 			s1 = s1->n;
 		if (n2 > 1)
 			s2 = s2->n;
-		if (s1 == NULL || s2 == NULL || (n1 == 1 && n2 == 1))
-			break;
 	}
-	r->n = NULL;
+	top[n - 1].n = NULL;
 	return top;
 }
 
-extern List *varsub(List *var, List *subs) {
+/*
+   Subscript var, which has n elements if it is a vector (see listvec()),
+   i.e., if n is not -1, so that each subscript takes constant time.
+*/
+
+extern List *varsub(List *var, int n, List *subs) {
 	List *r, *top;
-	int n = listnel(var);
+	bool vec = (n != -1);
+	if (!vec)
+		n = listnel(var);
 	for (top = r = NULL; subs != NULL; subs = subs->n) {
 		int i = a2u(subs->w);
 		if (i < 1)
 			rc_error("bad subscript");
 		if (i <= n) {
 			List *sub = var;
-			while (--i)
-				sub = sub->n; /* loop until sub == var(i) */
+			if (vec)
+				sub = &var[i - 1];
+			else
+				while (--i)
+					sub = sub->n; /* loop until sub == var(i) */
 			if (top == NULL)
 				top = r = nnew(List);
 			else
@@ -116,30 +160,30 @@ extern List *varsub(List *var, List *subs) {
 
 extern List *flatten(List *s) {
 	List *r;
-	size_t step;
+	size_t *lens;
+	bool meta = FALSE;
 	char *f;
+	int n, i;
 	if (s == NULL || s->n == NULL)
 		return s;
+	n = listnel(s);
+	lens = nalloc(n * sizeof *lens);
 	r = nnew(List);
-	f = r->w = nalloc(listlen(s) + 1);
+	f = r->w = nalloc(measure(s, lens, &meta) + n);
 	r->m = NULL; /* flattened lists come from variables, so no meta */
 	r->n = NULL;
-	strcpy(f, s->w);
-	f += strlen(s->w);
-	do {
+	for (i = 0; s != NULL; s = s->n, i++) {
+		memcpy(f, s->w, lens[i]);
+		f += lens[i];
 		*f++ = ' ';
-		s = s->n;
-		step = strlen(s->w);
-		memcpy(f, s->w, step);
-		f += step;
-	} while (s->n != NULL);
-	*f = '\0';
+	}
+	f[-1] = '\0';
 	return r;
 }
 
-static List *count(List *l) {
+static List *count(List *l, int nel) {
 	List *s = nnew(List);
-	s->w = nprint("%d", listnel(l));
+	s->w = nprint("%d", nel != -1 ? nel : listnel(l));
 	s->n = NULL;
 	s->m = NULL;
 	return s;
@@ -176,77 +220,37 @@ extern void assign(List *s1, List *s2, bool stack) {
    who could not stand the incompetence of my own backquote implementation.
 */
 
-#define BUFSIZE	((size_t) 1000)
+/*
+   The output is read in its entirety into a buffer in the arena, and
+   then split in place, so that every byte is copied at most once (and
+   usually not at all) no matter how long the words are.
+*/
 
 static List *bqinput(List *ifs, int fd) {
-	char *end, *bufend, *s;
-	List *r, *top, *prev;
-	size_t remain, bufsize;
-	char isifs[256];
-	int n, state; /* a simple FSA is used to read in data */
-
-	memzero(isifs, sizeof isifs);
-	for (isifs['\0'] = TRUE; ifs != NULL; ifs = ifs->n)
-		for (s = ifs->w; *s != '\0'; s++)
-			isifs[*(unsigned char *)s] = TRUE;
-	remain = bufsize = BUFSIZE;
-	top = r = nnew(List);
-	r->w = end = nalloc(bufsize + 1);
-	r->m = NULL;
-	state = 0;
-	prev = NULL;
+	char *buf;
+	size_t len, bufsize;
+	Ifs sep;
+	int n;
 
+	mkifs(&sep, ifs);
+	buf = nbuf(&bufsize);
+	len = 0;
 	while (1) {
-		if (remain == 0) { /* is the string bigger than the buffer? */
-			size_t m = end - r->w;
-			char *buf;
-			while (bufsize < m + BUFSIZE)
-				bufsize *= 2;
-			buf = nalloc(bufsize + 1);
-			memcpy(buf, r->w, m);
-			r->w = buf;
-			end = &buf[m];
-			remain = bufsize - m;
-		}
-		if ((n = rc_read(fd, end, remain)) <= 0) {
+		if (len == bufsize)
+			buf = nbufgrow(buf, len, &bufsize);
+		if ((n = rc_read(fd, &buf[len], bufsize - len)) <= 0) {
 			if (n == 0)
 	/* break */		break;
-			else if (errno == EINTR)
+			nbufdone(buf, 0);
+			if (errno == EINTR)
 				return NULL; /* interrupted, wait for subproc */
-			else {
-				uerror("backquote read");
-				rc_error(NULL);
-			}
+			uerror("backquote read");
+			rc_error(NULL);
 		}
-		remain -= n;
-		for (bufend = &end[n]; end < bufend; end++)
-			if (state == 0) {
-				if (!isifs[*(unsigned char *)end]) {
-					state = 1;
-					r->w = end;
-					r->m = NULL;
-				}
-			} else {
-				if (isifs[*(unsigned char *)end]) {
-					state = 0;
-					*end = '\0';
-					prev = r;
-					r = r->n = nnew(List);
-					r->w = end+1;
-					r->m = NULL;
-				}
-			}
+		len += n;
 	}
-	if (state == 1) { /* terminate last string */
-		*end = '\0';
-		r->n = NULL;
-	} else {
-		if (prev == NULL) /* no input at all? */
-			top = NULL;
-		else
-			prev->n = NULL; /* else terminate list */
-	}
-	return top;
+	nbufdone(buf, len + 1); /* one byte more, to terminate the last word */
+	return ifssplit(&sep, buf, len);
 }
 
 static List *backq(Node *ifs, Node *n) {
@@ -296,17 +300,25 @@ extern void qredir(Node *n) {
 }
 
 #if HAVE_DEV_FD || HAVE_PROC_SELF_FD
+/*
+   The pipe is close-on-exec, so that rc's end of it reaches only the
+   command it is an argument to: pop_cmdarg() clears the flag in the
+   child that runs that command. Other commands started meanwhile, such
+   as the writers of further <{} arguments, do not hold it open.
+*/
+
 static List *mkcmdarg(Node *n) {
 	char *name;
 	List *ret = nnew(List);
 	Estack *e = nnew(Estack);
 	Edata efd;
 	int p[2];
-	if (pipe(p) < 0) {
+	if (rc_pipe(p) < 0) {
 		uerror("pipe");
 		return NULL;
 	}
 	if (rc_fork() == 0) {
+		pop_cmdarg(TRUE); /* other <{} arguments are not for this command */
 		setsigdefaults(FALSE);
 		if (mvfd(p[n->u[0].i == rFrom], n->u[0].i == rFrom) < 0) /* stupid hack */
 			exit(1);
@@ -385,17 +397,22 @@ static List *mkcmdarg(Node *n) {
 extern List *glom(Node *n) {
 	List *v, *head, *tail;
 	Node *words;
+	int nel;
 	if (n == NULL)
 		return NULL;
 	switch (n->type) {
 	case nArgs:
 	case nLappend:
+		if (n->u[2].l != NULL)
+			return n->u[2].l; /* literal; see treelit() */
 		words = n->u[0].p;
 		tail = NULL;
-		while (words != NULL && (words->type == nArgs || words->type == nLappend)) {
+		while (words != NULL && (words->type == nArgs || words->type == nLappend) && words->u[2].l == NULL) {
 			if (words->u[1].p != NULL && words->u[1].p->type != nWord)
 				break;
-			head = glom(words->u[1].p);
+			head = NULL; /* not glom(), whose value for a literal word is shared */
+			if (words->u[1].p != NULL)
+				head = word(words->u[1].p->u[0].s, words->u[1].p->u[1].s);
 			if (head != NULL) {
 				head->n = tail;
 				tail = head;
@@ -414,6 +431,8 @@ extern List *glom(Node *n) {
 		qredir(n);
 		return NULL;
 	case nWord:
+		if (n->u[3].l != NULL)
+			return n->u[3].l;
 		return word(n->u[0].s, n->u[1].s);
 	case nNmpipe:
 		return mkcmdarg(n);
@@ -429,20 +448,24 @@ extern List *glom(Node *n) {
 			rc_error("multi-word variable name");
 		if (*v->w == '\0')
 			rc_error("zero-length variable name");
-		v = (*v->w == '*' && v->w[1] == '\0') ? varlookup(v->w)->n : varlookup(v->w);
+		if (*v->w == '*' && v->w[1] == '\0') {
+			v = varlookup_vec(v->w, &nel)->n; /* $* is a vector, so this is too */
+			--nel;
+		} else
+			v = varlookup_vec(v->w, &nel);
 		switch (n->type) {
 		default:
 			panic("unexpected node in glom");
 			exit(1);
 			/* NOTREACHED */
 		case nCount:
-			return count(v);
+			return count(v, nel);
 		case nFlat:
 			return flatten(v);
 		case nVar:
 			return v;
 		case nVarsub:
-			return varsub(v, glom(n->u[1].p));
+			return varsub(v, nel, glom(n->u[1].p));
 		}
 	}
 }
@@ -9,23 +9,50 @@
 */
 
 #include "rc.h"
+
+#include <stdio.h>
+
 #include "sigmsgs.h"
 
 static bool var_exportable(char *);
 static bool fn_exportable(char *);
-static int hash(char *, int);
+static unsigned int hash(char *, size_t *);
 static int find(char *, Htab *, int);
+static int findslot(char *, Htab *, int);
 static void free_fn(rc_Function *);
+static void growhash(Htab *, int);
 
 Htab *fp;
 Htab *vp;
 static int fused, fsize, vused, vsize;
-static char **env;
+static char **env, **bozo;
 static int bozosize;
 static int envsize;
 static bool env_dirty = TRUE;
 static char *dead = "";
 
+/*
+   Slots whose exported value changed since env was last built. As long
+   as no name has been added to or removed from the environment, makeenv()
+   just swaps the new strings into place; a value change cannot move an
+   entry, since the sort order is decided at or before the '='.
+*/
+
+#define MAXPATCH 32
+static struct { bool fn; int h; } patch[MAXPATCH];
+static int npatch;
+
+static void envchange(bool fn, int h) {
+	if (env_dirty)
+		return;
+	if (npatch == MAXPATCH) {
+		env_dirty = TRUE;
+		return;
+	}
+	patch[npatch].fn = fn;
+	patch[npatch++].h = h;
+}
+
 #define HASHSIZE 64 /* rc was debugged with HASHSIZE == 2; 64 is about right for normal use */
 
 extern void inithash() {
@@ -41,9 +68,14 @@ extern void inithash() {
 
 #define ADV()   {if ((c = *s++) == '\0') break;}
 
-/* hash function courtesy of paul haahr */
+/*
+   hash function courtesy of paul haahr. The full hash value is kept in
+   each slot (along with the length of the name), so that probes and
+   rehashes can reject mismatches without calling strcmp().
+*/
 
-static int hash(char *s, int size) {
+static unsigned int hash(char *s, size_t *lenp) {
+	char *s0 = s;
 	int c, n = 0;
 	while (1) {
 		ADV();
@@ -55,38 +87,40 @@ static int hash(char *s, int size) {
 		ADV();
 		n -= (c << 16) | (c << 9) | (c << 2) | (c & 3);
 	}
+	*lenp = s - s0 - 1;
 	if (n < 0)
 		n = ~n;
-	return n & (size - 1); /* need power of 2 size */
+	return (unsigned int) n;
 }
 
-static bool rehash(Htab *ht) {
-	int i, j, size;
-	int newsize, newused;
+/*
+   Rebuild a table, dropping dead entries. The new size is the smallest
+   power of 2 that keeps the live entries under a quarter full, so a
+   table full of tombstones is compacted rather than doubled.
+*/
+
+static void growhash(Htab *ht, int want) {
+	int i, j, size, newsize, newused;
 	Htab *newhtab;
-	if (ht == fp) {
-		if (fsize > 2 * fused)
-			return FALSE;
-		size = fsize;
-	} else {
-		if (vsize > 2 * vused)
-			return FALSE;
-		size = vsize;
-	}
-	newsize = 2 * size;
+	size = (ht == fp) ? fsize : vsize;
+	for (i = newused = 0; i < size; i++)
+		if (ht[i].name != NULL && ht[i].name != dead)
+			newused++;
+	if (want < newused)
+		want = newused;
+	for (newsize = HASHSIZE; newsize <= 4 * want; newsize *= 2)
+		;
 	newhtab = ealloc(newsize * sizeof(Htab));
 	for (i = 0; i < newsize; i++)
 		newhtab[i].name = NULL;
-	for (i = newused = 0; i < size; i++)
+	for (i = 0; i < size; i++)
 		if (ht[i].name != NULL && ht[i].name != dead) {
-			newused++;
-			j = hash(ht[i].name, newsize);
+			j = ht[i].h & (newsize - 1);
 			while (newhtab[j].name != NULL) {
 				j++;
 				j &= (newsize - 1);
 			}
-			newhtab[j].name = ht[i].name;
-			newhtab[j].p = ht[i].p;
+			newhtab[j] = ht[i];
 		}
 	if (ht == fp) {
 		fused = newused;
@@ -98,21 +132,53 @@ static bool rehash(Htab *ht) {
 		vsize = newsize;
 	}
 	efree(ht);
+}
+
+static bool rehash(Htab *ht) {
+	if (ht == fp) {
+		if (fsize > 2 * fused)
+			return FALSE;
+	} else {
+		if (vsize > 2 * vused)
+			return FALSE;
+	}
+	growhash(ht, 0);
 	return TRUE;
 }
 
 #define varfind(s) find(s, vp, vsize)
 #define fnfind(s) find(s, fp, fsize)
 
+/* find the slot holding s, or the empty slot that ends its probe sequence */
+
 static int find(char *s, Htab *ht, int size) {
-	int h = hash(s, size);
-	while (ht[h].name != NULL && !streq(ht[h].name, s)) {
+	size_t len;
+	unsigned int hv = hash(s, &len);
+	int h = hv & (size - 1);
+	while (ht[h].name != NULL &&
+			(ht[h].h != hv || ht[h].len != len || ht[h].name == dead || memcmp(ht[h].name, s, len) != 0)) {
 		h++;
 		h &= size - 1;
 	}
 	return h;
 }
 
+/* find a slot to insert s, which must not be in the table; dead slots are reused */
+
+static int findslot(char *s, Htab *ht, int size) {
+	size_t len;
+	unsigned int hv = hash(s, &len);
+	int h = hv & (size - 1);
+	while (ht[h].name != NULL && ht[h].name != dead) {
+		h++;
+		h &= size - 1;
+	}
+	ht[h].h = hv;
+	ht[h].len = len;
+	ht[h].envidx = -1;
+	return h;
+}
+
 extern void *lookup(char *s, Htab *ht) {
 	int h = find(s, ht, ht == fp ? fsize : vsize);
 	return (ht[h].name == NULL) ? NULL : ht[h].p;
@@ -120,15 +186,19 @@ extern void *lookup(char *s, Htab *ht) {
 
 extern rc_Function *get_fn_place(char *s) {
 	int h = fnfind(s);
-	env_dirty = TRUE;
 	if (fp[h].name == NULL) {
-		if (rehash(fp))
-			h = fnfind(s);
-		fused++;
+		env_dirty = TRUE;
+		rehash(fp);
+		h = findslot(s, fp, fsize);
+		if (fp[h].name == NULL)
+			fused++;
 		fp[h].name = ecpy(s);
 		fp[h].p = enew(rc_Function);
-	} else
+		memzero(fp[h].p, sizeof (rc_Function));
+	} else {
 		free_fn(fp[h].p);
+		envchange(TRUE, h);
+	}
 	return fp[h].p;
 }
 
@@ -136,25 +206,26 @@ extern Variable *get_var_place(char *s, bool stack) {
 	Variable *new;
 	int h = varfind(s);
 
-	env_dirty = TRUE;
-
 	if (vp[h].name == NULL) {
-		if (rehash(vp))
-			h = varfind(s);
-		vused++;
+		env_dirty = TRUE;
+		rehash(vp);
+		h = findslot(s, vp, vsize);
+		if (vp[h].name == NULL)
+			vused++;
 		vp[h].name = ecpy(s);
 		vp[h].p = enew(Variable);
 		((Variable *)vp[h].p)->n = NULL;
 		return vp[h].p;
 	} else {
+		envchange(FALSE, h);
 		if (stack) {	/* increase the stack by 1 */
 			new = enew(Variable);
 			new->n = vp[h].p;
 			return vp[h].p = new;
 		} else {	/* trample the top of the stack */
 			new = vp[h].p;
-			efree(new->extdef);
-			listfree(new->def);
+			extfree(new->extdef);
+			vecfree(new->vec);
 			return new;
 		}
 	}
@@ -181,19 +252,22 @@ extern void delete_var(char *s, bool stack) {
 	Variable *v;
 	if (vp[h].name == NULL)
 		return; /* not found */
-	env_dirty = TRUE;
 	v = vp[h].p;
-	efree(v->extdef);
-	listfree(v->def);
+	extfree(v->extdef);
+	vecfree(v->vec);
 	if (v->n != NULL) { /* This is the top of a stack */
+		envchange(FALSE, h);
 		if (stack) { /* pop */
 			vp[h].p = v->n;
 			efree(v);
 		} else { /* else just empty */
 			v->extdef = NULL;
+			v->vec = NULL;
 			v->def = NULL;
+			v->nel = 0;
 		}
 	} else { /* needs to be removed from the hash table */
+		env_dirty = TRUE;
 		efree(v);
 		vp[h].p = NULL;
 		efree(vp[h].name);
@@ -206,32 +280,101 @@ extern void delete_var(char *s, bool stack) {
 	}
 }
 
+/*
+   Function bodies which were replaced or deleted while they were being
+   executed; they are freed once no call is using them.
+*/
+
+static struct doomed {
+	Node *t;
+	struct doomed *n;
+} *doomed;
+
 static void free_fn(rc_Function *f) {
-	treefree(f->def);
-	efree(f->extdef);
+	struct doomed *d;
+	if (f->def != NULL && treebusy(f->def)) {
+		d = enew(struct doomed);
+		d->t = f->def;
+		d->n = doomed;
+		doomed = d;
+	} else {
+		treefree(f->def);
+	}
+	extfree(f->extdef);
+}
+
+extern void reaptrees() {
+	struct doomed **dp, *d;
+	for (dp = &doomed; (d = *dp) != NULL; )
+		if (treebusy(d->t)) {
+			dp = &d->n;
+		} else {
+			*dp = d->n;
+			treefree(d->t);
+			efree(d);
+		}
+}
+
+/*
+   The strings rc's environment was passed in are used in place, not
+   copied, so long as they lie end to end in one block, as execve() leaves
+   them. An imported value that is never looked at or changed costs only
+   its slot in the table; extcpy() and extfree() know not to copy or free
+   the strings of that block.
+*/
+
+static char *envlo, *envhi;
+
+extern char *extcpy(char *s) {
+	return s >= envlo && s < envhi ? s : ecpy(s);
+}
+
+extern void extfree(char *s) {
+	if ((s < envlo || s >= envhi) && !inlib(s))
+		efree(s);
 }
 
 extern void initenv(char **envp) {
-	int n;
-	for (n = 0; envp[n] != NULL; n++)
-		;
-	n++; /* one for the null terminator */
-	if (n < HASHSIZE)
-		n = HASHSIZE;
-	env = ealloc((envsize = 2 * n) * sizeof (char *));
+	int n, nfn;
+	char *end = NULL;
+	bool block = TRUE;
+	for (n = nfn = 0; envp[n] != NULL; n++) {
+		if (strncmp(envp[n], "fn_", conststrlen("fn_")) == 0)
+			nfn++;
+		if (end != NULL && envp[n] != end)
+			block = FALSE;
+		end = envp[n] + strlen(envp[n]) + 1;
+	}
+	if (block && n > 0) {
+		envlo = envp[0];
+		envhi = end;
+	}
+	/* presize the tables so that a large environment is imported without rehashing */
+	if (2 * (vused + n - nfn) >= vsize)
+		growhash(vp, vused + n - nfn);
+	if (2 * (fused + nfn) >= fsize)
+		growhash(fp, fused + nfn);
+	bozo = ealloc((n + 1) * sizeof (char *));
 	for (; *envp != NULL; envp++)
 		if (strncmp(*envp, "fn_", conststrlen("fn_")) == 0) {
 			if (!dashpee)
 				fnassign_string(*envp);
 		} else {
 			if (!varassign_string(*envp)) /* add to bozo env */
-				env[bozosize++] = *envp;
+				bozo[bozosize++] = *envp;
 		}
 }
 
+/* forget the strings from the environment that are not rc's; rfork e */
+
+extern void clearbozo() {
+	bozosize = 0;
+	env_dirty = TRUE;
+}
+
 static char *neverexport[] = {
-	"apid", "apids", "bqstatus", "cdpath", "home",
-	"ifs", "path", "pid", "status", "*"
+	"apid", "apids", "bqstatus", "cdpath", "cwd", "home",
+	"ifs", "path", "pid", "rcstats", "status", "timing", "*"
 };
 
 /* for a few variables that have default values, we export them only
@@ -249,12 +392,16 @@ static struct nameflag maybeexport[] = {
 void set_exportable(char *s, bool b) {
 	int i;
 	for (i = 0; i < arraysize(maybeexport); ++i)
-		if (maybeexport[i].flag != b && streq(s, maybeexport[i].name))
+		if (maybeexport[i].flag != b && streq(s, maybeexport[i].name)) {
 			maybeexport[i].flag = b;
+			env_dirty = TRUE;
+		}
 }
 
 static bool var_exportable(char *s) {
 	int i;
+	if (*s >= 'A' && *s <= 'Z')
+		return TRUE; /* as most of the environment is, and none of these */
 	for (i = 0; i < arraysize(neverexport); i++)
 		if (streq(s, neverexport[i]))
 			return FALSE;
@@ -276,34 +423,143 @@ static bool fn_exportable(char *s) {
 	return TRUE;
 }
 
+/*
+   Swap the current value of a changed slot into env. Returns FALSE if
+   the name has entered or left the environment, in which case env must
+   be rebuilt.
+*/
+
+static bool patchenv(bool fn, int h) {
+	Htab *t = fn ? &fp[h] : &vp[h];
+	char *v = NULL;
+	if (t->name == NULL || t->name == dead)
+		return FALSE;
+	if (fn) {
+		if (fn_exportable(t->name))
+			v = fnlookup_string(t->name);
+	} else {
+		if (var_exportable(t->name))
+			v = varlookup_string(t->name);
+	}
+	if (t->envidx < 0)
+		return v == NULL;
+	if (v == NULL)
+		return FALSE;
+	env[t->envidx] = v;
+	return TRUE;
+}
+
+/*
+   The exported strings are sorted along with the slots they came from,
+   so each slot learns where its string landed without a search after.
+*/
+
+typedef struct {
+	char *s;
+	Htab *t; /* NULL for the bozo env */
+} Envent;
+
+static Envent *ents;
+static int entsize;
+
+static int entcmp(const void *a, const void *b) {
+	return strcmp(((const Envent *) a)->s, ((const Envent *) b)->s);
+}
+
 extern char **makeenv() {
-	int ep, i;
+	int ep, i, n;
 	char *v;
-	if (!env_dirty)
-		return env;
+	double t;
+#if RC_DIST
+	ns_export();
+#endif
+	if (!env_dirty) {
+		for (i = 0; i < npatch; i++)
+			if (!patchenv(patch[i].fn, patch[i].h)) {
+				env_dirty = TRUE;
+				break;
+			}
+		npatch = 0;
+		if (!env_dirty)
+			return env;
+	}
+	t = tracenow();
 	env_dirty = FALSE;
-	ep = bozosize;
-	if (vsize + fsize + 1 + bozosize > envsize) {
-		envsize = 2 * (bozosize + vsize + fsize + 1);
+	npatch = 0;
+	n = bozosize + vsize + fsize;
+	if (n + 1 > envsize) {
+		envsize = 2 * (n + 1);
 		env = erealloc(env, envsize * sizeof(char *));
 	}
+	if (n > entsize)
+		ents = erealloc(ents, (entsize = 2 * n) * sizeof *ents);
+	for (ep = 0; ep < bozosize; ep++) {
+		ents[ep].s = bozo[ep];
+		ents[ep].t = NULL;
+	}
 	for (i = 0; i < vsize; i++) {
+		vp[i].envidx = -1;
 		if (vp[i].name == NULL || vp[i].name == dead || !var_exportable(vp[i].name))
 			continue;
-		v = varlookup_string(vp[i].name);
-		if (v != NULL)
-			env[ep++] = v;
+		if ((v = ((Variable *) vp[i].p)->extdef) == NULL && (v = varlookup_string(vp[i].name)) == NULL)
+			continue;
+		ents[ep].s = v;
+		ents[ep++].t = &vp[i];
 	}
 	for (i = 0; i < fsize; i++) {
+		fp[i].envidx = -1;
 		if (fp[i].name == NULL || fp[i].name == dead || !fn_exportable(fp[i].name))
 			continue;
-		env[ep++] = fnlookup_string(fp[i].name);
+		if ((v = ((rc_Function *) fp[i].p)->extdef) == NULL)
+			v = fnlookup_string(fp[i].name);
+		ents[ep].s = v;
+		ents[ep++].t = &fp[i];
+	}
+	qsort(ents, (size_t) ep, sizeof *ents, entcmp);
+	for (i = 0; i < ep; i++) {
+		env[i] = ents[i].s;
+		if (ents[i].t != NULL)
+			ents[i].t->envidx = i;
 	}
 	env[ep] = NULL;
-	qsort(env, (size_t) ep, sizeof(char *), starstrcmp);
+	trace("env", "makeenv", t);
 	return env;
 }
 
+/* whatis -t: the functions that have been called, the longest running first */
+
+static int profcmp(const void *a, const void *b) {
+	rc_Function *f = ((Htab *) a)->p, *g = ((Htab *) b)->p;
+	return f->total < g->total ? 1 : f->total > g->total ? -1 : 0;
+}
+
+extern void whatare_profiles(char **names) {
+	Htab *t;
+	rc_Function *f;
+	char line[128];
+	int i, n;
+	t = ealloc((fsize + 1) * sizeof *t);
+	n = 0;
+	if (*names == NULL) {
+		for (i = 0; i < fsize; i++)
+			if (fp[i].name != NULL && fp[i].name != dead && ((rc_Function *) fp[i].p)->calls > 0)
+				t[n++] = fp[i];
+	} else {
+		for (; *names != NULL; names++)
+			if ((i = fnfind(*names)) >= 0 && fp[i].name != NULL)
+				t[n++] = fp[i];
+	}
+	qsort(t, (size_t) n, sizeof *t, profcmp);
+	fprint(1, "%8s %12s %12s %12s  %s\n", "calls", "total ms", "self ms", "child cpu ms", "function");
+	for (i = 0; i < n; i++) {
+		f = t[i].p;
+		snprintf(line, sizeof line, "%8lu %12.3f %12.3f %12.3f", f->calls,
+			f->total / 1e3, f->self / 1e3, f->cpu / 1e3);
+		fprint(1, "%s  %S\n", line, t[i].name);
+	}
+	efree(t);
+}
+
 extern void whatare_all_vars(bool showfn, bool showvar) {
 	int i;
 	List *s;
@@ -317,6 +573,19 @@ extern void whatare_all_vars(bool showfn, bool showvar) {
 				prettyprint_fn(1, fp[i].name, fnlookup(fp[i].name));
 }
 
+/* the names of the functions, in nalloc space */
+
+extern char **fnnames() {
+	char **names;
+	int i, n;
+	names = nalloc((fused + 1) * sizeof *names);
+	for (i = n = 0; i < fsize; i++)
+		if (fp[i].name != NULL && fp[i].name != dead)
+			names[n++] = fp[i].name;
+	names[n] = NULL;
+	return names;
+}
+
 extern char *compl_name(const char *text, int state, char **p, size_t count, ssize_t inc) {
 	static char **n;
 	static size_t i, len;
@@ -14,61 +14,46 @@ struct Hq {
 static bool dead = FALSE;
 
 /*
- * read in a heredocument. A clever trick: skip over any partially matched end-of-file
- * marker storing only the number of characters matched. If the whole marker is matched,
- * return from readheredoc(). If only part of the marker is matched, copy that part into
- * the heredocument.
+ * read in a heredocument. Input is taken a line (or as much of a line as
+ * the input buffer holds) at a time, and appended to a single growing
+ * buffer in the arena. Once a line is complete it is compared with the
+ * end-of-file marker; if it matches, it is dropped and the document is
+ * done. A marker at end of input, without a newline, also counts.
  *
- * BUG: if the eof string contains a newline, the state can get confused, and the
- * heredoc may continue past where it should.  on the other hand, /bin/sh seems to
- * never get out of its readheredoc() when the heredoc string contains a newline
+ * BUG: an eof string containing a newline can never match.  on the other
+ * hand, /bin/sh seems to never get out of its readheredoc() when the
+ * heredoc string contains a newline
  */
 
 static char *readheredoc(char *eof) {
-	int c;
-	char *t, *buf, *bufend;
-	unsigned char *s;
-	size_t bufsize;
-	t = buf = nalloc(bufsize = 512);
-	bufend = &buf[bufsize];
+	char *buf, *line;
+	size_t bufsize, len, bol, n, eoflen = strlen(eof);
 	dead = FALSE;
-#define	RESIZE(extra) { \
-		char *nbuf; \
-		bufsize = bufsize * 2 + extra; \
-		nbuf = nalloc(bufsize); \
-		memcpy(nbuf, buf, (size_t) (t - buf)); \
-		t = nbuf + (t - buf); \
-		buf = nbuf; \
-		bufend = &buf[bufsize]; \
-	}
+	buf = nbuf(&bufsize);
+	len = 0;
 	for (;;) {
 		nextline();
-		for (s = (unsigned char *) eof; (c = gchar()) == *s; s++)
-			;
-		if (*s == '\0' && (c == '\n' || c == EOF)) {
-			*t++ = '\0';
-			return buf;
-		}
-		if (s != (unsigned char *) eof) {
-			size_t len = s - (unsigned char *) eof;
-			if (t + len >= bufend)
-				RESIZE(len);
-			memcpy(t, eof, len);
-			t += len;
-		}
-		for (;; c = gchar()) {
-			if (c == EOF) {
+		bol = len;
+		do {
+			if ((line = gline(&n)) == NULL) {
+				if (len - bol == eoflen && memcmp(&buf[bol], eof, eoflen) == 0)
+					goto done;
+				nbufdone(buf, 0);
 				yyerror("heredoc incomplete");
 				dead = TRUE;
 				return NULL;
 			}
-			if (t + 1 >= bufend)
-				RESIZE(0);
-			*t++ = c;
-			if (c == '\n')
-				break;
-		}
+			while (len + n > bufsize)
+				buf = nbufgrow(buf, len, &bufsize);
+			memcpy(&buf[len], line, n);
+			len += n;
+		} while (buf[len - 1] != '\n');
+		if (len - bol == eoflen + 1 && memcmp(&buf[bol], eof, eoflen) == 0)
+			break;
 	}
+done:	buf[bol] = '\0';
+	nbufdone(buf, bol + 1);
+	return buf;
 }
 
 /* parseheredoc -- turn a heredoc with variable references into a node chain */
@@ -19,6 +19,10 @@
 #include "rc.h"
 
 #include <stdio.h>
+#include <sys/stat.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #define CHUNKSIZE 65536
 
@@ -191,10 +195,21 @@ start:
 	}
 }
 
+/*
+   The history file is mapped rather than read, where that is possible, so
+   that only the pages getcommand() scans back through are ever touched: a
+   lookup costs the distance back to the command it finds, not the size of
+   the file. The mapping is private, so getcommand() may still write its
+   terminators into it.
+*/
+
 static char *readhistoryfile(char **last) {
 	char *buf;
 	size_t count, size;
 	long nread;
+#if HAVE_MMAP
+	struct stat st;
+#endif
 
 	if ((history = getenv("history")) == NULL) {
 		fprintf(stderr, "$history not set\n");
@@ -205,6 +220,23 @@ static char *readhistoryfile(char **last) {
 		perror(history);
 		exit(1);
 	}
+#if HAVE_MMAP
+	if (fstat(fileno(histfile), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		/* the file goes a page in, so that the sentinel can go just before it */
+		size_t page = sysconf(_SC_PAGESIZE);
+		buf = mmap(NULL, page + st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+		if (buf != MAP_FAILED) {
+			if (mmap(buf + page, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_FIXED,
+					fileno(histfile), 0) != MAP_FAILED) {
+				buf += page - 1;
+				buf[0] = '\0'; /* sentinel */
+				*last = buf + 1 + st.st_size;
+				return buf;
+			}
+			munmap(buf, page + st.st_size);
+		}
+	}
+#endif
 
 	size = CHUNKSIZE;
 	buf = ealloc(size);
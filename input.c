@@ -3,6 +3,11 @@
 #include "rc.h"
 
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 #include "edit.h"
 #include "input.h"
@@ -16,14 +21,15 @@
 enum { UNGETSIZE = 2 };
 
 typedef enum inputtype {
-	iFd, iString, iEdit
+	iFd, iString, iEdit, iMap
 } inputtype;
 
 typedef struct Input {
 	bool saved;
 	inputtype t;
 	int fd, index, read, ungetcount, lineno, last;
-	char *ibuf;
+	size_t maplen, pclen, pcoff;
+	char *ibuf, *pc;
 	void *cookie;
 	int ungetbuf[UNGETSIZE];
 	int (*gchar)(void);
@@ -65,6 +71,96 @@ static int stringgchar() {
 }
 
 
+/*
+   Return the rest of the current line of input, up to and including the
+   newline if it is in the buffer already, setting *lenp to its length;
+   NULL at EOF. This is a shortcut past gchar() for readers (such as the
+   heredoc reader) which want whole lines. The text is only valid until
+   the next read from the input.
+*/
+
+extern char *gline(size_t *lenp) {
+	static char one;
+	char *s, *nl;
+	size_t n;
+	int c;
+	if (istack != itop && istack->ungetcount == 0) {
+		s = &inbuf[chars_out];
+		if (istack->t == iString) {
+			n = strcspn(s, "\n");
+			if (s[n] == '\n')
+				n++;
+		} else {
+			n = (chars_out < chars_in) ? chars_in - chars_out : 0;
+			if ((nl = memchr(s, '\n', n)) != NULL)
+				n = nl - s + 1;
+			if (memchr(s, '\0', n) != NULL)
+				n = 0; /* let gchar() complain about it */
+		}
+		if (n > 0) {
+			chars_out += n;
+			lastchar = s[n - 1];
+			*lenp = n;
+			return s;
+		}
+	}
+	if ((c = gchar()) == EOF)
+		return NULL;
+	one = c;
+	*lenp = 1;
+	return &one;
+}
+
+/*
+   Return the longest run of characters at the head of the input buffer
+   for which stop[] is zero, setting *lenp to its length; or NULL if
+   there is none, in which case the next character must be read with
+   gchar(). This lets the lexer take a whole word at once. '\0' always
+   stops the run, so that gchar() gets to complain about it.
+*/
+
+extern char *gspan(const char *stop, size_t *lenp) {
+	char *s, *t, *end;
+	if (istack == itop || istack->ungetcount != 0)
+		return NULL;
+	s = &inbuf[chars_out];
+	if (istack->t == iString) {
+		for (t = s; *t != '\0' && !stop[*(unsigned char *) t]; t++)
+			;
+	} else {
+		if (chars_out >= chars_in)
+			return NULL;
+		for (t = s, end = &inbuf[chars_in]; t < end && *t != '\0' && !stop[*(unsigned char *) t]; t++)
+			;
+	}
+	if (t == s)
+		return NULL;
+	chars_out += t - s;
+	lastchar = t[-1];
+	*lenp = t - s;
+	return s;
+}
+
+/*
+   The history file is kept open (well above the descriptors scripts
+   use), so that a prompt costs one write rather than an open, a write
+   and a close; on a networked home directory the open and close are
+   round trips. It is opened with O_APPEND, and each command goes in a
+   single write, so shells sharing one file do not mix up their lines.
+   A relative $history is opened afresh each time, since it depends on
+   the current directory.
+*/
+
+#define HISTFD 64
+
+static int histfd = -1;
+
+extern void histclose() {
+	if (histfd >= 0)
+		close(histfd);
+	histfd = -1;
+}
+
 /* write last command out to a file if interactive && $history is set */
 
 static void history() {
@@ -84,13 +180,17 @@ static void history() {
 		/* line matches [ \t]*[^#\n] so it's ok to write out */
 		if (c != ' ' && c != '\t') {
 			char *name = hist->w;
-			int fd = rc_open(name, rAppend);
-			if (fd < 0)
+			int fd = histfd;
+			if (fd < 0 && (fd = rc_open(name, rAppend)) < 0) {
 				uerror(name);
-			else {
-				writeall(fd, inbuf, chars_in);
-				close(fd);
+				break;
 			}
+			writeall(fd, inbuf, chars_in);
+			if (fd == histfd)
+				break;
+			if (isabsolute(name) && (histfd = fcntl(fd, F_DUPFD, HISTFD)) >= 0)
+				closeonexec(histfd);
+			close(fd);
 			break;
 		}
 	}
@@ -102,7 +202,12 @@ static void history() {
 static int fdgchar() {
 	if (chars_out >= chars_in) { /* replenish empty buffer */
 		ssize_t r;
+		flushout();
 		do {
+			if (interactive) {
+				sigpoll(istack->fd);
+				sigchk();
+			}
 			r = rc_read(istack->fd, inbuf, BUFSIZE);
 			sigchk();
 			if (r == -1)
@@ -136,11 +241,94 @@ static int fdgchar() {
 	return lastchar = inbuf[chars_out++];
 }
 
+#if HAVE_MMAP
+/*
+   Read a character from a mapped script. The whole of the mapping is
+   the input buffer, so there is nothing to read; but with -v the
+   buffer is let out a line at a time, so that each command is echoed
+   just before it runs, as it would be if it were read().
+*/
+
+static int mapgchar() {
+	if (chars_out >= chars_in) {
+		char *nl;
+		if (chars_in >= istack->maplen)
+			return lastchar = EOF;
+		if (dashvee && (nl = memchr(&inbuf[chars_in], '\n', istack->maplen - chars_in)) != NULL)
+			chars_in = nl - inbuf + 1;
+		else
+			chars_in = istack->maplen;
+		if (dashvee)
+			writeall(2, &inbuf[chars_out], chars_in - chars_out);
+	}
+
+	return lastchar = inbuf[chars_out++];
+}
+
+/*
+   Map fd if it is a regular file, returning the mapping or NULL. Standard
+   input is left alone, since commands in the script may want the rest
+   of it; and so are interactive scripts, which keep their history.
+*/
+
+static char *mapfd(int fd, size_t *lenp, size_t *offp) {
+	struct stat st;
+	off_t off;
+	char *m;
+	if (fd == 0 || interactive || fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+		return NULL;
+	if ((off = lseek(fd, 0, SEEK_CUR)) < 0 || off >= st.st_size || (off_t) (size_t) st.st_size != st.st_size)
+		return NULL;
+	if ((m = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+		return NULL;
+	*lenp = st.st_size;
+	*offp = off;
+	return m;
+}
+
+/*
+   Parse the whole of a mapped script up front, for the parse cache. If
+   it does not parse cleanly, it is put back to be read as usual, so that
+   the commands before the error are run before the error is reported.
+*/
+
+static void preparse(int fd) {
+	size_t start;
+	bool ok;
+	if (dashvee || dashen || !pcachefind(fd, &istack->pc, &istack->pclen))
+		return;
+	istack->pcoff = 0;
+	if (istack->pc != NULL)
+		return;
+	start = chars_out;
+	if (memchr(&inbuf[start], '\0', istack->maplen - start) != NULL)
+		ok = FALSE; /* let gchar() warn about it */
+	else {
+		quietparse = TRUE;
+		do {
+			Edata block;
+			Estack e;
+			block.b = newblock();
+			except(eArena, block, &e);
+			inityy();
+			if ((ok = (yyparse() == 0)) && parsetree != NULL)
+				pcacheadd(parsetree, lineno);
+			unexcept(eArena);
+		} while (ok && lastchar != EOF);
+		quietparse = FALSE;
+	}
+	pcachesave(fd, ok, &istack->pc, &istack->pclen);
+	chars_out = chars_in = start;
+	lineno = 1;
+}
+#endif
+
 /* read a character from a line-editing file descriptor */
 
 static int editgchar() {
 	if (chars_out >= chars_in) { /* replenish empty buffer */
 		edit_free(istack->cookie);
+		flushout();
 		inbuf = edit_alloc(istack->cookie, &chars_in);
 		if (inbuf == NULL) {
 			chars_in = 0;
@@ -190,9 +378,14 @@ static void pushcommon() {
 	chars_out = 0;
 	chars_in = 0;
 	istack->ungetcount = 0;
+	istack->pc = NULL;
 }
 
 extern void pushfd(int fd) {
+#if HAVE_MMAP
+	char *m;
+	size_t len, off;
+#endif
 	pushcommon();
 	save_lineno = TRUE;
 	istack->fd = fd;
@@ -201,11 +394,24 @@ extern void pushfd(int fd) {
 		istack->t = iEdit;
 		istack->gchar = editgchar;
 		istack->cookie = edit_begin(fd);
+#if HAVE_MMAP
+	} else if ((m = mapfd(fd, &len, &off)) != NULL) {
+		istack->t = iMap;
+		istack->gchar = mapgchar;
+		istack->maplen = len;
+		inbuf = m;
+		chars_out = chars_in = off;
+		preparse(fd);
+#endif
 	} else {
 		istack->t = iFd;
 		istack->gchar = fdgchar;
 		inbuf = ealloc(BUFSIZE);
 	}
+#if HAVE_POSIX_SPAWN
+	if (istack->t != iEdit && fd > 2) /* closefds() is not run for commands started by rc_spawn() */
+		closeonexec(fd);
+#endif
 }
 
 extern void pushstring(char **a, bool save) {
@@ -226,9 +432,15 @@ extern void pushstring(char **a, bool save) {
 extern void popinput() {
 	if (istack->t == iEdit)
 		edit_end(istack->cookie);
-	if (istack->t == iFd || istack->t == iEdit)
+	if (istack->t == iFd || istack->t == iEdit || istack->t == iMap)
 		close(istack->fd);
+#if HAVE_MMAP
+	if (istack->t == iMap)
+		munmap(inbuf, istack->maplen);
+	else
+#endif
 	efree(inbuf);
+	efree(istack->pc);
 	--istack;
 	lastchar = istack->last;
 	inbuf = istack->ibuf;
@@ -306,8 +518,14 @@ extern Node *doit(bool clobberexecit) {
 				edit_prompt(istack->cookie, prompt);
 		}
 		inityy();
-		if (yyparse() == 1 && (execit || dashen))
+		if (istack->pc != NULL) { /* the script came from the parse cache */
+			parsetree = NULL;
+			if (istack->pcoff < istack->pclen)
+				parsetree = pcachetree(istack->pc, istack->pclen, &istack->pcoff, &lineno);
+			lastchar = (istack->pcoff < istack->pclen) ? '\n' : EOF;
+		} else if (yyparse() == 1 && (execit || dashen))
 			rc_raise(eError);
+		treelit(parsetree, nalloc);
 		eof = (lastchar == EOF); /* "lastchar" can be clobbered during a walk() */
 		if (parsetree != NULL) {
 #if RC_DEVELOP
@@ -346,10 +564,20 @@ extern Node *parseline(char *extdef) {
 extern void closefds() {
 	Input *i;
 	for (i = istack; i != itop; --i)	/* close open scripts */
-		if (i->t == iFd && i->fd > 2) {
+		if ((i->t == iFd || i->t == iMap) && i->fd > 2) {
 			close(i->fd);
 			i->fd = -1;
 		}
+	histclose();
+}
+
+extern int inputfds(int *fds, int n) {
+	Input *i;
+	int k = 0;
+	for (i = istack; i != itop && k < n; --i)
+		if ((i->t == iFd || i->t == iMap) && i->fd > 2)
+			fds[k++] = i->fd;
+	return k;
 }
 
 /* print (or set) prompt(2) */
@@ -13,6 +13,12 @@ extern void popinput(void);
 extern int gchar(void);
 extern void ugchar(int);
 
+/* get the rest of the current line */
+extern char *gline(size_t *);
+
+/* get a run of characters not in a stop table */
+extern char *gspan(const char *, size_t *);
+
 /* $TERM or $TERMCAP has changed */
 extern void termchange(void);
 
@@ -31,5 +37,11 @@ extern void nextline(void);
 /* close all file descriptors on the stack */
 extern void closefds(void);
 
+/* the file descriptors on the stack above 2, at most n of them */
+extern int inputfds(int *, int);
+
+/* let go of the history file, e.g., when $history changes */
+extern void histclose(void);
+
 /* the last character read */
 extern int lastchar;
@@ -71,10 +71,20 @@ const char q[] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 };
 
+/* stop tables for gspan(): the end of a comment, and of a quoted string */
+static const char nltab[256] = {
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1
+};
+static const char qtab[256] = {
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 1
+};
+
 static size_t bufsize = BUFSIZE;
 static char *realbuf = NULL;
 static bool newline = FALSE;
 static bool errset = FALSE;
+bool quietparse = FALSE;	/* for a trial parse: yyerror() says nothing */
 static bool prerror = FALSE;
 static wordstates w = NW;
 static int fd_left, fd_right;
@@ -99,9 +109,9 @@ extern bool quotep(char *s, bool dollar) {
 
 extern int yylex() {
 	static bool dollar = FALSE;
-	bool saw_meta = FALSE;
 	int c;
-	size_t i;			/* The purpose of all these local assignments is to	*/
+	char *s;
+	size_t i, n;			/* The purpose of all these local assignments is to	*/
 	const char *meta;		/* allow optimizing compilers like gcc to load these	*/
 	char *buf = realbuf;		/* values into registers. On a sparc this is a		*/
 	YYSTYPE *y = &yylval;		/* win, in code size *and* execution time		*/
@@ -127,10 +137,14 @@ top:	while ((c = gchar()) == ' ' || c == '\t')
 		i = 0;
 	read:	do {
 			buf[i++] = c;
-			if (c == '?' || c == '[' || c == '*')
-				saw_meta = TRUE;
 			if (i >= bufsize)
 				buf = realbuf = erealloc(buf, bufsize *= 2);
+			while ((s = gspan(meta, &n)) != NULL) { /* take the rest of the word wholesale */
+				while (i + n >= bufsize)
+					buf = realbuf = erealloc(buf, bufsize *= 2);
+				memcpy(&buf[i], s, n);
+				i += n;
+			}
 		} while ((c = gchar()) != EOF && !meta[(unsigned char) c]);
 		while (c == '\\') {
 			if ((c = gchar()) == '\n') {
@@ -166,8 +180,8 @@ top:	while ((c = gchar()) == ' ' || c == '\t')
 		if (streq(buf, "case")) return CASE;
 		w = RW;
 		y->word.w = ncpy(buf);
-		if (saw_meta) {
-			char *r, *s;
+		if (strpbrk(buf, "?[*") != NULL) {
+			char *r;
 
 			y->word.m = nalloc(strlen(buf) + 1);
 			for (r = buf, s = y->word.m; *r != '\0'; r++, s++)
@@ -220,6 +234,12 @@ top:	while ((c = gchar()) == ' ' || c == '\t')
 			}
 			if (i >= bufsize)
 				buf = realbuf = erealloc(buf, bufsize *= 2);
+			while ((s = gspan(qtab, &n)) != NULL) {
+				while (i + n >= bufsize)
+					buf = realbuf = erealloc(buf, bufsize *= 2);
+				memcpy(&buf[i], s, n);
+				i += n;
+			}
 		}
 		ugchar(c);
 		buf[i] = '\0';
@@ -244,9 +264,12 @@ top:	while ((c = gchar()) == ' ' || c == '\t')
 		w = NW;
 		return c;
 	case '#':
-		while ((c = gchar()) != '\n') /* skip comment until newline */
-			if (c == EOF)
-				return END;
+		do
+			while (gspan(nltab, &n) != NULL)
+				; /* skip comment until newline */
+		while ((c = gchar()) != '\n' && c != EOF);
+		if (c == EOF)
+			return END;
 		/* FALLTHROUGH */
 	case '\n':
 		lineno++;
@@ -334,6 +357,8 @@ extern void yyerror(const char *s) {
 		prerror = FALSE;
 		return;
 	}
+	if (quietparse)
+		return;
 	if (!interactive) {
 		if (w != NW)
 			tok = realbuf;
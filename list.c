@@ -55,3 +55,37 @@ extern int listnel(List *s) {
 		nel++;
 	return nel;
 }
+
+/*
+   Copy list into a single block of malloc space, laid out as a vector:
+   the cells are contiguous, so that element i is at l[i], and the words
+   follow them. Variables are stored this way, so that $#x and $x(i) do
+   not have to walk the list. The vector is immutable, so that variables
+   may share it; free it with vecfree().
+*/
+
+extern Vec *listvec(List *s, int *nel) {
+	Vec *v;
+	List *r;
+	size_t size, len;
+	char *w;
+	int n;
+	for (n = 0, size = 0, r = s; r != NULL; r = r->n, n++)
+		size += strlen(r->w) + 1;
+	*nel = n;
+	if (n == 0)
+		return NULL;
+	v = ealloc(offsetof(Vec, l) + n * sizeof (List) + size);
+	v->refs = 1;
+	w = (char *) &v->l[n];
+	for (r = v->l; s != NULL; s = s->n, r++) {
+		len = strlen(s->w) + 1;
+		memcpy(w, s->w, len);
+		r->w = w;
+		r->m = NULL;
+		r->n = r + 1;
+		w += len;
+	}
+	v->l[n - 1].n = NULL;
+	return v;
+}
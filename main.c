@@ -11,7 +11,7 @@
 extern char **environ;
 
 bool dashdee, dashee, dasheye, dashell, dashen;
-bool dashpee, dashoh, dashess, dashvee, dashex;
+bool dashpee, dashoh, dashess, dashvee, dashex, dashtee;
 bool interactive;
 static bool dashEYE;
 char *dashsee[2];
@@ -23,13 +23,16 @@ static void checkfd(int, enum redirtype);
 
 extern int main(int argc, char *argv[], char *envp[]) {
 	char *dollarzero, *null[1];
+	double t;
 	int c;
 	initprint();
+	atexit(flushout); /* see fprint() */
+	atexit(traceflush);
 	dashsee[0] = dashsee[1] = NULL;
 	dollarzero = argv[0];
 	rc_pid = getpid();
 	dashell = (*argv[0] == '-'); /* Unix tradition */
-	while ((c = rc_getopt(argc, argv, "c:deiIlnopsvx")) != -1)
+	while ((c = rc_getopt(argc, argv, "c:deiIlnopsTvx")) != -1)
 		switch (c) {
 		case 'c':
 			dashsee[0] = rc_optarg;
@@ -62,6 +65,9 @@ extern int main(int argc, char *argv[], char *envp[]) {
 		case 's':
 			dashess = TRUE;
 			break;
+		case 'T':
+			dashtee = TRUE;
+			break;
 		case 'v':
 			dashvee = TRUE;
 			break;
@@ -95,7 +101,13 @@ quitopts:
 	assigndefault("prompt", "; ", "", (void *)0);
 	assigndefault("tab", "\t", (void *)0);
 	assigndefault("version", VERSION, (void *)0);
+	t = tracenow();
 	initenv(envp);
+	trace("startup", "initenv", t);
+	libinit();
+#if RC_DIST
+	dist_init();
+#endif
 	initinput();
 	null[0] = NULL;
 	starassign(dollarzero, null, FALSE); /* assign $0 to $* */
@@ -106,6 +118,7 @@ quitopts:
 		int fd;
 
 		rcrc = concat(varlookup("home"), word("/.rcrc", NULL))->w;
+		t = tracenow();
 		fd = rc_open(rcrc, rFrom);
 		if (fd == -1) {
 			if (errno != ENOENT)
@@ -120,8 +133,10 @@ quitopts:
 			interactive = push_interactive;
 			close(fd);
 		}
+		trace("startup", ".rcrc", t);
 	}
-	environ = makeenv();
+	/* the environment rc was given suits the C library until a ~/.rcrc has changed it */
+	environ = dashell ? makeenv() : envp;
 	setlocale(LC_CTYPE, "");
 
 	if (dashsee[0] != NULL || dashess) {	/* input from  -c or -s? */
@@ -27,7 +27,7 @@ extern bool match(char *p, char *m, char *s) {
 				}
 				break;
 			case '[': {
-				int r = 1 + rangematch(p+1, *s);
+				int r = *s ? 1 + rangematch(p+1, *s) : 0;
 				if (r > 0) {
 					p += r, m += r, s++;
 					continue;
@@ -84,7 +84,7 @@ static int rangematch(char *p, char c) {
 	for (; *p != ']'; p++) {
 		if (*p == '\0')
 			return c == '[' ? 0 : -1;	/* no right-bracket */
-		if (p[1] == '-' && p[2] != ']') { /* check for [..-..] but ignore [..-] */
+		if (p[1] == '-' && p[2] != ']' && p[2] != '\0') { /* check for [..-..] but ignore [..-] */
 			if (c >= *p)
 				matched |= (c <= p[2]);
 			p += 2;
@@ -97,3 +97,203 @@ static int rangematch(char *p, char c) {
 	else
 		return -1;
 }
+
+/*
+   Compiled patterns, for matching one pattern against many strings. A
+   pattern is cut at its stars into segments, each of which matches a
+   fixed number of characters: literal characters stand for themselves,
+   while ? and [...] become 256-bit sets. A string matches if the first
+   segment matches at its start, the last at its end, and the others,
+   in order, somewhere in between; taking the leftmost place for each
+   is always safe, since the stars can absorb whatever is left over.
+   Compiled patterns are cached, so that, e.g., the cases of a switch
+   in a loop are compiled only once.
+*/
+
+typedef unsigned char Set[32];
+#define inset(set, c) ((set)[(unsigned char) (c) >> 3] & (1 << ((unsigned char) (c) & 7)))
+
+typedef struct {
+	size_t len;	/* number of characters matched */
+	bool literal;	/* no wildcards, so set[] is all NULL */
+	char *lit;	/* the literal characters */
+	Set **set;	/* the set for each wildcard position, or NULL */
+} Segment;
+
+struct Matcher {
+	char *p, *m;		/* the pattern, as a key for the cache */
+	size_t len;		/* strlen(p) */
+	bool never;		/* contains a class which matches nothing */
+	bool lead, trail;	/* starts or ends with a star */
+	int nseg;
+	Segment *seg;
+	size_t minlen;		/* sum of the segment lengths */
+};
+
+#define PATCACHE 64
+static Matcher *patcache[PATCACHE];
+
+static void freematcher(Matcher *x) {
+	int i;
+	size_t j;
+	if (x == NULL)
+		return;
+	for (i = 0; i < x->nseg; i++) {
+		for (j = 0; j < x->seg[i].len; j++)
+			efree(x->seg[i].set[j]);
+		efree(x->seg[i].set);
+		efree(x->seg[i].lit);
+	}
+	efree(x->seg);
+	efree(x->p);
+	efree(x->m);
+	efree(x);
+}
+
+static Matcher *compile(char *p, char *m, size_t len) {
+	Matcher *x = enew(Matcher);
+	Segment *g;
+	Set *set;
+	size_t i;
+	int c, r, w;
+	x->p = ealloc(len + 1);
+	memcpy(x->p, p, len + 1);
+	x->m = ealloc(len + 1);
+	memcpy(x->m, m, len); /* a mask copied by treecpy() has no terminator */
+	x->m[len] = '\0';
+	x->len = len;
+	x->never = x->lead = x->trail = FALSE;
+	x->nseg = 0;
+	x->seg = ealloc((len + 1) * sizeof(Segment));
+	x->minlen = 0;
+	for (g = NULL, i = 0; i < len; ) {
+		if (m[i] && p[i] == '*') {
+			if (i == 0)
+				x->lead = TRUE;
+			if (++i == len)
+				x->trail = TRUE;
+			g = NULL;
+			continue;
+		}
+		if (g == NULL) {
+			g = &x->seg[x->nseg++];
+			g->len = 0;
+			g->literal = TRUE;
+			g->lit = ealloc(len - i + 1);
+			g->set = ealloc((len - i + 1) * sizeof(Set *));
+		}
+		g->set[g->len] = NULL;
+		if (!m[i]) {
+			g->lit[g->len++] = p[i++];
+			continue;
+		}
+		set = ealloc(sizeof(Set));
+		memzero(set, sizeof(Set));
+		switch (p[i]) {
+		case '?':
+			for (c = 1; c < 256; c++)
+				(*set)[c >> 3] |= 1 << (c & 7);
+			i++;
+			break;
+		case '[':
+			for (w = -1, c = 1; c < 256; c++)
+				if ((r = rangematch(&p[i + 1], (char) c)) >= 0) {
+					(*set)[c >> 3] |= 1 << (c & 7);
+					w = r;
+				}
+			if (w < 0) { /* a class matching nothing; the rest is irrelevant */
+				efree(set);
+				x->never = TRUE;
+				return x;
+			}
+			i += 1 + w;
+			break;
+		default:
+			panic("bad metacharacter in match");
+		}
+		g->literal = FALSE;
+		g->lit[g->len] = '\0';
+		g->set[g->len++] = set;
+	}
+	for (c = 0; c < x->nseg; c++)
+		x->minlen += x->seg[c].len;
+	return x;
+}
+
+extern Matcher *patcomp(char *p, char *m) {
+	size_t i, len = strlen(p);
+	unsigned int h = 0;
+	Matcher **xp;
+	for (i = 0; i < len; i++)
+		h = 31 * h + 2 * (unsigned char) p[i] + (m[i] != 0);
+	xp = &patcache[h % PATCACHE];
+	if (*xp != NULL && (*xp)->len == len &&
+			memcmp((*xp)->p, p, len) == 0 && memcmp((*xp)->m, m, len) == 0)
+		return *xp;
+	freematcher(*xp);
+	return *xp = compile(p, m, len);
+}
+
+static bool segmatch(Segment *g, char *s) {
+	size_t i;
+	if (g->literal)
+		return memcmp(g->lit, s, g->len) == 0;
+	for (i = 0; i < g->len; i++)
+		if (g->set[i] != NULL ? !inset(*g->set[i], s[i]) : s[i] != g->lit[i])
+			return FALSE;
+	return TRUE;
+}
+
+/* find the leftmost match for g in s[start..end), or return -1 */
+
+static long segfind(Segment *g, char *s, size_t start, size_t end) {
+	char *t, *last = &s[end - g->len];
+	for (t = &s[start]; t <= last; t++) {
+		if (g->literal && (t = memchr(t, *g->lit, last - t + 1)) == NULL)
+			return -1;
+		if (segmatch(g, t))
+			return t - s;
+	}
+	return -1;
+}
+
+extern bool patmatch(Matcher *x, char *s) {
+	size_t slen, start, end;
+	int i, first, last;
+	long pos;
+	Segment *g;
+	if (x->never)
+		return FALSE;
+	slen = strlen(s);
+	if (slen < x->minlen)
+		return FALSE;
+	if (x->nseg == 0)
+		return x->lead || slen == 0;
+	first = 0;
+	last = x->nseg;
+	start = 0;
+	end = slen;
+	if (!x->lead) {
+		g = &x->seg[0];
+		if (!x->trail && x->nseg == 1)
+			return slen == g->len && segmatch(g, s);
+		if (!segmatch(g, s))
+			return FALSE;
+		start = g->len;
+		first = 1;
+	}
+	if (!x->trail && first < last) {
+		g = &x->seg[last - 1];
+		if (end - start < g->len || !segmatch(g, &s[end - g->len]))
+			return FALSE;
+		end -= g->len;
+		last--;
+	}
+	for (i = first; i < last; i++) {
+		g = &x->seg[i];
+		if (end - start < g->len || (pos = segfind(g, s, start, end)) < 0)
+			return FALSE;
+		start = pos + g->len;
+	}
+	return TRUE;
+}
@@ -0,0 +1,230 @@
+/* math.c: the math builtin, integer arithmetic without expr */
+
+#include "rc.h"
+
+#include <ctype.h>
+#include <limits.h>
+
+/*
+   math [-v name] expr... evaluates its arguments, joined by spaces, as
+   an integer expression in C's syntax and with its precedence: the
+   binary operators * / % + - << >> < <= > >= == != & ^ | && ||, the
+   unary - + ! ~, and parentheses. A name (with or without a $) stands
+   for the numbers in that variable, so an expression over a list gives
+   a list, element by element; a one-element operand goes with each of
+   the other's. The result is assigned to name, or printed one number
+   to a line, and, as with expr, the status is false if the last of it
+   is zero, or if there is no result at all.
+*/
+
+typedef struct {
+	long *v;
+	int n;
+} Num;
+
+static char *p;
+static char *err;
+
+static void fail(char *s) {
+	if (err == NULL)
+		err = s;
+}
+
+static Num scalar(long v) {
+	Num r;
+	r.v = nalloc(sizeof *r.v);
+	r.v[0] = v;
+	r.n = 1;
+	return r;
+}
+
+static void space() {
+	while (*p == ' ' || *p == '\t' || *p == '\n')
+		p++;
+}
+
+static Num variable() {
+	char *start = p, *name, *e;
+	List *l;
+	Num r;
+	int i;
+	if (*p == '*')
+		p++;
+	else
+		while (isalnum((unsigned char) *p) || *p == '_')
+			p++;
+	name = nalloc(p - start + 1);
+	memcpy(name, start, p - start);
+	name[p - start] = '\0';
+	if (*name == '\0') {
+		fail("missing name after $");
+		return scalar(0);
+	}
+	if ((l = varlookup(name)) == NULL && !streq(name, "*")) {
+		fail(nprint("`%s' is not set", name));
+		return scalar(0);
+	}
+	if (streq(name, "*") && l != NULL)
+		l = l->n; /* $0 */
+	r.n = listnel(l);
+	r.v = nalloc((r.n > 0 ? r.n : 1) * sizeof *r.v);
+	for (i = 0; l != NULL; l = l->n, i++) {
+		r.v[i] = strtol(l->w, &e, 0);
+		if (e == l->w || *e != '\0') {
+			fail(nprint("`%s' in $%s is not a number", l->w, name));
+			return scalar(0);
+		}
+	}
+	return r;
+}
+
+static Num expr(int);
+
+static Num primary() {
+	char *e;
+	Num r;
+	int i;
+	space();
+	switch (*p) {
+	case '(':
+		p++;
+		r = expr(0);
+		space();
+		if (*p != ')')
+			fail("missing )");
+		else
+			p++;
+		return r;
+	case '-': case '+': case '!': case '~': {
+		int op = *p++;
+		r = primary();
+		for (i = 0; i < r.n; i++)
+			switch (op) {
+			case '-': r.v[i] = -(unsigned long) r.v[i]; break;
+			case '!': r.v[i] = !r.v[i]; break;
+			case '~': r.v[i] = ~r.v[i]; break;
+			}
+		return r;
+	}
+	case '$':
+		p++;
+		return variable();
+	}
+	if (isdigit((unsigned char) *p)) {
+		r = scalar(strtol(p, &e, 0));
+		p = e;
+		return r;
+	}
+	if (isalpha((unsigned char) *p) || *p == '_' || *p == '*')
+		return variable();
+	fail(*p == '\0' ? "missing operand" : nprint("`%c' is unexpected", *p));
+	return scalar(0);
+}
+
+/* the binary operators, with C's precedence, tightest binding last */
+
+static struct {
+	char *op;
+	int prec;
+} binops[] = {
+	{ "||", 1 }, { "&&", 2 }, { "|", 3 }, { "^", 4 }, { "&", 5 },
+	{ "==", 6 }, { "!=", 6 }, { "<=", 7 }, { ">=", 7 }, { "<<", 8 }, { ">>", 8 },
+	{ "<", 7 }, { ">", 7 }, { "+", 9 }, { "-", 9 }, { "*", 10 }, { "/", 10 }, { "%", 10 },
+};
+
+static int binop() {
+	int i;
+	space();
+	for (i = 0; i < arraysize(binops); i++)
+		if (strncmp(p, binops[i].op, strlen(binops[i].op)) == 0)
+			return i;
+	return -1;
+}
+
+static long apply(char *op, long a, long b) {
+	unsigned long ua = a, ub = b;
+	switch (op[0]) {
+	case '|': return op[1] == '|' ? a || b : a | b;
+	case '&': return op[1] == '&' ? a && b : a & b;
+	case '^': return a ^ b;
+	case '=': return a == b;
+	case '!': return a != b;
+	case '<':
+		if (op[1] == '<')
+			return b < 0 || b >= (long) (CHAR_BIT * sizeof a) ? 0 : (long) (ua << b);
+		return op[1] == '=' ? a <= b : a < b;
+	case '>':
+		if (op[1] == '>')
+			return b < 0 || b >= (long) (CHAR_BIT * sizeof a) ? (a < 0 ? -1 : 0) : a >> b;
+		return op[1] == '=' ? a >= b : a > b;
+	case '+': return ua + ub;
+	case '-': return ua - ub;
+	case '*': return ua * ub;
+	}
+	if (b == 0) {
+		fail("division by zero");
+		return 0;
+	}
+	if (a == LONG_MIN && b == -1)
+		return op[0] == '/' ? LONG_MIN : 0;
+	return op[0] == '/' ? a / b : a % b;
+}
+
+static Num expr(int min) {
+	Num a = primary(), b, r;
+	int i, k;
+	char *op;
+	while (err == NULL && (k = binop()) >= 0 && binops[k].prec > min) {
+		op = binops[k].op;
+		p += strlen(op);
+		b = expr(binops[k].prec);
+		if (a.n != b.n && a.n != 1 && b.n != 1) {
+			fail(nprint("lists of %d and %d numbers", a.n, b.n));
+			return a;
+		}
+		r.n = a.n == 1 ? b.n : a.n;
+		r.v = nalloc((r.n > 0 ? r.n : 1) * sizeof *r.v);
+		for (i = 0; i < r.n; i++)
+			r.v[i] = apply(op, a.v[a.n == 1 ? 0 : i], b.v[b.n == 1 ? 0 : i]);
+		a = r;
+	}
+	return a;
+}
+
+extern void b_math(char **av) {
+	char *var = NULL;
+	List *top, **tail;
+	Num r;
+	int i;
+	/* not getopt, which would take math -1 + 2 for options */
+	if (av[1] != NULL && streq(av[1], "-v") && av[2] != NULL) {
+		var = av[2];
+		av += 2;
+	}
+	if (*++av == NULL) {
+		fprint(2, RC "usage: math [-v name] expr ...\n");
+		set(FALSE);
+		return;
+	}
+	p = nprint("%A", av);
+	err = NULL;
+	r = expr(0);
+	space();
+	if (err == NULL && *p != '\0')
+		fail(nprint("`%c' is unexpected", *p));
+	if (err != NULL) {
+		fprint(2, RC "math: %s\n", err);
+		set(FALSE);
+		return;
+	}
+	for (top = NULL, tail = &top, i = 0; i < r.n; i++) {
+		*tail = word(nprint("%ld", r.v[i]), NULL);
+		tail = &(*tail)->n;
+	}
+	if (var != NULL)
+		varassign(var, top, FALSE);
+	else
+		for (; top != NULL; top = top->n)
+			fprint(1, "%s\n", top->w);
+	set(r.n > 0 && r.v[r.n - 1] != 0);
+}
@@ -1,31 +1,80 @@
 /* nalloc.c: a simple single-arena allocator for command-line-lifetime allocation */
 #include "rc.h"
 
+/*
+   Blocks come in NCLASS power-of-2 size classes starting at BLOCKSIZE,
+   each with its own free list, so a block can be reused without a
+   search. Anything bigger lives on fl[NCLASS], which is searched
+   first-fit; such requests are rare.
+*/
+
+#define NCLASS 8
+
 static struct Block {
 	size_t used, size;
 	char *mem;
 	Block *n;
-} *fl, *ul;
+} *fl[NCLASS + 1], *ul;
+
+/* arena statistics, reported in $rcstats */
+static struct {
+	unsigned long bytes;	/* bytes handed out by nalloc() */
+	unsigned long blocks;	/* blocks malloc'd */
+	unsigned long freed;	/* blocks returned to the system */
+	size_t held;		/* bytes in blocks, used or free */
+	size_t peak;		/* largest value of held */
+} st;
+
+static size_t freebytes;	/* bytes in blocks on the free lists */
+static size_t hwm;		/* decaying high-water mark of per-command use */
 
 /* alignto() works only with power of 2 blocks and assumes 2's complement arithmetic */
 #define alignto(m, n)   ((m + n - 1) & ~(n - 1))
 #define BLOCKSIZE ((size_t) 4096)
 
-/* Allocate a block from the free list or malloc one if none in the fl fit */
+static int sizeclass(size_t n) {
+	int c;
+	for (c = 0; c < NCLASS; c++)
+		if (n <= BLOCKSIZE << c)
+			break;
+	return c;
+}
+
+/* the free list for a block; blocks resized by nbufgrow() may fit no class exactly */
+
+static int blockclass(size_t size) {
+	int c = sizeclass(size);
+	return (c < NCLASS && size == BLOCKSIZE << c) ? c : NCLASS;
+}
+
+/* Allocate a block from the free list for its class, or malloc one */
 
 static void getblock(size_t n) {
 	Block *r, *p;
-	for (r = fl, p = NULL; r != NULL; p = r, r = r->n)
-		if (n <= r->size)
-			break;	/* look for a block which fits the request */
-	if (r != NULL) {	/* if one is found, take it off the free list */	
-		if (p != NULL)
-			p->n = r->n;
-		else
-			fl = r->n;
-	} else {		/* else allocate a new block */
+	int c = sizeclass(n);
+	if (c < NCLASS) {
+		if ((r = fl[c]) != NULL)
+			fl[c] = r->n;
+	} else {
+		for (r = fl[c], p = NULL; r != NULL; p = r, r = r->n)
+			if (n <= r->size)
+				break;	/* look for a block which fits the request */
+		if (r != NULL) {
+			if (p != NULL)
+				p->n = r->n;
+			else
+				fl[c] = r->n;
+		}
+	}
+	if (r != NULL) {
+		freebytes -= r->size;
+	} else {
 		r = enew(Block);
-		r->mem = ealloc(r->size = alignto(n, BLOCKSIZE));
+		r->size = (c < NCLASS) ? BLOCKSIZE << c : alignto(n, BLOCKSIZE);
+		r->mem = ealloc(r->size);
+		st.blocks++;
+		if ((st.held += r->size) > st.peak)
+			st.peak = st.held;
 	}
 	r->used = 0;
 	r->n = ul;
@@ -45,6 +94,7 @@ extern void *nalloc(size_t n) {
 	size_t base;
 	Block *ulp;
 	n = alignto(n, sizeof(align_t));
+	st.bytes += n;
 	ulp = ul;
 	if (ulp != NULL && n + (base = ulp->used) < ulp->size) {
 		ulp->used = base + n;
@@ -58,37 +108,104 @@ extern void *nalloc(size_t n) {
 }
 
 /*
-   Frees memory from nalloc space by putting it on the free list.
-   Returns free blocks to the system, retaining at least MAXMEM bytes
-   worth of blocks for nalloc.
+   Growable buffers, for reading input of unknown size straight into the
+   arena. nbuf() claims the free space at the end of the current block
+   and returns its size. nbufgrow() at least doubles the buffer, keeping
+   its first m bytes; once the buffer has a block to itself it is grown
+   in place with erealloc(), which for large blocks is usually a
+   remapping rather than a copy. nbufdone() keeps the first n bytes and
+   gives the rest back. Other calls to nalloc() (from a signal handler,
+   say) may be made while a buffer is open; they just get another block.
 */
 
-#define MAXMEM 500000
+#define MINBUF ((size_t) 1024)
 
-extern void nfree() {
-	size_t count;
+static Block *bufblock(char *p) {
 	Block *r;
+	for (r = ul; r != NULL; r = r->n)
+		if (p >= r->mem && p < r->mem + r->size)
+			return r;
+	panic("buffer not in arena");
+	return NULL; /* hush up gcc -Wall */
+}
+
+extern char *nbuf(size_t *sizep) {
+	char *p;
+	if (ul == NULL || ul->size - ul->used <= MINBUF)
+		getblock(MINBUF);
+	p = &ul->mem[ul->used];
+	*sizep = ul->size - ul->used - 1;
+	ul->used = ul->size; /* reserved until nbufdone() */
+	return p;
+}
+
+extern char *nbufgrow(char *p, size_t m, size_t *sizep) {
+	Block *r = bufblock(p);
+	if (p == r->mem) {
+		st.held += r->size;
+		r->mem = erealloc(r->mem, r->size *= 2);
+		if (st.held > st.peak)
+			st.peak = st.held;
+	} else {
+		getblock(2 * (*sizep + 1));
+		memcpy(ul->mem, p, m);
+		r->used = p - r->mem;
+		r = ul;
+	}
+	r->used = r->size;
+	*sizep = r->size - 1;
+	return r->mem;
+}
+
+extern void nbufdone(char *p, size_t n) {
+	Block *r = bufblock(p);
+	assert(p + n <= r->mem + r->size);
+	n = alignto(n, sizeof(align_t));
+	st.bytes += n;
+	r->used = (p - r->mem) + n;
+	if (r->used > r->size)
+		r->used = r->size;
+}
+
+/*
+   Frees memory from nalloc space by putting it on the free lists. The
+   free lists are then trimmed, largest blocks first, to the high-water
+   mark of recent commands: a command that needed a lot of memory keeps
+   it around for its successors, but the excess drains away gradually
+   once usage drops. MINMEM bytes are always retained.
+*/
+
+#define MINMEM ((size_t) 65536)
+
+extern void nfree() {
+	size_t count, keep;
+	Block *r, *next;
+	int c;
 	if (ul == NULL)
 		return;
-	for (r = ul; r->n != NULL; r = r->n)
-		;	/* get to end of used list */
-	r->n = fl;	/* tack free list onto it */
-	fl = ul;	/* and make it the free list */
+	for (r = ul, count = 0; r != NULL; r = next) {
+		next = r->n;
+		count += r->size;
+		c = blockclass(r->size);
+		r->n = fl[c];
+		fl[c] = r;
+	}
 	ul = NULL;	/* finally, zero out the used list */
-	for (r = fl, count = r->size; r->n != NULL; r = r->n, count += r->size) {
-		if (count >= MAXMEM) {
-			Block *tmp = r;
-			r = r->n;
-			tmp->n = NULL;		/* terminate the free list */
-			while (r != NULL) {	/* free memory off the tail of the free list */
-				tmp = r->n;
-				efree(r->mem);
-				efree(r);
-				r = tmp;
-			}
-		return;
+	freebytes += count;
+	if (count > hwm)
+		hwm = count;
+	else
+		hwm -= (hwm - count) / 8;
+	keep = (hwm > MINMEM) ? hwm : MINMEM;
+	for (c = NCLASS; c >= 0 && freebytes > keep; c--)
+		while ((r = fl[c]) != NULL && freebytes > keep) {
+			fl[c] = r->n;
+			freebytes -= r->size;
+			st.held -= r->size;
+			st.freed++;
+			efree(r->mem);
+			efree(r);
 		}
-	}
 }
 
 /*
@@ -109,6 +226,30 @@ extern void restoreblock(Block *old) {
 	ul = old;
 }
 
+/* the value of $rcstats */
+
+extern List *sgetrcstats() {
+	struct { char *name; unsigned long val; } v[5];
+	List *r, *q;
+	int i;
+	v[0].name = "nalloc";	v[0].val = st.bytes;
+	v[1].name = "blocks";	v[1].val = st.blocks;
+	v[2].name = "freed";	v[2].val = st.freed;
+	v[3].name = "held";	v[3].val = st.held;
+	v[4].name = "peak";	v[4].val = st.peak;
+	for (r = NULL, i = arraysize(v) - 1; i >= 0; i--) {
+		q = nnew(List);
+		q->w = nprint("%uld", v[i].val);
+		q->m = NULL;
+		q->n = r;
+		r = nnew(List);
+		r->w = v[i].name;
+		r->m = NULL;
+		r->n = q;
+	}
+	return r;
+}
+
 /* generic memory allocation functions */
 
 extern void *ealloc(size_t n) {
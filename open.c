@@ -1,7 +1,13 @@
 /* open.c: to insulate <fcntl.h> from the rest of rc. */
 
+#define _GNU_SOURCE /* for memfd_create(), pipe2() and O_TMPFILE, where they exist */
+
 #include "rc.h"
+#include <errno.h>
 #include <fcntl.h>
+#if HAVE_MEMFD_CREATE
+#include <sys/mman.h>
+#endif
 
 /*
    Opens a file with the necessary flags. Assumes the following
@@ -18,10 +24,45 @@ static const int mode_masks[] = {
 	/* rAppend */	O_APPEND | O_CREAT | O_WRONLY
 };
 
+/*
+   A name under a union directory is looked for in each directory of
+   the union in turn. A file is written where it is found, in whichever
+   directory; only if none has it is a new one made, in the first that
+   will take it.
+*/
+
 extern int rc_open(const char *name, redirtype m) {
+	char *p;
+	int i, fd = -1, flags;
 	if ((unsigned) m >= arraysize(mode_masks))
 		panic("bad mode passed to rc_open");
-	return open(name, mode_masks[m], 0666);
+	flags = mode_masks[m];
+	if ((flags & O_CREAT) && ns_try((char *) name, 1) != NULL)
+		for (i = 0; (p = ns_try((char *) name, i)) != NULL; i++)
+			if ((fd = open(p, flags & ~O_CREAT)) >= 0 || errno != ENOENT)
+				return fd;
+	for (i = 0; (p = ns_try((char *) name, i)) != NULL; i++)
+		if ((fd = open(p, flags, 0666)) >= 0 || errno != ENOENT)
+			break;
+	return fd;
+}
+
+/*
+   Open an anonymous file, which vanishes when it is closed; used to
+   hold here documents. Returns -1 if the system has no way to do this,
+   in which case the caller must make do with a pipe.
+*/
+
+extern int rc_tmpfd() {
+	int fd = -1;
+#if HAVE_MEMFD_CREATE
+	fd = memfd_create("rc heredoc", 0);
+#endif
+#ifdef O_TMPFILE
+	if (fd < 0)
+		fd = open("/tmp", O_TMPFILE | O_RDWR, 0600);
+#endif
+	return fd;
 }
 
 /* make a file descriptor blocking. return value indicates whether
@@ -44,6 +85,46 @@ extern bool makeblocking(int fd) {
 	return TRUE;
 }
 
+/* mark a file descriptor to be closed across exec. */
+
+extern void closeonexec(int fd) {
+	int flags;
+
+	if ((flags = fcntl(fd, F_GETFD)) != -1)
+		fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+}
+
+/* undo closeonexec(), for a descriptor a child is to keep. */
+
+extern void keeponexec(int fd) {
+	int flags;
+
+	if ((flags = fcntl(fd, F_GETFD)) != -1 && (flags & FD_CLOEXEC))
+		fcntl(fd, F_SETFD, flags & ~FD_CLOEXEC);
+}
+
+/*
+   Make a pipe for a pipeline. Both ends are close-on-exec, so that
+   they cannot leak into any other command; the stage that uses an end
+   moves it into place with mvfd(), which clears the flag.
+*/
+
+extern int rc_pipe(int p[2]) {
+#if HAVE_PIPE2
+	if (pipe2(p, O_CLOEXEC) < 0)
+		return -1;
+#else
+	if (pipe(p) < 0)
+		return -1;
+	closeonexec(p[0]);
+	closeonexec(p[1]);
+#endif
+#if defined(PIPE_SIZE) && defined(F_SETPIPE_SZ)
+	fcntl(p[1], F_SETPIPE_SZ, PIPE_SIZE); /* only a hint */
+#endif
+	return 0;
+}
+
 /* make a file descriptor the same pgrp as us.  Returns TRUE if
 it changes anything. */
 
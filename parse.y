@@ -107,6 +107,7 @@ cmd	: /* empty */	%prec WHILE		{ $$ = NULL; }
 	| brace epilog				{ $$ = mk(nBrace,$1,$2); }
 	| IF paren optnl iftail			{ $$ = mk(nIf,$2,$4); }
 	| FOR '(' word IN words ')' optnl cmd	{ $$ = mk(nForin,$3,$5,$8); }
+	| FOR '(' word IN words '&' ')' optnl cmd	{ $$ = mk(nForin,$3,$5,mk(nNowait,$9)); }
 	| FOR '(' word ')' optnl cmd		{ $$ = mk(nForin,$3,star,$6); }
 	| WHILE paren optnl cmd			{ $$ = mk(nWhile,$2,$4); }
 	| SWITCH '(' word ')' optnl '{' cbody '}' { $$ = mk(nSwitch,$3,$7); }
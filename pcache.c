@@ -0,0 +1,389 @@
+/* pcache.c: a cache of parsed scripts, kept on disk */
+
+#include "rc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "version.h"
+
+/*
+   A script run with `.' (or as `rc file') is parsed whole the first
+   time, and its trees are written to $XDG_CACHE_HOME/rc (or
+   $home/.cache/rc), if that directory exists; later runs read the
+   trees back instead of parsing. The file is named by its device and
+   inode, and the header records the rc version, the layout of its trees
+   (see treelayout()), and the script's size, mtime and ctime, so that
+   any change to either makes the entry stale.
+
+   Trees are written out in prefix order: a byte of node type (or NONE
+   for a null pointer), followed by the fields in the order mk() takes
+   them; a word is its length, the text, and the meta bytes if any.
+   Each top-level tree is preceded by the line number the parser had
+   reached at its end, for error messages.
+*/
+
+#define NONE	255
+#define MAGIC	"rc tree 2\n"
+#define RACY	2	/* a script this recently changed may change again and not show it */
+
+typedef struct {
+	char magic[sizeof MAGIC];
+	char version[32];
+	Treelayout layout;
+	unsigned long dev, ino, size;
+	long mtime, ctime;
+	size_t len;
+} Header;
+
+static char *wbuf, *cachename;
+static size_t wlen, wsize;
+
+static char *rp, *rend;
+static bool bad;
+
+static void mkheader(Header *h, struct stat *st) {
+	memzero(h, sizeof *h);
+	strcpy(h->magic, MAGIC);
+	strncpy(h->version, VERSION, sizeof h->version - 1);
+	treelayout(&h->layout);
+	h->dev = st->st_dev;
+	h->ino = st->st_ino;
+	h->size = st->st_size;
+	h->mtime = st->st_mtime;
+	h->ctime = st->st_ctime;
+}
+
+static bool readall(int fd, char *buf, size_t len) {
+	ssize_t n;
+	while (len > 0) {
+		if ((n = read(fd, buf, len)) <= 0) {
+			if (n < 0 && errno == EINTR)
+				continue;
+			return FALSE;
+		}
+		buf += n;
+		len -= n;
+	}
+	return TRUE;
+}
+
+/*
+   Look for fd's script in the cache. Returns FALSE if the script cannot
+   be cached. Otherwise *bufp is set to the trees (in ealloc space) and
+   *lenp to their length, or *bufp is NULL if they have yet to be saved
+   with pcacheadd() and pcachesave().
+*/
+
+extern bool pcachefind(int fd, char **bufp, size_t *lenp) {
+	struct stat st, dst;
+	Header h, want;
+	List *dir;
+	char *s, *buf;
+	int cfd;
+
+	*bufp = NULL;
+	if ((dir = varlookup("XDG_CACHE_HOME")) != NULL && *dir->w != '\0')
+		s = nprint("%s/rc", dir->w);
+	else if ((dir = varlookup("home")) != NULL)
+		s = nprint("%s/.cache/rc", dir->w);
+	else
+		return FALSE;
+	if (stat(s, &dst) < 0 || !S_ISDIR(dst.st_mode) || fstat(fd, &st) < 0)
+		return FALSE;
+	if (st.st_mtime + RACY > time(NULL) || st.st_ctime + RACY > time(NULL))
+		return FALSE;
+	efree(cachename);
+	cachename = mprint("%s/%uld.%uld", s, (unsigned long) st.st_dev, (unsigned long) st.st_ino);
+	mkheader(&want, &st);
+	if ((cfd = open(cachename, O_RDONLY)) < 0)
+		return TRUE;
+	if (fstat(cfd, &dst) < 0 || !readall(cfd, (char *) &h, sizeof h)
+			|| memcmp(&h, &want, offsetof(Header, len)) != 0
+			|| (size_t) dst.st_size != sizeof h + h.len) {
+		close(cfd);
+		return TRUE;
+	}
+	buf = ealloc(h.len + 1);
+	if (!readall(cfd, buf, h.len)) {
+		efree(buf);
+		close(cfd);
+		return TRUE;
+	}
+	close(cfd);
+	/* check the lot before any of it is run */
+	rp = buf;
+	rend = buf + h.len;
+	bad = FALSE;
+	while (rp < rend && !bad)
+		(void) pcachetree(NULL, 0, NULL, NULL);
+	if (bad) {
+		efree(buf);
+		return TRUE;
+	}
+	*bufp = buf;
+	*lenp = h.len;
+	return TRUE;
+}
+
+static void put(const void *p, size_t n) {
+	if (wlen + n > wsize)
+		wbuf = erealloc(wbuf, wsize = 2 * (wlen + n) + 1024);
+	memcpy(&wbuf[wlen], p, n);
+	wlen += n;
+}
+
+static void putint(int i) {
+	put(&i, sizeof i);
+}
+
+static void putnode(Node *n) {
+	unsigned char t;
+	size_t len;
+	if (n == NULL) {
+		t = NONE;
+		put(&t, 1);
+		return;
+	}
+	t = n->type;
+	put(&t, 1);
+	switch (n->type) {
+	default:
+		panic("unexpected node in putnode");
+		/* NOTREACHED */
+	case nDup:
+		putint(n->u[0].i);
+		putint(n->u[1].i);
+		putint(n->u[2].i);
+		break;
+	case nWord:
+		len = strlen(n->u[0].s);
+		put(&len, sizeof len);
+		put(n->u[0].s, len);
+		t = (n->u[1].s != NULL);
+		put(&t, 1);
+		if (t)
+			put(n->u[1].s, len);
+		putint(n->u[2].i);
+		break;
+	case nBang: case nNowait:
+	case nCount: case nFlat: case nRmfn: case nSubshell:
+	case nVar: case nCase:
+		putnode(n->u[0].p);
+		break;
+	case nAndalso: case nAssign: case nBackq: case nBody: case nBrace: case nConcat:
+	case nElse: case nEpilog: case nIf: case nNewfn: case nCbody:
+	case nOrelse: case nPre: case nArgs: case nSwitch:
+	case nMatch: case nVarsub: case nWhile: case nLappend:
+		putnode(n->u[0].p);
+		putnode(n->u[1].p);
+		break;
+	case nForin:
+		putnode(n->u[0].p);
+		putnode(n->u[1].p);
+		putnode(n->u[2].p);
+		break;
+	case nPipe:
+		putint(n->u[0].i);
+		putint(n->u[1].i);
+		putnode(n->u[2].p);
+		putnode(n->u[3].p);
+		break;
+	case nRedir:
+	case nNmpipe:
+		putint(n->u[0].i);
+		putint(n->u[1].i);
+		putnode(n->u[2].p);
+		break;
+	}
+}
+
+/* append a top-level tree, parsed up to line lineno, to the pending entry */
+
+extern void pcacheadd(Node *n, int lineno) {
+	putint(lineno);
+	putnode(n);
+}
+
+/*
+   Finish the pending entry: write it out if ok, and hand back the trees
+   as pcachefind() would have. The cache is only a cache, so failing to
+   write it is not an error.
+*/
+
+extern bool pcachesave(int fd, bool ok, char **bufp, size_t *lenp) {
+	struct stat st;
+	Header h;
+	char *tmp;
+	int cfd;
+
+	*bufp = wbuf;
+	*lenp = wlen;
+	wbuf = NULL;
+	wlen = wsize = 0;
+	if (!ok || cachename == NULL || fstat(fd, &st) < 0) {
+		efree(*bufp);
+		*bufp = NULL;
+		return FALSE;
+	}
+	mkheader(&h, &st);
+	h.len = *lenp;
+	tmp = nprint("%s.%d", cachename, rc_pid);
+	if ((cfd = open(tmp, O_WRONLY | O_CREAT | O_EXCL, 0666)) >= 0) {
+		writeall(cfd, (char *) &h, sizeof h);
+		if (*lenp > 0)
+			writeall(cfd, *bufp, *lenp);
+		if (close(cfd) < 0 || rename(tmp, cachename) < 0)
+			unlink(tmp);
+	}
+	if (*bufp == NULL)
+		*bufp = ealloc(1);
+	return TRUE;
+}
+
+static int getint() {
+	int i;
+	if ((size_t) (rend - rp) < sizeof i) {
+		bad = TRUE;
+		return 0;
+	}
+	memcpy(&i, rp, sizeof i);
+	rp += sizeof i;
+	return i;
+}
+
+static char *getbytes(size_t n, bool make) {
+	char *s;
+	if ((size_t) (rend - rp) < n) {
+		bad = TRUE;
+		return NULL;
+	}
+	s = NULL;
+	if (make) {
+		s = nalloc(n + 1);
+		memcpy(s, rp, n);
+		s[n] = '\0';
+	}
+	rp += n;
+	return s;
+}
+
+/* read a node back in: to the arena if make, otherwise just to check it */
+
+static Node *getnode(bool make) {
+	static Node scratch;
+	Node *n;
+	size_t len;
+	int t;
+	if (bad || rp >= rend) {
+		bad = TRUE;
+		return NULL;
+	}
+	if ((t = *(unsigned char *) rp++) == NONE)
+		return NULL;
+	switch (t) {
+	default:
+		bad = TRUE;
+		return NULL;
+	case nDup:
+		n = make ? nalloc(offsetof(Node, u[3])) : &scratch;
+		n->u[0].i = getint();
+		n->u[1].i = getint();
+		n->u[2].i = getint();
+		break;
+	case nWord:
+		n = make ? nalloc(offsetof(Node, u[4])) : &scratch;
+		if ((size_t) (rend - rp) < sizeof len) {
+			bad = TRUE;
+			return NULL;
+		}
+		memcpy(&len, rp, sizeof len);
+		rp += sizeof len;
+		n->u[0].s = getbytes(len, make);
+		if (bad || rp >= rend) {
+			bad = TRUE;
+			return NULL;
+		}
+		n->u[1].s = (*rp++ != 0) ? getbytes(len, make) : NULL;
+		n->u[2].i = getint();
+		n->u[3].l = NULL;
+		break;
+	case nBang: case nNowait:
+	case nCount: case nFlat: case nRmfn: case nSubshell:
+	case nVar: case nCase:
+		n = make ? nalloc(offsetof(Node, u[1])) : &scratch;
+		n->u[0].p = getnode(make);
+		break;
+	case nArgs: case nLappend:
+		n = make ? nalloc(offsetof(Node, u[3])) : &scratch;
+		n->u[0].p = getnode(make);
+		n->u[1].p = getnode(make);
+		n->u[2].l = NULL;
+		break;
+	case nAndalso: case nAssign: case nBackq: case nBody: case nBrace: case nConcat:
+	case nElse: case nEpilog: case nIf: case nNewfn: case nCbody:
+	case nOrelse: case nPre:
+	case nMatch: case nVarsub: case nWhile:
+		n = make ? nalloc(offsetof(Node, u[2])) : &scratch;
+		n->u[0].p = getnode(make);
+		n->u[1].p = getnode(make);
+		break;
+	case nSwitch:
+		n = make ? nalloc(offsetof(Node, u[3])) : &scratch;
+		n->u[0].p = getnode(make);
+		n->u[1].p = getnode(make);
+		n->u[2].sw = NULL;
+		break;
+	case nForin:
+		n = make ? nalloc(offsetof(Node, u[3])) : &scratch;
+		n->u[0].p = getnode(make);
+		n->u[1].p = getnode(make);
+		n->u[2].p = getnode(make);
+		break;
+	case nPipe:
+		n = make ? nalloc(offsetof(Node, u[4])) : &scratch;
+		n->u[0].i = getint();
+		n->u[1].i = getint();
+		n->u[2].p = getnode(make);
+		n->u[3].p = getnode(make);
+		break;
+	case nRedir:
+	case nNmpipe:
+		n = make ? nalloc(offsetof(Node, u[3])) : &scratch;
+		n->u[0].i = getint();
+		n->u[1].i = getint();
+		n->u[2].p = getnode(make);
+		break;
+	}
+	n->type = t;
+	return n;
+}
+
+/*
+   Read the tree at *offp in buf into the arena, advancing *offp and
+   setting *linep. With a null buf, check the tree at rp instead.
+*/
+
+extern Node *pcachetree(char *buf, size_t len, size_t *offp, int *linep) {
+	Node *n;
+	int line;
+	if (buf == NULL) {
+		(void) getint();
+		(void) getnode(FALSE);
+		return NULL;
+	}
+	rp = buf + *offp;
+	rend = buf + len;
+	bad = FALSE;
+	line = getint();
+	n = getnode(TRUE);
+	if (bad)
+		panic("corrupt parse cache"); /* it was checked when it was read */
+	*offp = rp - buf;
+	*linep = line;
+	return n;
+}
@@ -294,13 +294,43 @@ extern int fmtprint(Format *format, const char *fmt,...) {
 	return n + format->flushed;
 }
 
+/*
+   Output to fd 1 is gathered here, so that a loop of echos makes a write
+   per buffer rather than one per echo. writeall() flushes it before it
+   writes anything else, so that it stays in order with standard error;
+   and it is flushed before rc forks, execs, waits, redirects or reads
+   input, so that it stays in order with other commands too, and at exit.
+*/
+
+static char outbuf[8192];
+static size_t outlen;
+
+extern void flushout() {
+	size_t n = outlen;
+	if (n == 0)
+		return;
+	outlen = 0;
+	writeall(1, outbuf, n);
+}
+
 static void fprint_flush(Format *format, size_t ignore) {
 	size_t n = format->buf - format->bufbegin;
 	char *buf = format->bufbegin;
 
 	format->flushed += n;
 	format->buf = format->bufbegin;
-	writeall(format->u.n, buf, n);
+	if (format->u.n != 1) {
+		writeall(format->u.n, buf, n);
+		return;
+	}
+	if (outlen + n > sizeof outbuf)
+		flushout();
+	if (n > sizeof outbuf) {
+		writeall(1, buf, n);
+		return;
+	}
+	memcpy(&outbuf[outlen], buf, n);
+	outlen += n;
 }
 
 extern int fprint(int fd, const char *fmt,...) {
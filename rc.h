@@ -4,6 +4,9 @@
 
 #include <assert.h>
 
+/* for offsetof and ptrdiff_t */
+#include <stddef.h>
+
 /* for struct stat */
 #include <sys/stat.h>
 
@@ -22,16 +25,22 @@ typedef void builtin_t(char **);
 typedef struct Block Block;
 typedef struct Dup Dup;
 typedef struct Estack Estack;
+typedef struct Prof Prof;
 typedef struct rc_Function rc_Function;
 typedef struct Hq Hq;
 typedef struct Htab Htab;
+typedef struct Ifs Ifs;
 typedef struct Jbwrap Jbwrap;
 typedef struct List List;
+typedef struct Matcher Matcher;
 typedef struct Node Node;
 typedef struct Pipe Pipe;
 typedef struct Redir Redir;
 typedef struct Rq Rq;
+typedef struct Swtab Swtab;
+typedef struct Treelayout Treelayout;
 typedef struct Variable Variable;
+typedef struct Vec Vec;
 typedef struct Word Word;
 typedef struct Format Format;
 typedef union Edata Edata;
@@ -44,7 +53,7 @@ typedef enum nodetype {
 } nodetype;
 
 typedef enum ecodes {
-	eError, eBreak, eReturn, eVarstack, eArena, eFifo, eFd, eContinue
+	eError, eBreak, eReturn, eVarstack, eArena, eFifo, eFd, eContinue, eTree
 } ecodes;
 
 typedef enum bool {
@@ -62,6 +71,7 @@ union Edata {
 	Block *b;
 	char *name;
 	int fd;
+	Node *tree;
 };
 
 struct Estack {
@@ -76,15 +86,28 @@ struct List {
 	List *n;
 };
 
+/* a List laid out as a vector, shared by the variables holding it; see listvec() */
+struct Vec {
+	int refs;
+	List l[1];	/* really one cell per word; the words follow */
+};
+
 struct Node {
 	nodetype type;
 	union {
 		char *s;
 		int i;
 		Node *p;
+		List *l;	/* the value of a literal word or list; see treelit() */
+		Swtab *sw;	/* the cases of a switch, hashed; see swcase() */
 	} u[4];
 };
 
+/* what a tree's shape depends on, for the files that hold trees */
+struct Treelayout {
+	unsigned short ntypes, node, list, swtab, swent;
+};
+
 struct Pipe {
 	int left, right;
 };
@@ -112,10 +135,19 @@ struct Rq {
 struct rc_Function {
 	Node *def;
 	char *extdef;
+	unsigned long calls;	/* the rest are kept under -T only */
+	double total, self, cpu; /* microseconds */
+};
+
+struct Prof {
+	double t, cpu, inner;
+	bool recursive;
 };
 
 struct Variable {
-	List *def;
+	List *def;	/* nel cells of vec */
+	int nel;
+	Vec *vec;
 	char *extdef;
 	Variable *n;
 };
@@ -123,6 +155,18 @@ struct Variable {
 struct Htab {
 	char *name;
 	void *p;
+	unsigned int h;		/* full hash of name */
+	size_t len;		/* strlen(name) */
+	int envidx;		/* position in the exported environment, or -1 */
+};
+
+#define MAXSWAR 4
+
+struct Ifs {
+	char map[256];		/* map[c] is TRUE if c separates words */
+	int nsep;		/* number of separators, including '\0' */
+	unsigned char sep[MAXSWAR];	/* the first MAXSWAR separators, in order */
+	size_t pat[MAXSWAR];	/* each of them replicated across a word */
 };
 
 struct Format {
@@ -150,7 +194,6 @@ enum {
 
 /* macros */
 #define EOF (-1)
-#define MAX_PIPELINE 512
 #ifndef NULL
 #define NULL 0
 #endif
@@ -175,7 +218,7 @@ enum {
 /* main.c */
 extern Rq *redirq;
 extern bool dashdee, dashee, dasheye, dashell, dashen;
-extern bool dashpee, dashoh, dashess, dashvee, dashex;
+extern bool dashpee, dashoh, dashess, dashvee, dashex, dashtee;
 extern bool interactive;
 extern char *dashsee[];
 extern pid_t rc_pid;
@@ -183,17 +226,21 @@ extern int lineno;
 
 /* builtins.c */
 extern builtin_t *isbuiltin(char *);
-extern void b_exec(char **), funcall(char **), b_dot(char **), b_builtin(char **);
+extern void b_exec(char **), funcall(char **), b_dot(char **), b_builtin(char **), b_time(char **);
 extern char *compl_builtin(const char *, int);
+extern List *sgetcwd(void);
 
 /* except.c */
 extern bool nl_on_intr;
 extern bool outstanding_cmdarg(void);
 extern void pop_cmdarg(bool);
 extern void rc_raise(ecodes);
+extern Estack *flow;
+extern void rc_flow(ecodes);
 extern void except(ecodes, Edata, Estack *);
 extern void unexcept(ecodes);
 extern void clearflow(void);
+extern bool treebusy(Node *);
 extern void rc_error(char *);
 extern void sigint(int);
 
@@ -207,6 +254,11 @@ extern void exec(List *, bool);
 extern int rc_execve(char *, char **, char **);
 #endif
 
+/* fnlib.c */
+extern void b_load(char **);
+extern bool inlib(void *);
+extern void libinit(void);
+
 /* footobar.c */
 extern char **list2array(List *, bool);
 extern char *get_name(char *);
@@ -232,7 +284,7 @@ extern List *append(List *, List*);
 extern List *flatten(List *);
 extern List *glom(Node *);
 extern List *concat(List *, List *);
-extern List *varsub(List *, List *);
+extern List *varsub(List *, int, List *);
 extern List *word(char *, char *);
 
 /* hash.c */
@@ -240,6 +292,8 @@ extern Htab *fp, *vp;
 extern void *lookup(char *, Htab *);
 extern rc_Function *get_fn_place(char *);
 extern List *varlookup(char *);
+extern List *varlookup_vec(char *, int *);
+extern void vecfree(Vec *);
 extern Node *fnlookup(char *);
 extern Variable *get_var_place(char *, bool);
 extern bool varassign_string(char *);
@@ -252,15 +306,21 @@ extern void delete_fn(char *);
 extern void delete_var(char *, bool);
 extern void fnassign(char *, Node *);
 extern void fnassign_string(char *);
+extern char **fnnames(void);
 extern void fnrm(char *);
 extern void initenv(char **);
+extern void clearbozo(void);
+extern char *extcpy(char *);
+extern void extfree(char *);
 extern void inithash(void);
 extern void set_exportable(char *, bool);
+extern void reaptrees(void);
 extern void setsigdefaults(bool);
 extern void inithandler(void);
 extern void varassign(char *, List *, bool);
 extern void varrm(char *, bool);
 extern void whatare_all_vars(bool, bool);
+extern void whatare_profiles(char **);
 extern void whatare_all_signals(void);
 extern void prettyprint_var(int, char *, List *);
 extern void prettyprint_fn(int, char *, Node *);
@@ -280,15 +340,22 @@ extern void inityy(void);
 extern void yyerror(const char *);
 extern void scanerror(char *);
 extern const char nw[], dnw[];
+extern bool quietparse;
 
 /* list.c */
 extern void listfree(List *);
 extern List *listcpy(List *, void *(*)(size_t));
+extern Vec *listvec(List *, int *);
 extern size_t listlen(List *);
 extern int listnel(List *);
 
 /* match.c */
 extern bool match(char *, char *, char *);
+extern Matcher *patcomp(char *, char *);
+extern bool patmatch(Matcher *, char *);
+
+/* math.c */
+extern void b_math(char **);
 
 /* alloc.c */
 extern void *ealloc(size_t);
@@ -296,14 +363,28 @@ extern void *erealloc(void *, size_t);
 extern void efree(void *);
 extern Block *newblock(void);
 extern void *nalloc(size_t);
+extern char *nbuf(size_t *);
+extern char *nbufgrow(char *, size_t, size_t *);
+extern void nbufdone(char *, size_t);
 extern void nfree(void);
 extern void restoreblock(Block *);
+extern List *sgetrcstats(void);
 
 /* open.c */
 extern int rc_open(const char *, redirtype);
+extern int rc_tmpfd(void);
 extern bool makeblocking(int);
+extern void closeonexec(int);
+extern void keeponexec(int);
+extern int rc_pipe(int [2]);
 extern bool makesamepgrp(int);
 
+/* pcache.c */
+extern bool pcachefind(int, char **, size_t *);
+extern void pcacheadd(Node *, int);
+extern bool pcachesave(int, bool, char **, size_t *);
+extern Node *pcachetree(char *, size_t, size_t *, int *);
+
 /* print.c */
 /*
    The following prototype should be:
@@ -316,6 +397,7 @@ extern int fmtprint(Format *, const char *,...);
 extern void fmtappend(Format *, const char *, size_t);
 extern void fmtcat(Format *, const char *);
 extern int fprint(int fd, const char *fmt,...);
+extern void flushout(void);
 extern char *mprint(const char *fmt,...);
 extern char *nprint(const char *fmt,...);
 /*
@@ -338,26 +420,39 @@ extern void initparse(void);
 extern volatile sig_atomic_t rl_active;
 extern struct Jbwrap rl_buf;
 
+/* read.c */
+extern void b_read(char **);
+
 /* redir.c */
 extern void doredirs(void);
 
 
+/* regex.c */
+extern void b_regex(char **);
+
 /* signal.c */
 extern void initsignal(void);
 extern void catcher(int);
 extern void sigchk(void);
+extern void sigpoll(int);
+extern int sigfds(int *);
 extern void (*rc_signal(int, void (*)(int)))(int);
 extern void (*sys_signal(int, void (*)(int)))(int);
 extern void (*sighandlers[])(int);
 
 
+/* split.c */
+extern void mkifs(Ifs *, List *);
+extern List *ifssplit(Ifs *, char *, size_t);
+
 /* status.c */
 extern int istrue(void);
 extern int getstatus(void);
 extern void set(bool);
 extern void setstatus(pid_t, int);
 extern void setpipestatuslength(int);
-extern void setpipestatus(int, pid_t, int);
+extern void setpipestatus(int, pid_t, int, double);
+extern int pipecpu(double **, unsigned long *);
 extern List *sgetstatus(void);
 extern void ssetstatus(char **);
 extern char *strstatus(int s);
@@ -366,23 +461,44 @@ extern char *strstatus(int s);
 /* system.c or system-bsd.c */
 extern void writeall(int, char *, size_t);
 
+struct rusage;
+
 #if HAVE_RESTARTABLE_SYSCALLS
 extern int rc_read(int, char *, size_t);
-extern pid_t rc_wait(int *);
+extern pid_t rc_wait(int *, struct rusage *);
 extern Jbwrap slowbuf;
 extern volatile sig_atomic_t slow;
 
 #else /* HAVE_RESTARTABLE_SYSCALLS */
 
 #define rc_read read
-#define rc_wait wait
+#define rc_wait(stat, ru) wait3(stat, 0, ru)
 #endif /* HAVE_RESTARTABLE_SYSCALLS */
 
 
+/* string.c */
+extern void b_string(char **);
+
+/* trace.c */
+extern double tracenow(void);
+extern void trace(char *, char *, double);
+extern void tracemark(char *, char *);
+extern void traceflush(void);
+extern void tracefork(void);
+extern void profenter(Prof *, char *);
+extern void profleave(Prof *, char *);
+
 /* tree.c */
 extern Node *mk(enum nodetype, ...);
 extern Node *treecpy(Node *, void *(*)(size_t));
 extern void treefree(Node *);
+extern void treelit(Node *, void *(*)(size_t));
+extern Node *treestore(Node *);
+extern size_t treelen(Node *);
+extern Node *treeat(Node *, void *);
+extern void treereloc(Node *, ptrdiff_t);
+extern void treelayout(Treelayout *);
+extern Node *swcase(Node *, List *);
 
 /* utils.c */
 extern bool isabsolute(char *);
@@ -395,11 +511,20 @@ extern void uerror(char *);
 
 /* wait.c */
 extern pid_t rc_fork(void);
+#if HAVE_POSIX_SPAWN
+extern pid_t rc_spawn(char *, char **, char **);
+#endif
 extern pid_t rc_wait4(pid_t, int *, bool);
+extern bool rc_exited(pid_t);
+extern void rc_waitall(pid_t *, int *, double *, int);
+extern long childrss;
+extern void jobslot(int);
+extern int joblimit(void);
 extern List *sgetapids(void);
 extern void waitforall(void);
 extern void waitfor(char **);
 extern bool forked;
+extern int jobmax;
 
 /* walk.c */
 extern bool walk(Node *, bool);
@@ -408,8 +533,17 @@ extern bool cond;
 /* which.c */
 extern bool rc_access(char *, bool, struct stat *);
 extern char *which(char *, bool);
+extern bool cmdhash_forget(char *);
+extern char *cmdhash_lookup(char *);
+extern void cmdhash_flush(void);
+extern void cmdhash_cd(void);
+extern void cmdhash_print(int);
+extern char *compl_path(const char *, int, bool *);
+extern char *compl_file(const char *, int);
 
 /* dist.c */
 #if RC_DIST
 #include "dist.h"
+#else
+#define ns_try(path, i) ((i) == 0 ? (path) : NULL)
 #endif
@@ -0,0 +1,174 @@
+/* read.c: the read builtin, a record at a time from a file descriptor */
+
+#include "rc.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+
+/*
+   read [-s] [-d delim] [-u fd] name assigns the next line (or record
+   ending in delim, the first character of its argument) read from fd,
+   0 by default, to name, and is false at the end of the input, so that
+
+	while (read line) ...
+
+   works through its input as it comes, in constant space. With -s the
+   record is split at $ifs characters into a list.
+
+   Reading a character at a time, as sh does so that nothing past the
+   record is used up, would cost a system call a byte. So the input is
+   read into a buffer kept for the fd. An ordinary file is read with
+   pread, and its offset set after each record, where a command run next
+   would expect it; the buffer still holds the rest for as long as the offset
+   is found there on the next call. Anything else cannot be put back, so
+   what read has taken from a pipe or terminal is seen only by later
+   reads of that fd. Either way the buffer belongs to the file the fd
+   had when it was filled, and is thrown away if the fd is now another.
+*/
+
+#define RBUFSIZE 65536
+#define NRBUF 8
+
+typedef struct {
+	int fd;			/* -1 if unused */
+	dev_t dev;
+	ino_t ino;
+	bool seekable;
+	off_t pos;		/* the file offset of buf[0], if seekable */
+	char *buf;
+	size_t start, end, room;
+	unsigned long used;
+} Rbuf;
+
+static Rbuf rbufs[NRBUF] = {
+	{ -1 }, { -1 }, { -1 }, { -1 }, { -1 }, { -1 }, { -1 }, { -1 }
+};
+static unsigned long rclock;
+
+/* the buffer for fd, emptied if it was the buffer of another file */
+static Rbuf *rbuf(int fd) {
+	struct stat st;
+	Rbuf *b, *old;
+	off_t cur = -1;
+	if (fstat(fd, &st) < 0)
+		return NULL;
+	if (S_ISREG(st.st_mode) && (cur = lseek(fd, 0, SEEK_CUR)) < 0)
+		return NULL;
+	for (b = old = rbufs; b < &rbufs[NRBUF]; b++) {
+		if (b->fd == fd)
+			break;
+		if (b->used < old->used)
+			old = b;
+	}
+	if (b == &rbufs[NRBUF]) {
+		b = old;
+		b->fd = -1;
+	}
+	if (b->fd != fd || b->dev != st.st_dev || b->ino != st.st_ino
+			|| (b->seekable && cur != b->pos + (off_t) b->start)) {
+		b->fd = fd;
+		b->dev = st.st_dev;
+		b->ino = st.st_ino;
+		b->seekable = S_ISREG(st.st_mode);
+		b->pos = cur;
+		b->start = b->end = 0;
+		if (b->buf == NULL)
+			b->buf = ealloc(b->room = RBUFSIZE);
+	}
+	b->used = ++rclock;
+	return b;
+}
+
+/* put the next record in b, without its delimiter, in *rec: 1, or 0 at the end, -1 on error */
+static int record(Rbuf *b, int delim, char **rec, size_t *len) {
+	char *d;
+	ssize_t n;
+	size_t from = b->start;
+	for (;;) {
+		if ((d = memchr(b->buf + from, delim, b->end - from)) != NULL) {
+			*rec = b->buf + b->start;
+			*len = d - *rec;
+			b->start = d + 1 - b->buf;
+			return 1;
+		}
+		if (b->start > 0) {
+			memmove(b->buf, b->buf + b->start, b->end - b->start);
+			b->end -= b->start;
+			b->pos += b->start;
+			b->start = 0;
+		}
+		if (b->end == b->room)
+			b->buf = erealloc(b->buf, b->room *= 2);
+		from = b->end;
+		if (b->seekable)
+			n = pread(b->fd, b->buf + b->end, b->room - b->end, b->pos + b->end);
+		else
+			n = rc_read(b->fd, b->buf + b->end, b->room - b->end);
+		if (n < 0)
+			return -1;
+		if (n == 0) {
+			if (b->end == b->start)
+				return 0;
+			*rec = b->buf + b->start;
+			*len = b->end - b->start;
+			b->start = b->end;
+			return 1;
+		}
+		b->end += n;
+	}
+}
+
+extern void b_read(char **av) {
+	bool split = FALSE;
+	int ac, c, delim = '\n', fd = 0;
+	char *rec, *w;
+	size_t len;
+	Rbuf *b;
+	Ifs ifs;
+	int r;
+	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
+		; /* count the arguments for getopt */
+	while ((c = rc_getopt(ac, av, "d:su:")) != -1)
+		switch (c) {
+		default: set(FALSE); return;
+		case 'd': delim = *(unsigned char *) rc_optarg; break;
+		case 's': split = TRUE; break;
+		case 'u':
+			if ((fd = a2u(rc_optarg)) < 0) {
+				fprint(2, RC "`%s' is a bad number\n", rc_optarg);
+				set(FALSE);
+				return;
+			}
+			break;
+		}
+	av += rc_optind;
+	if (av[0] == NULL || av[1] != NULL) {
+		fprint(2, RC "usage: read [-s] [-d delim] [-u fd] name\n");
+		set(FALSE);
+		return;
+	}
+	if ((b = rbuf(fd)) == NULL) {
+		uerror("read");
+		set(FALSE);
+		return;
+	}
+	r = record(b, delim, &rec, &len);
+	if (b->seekable)
+		lseek(fd, b->pos + b->start, SEEK_SET);
+	if (r <= 0) {
+		if (r < 0 && errno != EINTR)
+			uerror("read");
+		set(FALSE);
+		sigchk();
+		return;
+	}
+	w = nalloc(len + 1);
+	memcpy(w, rec, len);
+	w[len] = '\0';
+	if (split) {
+		mkifs(&ifs, varlookup("ifs"));
+		varassign(*av, ifssplit(&ifs, w, len), FALSE);
+	} else
+		varassign(*av, word(w, NULL), FALSE);
+	set(TRUE);
+}
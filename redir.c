@@ -2,21 +2,57 @@
 
 #include "rc.h"
 
+#include <limits.h>
+
+#ifndef PIPE_BUF
+#define PIPE_BUF 512 /* the POSIX minimum */
+#endif
+
 /*
    Walk the redirection queue, and open files and dup2 to them. Also,
-   here-documents are treated here by dumping them down a pipe. (this
-   should make here-documents fast on systems with lots of memory which
-   do pipes right. Under sh, a file is copied to /tmp, and then read
-   out of /tmp again. I'm interested in knowing how much faster, say,
-   shar runs when unpacking when invoked with rc instead of sh. On my
-   sun4/280, it runs in about 60-75% of the time of sh for unpacking
-   the rc source distribution.)
+   here-documents are treated here. Where the system has anonymous
+   files (memfd_create() or O_TMPFILE) the document is written into one,
+   which costs no fork and gives the reader a seekable file. Otherwise
+   it is dumped down a pipe: directly, if it fits in the pipe without
+   blocking, or else by a child process. (this should make
+   here-documents fast on systems with lots of memory which do pipes
+   right. Under sh, a file is copied to /tmp, and then read out of /tmp
+   again. I'm interested in knowing how much faster, say, shar runs when
+   unpacking when invoked with rc instead of sh. On my sun4/280, it runs
+   in about 60-75% of the time of sh for unpacking the rc source
+   distribution.)
 */
 
+static int heredocfd(List *doc) {
+	int fd, p[2];
+	size_t len = (doc != NULL) ? strlen(doc->w) : 0;
+	if ((fd = rc_tmpfd()) >= 0) {
+		writeall(fd, doc != NULL ? doc->w : "", len);
+		if (lseek(fd, 0, SEEK_SET) == 0)
+			return fd;
+		close(fd);
+	}
+	if (pipe(p) < 0) {
+		uerror("pipe");
+		rc_error(NULL);
+	}
+	if (len <= PIPE_BUF) { /* fits without blocking */
+		writeall(p[1], doc != NULL ? doc->w : "", len);
+	} else if (rc_fork() == 0) { /* child writes to pipe */
+		setsigdefaults(FALSE);
+		close(p[0]);
+		writeall(p[1], doc->w, len);
+		exit(0);
+	}
+	close(p[1]);
+	return p[0];
+}
+
 extern void doredirs() {
 	List *fname;
-	int fd, p[2];
+	int fd;
 	Rq *r;
+	flushout();
 	for (r = redirq; r != NULL; r = r->n) {
 		switch(r->r->type) {
 		default:
@@ -25,21 +61,8 @@ extern void doredirs() {
 		case nRedir:
 			if (r->r->u[0].i == rHerestring) {
 				fname = flatten(glom(r->r->u[2].p)); /* fname is really a string */
-				if (pipe(p) < 0) {
-					uerror("pipe");
+				if (mvfd(heredocfd(fname), r->r->u[1].i) < 0)
 					rc_error(NULL);
-				}
-				if (rc_fork() == 0) { /* child writes to pipe */
-					setsigdefaults(FALSE);
-					close(p[0]);
-					if (fname != NULL)
-						writeall(p[1], fname->w, strlen(fname->w));
-					exit(0);
-				} else {
-					close(p[1]);
-					if (mvfd(p[0], r->r->u[1].i) < 0)
-						rc_error(NULL);
-				}
 			} else {
 				fname = glob(glom(r->r->u[2].p));
 				if (fname == NULL)
@@ -0,0 +1,111 @@
+/* regex.c: the regex builtin, extended regular expressions without grep */
+
+#include "rc.h"
+
+#include <regex.h>
+
+/*
+   regex [-i] [-v name] pattern word... is true if the extended regular
+   expression matches any of the words, case blind with -i. With -v the
+   part of the first of them that matched, and then that of each
+   parenthesised group, are assigned to name as a list, with '' for a
+   group that took no part.
+
+   A script checks its arguments against the same few patterns over
+   and over, so the compiled forms of the last NRECACHE are kept, and
+   the least recently used is the one to go.
+*/
+
+#define NRECACHE 32
+#define NGROUPS 10 /* the whole match and \1 to \9 */
+
+typedef struct {
+	char *pat;		/* NULL if unused */
+	int flags;
+	regex_t re;
+	unsigned long used;
+} Recache;
+
+static Recache recache[NRECACHE];
+static unsigned long reclock;
+
+static regex_t *recomp(char *pat, int flags) {
+	Recache *c, *old;
+	char msg[256];
+	int e;
+	for (c = old = recache; c < &recache[NRECACHE]; c++) {
+		if (c->pat != NULL && c->flags == flags && streq(c->pat, pat)) {
+			c->used = ++reclock;
+			return &c->re;
+		}
+		if (c->used < old->used)
+			old = c;
+	}
+	if (old->pat != NULL) {
+		regfree(&old->re);
+		efree(old->pat);
+		old->pat = NULL;
+		old->used = 0;
+	}
+	if ((e = regcomp(&old->re, pat, flags)) != 0) {
+		regerror(e, &old->re, msg, sizeof msg);
+		fprint(2, RC "regex: %s: %s\n", pat, msg);
+		return NULL;
+	}
+	old->pat = ecpy(pat);
+	old->flags = flags;
+	old->used = ++reclock;
+	return &old->re;
+}
+
+extern void b_regex(char **av) {
+	int ac, c, i, flags = REG_EXTENDED;
+	char *var = NULL, *w;
+	regmatch_t g[NGROUPS];
+	List *top, **tail;
+	regex_t *re;
+	size_t n;
+	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
+		; /* count the arguments for getopt */
+	while ((c = rc_getopt(ac, av, "iv:")) != -1)
+		switch (c) {
+		default: set(FALSE); return;
+		case 'i': flags |= REG_ICASE; break;
+		case 'v': var = rc_optarg; break;
+		}
+	av += rc_optind;
+	if (*av == NULL) {
+		fprint(2, RC "usage: regex [-i] [-v name] pattern word ...\n");
+		set(FALSE);
+		return;
+	}
+	if (var == NULL)
+		flags |= REG_NOSUB;
+	if ((re = recomp(*av, flags)) == NULL) {
+		set(FALSE);
+		return;
+	}
+	for (av++; *av != NULL; av++)
+		if (regexec(re, *av, var != NULL ? NGROUPS : 0, var != NULL ? g : NULL, 0) == 0)
+			break;
+	if (*av == NULL) {
+		set(FALSE);
+		return;
+	}
+	if (var != NULL) {
+		n = re->re_nsub + 1 < NGROUPS ? re->re_nsub + 1 : NGROUPS;
+		for (top = NULL, tail = &top, i = 0; i < (int) n; i++) {
+			if (g[i].rm_so < 0)
+				w = "";
+			else {
+				w = nalloc(g[i].rm_eo - g[i].rm_so + 1);
+				memcpy(w, *av + g[i].rm_so, g[i].rm_eo - g[i].rm_so);
+				w[g[i].rm_eo - g[i].rm_so] = '\0';
+			}
+			*tail = word(w, NULL);
+			tail = &(*tail)->n;
+		}
+		varassign(var, top, FALSE);
+	}
+	set(TRUE);
+}
@@ -2,6 +2,9 @@
 
 #include "rc.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <setjmp.h>
 
@@ -27,13 +30,31 @@ void (*sys_signal(int signum, void (*handler)(int)))(int) {
 
 void (*sighandlers[NUMOFSIGNALS])(int);
 
-static volatile sig_atomic_t sigcount, caught[NUMOFSIGNALS];
+/*
+   A caught signal is marked in caught[] with the order it came in, and
+   sigchk() sees to the earliest marked. Each is marked once at most,
+   and the handler does it in a single store, so one handler that
+   interrupts another cannot lose it. As well, once rc has waited for
+   the terminal with sigpoll(), the handler writes a byte down a pipe,
+   only to wake it: a blocking read would otherwise miss a signal that
+   came just before it, and sit waiting for a line before the signal
+   was seen to.
+*/
+
+#define SIGFD 63 /* out of the way of user redirections */
+
+static volatile sig_atomic_t caught[NUMOFSIGNALS], sigwaiting, sigseq;
+static int sigpipe[2] = { -1, -1 };
 
 extern void catcher(int s) {
+	int e = errno;
 	if (caught[s] == 0) {
-		sigcount++;
-		caught[s] = 1;
+		caught[s] = ++sigseq;
+		if (sigpipe[1] >= 0)
+			write(sigpipe[1], "", 1);
 	}
+	sigwaiting = 1;
+	errno = e;
 	sys_signal(s, catcher);
 
 #if HAVE_RESTARTABLE_SYSCALLS
@@ -45,21 +66,31 @@ extern void catcher(int s) {
 
 extern void sigchk() {
 	void (*h)(int);
-	int s, i;
+	char buf[64];
+	int i, n, s, e;
 
-	if (sigcount == 0)
+	if (!sigwaiting)
 		return; /* ho hum; life as usual */
 	if (forked)
 		exit(1); /* exit unconditionally on a signal in a child process */
-	for (i = 0, s = -1; i < NUMOFSIGNALS; i++)
+	sigwaiting = 0; /* before the scan: a signal during it sets it again */
+	for (s = 0, n = 0, i = 1; i < NUMOFSIGNALS; i++)
 		if (caught[i] != 0) {
-			s = i;
-			--sigcount;
-			caught[s] = 0;
-			break;
+			n++;
+			if (s == 0 || caught[i] < caught[s])
+				s = i;
 		}
-	if (s == -1)
-		panic("all-zero sig vector with nonzero sigcount");
+	if (s == 0)
+		return;
+	caught[s] = 0;
+	if (n > 1)
+		sigwaiting = 1; /* the rest, at the next sigchk() */
+	if (sigpipe[0] >= 0) {
+		e = errno; /* the caller may be about to look at it */
+		while (read(sigpipe[0], buf, sizeof buf) > 0)
+			; /* sigpoll() looks at sigwaiting first */
+		errno = e;
+	}
 	if ((h = sighandlers[s]) == SIG_DFL)
 		panic("caught signal set to SIG_DFL");
 	if (h == SIG_IGN)
@@ -67,6 +98,53 @@ extern void sigchk() {
 	(*h)(s);
 }
 
+static int sigfdup(int fd) {
+	int r;
+	if ((r = fcntl(fd, F_DUPFD, SIGFD)) < 0)
+		return fd;
+	close(fd);
+	return r;
+}
+
+static bool sigpipeopen() {
+	int p[2], i;
+	if (pipe(p) < 0)
+		return FALSE;
+	for (i = 0; i < 2; i++) {
+		p[i] = sigfdup(p[i]);
+		fcntl(p[i], F_SETFL, fcntl(p[i], F_GETFL) | O_NONBLOCK);
+		closeonexec(p[i]);
+	}
+	sigpipe[0] = p[0];
+	sigpipe[1] = p[1]; /* the handler may use it from here on */
+	return TRUE;
+}
+
+/* wait until fd has something to read, or a signal has come */
+
+extern void sigpoll(int fd) {
+	struct pollfd p[2];
+	if (sigpipe[0] < 0 && !sigpipeopen())
+		return;
+	if (sigwaiting)
+		return;
+	p[0].fd = fd;
+	p[0].events = POLLIN;
+	p[1].fd = sigpipe[0];
+	p[1].events = POLLIN;
+	poll(p, 2, -1);
+}
+
+/* the descriptors of the pipe, for rfork f to leave open */
+
+extern int sigfds(int *fds) {
+	if (sigpipe[0] < 0)
+		return 0;
+	fds[0] = sigpipe[0];
+	fds[1] = sigpipe[1];
+	return 2;
+}
+
 extern void (*rc_signal(int s, void (*h)(int)))(int) {
 	void (*old)(int);
 	sigchk();
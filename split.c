@@ -0,0 +1,91 @@
+/* split.c: breaking text into words at $ifs characters */
+
+#include "rc.h"
+
+/*
+   Most of the time is spent looking for the end of a word, so that is
+   where the effort goes. With only one or two separators ('\0' is always
+   one) memchr() is used; with up to MAXSWAR, the text is examined a
+   machine word at a time, using the old trick for finding a zero byte
+   in a word; beyond that, a byte at a time through the table.
+*/
+
+#define ONES	((size_t) -1 / 255)		/* 0x0101...01 */
+#define HIGHS	(ONES * 128)			/* 0x8080...80 */
+#define haszero(x)	(((x) - ONES) & ~(x) & HIGHS)
+
+extern void mkifs(Ifs *ifs, List *l) {
+	char *s;
+	int c;
+	memzero(ifs->map, sizeof ifs->map);
+	for (ifs->map['\0'] = TRUE; l != NULL; l = l->n)
+		for (s = l->w; *s != '\0'; s++)
+			ifs->map[*(unsigned char *) s] = TRUE;
+	for (ifs->nsep = c = 0; c < 256; c++)
+		if (ifs->map[c]) {
+			if (ifs->nsep < MAXSWAR) {
+				ifs->sep[ifs->nsep] = c;
+				ifs->pat[ifs->nsep] = ONES * c;
+			}
+			ifs->nsep++;
+		}
+}
+
+/* return the first separator in [s, end), or end */
+
+static char *wordend(Ifs *ifs, char *s, char *end) {
+	char *t, *z;
+	size_t x, hit;
+	int i;
+	switch (ifs->nsep) {
+	case 1:
+		z = memchr(s, '\0', end - s);
+		return (z != NULL) ? z : end;
+	case 2:
+		if ((t = memchr(s, ifs->sep[1], end - s)) == NULL)
+			t = end;
+		z = memchr(s, '\0', t - s);
+		return (z != NULL) ? z : t;
+	}
+	if (ifs->nsep <= MAXSWAR)
+		for (; end - s >= (int) sizeof x; s += sizeof x) {
+			memcpy(&x, s, sizeof x);
+			for (hit = 0, i = 0; i < ifs->nsep; i++)
+				hit |= haszero(x ^ ifs->pat[i]);
+			if (hit)
+				break;
+		}
+	while (s < end && !ifs->map[*(unsigned char *) s])
+		s++;
+	return s;
+}
+
+/*
+   Split the len bytes at buf into a list of words, in place: separators
+   are overwritten with '\0', and buf[len] must be writable so that the
+   last word can be terminated too. The list is allocated in the arena.
+*/
+
+extern List *ifssplit(Ifs *ifs, char *buf, size_t len) {
+	char *s, *w, *end;
+	List *top, **tail, *r;
+	top = NULL;
+	tail = &top;
+	for (s = buf, end = &buf[len]; ; s++) {
+		while (s < end && ifs->map[*(unsigned char *) s])
+			s++;
+		if (s == end)
+			break;
+		w = s;
+		s = wordend(ifs, s, end);
+		*s = '\0';
+		r = *tail = nnew(List);
+		r->w = w;
+		r->m = NULL;
+		tail = &r->n;
+		if (s == end)
+			break;
+	}
+	*tail = NULL;
+	return top;
+}
@@ -9,8 +9,37 @@
 
 static void statprint(pid_t, int);
 
-static int statuses[MAX_PIPELINE];
-static int pipelength = 1;
+static int first[8];
+static int *statuses = first;
+static int pipelength = 1, room = arraysize(first);
+
+/*
+   The CPU seconds each stage of the last pipeline took, for the time
+   builtin, which can tell from npipes whether one has finished since
+   it last looked.
+*/
+
+static double firstcpu[arraysize(first)];
+static double *cpus = firstcpu;
+static int ncpus;
+static unsigned long npipes;
+
+/* make room for the statuses of a pipeline n long */
+
+static void statusroom(int n) {
+	if (n <= room)
+		return;
+	while (room < n)
+		room *= 2;
+	if (statuses == first) {
+		statuses = ealloc(room * sizeof *statuses);
+		memcpy(statuses, first, sizeof first);
+		cpus = ealloc(room * sizeof *cpus);
+	} else {
+		statuses = erealloc(statuses, room * sizeof *statuses);
+		cpus = erealloc(cpus, room * sizeof *cpus);
+	}
+}
 
 /*
    Test to see if rc's status is true. According to td, status is true
@@ -57,16 +86,27 @@ extern void setstatus(pid_t pid, int stat) {
 /* set number of statuses for pipeline */
 
 extern void setpipestatuslength(int n) {
-	pipelength = n;
+	statusroom(n);
+	pipelength = ncpus = n;
+	npipes++;
 }
 
-/* set a status of a pipeline */
+/* set a status of a pipeline, and the CPU time the stage took */
 
-extern void setpipestatus(int i, pid_t pid, int stat) {
+extern void setpipestatus(int i, pid_t pid, int stat, double cpu) {
 	statuses[i] = stat;
+	cpus[i] = cpu;
 	statprint(pid, stat);
 }
 
+/* the CPU times of the last pipeline, in the order of $status */
+
+extern int pipecpu(double **cpu, unsigned long *gen) {
+	*cpu = cpus;
+	*gen = npipes;
+	return ncpus;
+}
+
 /* 
    Print a message if called from the wait builitin in an interactive 
    shell or termination was with a signal and it is not sigint and
@@ -126,6 +166,7 @@ extern void ssetstatus(char **av) {
 	bool found;
 	for (l = 0; av[l] != NULL; l++)
 		; /* count up array length */
+	statusroom(l);
 	--l;
 	for (i = 0; av[i] != NULL; i++) {
 		j = a2u(av[i]);
@@ -0,0 +1,226 @@
+/* string.c: the string builtin, for the edits scripts would fork sed for */
+
+#include "rc.h"
+
+#include <ctype.h>
+#include <limits.h>
+
+/*
+   string [-v name] op arg... applies op to each of its words, and
+   assigns the words that result to name or, without -v, prints them
+   one to a line. The ops are
+
+	length word...		the length of each word
+	sub range word...	the bytes range picks out, as a subscript
+	split sep word...	each word cut at each sep ("" for bytes)
+	replace old new word...	each old replaced by new
+	trim word...		leading and trailing white space taken off
+	upper word...		letters made capitals
+	lower word...		and small
+
+   The words come from the arena, and if a result is a whole argument
+   it is not copied at all.
+*/
+
+typedef struct {
+	List *top, **tail;
+} Out;
+
+static void put(Out *o, char *w) {
+	List *l = nnew(List);
+	l->w = w;
+	l->m = NULL;
+	l->n = NULL;
+	*o->tail = l;
+	o->tail = &l->n;
+}
+
+static char *slice(char *s, size_t len) {
+	char *r = nalloc(len + 1);
+	memcpy(r, s, len);
+	r[len] = '\0';
+	return r;
+}
+
+/* the digits from s up to e as a2u() has them; -1 if there is anything else */
+static int spanu(char *s, char *e) {
+	unsigned int i;
+	for (i = 0; s < e; s++) {
+		if (*s < '0' || *s > '9')
+			return -1;
+		i = i * 10 + (*s - '0');
+	}
+	return (int) i;
+}
+
+/*
+   n, n- or n-m, as in $x(n-m); the range is 1-based and takes in m.
+   s is only read: it may be a word of a function in a loaded library,
+   which is mapped read-only.
+*/
+static bool range(char *s, size_t *from, size_t *to) {
+	char *dash = strchr(s, '-');
+	int n, m;
+	if (dash == NULL) {
+		n = m = a2u(s);
+	} else {
+		n = spanu(s, dash);
+		m = dash[1] == '\0' ? INT_MAX : a2u(dash + 1);
+	}
+	if (n < 1 || m < 0)
+		return FALSE;
+	*from = n - 1;
+	*to = m;
+	return TRUE;
+}
+
+static void sub(Out *o, char *r, char **av) {
+	size_t from, to, len, end;
+	if (!range(r, &from, &to)) {
+		fprint(2, RC "string: `%s' is a bad range\n", r);
+		set(FALSE);
+		return;
+	}
+	for (; *av != NULL; av++) {
+		len = strlen(*av);
+		end = to < len ? to : len;
+		put(o, from >= end ? "" : from == 0 && end == len ? *av : slice(*av + from, end - from));
+	}
+}
+
+static void split(Out *o, char *sep, char **av) {
+	size_t n = strlen(sep);
+	char *s, *e;
+	for (; *av != NULL; av++) {
+		s = *av;
+		if (n == 0) {
+			for (; *s != '\0'; s++)
+				put(o, slice(s, 1));
+			continue;
+		}
+		while ((e = strstr(s, sep)) != NULL) {
+			put(o, slice(s, e - s));
+			s = e + n;
+		}
+		put(o, s == *av ? s : slice(s, strlen(s)));
+	}
+}
+
+static void replace(Out *o, char *old, char *new, char **av) {
+	size_t n = strlen(old), m = strlen(new), len;
+	char *s, *e, *r, *p;
+	int count;
+	if (n == 0) {
+		fprint(2, RC "string: nothing to replace\n");
+		set(FALSE);
+		return;
+	}
+	for (; *av != NULL; av++) {
+		for (count = 0, s = *av; (e = strstr(s, old)) != NULL; s = e + n)
+			count++;
+		if (count == 0) {
+			put(o, *av);
+			continue;
+		}
+		len = strlen(*av);
+		r = p = nalloc(len - count * n + count * m + 1);
+		for (s = *av; (e = strstr(s, old)) != NULL; s = e + n) {
+			memcpy(p, s, e - s);
+			p += e - s;
+			memcpy(p, new, m);
+			p += m;
+		}
+		strcpy(p, s);
+		put(o, r);
+	}
+}
+
+static void trim(Out *o, char **av) {
+	char *s, *e;
+	for (; *av != NULL; av++) {
+		for (s = *av; *s == ' ' || *s == '\t' || *s == '\n'; s++)
+			;
+		for (e = s + strlen(s); e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\n'); e--)
+			;
+		put(o, *e == '\0' ? s : slice(s, e - s));
+	}
+}
+
+static void mapcase(Out *o, int (*f)(int), char **av) {
+	char *s, *r;
+	for (; *av != NULL; av++) {
+		for (s = *av; *s != '\0' && (*f)((unsigned char) *s) == (unsigned char) *s; s++)
+			;
+		if (*s == '\0') {
+			put(o, *av);
+			continue;
+		}
+		r = ncpy(*av);
+		for (s = r + (s - *av); *s != '\0'; s++)
+			*s = (*f)((unsigned char) *s);
+		put(o, r);
+	}
+}
+
+static bool needs(char **av, int n) {
+	int i;
+	for (i = 1; i <= n; i++)
+		if (av[i] == NULL) {
+			fprint(2, RC "string: %s needs %d argument%s\n", *av, n, n == 1 ? "" : "s");
+			set(FALSE);
+			return FALSE;
+		}
+	return TRUE;
+}
+
+extern void b_string(char **av) {
+	char *var = NULL;
+	Out o;
+	List *l;
+	int ac, c;
+	for (rc_optind = ac = 0; av[ac] != NULL; ac++)
+		; /* count the arguments for getopt */
+	while ((c = rc_getopt(ac, av, "v:")) != -1)
+		switch (c) {
+		default: set(FALSE); return;
+		case 'v': var = rc_optarg; break;
+		}
+	av += rc_optind;
+	if (*av == NULL) {
+		fprint(2, RC "usage: string [-v name] length|sub|split|replace|trim|upper|lower arg ...\n");
+		set(FALSE);
+		return;
+	}
+	o.top = NULL;
+	o.tail = &o.top;
+	set(TRUE);
+	if (streq(*av, "length")) {
+		for (av++; *av != NULL; av++)
+			put(&o, nprint("%d", (int) strlen(*av)));
+	} else if (streq(*av, "sub")) {
+		if (needs(av, 1))
+			sub(&o, av[1], av + 2);
+	} else if (streq(*av, "split")) {
+		if (needs(av, 1))
+			split(&o, av[1], av + 2);
+	} else if (streq(*av, "replace")) {
+		if (needs(av, 2))
+			replace(&o, av[1], av[2], av + 3);
+	} else if (streq(*av, "trim")) {
+		trim(&o, av + 1);
+	} else if (streq(*av, "upper")) {
+		mapcase(&o, toupper, av + 1);
+	} else if (streq(*av, "lower")) {
+		mapcase(&o, tolower, av + 1);
+	} else {
+		fprint(2, RC "string: `%s' is not an op\n", *av);
+		set(FALSE);
+	}
+	if (!istrue())
+		return;
+	if (var != NULL)
+		varassign(var, o.top, FALSE);
+	else
+		for (l = o.top; l != NULL; l = l->n)
+			fprint(1, "%s\n", l->w);
+}
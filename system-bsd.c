@@ -15,6 +15,7 @@ static size_t safe_remain;
 extern void writeall(int fd, char *buf, size_t remain) {
 	int i;
 
+	flushout(); /* anything fprint() has kept back goes first */
 	safe_buf = buf;
 	safe_remain = remain;
 	for (i = 0; safe_remain > 0; buf += i, safe_remain -= i) {
@@ -45,10 +46,10 @@ extern int rc_read(int fd, char *buf, size_t n) {
 }
 
 static int r = -1;
-extern pid_t rc_wait(int *stat) {
+extern pid_t rc_wait(int *stat, struct rusage *ru) {
 	if (sigsetjmp(slowbuf.j, 1) == 0) {
 		slow = TRUE;
-		r = wait(stat);
+		r = wait3(stat, 0, ru);
 	} else {
 		errno = EINTR;
 		r = -1;
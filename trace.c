@@ -0,0 +1,168 @@
+/* trace.c: a timeline of what rc does, for -T */
+
+#include "rc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+/*
+   Each event is one line of Chrome's trace format (chrome://tracing,
+   or https://ui.perfetto.dev), and the lines are gathered in a buffer
+   that goes to the file named by $rctrace (rctrace.json if it is unset)
+   when it fills, before an exec, and at exit. The file is opened for
+   appending the first time, so an rc run by a traced rc can add to it;
+   the closing "]" of the array is optional in the format, and left off.
+   Times are in microseconds of the monotonic clock, which all processes
+   share. A child forked by rc drops the events it inherited, which are
+   its parent's to write.
+*/
+
+#define TRACEFD 65 /* out of the way of user redirections */
+
+static char tbuf[8192];
+static size_t tlen;
+static int tracefd = -1;
+
+extern double tracenow() {
+	struct timespec ts;
+	if (!dashtee)
+		return 0;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static bool traceopen() {
+	List *f = varlookup("rctrace");
+	char *name = f != NULL ? f->w : "rctrace.json";
+	struct stat st;
+	int fd;
+	if ((fd = open(name, O_WRONLY | O_APPEND | O_CREAT, 0666)) < 0) {
+		uerror(name);
+		return FALSE;
+	}
+	if ((tracefd = fcntl(fd, F_DUPFD, TRACEFD)) < 0)
+		tracefd = fd;
+	else
+		close(fd);
+	closeonexec(tracefd);
+	if (fstat(tracefd, &st) == 0 && st.st_size == 0)
+		writeall(tracefd, "[\n", 2);
+	return TRUE;
+}
+
+extern void traceflush() {
+	if (tlen == 0)
+		return;
+	if (tracefd < 0 && !traceopen()) {
+		dashtee = FALSE; /* say so once only */
+		tlen = 0;
+		return;
+	}
+	writeall(tracefd, tbuf, tlen);
+	tlen = 0;
+}
+
+extern void tracefork() {
+	tlen = 0;
+}
+
+/* s as a JSON string, shortened if need be, into buf of size n */
+static void jsonstr(char *buf, size_t n, char *s) {
+	size_t i = 0;
+	for (; *s != '\0' && i + 7 < n; s++) {
+		unsigned char c = *s;
+		if (c == '"' || c == '\\') {
+			buf[i++] = '\\';
+			buf[i++] = c;
+		} else if (c < ' ') {
+			sprintf(buf + i, "\\u%04x", c);
+			i += 6;
+		} else {
+			buf[i++] = c;
+		}
+	}
+	buf[i] = '\0';
+}
+
+static void event(char *ph, char *cat, char *name, double ts, double dur) {
+	char jname[256], line[512];
+	int n;
+	jsonstr(jname, sizeof jname, name == NULL ? "" : name);
+	if (*ph == 'X')
+		n = snprintf(line, sizeof line,
+			"{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d},\n",
+			jname, cat, ts, dur, (int) getpid(), (int) getpid());
+	else
+		n = snprintf(line, sizeof line,
+			"{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d},\n",
+			jname, cat, ts, (int) getpid(), (int) getpid());
+	if (n < 0 || (size_t) n >= sizeof line)
+		return;
+	if (tlen + n > sizeof tbuf)
+		traceflush();
+	memcpy(tbuf + tlen, line, n);
+	tlen += n;
+}
+
+/* something that began at start (from tracenow()) and has just ended */
+extern void trace(char *cat, char *name, double start) {
+	if (dashtee)
+		event("X", cat, name, start, tracenow() - start);
+}
+
+/* something that happens at an instant */
+extern void tracemark(char *cat, char *name) {
+	if (dashtee)
+		event("i", cat, name, tracenow(), 0);
+}
+
+/*
+   Function profiles, for whatis -t. A call's total time runs from entry
+   to return and includes that of the functions it calls, which is taken
+   off its self time. A recursive call adds to the self time only, so the
+   outermost call's total is not counted twice. The child CPU time is
+   that of the children reaped during the call.
+*/
+
+static double fninner; /* the total time of calls made by the current function */
+
+static double childcpu() {
+	struct rusage ru;
+	getrusage(RUSAGE_CHILDREN, &ru);
+	return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e6 + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+extern void profenter(Prof *p, char *name) {
+	rc_Function *f = lookup_fn(name);
+	if (f != NULL)
+		f->calls++;
+	if (!dashtee)
+		return;
+	p->t = tracenow();
+	p->cpu = childcpu();
+	p->inner = fninner;
+	p->recursive = f != NULL && f->def != NULL && treebusy(f->def);
+	fninner = 0;
+}
+
+extern void profleave(Prof *p, char *name) {
+	rc_Function *f;
+	double dur;
+	if (!dashtee)
+		return;
+	dur = tracenow() - p->t;
+	if ((f = lookup_fn(name)) != NULL) {
+		if (!p->recursive) {
+			f->total += dur;
+			f->cpu += childcpu() - p->cpu;
+		}
+		f->self += dur - fninner;
+	}
+	fninner = p->inner + dur;
+	event("X", "fn", name, p->t, dur);
+}
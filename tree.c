@@ -19,10 +19,11 @@ extern Node *mk(enum nodetype t,...) {
 		n->u[2].i = va_arg(ap, int);
 		break;
 	case nWord:
-		n = nalloc(offsetof(Node, u[3]));
+		n = nalloc(offsetof(Node, u[4]));
 		n->u[0].s = va_arg(ap, char *);
 		n->u[1].s = va_arg(ap, char *);
 		n->u[2].i = va_arg(ap, int);
+		n->u[3].l = NULL;
 		break;
 	case nBang: case nNowait:
 	case nCount: case nFlat: case nRmfn: case nSubshell:
@@ -30,14 +31,26 @@ extern Node *mk(enum nodetype t,...) {
 		n = nalloc(offsetof(Node, u[1]));
 		n->u[0].p = va_arg(ap, Node *);
 		break;
+	case nArgs: case nLappend:
+		n = nalloc(offsetof(Node, u[3]));
+		n->u[0].p = va_arg(ap, Node *);
+		n->u[1].p = va_arg(ap, Node *);
+		n->u[2].l = NULL;
+		break;
 	case nAndalso: case nAssign: case nBackq: case nBody: case nBrace: case nConcat:
 	case nElse: case nEpilog: case nIf: case nNewfn: case nCbody:
-	case nOrelse: case nPre: case nArgs: case nSwitch:
-	case nMatch: case nVarsub: case nWhile: case nLappend:
+	case nOrelse: case nPre:
+	case nMatch: case nVarsub: case nWhile:
 		n = nalloc(offsetof(Node, u[2]));
 		n->u[0].p = va_arg(ap, Node *);
 		n->u[1].p = va_arg(ap, Node *);
 		break;
+	case nSwitch:
+		n = nalloc(offsetof(Node, u[3]));
+		n->u[0].p = va_arg(ap, Node *);
+		n->u[1].p = va_arg(ap, Node *);
+		n->u[2].sw = NULL;
+		break;
 	case nForin:
 		n = nalloc(offsetof(Node, u[3]));
 		n->u[0].p = va_arg(ap, Node *);
@@ -64,7 +77,11 @@ extern Node *mk(enum nodetype t,...) {
 	return n;
 }
 
-/* copy a tree to malloc space. Used when storing the definition of a function */
+/*
+   Copy a tree to space from alloc. Used when storing the definition
+   of a function, by treestore(). The literal values are not copied,
+   but treelit() is run on the copy by the caller, cheaply enough.
+*/
 
 extern Node *treecpy(Node *s, void *(*alloc)(size_t)) {
 	Node *n;
@@ -81,7 +98,7 @@ extern Node *treecpy(Node *s, void *(*alloc)(size_t)) {
 		n->u[2].i = s->u[2].i;
 		break;
 	case nWord:
-		n = (*alloc)(offsetof(Node, u[3]));
+		n = (*alloc)(offsetof(Node, u[4]));
 		n->u[0].s = strcpy((char *) (*alloc)(strlen(s->u[0].s) + 1), s->u[0].s);
 		if (s->u[1].s != NULL) {
 			size_t i = strlen(s->u[0].s);
@@ -90,20 +107,33 @@ extern Node *treecpy(Node *s, void *(*alloc)(size_t)) {
 		} else
 			n->u[1].s = NULL;
 		n->u[2].i = s->u[2].i;
+		n->u[3].l = NULL;
 		break;
 	case nBang: case nNowait: case nCase:
 	case nCount: case nFlat: case nRmfn: case nSubshell: case nVar:
 		n = (*alloc)(offsetof(Node, u[1]));
 		n->u[0].p = treecpy(s->u[0].p, alloc);
 		break;
+	case nArgs: case nLappend:
+		n = (*alloc)(offsetof(Node, u[3]));
+		n->u[0].p = treecpy(s->u[0].p, alloc);
+		n->u[1].p = treecpy(s->u[1].p, alloc);
+		n->u[2].l = NULL;
+		break;
 	case nAndalso: case nAssign: case nBackq: case nBody: case nBrace: case nConcat:
 	case nElse: case nEpilog: case nIf: case nNewfn: case nCbody:
-	case nOrelse: case nPre: case nArgs: case nSwitch:
-	case nMatch: case nVarsub: case nWhile: case nLappend:
+	case nOrelse: case nPre:
+	case nMatch: case nVarsub: case nWhile:
 		n = (*alloc)(offsetof(Node, u[2]));
 		n->u[0].p = treecpy(s->u[0].p, alloc);
 		n->u[1].p = treecpy(s->u[1].p, alloc);
 		break;
+	case nSwitch:
+		n = (*alloc)(offsetof(Node, u[3]));
+		n->u[0].p = treecpy(s->u[0].p, alloc);
+		n->u[1].p = treecpy(s->u[1].p, alloc);
+		n->u[2].sw = NULL;
+		break;
 	case nForin:
 		n = (*alloc)(offsetof(Node, u[3]));
 		n->u[0].p = treecpy(s->u[0].p, alloc);
@@ -129,46 +159,387 @@ extern Node *treecpy(Node *s, void *(*alloc)(size_t)) {
 	return n;
 }
 
+/*
+   A switch with many literal cases is dispatched through a hash table
+   of its case words, built once for the tree by treelit(). Cases are
+   numbered in order; the table gives the first literal case a word is
+   in, and the cases with patterns or variables are kept in a list of
+   their own, so that only those of them that come before the literal
+   case found need to be tried. The table is allocated as the tree is.
+*/
+
+#define SWMIN 4 /* the fewest literal cases worth a table */
+
+typedef struct {
+	char *w;	/* NULL for an empty slot */
+	int ord;
+	Node *at;	/* the link of the switch body holding the case */
+} Swent;
+
+struct Swtab {
+	size_t mask;
+	Swent *ent;
+	int nother;
+	Swent *other;
+};
+
+static unsigned long swhash(char *s) {
+	unsigned long h = 2166136261UL;
+	while (*s != '\0')
+		h = (h ^ (unsigned char) *s++) * 16777619UL;
+	return h;
+}
+
+/* TRUE if a case's words are literal, with their value in *l */
+
+static bool caselit(Node *w, List **l) {
+	*l = NULL;
+	if (w == NULL)
+		return TRUE; /* case (), which only () matches */
+	if (w->type == nWord)
+		*l = w->u[3].l;
+	else if (w->type == nArgs || w->type == nLappend)
+		*l = w->u[2].l;
+	return *l != NULL;
+}
+
+static Swtab *swbuild(Node *n, void *(*alloc)(size_t)) {
+	Node *at, *c;
+	List *l;
+	Swtab *sw;
+	size_t size, i;
+	int nlit = 0, nother = 0, ord;
+	for (at = n->u[1].p; at != NULL; at = at->u[1].p)
+		if ((c = at->u[0].p) != NULL && c->type == nCase) {
+			if (caselit(c->u[0].p, &l))
+				for (; l != NULL; l = l->n)
+					nlit++;
+			else
+				nother++;
+		}
+	if (nlit < SWMIN)
+		return NULL;
+	for (size = 1; size < 2 * (size_t) nlit; size <<= 1)
+		;
+	sw = (*alloc)(sizeof *sw);
+	sw->mask = size - 1;
+	sw->ent = (*alloc)(size * sizeof *sw->ent);
+	memzero(sw->ent, size * sizeof *sw->ent);
+	sw->nother = 0;
+	sw->other = nother > 0 ? (*alloc)(nother * sizeof *sw->other) : NULL;
+	for (ord = 0, at = n->u[1].p; at != NULL; at = at->u[1].p) {
+		if ((c = at->u[0].p) == NULL || c->type != nCase)
+			continue;
+		if (!caselit(c->u[0].p, &l)) {
+			sw->other[sw->nother].w = NULL;
+			sw->other[sw->nother].ord = ord;
+			sw->other[sw->nother++].at = at;
+		}
+		for (; l != NULL; l = l->n) {
+			for (i = swhash(l->w) & sw->mask; sw->ent[i].w != NULL; i = (i + 1) & sw->mask)
+				if (streq(sw->ent[i].w, l->w))
+					break;
+			if (sw->ent[i].w == NULL) { /* an earlier case has it first */
+				sw->ent[i].w = l->w;
+				sw->ent[i].ord = ord;
+				sw->ent[i].at = at;
+			}
+		}
+		ord++;
+	}
+	return sw;
+}
+
+/*
+   The link of the switch body holding the first case that v matches,
+   or NULL, as the cases would have been tried in order.
+*/
+
+extern Node *swcase(Node *n, List *v) {
+	Swtab *sw = n->u[2].sw;
+	Swent *best = NULL;
+	List *q;
+	size_t i;
+	int j;
+	for (q = v; q != NULL; q = q->n)
+		for (i = swhash(q->w) & sw->mask; sw->ent[i].w != NULL; i = (i + 1) & sw->mask)
+			if (streq(sw->ent[i].w, q->w)) {
+				if (best == NULL || sw->ent[i].ord < best->ord)
+					best = &sw->ent[i];
+				break;
+			}
+	for (j = 0; j < sw->nother && (best == NULL || sw->other[j].ord < best->ord); j++)
+		if (lmatch(v, glom(sw->other[j].at->u[0].p->u[0].p)))
+			return sw->other[j].at;
+	return best != NULL ? best->at : NULL;
+}
+
 /* free a function definition that is no longer needed */
 
 extern void treefree(Node *s) {
+	if (!inlib(s))
+		efree(s);
+}
+
+/*
+   Literal words (ones without metacharacters, and lists of them) have
+   the same value every time they are evaluated. treelit() works this
+   value out once, for the largest such subtrees of a finished tree, and
+   keeps it in the tree, so that glom() can return it without building
+   a new List each time round a loop. The List is shared, and must not
+   be changed; its words are those of the tree.
+*/
+
+static List **litlist(Node *n, List **tail, void *(*alloc)(size_t)) {
+	List *r;
+	if (n == NULL)
+		return tail;
+	if (n->type != nWord) {
+		tail = litlist(n->u[0].p, tail, alloc);
+		return litlist(n->u[1].p, tail, alloc);
+	}
+	r = *tail = (*alloc)(sizeof (List));
+	r->w = n->u[0].s;
+	r->m = NULL;
+	r->n = NULL;
+	return &r->n;
+}
+
+static void setlit(Node *n, void *(*alloc)(size_t)) {
+	List *l = NULL;
+	if (n == NULL)
+		return;
+	litlist(n, &l, alloc);
+	if (n->type == nWord)
+		n->u[3].l = l;
+	else
+		n->u[2].l = l;
+}
+
+/* returns TRUE if n is literal, leaving its value to be set by the caller */
+
+static bool lit(Node *n, void *(*alloc)(size_t)) {
+	bool a, b;
+	if (n == NULL)
+		return FALSE;
+	switch (n->type) {
+	default:
+		panic("unexpected node in treelit");
+		/* NOTREACHED */
+	case nDup:
+		return FALSE;
+	case nWord:
+		return n->u[1].s == NULL;
+	case nArgs: case nLappend:
+		a = (n->u[0].p == NULL || lit(n->u[0].p, alloc));
+		b = (n->u[1].p == NULL || lit(n->u[1].p, alloc));
+		if (a && b)
+			return TRUE;
+		if (a)
+			setlit(n->u[0].p, alloc);
+		if (b)
+			setlit(n->u[1].p, alloc);
+		return FALSE;
+	case nBang: case nNowait: case nCase:
+	case nCount: case nFlat: case nRmfn: case nSubshell: case nVar:
+		treelit(n->u[0].p, alloc);
+		return FALSE;
+	case nAndalso: case nAssign: case nBackq: case nBody: case nBrace: case nConcat:
+	case nElse: case nEpilog: case nIf: case nNewfn: case nCbody:
+	case nOrelse: case nPre:
+	case nMatch: case nVarsub: case nWhile:
+		treelit(n->u[0].p, alloc);
+		treelit(n->u[1].p, alloc);
+		return FALSE;
+	case nSwitch:
+		treelit(n->u[0].p, alloc);
+		treelit(n->u[1].p, alloc);
+		if (n->u[2].sw == NULL)
+			n->u[2].sw = swbuild(n, alloc);
+		return FALSE;
+	case nForin:
+		treelit(n->u[0].p, alloc);
+		treelit(n->u[1].p, alloc);
+		treelit(n->u[2].p, alloc);
+		return FALSE;
+	case nPipe:
+		treelit(n->u[2].p, alloc);
+		treelit(n->u[3].p, alloc);
+		return FALSE;
+	case nRedir: case nNmpipe:
+		treelit(n->u[2].p, alloc);
+		return FALSE;
+	}
+}
+
+extern void treelit(Node *n, void *(*alloc)(size_t)) {
+	if (lit(n, alloc))
+		setlit(n, alloc);
+}
+
+/*
+   Store a function definition in malloc space. The whole tree, with
+   its words, literal values and switch tables, goes in one block: a
+   body that was hundreds of small blocks, each with malloc's overhead
+   and all over the heap, is then a single one, walked in the order it
+   was laid out, and freed at a stroke. The root is allocated first,
+   and is the block itself.
+
+   The block is sized by a trial copy to scratch space, which has to be
+   malloc'd; the tree being stored may be in an arena already released
+   (see parseline()), which nalloc() would hand out again.
+*/
+
+#define storeround(n) (((n) + sizeof (align_t) - 1) & ~(sizeof (align_t) - 1))
+#define SCRATCHSIZE 4096
+
+typedef struct Scratch {
+	struct Scratch *n;
+	align_t mem[1];
+} Scratch;
+
+static Scratch *scratch;
+static char *storep;
+static size_t storesize, scratchleft;
+
+static void *storesizer(size_t n) {
+	size_t m = storeround(n);
+	Scratch *s;
+	storesize += m;
+	if (m > scratchleft) {
+		scratchleft = m > SCRATCHSIZE ? m : SCRATCHSIZE;
+		s = ealloc(offsetof(Scratch, mem) + scratchleft);
+		s->n = scratch;
+		scratch = s;
+		storep = (char *) s->mem;
+	}
+	scratchleft -= m;
+	storep += m;
+	return storep - m;
+}
+
+static void *storealloc(size_t n) {
+	void *r = storep;
+	storep += storeround(n);
+	return r;
+}
+
+/*
+   The layout of trees in this rc. A cache or library written by an rc
+   whose nodes or node types differ is refused with this, not misread.
+*/
+
+extern void treelayout(Treelayout *l) {
+	memzero(l, sizeof *l);
+	l->ntypes = nNmpipe + 1; /* the last of enum nodetype */
+	l->node = sizeof (Node);
+	l->list = sizeof (List);
+	l->swtab = sizeof (Swtab);
+	l->swent = sizeof (Swent);
+}
+
+/* the size of the block treestore() would allocate for s */
+
+extern size_t treelen(Node *s) {
+	Scratch *next;
+	storesize = scratchleft = 0;
+	treelit(treecpy(s, storesizer), storesizer);
+	for (; scratch != NULL; scratch = next) {
+		next = scratch->n;
+		efree(scratch);
+	}
+	return storesize;
+}
+
+/* copy s, as treestore() would, to the treelen(s) bytes at mem */
+
+extern Node *treeat(Node *s, void *mem) {
+	Node *n;
+	storep = mem;
+	n = treecpy(s, storealloc);
+	treelit(n, storealloc);
+	return n;
+}
+
+extern Node *treestore(Node *s) {
 	if (s == NULL)
+		return NULL;
+	return treeat(s, ealloc(treelen(s)));
+}
+
+/*
+   Move the pointers of a stored tree (see fnlib.c), which is at n but
+   was laid out d bytes away, along with it. Each pointer field is
+   reached once, by way of the node that owns it.
+*/
+
+#define reloc(p) ((p) = (p) == NULL ? NULL : (void *) ((char *) (p) + d))
+
+static void listreloc(List **l, ptrdiff_t d) {
+	for (reloc(*l); *l != NULL; l = &(*l)->n, reloc(*l)) {
+		reloc((*l)->w);
+		reloc((*l)->m);
+	}
+}
+
+extern void treereloc(Node *n, ptrdiff_t d) {
+	Swtab *sw;
+	size_t i;
+	int j;
+	if (n == NULL)
 		return;
-	switch (s->type) {
+	switch (n->type) {
 	default:
-		panic("unexpected node in treefree");
+		panic("unexpected node in treereloc");
 		/* NOTREACHED */
 	case nDup:
 		break;
 	case nWord:
-		efree(s->u[0].s);
-		efree(s->u[1].s);
+		reloc(n->u[0].s);
+		reloc(n->u[1].s);
+		listreloc(&n->u[3].l, d);
 		break;
-	case nBang: case nNowait:
-	case nCount: case nFlat: case nRmfn:
-	case nSubshell: case nVar: case nCase:
-		treefree(s->u[0].p);
+	case nBang: case nNowait: case nCase:
+	case nCount: case nFlat: case nRmfn: case nSubshell: case nVar:
+		treereloc(reloc(n->u[0].p), d);
+		break;
+	case nArgs: case nLappend:
+		treereloc(reloc(n->u[0].p), d);
+		treereloc(reloc(n->u[1].p), d);
+		listreloc(&n->u[2].l, d);
 		break;
 	case nAndalso: case nAssign: case nBackq: case nBody: case nBrace: case nConcat:
-	case nElse: case nEpilog: case nIf: case nNewfn:
-	case nOrelse: case nPre: case nArgs: case nCbody:
-	case nSwitch: case nMatch:  case nVarsub: case nWhile:
-	case nLappend:
-		treefree(s->u[1].p);
-		treefree(s->u[0].p);
+	case nElse: case nEpilog: case nIf: case nNewfn: case nCbody:
+	case nOrelse: case nPre:
+	case nMatch: case nVarsub: case nWhile:
+		treereloc(reloc(n->u[0].p), d);
+		treereloc(reloc(n->u[1].p), d);
+		break;
+	case nSwitch:
+		treereloc(reloc(n->u[0].p), d);
+		treereloc(reloc(n->u[1].p), d);
+		if ((sw = reloc(n->u[2].sw)) == NULL)
+			break;
+		reloc(sw->ent);
+		reloc(sw->other);
+		for (i = 0; i <= sw->mask; i++) {
+			reloc(sw->ent[i].w);
+			reloc(sw->ent[i].at);
+		}
+		for (j = 0; j < sw->nother; j++)
+			reloc(sw->other[j].at);
 		break;
 	case nForin:
-		treefree(s->u[2].p);
-		treefree(s->u[1].p);
-		treefree(s->u[0].p);
+		treereloc(reloc(n->u[0].p), d);
+		treereloc(reloc(n->u[1].p), d);
+		treereloc(reloc(n->u[2].p), d);
 		break;
 	case nPipe:
-		treefree(s->u[2].p);
-		treefree(s->u[3].p);
+		treereloc(reloc(n->u[2].p), d);
+		treereloc(reloc(n->u[3].p), d);
+		break;
+	case nRedir: case nNmpipe:
+		treereloc(reloc(n->u[2].p), d);
 		break;
-	case nRedir:
-	case nNmpipe:
-		treefree(s->u[2].p);
 	}
-	efree(s);
 }
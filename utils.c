@@ -73,9 +73,13 @@ extern bool isabsolute(char *path) {
 
 extern int mvfd(int i, int j) {
 	if (i != j) {
-		int s = dup2(i, j);
+		int s;
+		if (j == 1)
+			flushout(); /* what fprint() kept back was for the old fd 1 */
+		s = dup2(i, j);
 		close(i);
 		return s;
 	}
+	keeponexec(j); /* as dup2() would have */
 	return 0;
 }
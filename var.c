@@ -7,22 +7,64 @@
 static void colonassign(char *, List *, bool);
 static void listassign(char *, List *, bool);
 static int hasalias(char *);
+static void varset(char *, Vec *, List *, int, bool);
 
 static char *const aliases[] = {
 	"home", "HOME", "path", "PATH", "cdpath", "CDPATH"
 };
 
+/*
+   The value last handed out by varlookup_vec(). Assigning it, or its tail
+   (as with $* less $0), to another variable shares its vector instead of
+   copying it.
+*/
+
+static struct {
+	Vec *vec;
+	List *def;
+	int nel;
+} looked;
+
+/* drop a reference to a vector, freeing it with the last one */
+
+extern void vecfree(Vec *v) {
+	if (v == NULL || --v->refs > 0)
+		return;
+	if (v == looked.vec)
+		looked.vec = NULL;
+	efree(v);
+}
+
 /* assign a variable in List form to a name, stacking if appropriate */
 
 extern void varassign(char *name, List *def, bool stack) {
-	Variable *new;
-	List *newdef = listcpy(def, ealloc); /* important to do the listcpy first; get_var_place() frees old values */
-	new = get_var_place(name, stack);
-	new->def = newdef;
+	Vec *vec;
+	int nel;
+	/* important to take hold of the value first; get_var_place() frees old values */
+	if (def != NULL && looked.vec != NULL && (def == looked.def || (looked.nel > 1 && def == looked.def + 1))) {
+		vec = looked.vec;
+		vec->refs++;
+		nel = looked.nel - (def != looked.def);
+	} else {
+		vec = listvec(def, &nel);
+		def = (vec == NULL) ? NULL : vec->l;
+	}
+	varset(name, vec, def, nel, stack);
+}
+
+static void varset(char *name, Vec *vec, List *def, int nel, bool stack) {
+	Variable *new = get_var_place(name, stack);
+	new->vec = vec;
+	new->def = def;
+	new->nel = nel;
 	new->extdef = NULL;
 	set_exportable(name, TRUE);
 	if (streq(name, "TERM") || streq(name, "TERMCAP"))
 		termchange();
+	if (streq(name, "path"))
+		cmdhash_flush();
+	if (streq(name, "history"))
+		histclose();
 }
 
 /* assign a variable in string form. Check to see if it is aliased (e.g., PATH and path) */
@@ -43,9 +85,10 @@ extern bool varassign_string(char *extdef) {
 			return TRUE;
 	}
 	new = get_var_place(name, FALSE);
+	new->vec = NULL;
 	new->def = NULL;
-	new->extdef = ealloc(strlen(extdef) + 1);
-	strcpy(new->extdef, extdef);
+	new->nel = 0;
+	new->extdef = extcpy(extdef);
 	if (i != -1)
 		alias(name, varlookup(name), FALSE);
 	set_exportable(name, TRUE);
@@ -60,37 +103,59 @@ extern bool varassign_string(char *extdef) {
 */
 
 extern List *varlookup(char *name) {
+	int nel;
+	return varlookup_vec(name, &nel);
+}
+
+/*
+   As varlookup(), but also report in nel the number of elements if the List
+   is a vector (see listvec()), so that it may be counted and subscripted
+   without walking it, or -1 if it is an ordinary linked List.
+*/
+
+extern List *varlookup_vec(char *name, int *nel) {
 	Variable *look;
 	List *ret, *l;
-	int sub;
+	int sub, n;
+	*nel = -1;
 	if (streq(name, "apids"))
 		return sgetapids();
+	if (streq(name, "cwd"))
+		return sgetcwd();
 	if (streq(name, "status"))
 		return sgetstatus();
+	if (streq(name, "rcstats"))
+		return sgetrcstats();
 	if (*name != '\0' && (sub = a2u(name)) != -1) { /* handle $1, $2, etc. */
-		for (l = varlookup("*"); l != NULL && sub != 0; --sub)
-			l = l->n;
-		if (l == NULL)
+		if ((l = varlookup_vec("*", &n)) == NULL || sub >= n)
 			return NULL;
 		ret = nnew(List);
-		ret->w = l->w;
+		ret->w = l[sub].w;
 		ret->m = NULL;
 		ret->n = NULL;
+		*nel = 1;
 		return ret;
 	}
 	look = lookup_var(name);
 	if (look == NULL)
 		return NULL; /* not found */
-	if (look->def != NULL)
-		return look->def;
-	if (look->extdef == NULL)
-		return NULL; /* variable was set to null, e.g., a=() echo foo */
-	ret = parse_var(look->extdef);
-	if (ret == NULL) {
-		look->extdef = NULL;
-		return NULL;
+	if (look->def == NULL) {
+		if (look->extdef == NULL)
+			return NULL; /* variable was set to null, e.g., a=() echo foo */
+		l = parse_var(look->extdef);
+		if (l == NULL) {
+			look->extdef = NULL;
+			return NULL;
+		}
+		look->vec = listvec(l, &look->nel);
+		look->def = look->vec->l;
+		listfree(l);
 	}
-	return look->def = ret;
+	looked.vec = look->vec;
+	looked.def = look->def;
+	looked.nel = look->nel;
+	*nel = look->nel;
+	return look->def;
 }
 
 /* lookup a variable in external (string) form, converting if necessary. Used by makeenv() */
@@ -118,12 +183,26 @@ extern void varrm(char *name, bool stack) {
 	delete_var(name, stack);
 	if (i != -1)
 		delete_var(aliases[i^1], stack);
+	if (streq(name, "path") || streq(name, "PATH"))
+		cmdhash_flush();
+	if (streq(name, "history"))
+		histclose();
 }
 
 /* assign a value (List) to a variable, using array "a" as input. Used to assign $* */
 
 extern void starassign(char *dollarzero, char **a, bool stack) {
 	List *s, *var;
+	int i, n;
+	/* a function calling itself with its own arguments shares them */
+	var = varlookup_vec("*", &n);
+	for (i = 0; i < n - 1 && a[i] == var[i + 1].w; i++)
+		;
+	if (n > 0 && i == n - 1 && a[i] == NULL && streq(dollarzero, var->w)) {
+		looked.vec->refs++;
+		varset("*", looked.vec, var, n, stack);
+		return;
+	}
 	var = nnew(List);
 	var->w = dollarzero;
 	if (*a == NULL) {
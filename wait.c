@@ -1,25 +1,177 @@
 #include "rc.h"
 
 #include <errno.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#if HAVE_POSIX_SPAWN
+#include <spawn.h>
+#endif
 
 #include "wait.h"
 
 bool forked = FALSE;
 
+/*
+   Children are kept in a table hashed on pid. The live ones are also
+   on a list in the order they were started, for $apids; the dead ones,
+   which have been reaped but whose status has not been collected, are
+   on a list of their own, which is all dowait() has to search. Which
+   children are being waited for is a generation number, so that
+   forgetting the last wait is a matter of bumping it. Entries come
+   from slabs, so that a child can throw the whole table away at once.
+*/
+
 typedef struct Pid Pid;
 
-static struct Pid {
+struct Pid {
 	pid_t pid;
 	int stat;
+	double cpu;		/* user and system seconds, once reaped */
 	bool alive;
-	bool waiting;
-	Pid *n;
-} *plist = NULL;
+	unsigned int waitgen;
+	Pid *hnext;		/* hash chain */
+	Pid *next, *prev;	/* the live list, or (next only) the dead list */
+};
 
-extern pid_t rc_fork() {
+enum { SLAB = 64 };
+
+typedef struct Slab Slab;
+struct Slab {
+	Slab *n;
+	Pid p[SLAB];
+};
+
+static Slab *slabs;
+static Pid *freepids;
+static Pid **pidtab;
+static int pidtabsize, npids, nlive;
+static Pid *live, *lastlive, *dead, **deadtail = &dead;
+static unsigned int waitgen;
+static bool waitany;
+
+int jobmax = 0;
+
+#define pidhash(pid) ((unsigned int) (pid) & (pidtabsize - 1))
+#define waitingfor(p) (waitany || (p)->waitgen == waitgen)
+
+static Pid **findpid(pid_t pid) {
+	Pid **pp;
+	if (pidtabsize == 0)
+		return NULL;
+	for (pp = &pidtab[pidhash(pid)]; *pp != NULL; pp = &(*pp)->hnext)
+		if ((*pp)->pid == pid)
+			return pp;
+	return NULL;
+}
+
+static void growpids() {
+	Pid **old = pidtab, *p, *next;
+	int i, oldsize = pidtabsize;
+	pidtabsize = (oldsize == 0) ? 64 : 2 * oldsize;
+	pidtab = ealloc(pidtabsize * sizeof *pidtab);
+	memzero(pidtab, pidtabsize * sizeof *pidtab);
+	for (i = 0; i < oldsize; i++)
+		for (p = old[i]; p != NULL; p = next) {
+			next = p->hnext;
+			p->hnext = pidtab[pidhash(p->pid)];
+			pidtab[pidhash(p->pid)] = p;
+		}
+	efree(old);
+}
+
+static void newpid(pid_t pid) {
 	Pid *new;
-	struct Pid *p, *q;
-	pid_t pid = fork();
+	int i;
+	if (freepids == NULL) {
+		Slab *s = enew(Slab);
+		s->n = slabs;
+		slabs = s;
+		for (i = 0; i < SLAB; i++) {
+			s->p[i].next = freepids;
+			freepids = &s->p[i];
+		}
+	}
+	new = freepids;
+	freepids = new->next;
+	if (npids >= pidtabsize)
+		growpids();
+	npids++;
+	nlive++;
+	new->pid = pid;
+	new->alive = TRUE;
+	new->waitgen = waitgen - 1;
+	new->hnext = pidtab[pidhash(pid)];
+	pidtab[pidhash(pid)] = new;
+	new->next = NULL;
+	new->prev = lastlive;
+	if (lastlive != NULL)
+		lastlive->next = new;
+	else
+		live = new;
+	lastlive = new;
+}
+
+/* a child has been reaped: move it to the dead list */
+
+long childrss; /* the largest ru_maxrss of a child reaped, for time */
+
+static double rucpu(struct rusage *ru) {
+	return ru->ru_utime.tv_sec + ru->ru_stime.tv_sec + (ru->ru_utime.tv_usec + ru->ru_stime.tv_usec) / 1e6;
+}
+
+static void reaped(Pid *p, int stat, struct rusage *ru) {
+	p->alive = FALSE;
+	p->stat = stat;
+	p->cpu = rucpu(ru);
+	if (ru->ru_maxrss > childrss)
+		childrss = ru->ru_maxrss;
+	nlive--;
+	if (p->prev != NULL)
+		p->prev->next = p->next;
+	else
+		live = p->next;
+	if (p->next != NULL)
+		p->next->prev = p->prev;
+	else
+		lastlive = p->prev;
+	p->next = NULL;
+	*deadtail = p; /* keep the dead in the order they died */
+	deadtail = &p->next;
+}
+
+/* forget a dead child whose status has been collected */
+
+static void freepid(Pid **dp) {
+	Pid *p = *dp, **pp = findpid(p->pid);
+	if ((*dp = p->next) == NULL)
+		deadtail = dp;
+	*pp = p->hnext;
+	p->next = freepids;
+	freepids = p;
+	npids--;
+}
+
+/* in a new child, none of these are our children */
+
+static void clearpids() {
+	Slab *s, *next;
+	for (s = slabs; s != NULL; s = next) {
+		next = s->n;
+		efree(s);
+	}
+	efree(pidtab);
+	slabs = NULL;
+	freepids = live = lastlive = dead = NULL;
+	deadtail = &dead;
+	pidtab = NULL;
+	pidtabsize = npids = nlive = 0;
+}
+
+extern pid_t rc_fork() {
+	pid_t pid;
+	double t = tracenow();
+	flushout();
+	pid = fork();
 
 	switch (pid) {
 	case -1:
@@ -28,55 +180,69 @@ extern pid_t rc_fork() {
 		/* NOTREACHED */
 	case 0:
 		forked = TRUE;
+		tracefork();
 		sigchk();
 		clearflow();
-		p = plist; q = 0;
-		while (p) {
-			if (q) efree(q);
-			q = p;
-			p = p->n;
-		}
-		if (q) efree(q);
-		plist = 0;
+		clearpids();
 		return 0;
 	default:
-		new = enew(Pid);
-		new->pid = pid;
-		new->alive = TRUE;
-		new->waiting = FALSE;
-		new->n = plist;
-		plist = new;
+		trace("proc", "fork", t);
+		newpid(pid);
 		return pid;
 	}
 }
 
+#if HAVE_POSIX_SPAWN
+/*
+   Start an external command without duplicating rc's address space.
+   This is only used when there is nothing to do between fork and exec.
+   If the spawn fails for any reason (including a failed exec), fall
+   back to a real fork so that the child reports the error, or finds an
+   interpreter, exactly as it always has.
+*/
+
+extern pid_t rc_spawn(char *path, char **av, char **ev) {
+	pid_t pid;
+	double t = tracenow();
+	flushout();
+	if (posix_spawn(&pid, path, NULL, NULL, av, ev) != 0)
+		return rc_fork();
+	trace("proc", "spawn", t);
+	newpid(pid);
+	return pid;
+}
+#endif
+
 static int markwaiting(pid_t pid, bool clear) {
-	Pid *p;
-	int n = 0;
-	for (p = plist; p != NULL; p = p->n)
-		if (pid == -1 || p->pid == pid) {
-			p->waiting = TRUE;
-			n++;
-		} else if (clear)
-			p->waiting = FALSE;
-	return n;
-}
-
-static pid_t dowait(int *stat, bool nointr) {
-	Pid **p, *q;
+	Pid **pp;
+	if (clear) {
+		waitgen++;
+		waitany = FALSE;
+	}
+	if (pid == -1) {
+		waitany = TRUE;
+		return npids;
+	}
+	if ((pp = findpid(pid)) == NULL)
+		return 0;
+	(*pp)->waitgen = waitgen;
+	return 1;
+}
+
+static pid_t dowait(int *stat, double *cpu, bool nointr) {
+	Pid **dp, **pp;
 	pid_t pid;
+	struct rusage ru;
 	for (;;) {
-		for (p = &plist; *p != NULL; p = &(*p)->n) {
-			q = *p;
-			if (q->waiting && !q->alive) {
-				pid = q->pid;
-				*stat = q->stat;
-				*p = q->n; /* remove element from list */
-				efree(q);
+		for (dp = &dead; *dp != NULL; dp = &(*dp)->next)
+			if (waitingfor(*dp)) {
+				pid = (*dp)->pid;
+				*stat = (*dp)->stat;
+				*cpu = (*dp)->cpu;
+				freepid(dp);
 				return pid;
 			}
-		}
-		pid = rc_wait(stat);
+		pid = rc_wait(stat, &ru);
 		if (pid < 0) {
 			if (errno == ECHILD)
 				panic("lost child");
@@ -85,18 +251,16 @@ static pid_t dowait(int *stat, bool nointr) {
 			else
 				return pid;
 		}
-		for (q = plist; q != NULL; q = q->n)
-			if (q->pid == pid) {
-				q->alive = FALSE;
-				q->stat = *stat;
-				break;
-			}
+		if ((pp = findpid(pid)) != NULL && (*pp)->alive)
+			reaped(*pp, *stat, &ru);
 	}
 	/* never reached */
 	return -1;
 }
 
 extern pid_t rc_wait4(pid_t pid, int *stat, bool nointr) {
+	double t = tracenow(), cpu;
+	flushout();
 	if (markwaiting(pid, TRUE) == 0) {
 		/* Uh-oh, not there. */
 		errno = ECHILD; /* no children */
@@ -104,30 +268,107 @@ extern pid_t rc_wait4(pid_t pid, int *stat, bool nointr) {
 		*stat = 0x100; /* exit(1) */
 		return -1;
 	}
-	return dowait(stat, nointr);
+	pid = dowait(stat, &cpu, nointr);
+	trace("proc", "wait", t);
+	return pid;
+}
+
+/*
+   Reap whichever children have finished, without waiting for any, and
+   say whether pid is among the dead. Their statuses stay on the dead
+   list, for the wait that collects them.
+*/
+
+extern bool rc_exited(pid_t pid) {
+	Pid **pp;
+	pid_t r;
+	int stat;
+	struct rusage ru;
+	while ((r = wait3(&stat, WNOHANG, &ru)) > 0)
+		if ((pp = findpid(r)) != NULL && (*pp)->alive)
+			reaped(*pp, stat, &ru);
+	return (pp = findpid(pid)) == NULL || !(*pp)->alive;
+}
+
+/*
+   Wait for all n of the given children, in whatever order they finish,
+   leaving the status of pids[i] in stats[i] and the CPU seconds it took
+   in cpus[i]. Used for pipelines.
+*/
+
+extern void rc_waitall(pid_t *pids, int *stats, double *cpus, int n) {
+	pid_t pid;
+	int i, left, stat;
+	double t = tracenow(), cpu;
+	flushout();
+	markwaiting(0, TRUE);
+	for (i = 0; i < n; i++)
+		markwaiting(pids[i], FALSE);
+	for (left = n; left > 0; left--) {
+		pid = dowait(&stat, &cpu, TRUE);
+		for (i = 0; i < n; i++)
+			if (pids[i] == pid) {
+				stats[i] = stat;
+				cpus[i] = cpu;
+				pids[i] = -1;
+				break;
+			}
+	}
+	trace("proc", "wait", t);
+}
+
+/*
+   Wait until fewer than max children are running (0 for no limit). Any
+   that finish meanwhile go on the dead list, for wait to collect.
+*/
+
+extern void jobslot(int max) {
+	Pid **pp;
+	pid_t pid;
+	int stat;
+	struct rusage ru;
+	while (max > 0 && nlive >= max) {
+		if ((pid = rc_wait(&stat, &ru)) < 0) {
+			if (errno != EINTR)
+				break;
+			sigchk();
+			continue;
+		}
+		if ((pp = findpid(pid)) != NULL && (*pp)->alive)
+			reaped(*pp, stat, &ru);
+	}
+}
+
+/* the number of children to run at once when asked for parallelism */
+
+extern int joblimit() {
+	int n = jobmax;
+#ifdef _SC_NPROCESSORS_ONLN
+	if (n == 0)
+		n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return n < 1 ? 1 : n;
 }
 
 extern List *sgetapids() {
-	List *r;
+	List *r, **tail;
 	Pid *p;
-	for (r = NULL, p = plist; p != NULL; p = p->n) {
-		List *q;
-		if (!p->alive)
-			continue;
-		q = nnew(List);
+	for (r = NULL, tail = &r, p = live; p != NULL; p = p->next) {
+		List *q = *tail = nnew(List);
 		q->w = nprint("%d", p->pid);
 		q->m = NULL;
-		q->n = r;
-		r = q;
+		q->n = NULL;
+		tail = &q->n;
 	}
 	return r;
 }
 
 extern void waitforall() {
 	int stat;
+	double cpu;
 	markwaiting(-1, TRUE);
-	while (plist != NULL) {
-		pid_t pid = dowait(&stat, FALSE);
+	while (npids > 0) {
+		pid_t pid = dowait(&stat, &cpu, FALSE);
 		if (pid > 0)
 			setstatus(pid, stat);
 		else {
@@ -141,6 +382,7 @@ extern void waitforall() {
 
 extern void waitfor(char **av) {
 	int alive, count, i, stat;
+	double cpu;
 	pid_t pid;
 	for (i = 0; av[i] != NULL; i++)
 		if ((pid = a2u(av[i])) < 0) {
@@ -153,19 +395,14 @@ extern void waitfor(char **av) {
 			return;
 		}
 	alive = count = i;
-	if (count >= MAX_PIPELINE) {
-		fprint(2, RC "too many arguments to wait\n");
-		set(FALSE);
-		return;
-	}
 	setpipestatuslength(count);
 	while (alive > 0) {
-		pid = dowait(&stat, FALSE);
+		pid = dowait(&stat, &cpu, FALSE);
 		if (pid > 0) {
 			alive--;
 			for (i = 0; av[i] != NULL; i++)
 				if (a2u(av[i]) == pid) {
-					setpipestatus(count - i - 1, pid, stat);
+					setpipestatus(count - i - 1, pid, stat, cpu);
 					break;
 				}
 		} else if (errno == EINTR) {
@@ -3,11 +3,9 @@
 #include "rc.h"
 
 #include <signal.h>
-#include <setjmp.h>
 #include <termios.h>
 #include <unistd.h>
 
-#include "jbwrap.h"
 #include "wait.h"
 
 /*
@@ -21,6 +19,7 @@ static bool isallpre(Node *);
 static bool dofork(bool);
 static void dopipe(Node *);
 static void loop_body(Node* n);
+static void parfor(List *, List *, Node *);
 
 /* Tail-recursive version of walk() */
 
@@ -29,7 +28,9 @@ static void loop_body(Node* n);
 /* walk the parse-tree. "obvious". */
 
 extern bool walk(Node *n, bool parent) {
-top:	sigchk();
+top:	if (flow != NULL)
+		return istrue(); /* a break, continue or return is on its way up */
+	sigchk();
 	if (n == NULL) {
 		if (!parent)
 			exit(0);
@@ -48,6 +49,7 @@ top:	sigchk();
 		/* WALK doesn't fall through */
 	case nNowait: {
 		int pid;
+		jobslot(jobmax);
 		if ((pid = rc_fork()) == 0) {
 #if defined(RC_JOB) && defined(SIGTTOU) && defined(SIGTTIN) && defined(SIGTSTP)
 			setsigdefaults(FALSE);
@@ -88,9 +90,12 @@ top:	sigchk();
 			cond = oldcond;
 		break;
 	}
-	case nBang:
-		set(!walk(n->u[0].p, TRUE));
+	case nBang: {
+		bool b = walk(n->u[0].p, TRUE);
+		if (flow == NULL)
+			set(!b);
 		break;
+	}
 	case nIf: {
 		bool oldcond = cond;
 		Node *true_cmd = n->u[1].p, *false_cmd = NULL;
@@ -105,7 +110,6 @@ top:	sigchk();
 		WALK(true_cmd, parent);
 	}
 	case nWhile: {
-		Jbwrap break_jb;
 		Edata  break_data;
 		Estack break_stack;
 		bool testtrue;
@@ -116,38 +120,40 @@ top:	sigchk();
 			break;
 		}
 		cond = oldcond;
-		if (sigsetjmp(break_jb.j, 1))
-			break;
-		break_data.jb = &break_jb;
+		break_data.jb = NULL; /* see rc_flow() */
 		except(eBreak, break_data, &break_stack);
 
-		cond = oldcond;
 		do {
 			Edata  iter_data;
 			Estack iter_stack;
 			iter_data.b = newblock();
 			except(eArena, iter_data, &iter_stack);
 			loop_body(n->u[1].p);
-			cond = TRUE;
-			testtrue = walk(n->u[0].p, TRUE);
-			cond = oldcond;
+			testtrue = FALSE;
+			if (flow == NULL) {
+				cond = TRUE;
+				testtrue = walk(n->u[0].p, TRUE);
+				cond = oldcond;
+			}
 			unexcept(eArena);
-		} while (testtrue);
-		cond = oldcond;
+		} while (testtrue && flow == NULL);
 		unexcept(eBreak);
+		if (flow == &break_stack)
+			flow = NULL;
 		break;
 	}
 	case nForin: {
 		List *l, *var = glom(n->u[0].p);
-		Jbwrap break_jb;
 		Edata  break_data;
 		Estack break_stack;
-		if (sigsetjmp(break_jb.j, 1))
+		if (n->u[2].p != NULL && n->u[2].p->type == nNowait) {
+			parfor(var, glob(glom(n->u[1].p)), n->u[2].p->u[0].p);
 			break;
-		break_data.jb = &break_jb;
+		}
+		break_data.jb = NULL; /* see rc_flow() */
 		except(eBreak, break_data, &break_stack);
 
-		for (l = listcpy(glob(glom(n->u[1].p)), nalloc); l != NULL; l = l->n) {
+		for (l = listcpy(glob(glom(n->u[1].p)), nalloc); l != NULL && flow == NULL; l = l->n) {
 			Edata  iter_data;
 			Estack iter_stack;
 			assign(var, word(l->w, NULL), FALSE);
@@ -157,6 +163,8 @@ top:	sigchk();
 			unexcept(eArena);
 		}
 		unexcept(eBreak);
+		if (flow == &break_stack)
+			flow = NULL;
 		break;
 	}
 	case nSubshell:
@@ -210,6 +218,13 @@ top:	sigchk();
 	}
 	case nSwitch: {
 		List *v = glom(n->u[0].p);
+		if (n->u[2].sw != NULL && v != NULL) { /* see swcase() */
+			if ((n = swcase(n, v)) == NULL)
+				return istrue();
+			for (n = n->u[1].p; n != NULL && flow == NULL && (n->u[0].p == NULL || n->u[0].p->type != nCase); n = n->u[1].p)
+				walk(n->u[0].p, TRUE);
+			break;
+		}
 		while (1) {
 			do {
 				n = n->u[1].p;
@@ -217,7 +232,7 @@ top:	sigchk();
 					return istrue();
 			} while (n->u[0].p == NULL || n->u[0].p->type != nCase);
 			if (lmatch(v, glom(n->u[0].p->u[0].p))) {
-				for (n = n->u[1].p; n != NULL && (n->u[0].p == NULL || n->u[0].p->type != nCase); n = n->u[1].p)
+				for (n = n->u[1].p; n != NULL && flow == NULL && (n->u[0].p == NULL || n->u[0].p->type != nCase); n = n->u[1].p)
 					walk(n->u[0].p, TRUE);
 				break;
 			}
@@ -326,19 +341,29 @@ static bool dofork(bool parent) {
 	return FALSE;
 }
 
+/*
+   A pipeline may be any length; the pids and statuses are kept in the
+   arena. Pipes are made close-on-exec (see rc_pipe()), and the stages
+   are reaped in whatever order they finish.
+*/
+
 static void dopipe(Node *n) {
-	int i, j, sp, pid, fd_prev, fd_out, pids[MAX_PIPELINE], p[2];
+	int i, j, pid, fd_prev, fd_out, np, p[2], *pids, *stats;
+	double *cpus;
 	bool intr;
 	Node *r;
 	struct termios t;
 
+	for (r = n, np = 1; r != NULL && r->type == nPipe; r = r->u[2].p)
+		np++;
+	pids = nalloc(np * sizeof *pids);
+	stats = nalloc(np * sizeof *stats);
+	cpus = nalloc(np * sizeof *cpus);
 	if (interactive)
 		tcgetattr(0, &t);
 	fd_prev = fd_out = 1;
 	for (r = n, i = 0; r != NULL && r->type == nPipe; r = r->u[2].p, i++) {
-		if (i + 1 >= MAX_PIPELINE)
-			rc_error("pipe too long");
-		if (pipe(p) < 0) {
+		if (rc_pipe(p) < 0) {
 			uerror("pipe");
 			rc_error(NULL);
 		}
@@ -373,36 +398,67 @@ static void dopipe(Node *n) {
 	/* collect statuses */
 
 	intr = FALSE;
+	rc_waitall(pids, stats, cpus, i);
 	setpipestatuslength(i);
 	for (j = 0; j < i; j++) {
-		rc_wait4(pids[j], &sp, TRUE);
-		setpipestatus(j, -1, sp);
-		intr |= WIFSIGNALED(sp);
+		setpipestatus(j, -1, stats[j], cpus[j]);
+		intr |= WIFSIGNALED(stats[j]);
 	}
 	if (interactive && intr)
 		tcsetattr(0, TCSANOW, &t);
 	sigchk();
 }
 
-/* From http://en.cppreference.com/w/c/program/setjmp
- * According to the C standard setjmp() must appear only in the following 4 constructs:
- *   1. switch (setjmp(args)) {statements}
- *   2. if (setjmp(args) == Const) {statements} with any of
- *             operators: ==, !=, <, >, <=, >=
- *   3. while (! setjmp(args)) {statements}
- *   4. setjmp(args);
+/*
+   for (var in words &) body: each iteration runs in a child of its own,
+   with no more than $jobs -j (or else one per processor) at once. The
+   statuses are collected in the order of the words, so that $status
+   (and -e) see the iterations as if they had run one after another.
 */
-static void loop_body(Node* nd)
-{
-	Node *volatile n = nd;
-	Jbwrap cont_jb;
+
+static void parfor(List *var, List *words, Node *body) {
+	Edata  break_data;
+	Estack break_stack;
+	pid_t *pids;
+	int *stats, i, n, max;
+	double *cpus;
+	if ((n = listnel(words)) == 0) {
+		set(TRUE);
+		return;
+	}
+	pids = nalloc(n * sizeof *pids);
+	stats = nalloc(n * sizeof *stats);
+	cpus = nalloc(n * sizeof *cpus);
+	max = joblimit();
+	for (i = 0; words != NULL; words = words->n, i++) {
+		jobslot(max);
+		if ((pids[i] = rc_fork()) == 0) {
+			break_data.jb = NULL; /* break ends only this iteration */
+			except(eBreak, break_data, &break_stack);
+			setsigdefaults(FALSE);
+			redirq = NULL;
+			assign(var, word(words->w, NULL), FALSE);
+			loop_body(body);
+			exit(getstatus());
+		}
+	}
+	rc_waitall(pids, stats, cpus, n);
+	setpipestatuslength(n);
+	for (i = 0; i < n; i++)
+		setpipestatus(n - i - 1, -1, stats[i], cpus[i]);
+	sigchk();
+}
+
+/* run one iteration of a loop, which a continue ends early */
+
+static void loop_body(Node *n) {
 	Edata  cont_data;
 	Estack cont_stack;
 
-	if (sigsetjmp(cont_jb.j, 1) == 0) {
-		cont_data.jb = &cont_jb;
-		except(eContinue, cont_data, &cont_stack);
-		walk(n, TRUE);
-		unexcept(eContinue);
-	}
+	cont_data.jb = NULL; /* see rc_flow() */
+	except(eContinue, cont_data, &cont_stack);
+	walk(n, TRUE);
+	unexcept(eContinue);
+	if (flow == &cont_stack)
+		flow = NULL;
 }
@@ -13,6 +13,8 @@
 #include <ctype.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <dirent.h>
+#include <time.h>
 
 #include "getgroups.h"
 
@@ -42,6 +44,29 @@ static int ingidset(gid_t g) {
 #define ingidset(g) (FALSE)
 #endif
 
+static void idinit() {
+	if (initialized)
+		return;
+	initialized = TRUE;
+	uid = geteuid();
+	gid = getegid();
+#if HAVE_GETGROUPS
+#if HAVE_POSIX_GETGROUPS
+	ngroups = getgroups(0, (GETGROUPS_T *)0);
+	if (ngroups < 0) {
+		uerror("getgroups");
+		rc_exit(1);
+	}
+#else
+	ngroups = NGROUPS;
+#endif
+	if (ngroups) {	
+		gidset = ealloc(ngroups * sizeof(GETGROUPS_T));
+		getgroups(ngroups, gidset);
+	}
+#endif
+}
+
 /*
    A home-grown access/stat. Does the right thing for group-executable files.
    Returns a bool instead of this -1 nonsense.
@@ -70,38 +95,377 @@ bool rc_access(char *path, bool verbose, struct stat *stp) {
 	return FALSE;
 }
 
+/*
+   Completion wants every command in $path that starts with some prefix,
+   and reading the directories afresh on every Tab is slow when they are
+   large or remote. So a directory's listing is kept, sorted, with the
+   mtime the directory had when it was read, and a later query costs one
+   stat() unless that shows a change. A listing read in the second the
+   directory last changed is not trusted, as a second change within that
+   second would not show. Whether an entry is executable is found out the
+   first time a query needs it, and kept with the listing. Past NDIRLIST
+   listings the least recently used go, and they all go along with the
+   command hash, when $path is assigned.
+*/
+
+typedef struct Dirlist Dirlist;
+
+struct Dirlist {
+	char *name;
+	time_t mtime, read;
+	size_t nent;
+	char **ent;		/* sorted, in one block with the names */
+	unsigned char *kind;	/* KUNKNOWN until a query needs it */
+	Dirlist *n;
+};
+
+#define NDIRLIST 64
+
+#define KUNKNOWN 0
+#define KOTHER 1
+#define KEXEC 2
+#define KDIR 3
+
+static Dirlist *dirlists;
+static int ndirlist = 0;
+
+static void dirlist_free(Dirlist *d) {
+	efree(d->name);
+	efree(d->ent);
+	efree(d->kind);
+	efree(d);
+}
+
+static void dirlist_flush() {
+	Dirlist *d;
+	while ((d = dirlists) != NULL) {
+		dirlists = d->n;
+		dirlist_free(d);
+	}
+	ndirlist = 0;
+}
+
+static int entcmp(const void *a, const void *b) {
+	return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+/* (re)read d from the directory; FALSE if it cannot be opened */
+static bool dirlist_read(Dirlist *d, struct stat *st) {
+	DIR *dp;
+	struct dirent *e;
+	size_t n = 0, nalloc = 64, size = 0, bufsize = 1024, len, i, *off;
+	char *buf;
+	if ((dp = opendir(d->name)) == NULL)
+		return FALSE;
+	off = ealloc(nalloc * sizeof *off);
+	buf = ealloc(bufsize);
+	while ((e = readdir(dp)) != NULL) {
+		if (streq(e->d_name, ".") || streq(e->d_name, ".."))
+			continue;
+		len = strlen(e->d_name) + 1;
+		if (n == nalloc)
+			off = erealloc(off, (nalloc *= 2) * sizeof *off);
+		while (size + len > bufsize)
+			buf = erealloc(buf, bufsize *= 2);
+		memcpy(buf + size, e->d_name, len);
+		off[n++] = size;
+		size += len;
+	}
+	closedir(dp);
+	efree(d->ent);
+	efree(d->kind);
+	d->ent = ealloc(n * sizeof *d->ent + size);
+	memcpy(d->ent + n, buf, size);
+	for (i = 0; i < n; i++)
+		d->ent[i] = (char *) (d->ent + n) + off[i];
+	qsort(d->ent, n, sizeof *d->ent, entcmp);
+	d->kind = ealloc(n + 1);
+	memzero(d->kind, n + 1);
+	d->nent = n;
+	d->mtime = st->st_mtime;
+	d->read = time(NULL);
+	efree(off);
+	efree(buf);
+	return TRUE;
+}
+
+/* the listing of directory dname, brought up to date; NULL if there is none */
+static Dirlist *dirlist(char *dname) {
+	struct stat st;
+	Dirlist **dp, *d;
+	int i;
+	if (stat(dname, &st) != 0 || !S_ISDIR(st.st_mode))
+		return NULL;
+	for (dp = &dirlists; (d = *dp) != NULL; dp = &d->n)
+		if (streq(d->name, dname))
+			break;
+	if (d != NULL) {
+		*dp = d->n;
+		ndirlist--;
+		if ((d->mtime != st.st_mtime || d->mtime >= d->read) && !dirlist_read(d, &st)) {
+			dirlist_free(d);
+			return NULL;
+		}
+	} else {
+		d = enew(Dirlist);
+		d->name = ecpy(dname);
+		d->ent = NULL;
+		d->kind = NULL;
+		if (!dirlist_read(d, &st)) {
+			efree(d->name);
+			efree(d);
+			return NULL;
+		}
+	}
+	d->n = dirlists;
+	dirlists = d;
+	if (++ndirlist > NDIRLIST) {
+		for (dp = &dirlists, i = 1; i < NDIRLIST; i++)
+			dp = &(*dp)->n;
+		dirlist_free((*dp)->n);
+		(*dp)->n = NULL;
+		ndirlist--;
+	}
+	return d;
+}
+
+static int entkind(Dirlist *d, size_t i) {
+	struct stat st;
+	char *full;
+	if (d->kind[i] == KUNKNOWN) {
+		full = mprint("%s/%s", d->name, d->ent[i]);
+		if (rc_access(full, FALSE, &st))
+			d->kind[i] = KEXEC;
+		else if (stat(full, &st) == 0 && S_ISDIR(st.st_mode))
+			d->kind[i] = KDIR;
+		else
+			d->kind[i] = KOTHER;
+		efree(full);
+	}
+	return d->kind[i];
+}
+
+/* the first entry of d not less than prefix */
+static size_t entfirst(Dirlist *d, const char *prefix) {
+	size_t lo = 0, hi = d->nent, mid;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strcmp(d->ent[mid], prefix) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/*
+   The completions of text, one per call with state 0 on the first, in the
+   manner of readline's generators; each is malloc'd. With cmds, they are
+   the executables and directories in $path (or, if text is absolute, in
+   the directory it names), and *isdir tells which; otherwise they are all
+   the names in text's directory, or the current one.
+*/
+
+static char *complete(const char *text, int state, bool cmds, bool *isdir) {
+	static char *word, *prefix;
+	static size_t sublen, plen, i;
+	static List *path, one;
+	static Dirlist *d;
+	char *dname, *name, *slash, *w;
+	size_t wlen;
+	int k;
+	if (!state) {
+		idinit();
+		efree(word);
+		word = ecpy(text);
+		slash = strrchr(word, '/');
+		sublen = slash == NULL ? 0 : slash + 1 - word;
+		prefix = word + sublen;
+		plen = strlen(prefix);
+		one.w = "";
+		one.n = NULL;
+		path = cmds && !isabsolute(word) ? varlookup("path") : &one;
+		d = NULL;
+	}
+	for (;;) {
+		if (d == NULL) {
+			if (path == NULL)
+				break;
+			w = path->w;
+			path = path->n;
+			wlen = strlen(w);
+			dname = ealloc(wlen + sublen + 3);
+			strcpy(dname, w);
+			if (wlen > 0 && w[wlen - 1] != '/' && sublen > 0)
+				strcat(dname, "/");
+			strncat(dname, word, sublen);
+			if (*dname == '\0')
+				strcpy(dname, ".");
+			d = dirlist(dname);
+			efree(dname);
+			if (d != NULL)
+				i = entfirst(d, prefix);
+			continue;
+		}
+		while (i < d->nent && strncmp(d->ent[i], prefix, plen) == 0) {
+			name = d->ent[i];
+			k = cmds ? entkind(d, i) : KOTHER;
+			i++;
+			if (cmds && k == KOTHER)
+				continue;
+			if (isdir != NULL)
+				*isdir = k == KDIR;
+			dname = ealloc(sublen + strlen(name) + 1);
+			memcpy(dname, word, sublen);
+			strcpy(dname + sublen, name);
+			return dname;
+		}
+		d = NULL;
+	}
+	efree(word);
+	word = NULL;
+	return NULL;
+}
+
+extern char *compl_path(const char *text, int state, bool *isdir) {
+	return complete(text, state, TRUE, isdir);
+}
+
+extern char *compl_file(const char *text, int state) {
+	return complete(text, state, FALSE, NULL);
+}
+
+/*
+   A cache of command locations, keyed on the command name. Entries are
+   only trusted if the cached file still passes rc_access(), and the
+   whole table is flushed whenever $path is assigned (see varassign()),
+   and on a cd while $path has a relative entry, since what that finds
+   changes with the directory.
+*/
+
+typedef struct Cmdhash Cmdhash;
+
+struct Cmdhash {
+	char *name, *path;
+	Cmdhash *n;
+};
+
+#define CMDHASHSIZE 64
+
+static Cmdhash *cmdhash[CMDHASHSIZE];
+static int ncmdhash = 0;
+
+static Cmdhash **cmdhash_find(char *name) {
+	unsigned int h = 0;
+	char *s;
+	Cmdhash **cp;
+	for (s = name; *s != '\0'; s++)
+		h = h * 31 + *(unsigned char *) s;
+	for (cp = &cmdhash[h & (CMDHASHSIZE - 1)]; *cp != NULL; cp = &(*cp)->n)
+		if (streq((*cp)->name, name))
+			break;
+	return cp;
+}
+
+static void cmdhash_enter(char *name, char *path) {
+	Cmdhash **cp = cmdhash_find(name), *c;
+	if ((c = *cp) != NULL) {
+		efree(c->path);
+	} else {
+		c = *cp = enew(Cmdhash);
+		c->name = ecpy(name);
+		c->n = NULL;
+		ncmdhash++;
+	}
+	c->path = ecpy(path);
+}
+
+extern bool cmdhash_forget(char *name) {
+	Cmdhash **cp = cmdhash_find(name), *c;
+	if ((c = *cp) == NULL)
+		return FALSE;
+	*cp = c->n;
+	efree(c->name);
+	efree(c->path);
+	efree(c);
+	ncmdhash--;
+	return TRUE;
+}
+
+extern void cmdhash_flush() {
+	Cmdhash *c, *next;
+	int i;
+	dirlist_flush();
+	if (ncmdhash == 0)
+		return;
+	for (i = 0; i < CMDHASHSIZE; i++) {
+		for (c = cmdhash[i]; c != NULL; c = next) {
+			next = c->n;
+			efree(c->name);
+			efree(c->path);
+			efree(c);
+		}
+		cmdhash[i] = NULL;
+	}
+	ncmdhash = 0;
+}
+
+extern void cmdhash_cd() {
+	List *path;
+	if (ncmdhash == 0)
+		return;
+	for (path = varlookup("path"); path != NULL; path = path->n)
+		if (*path->w != '/') {
+			cmdhash_flush();
+			return;
+		}
+}
+
+extern char *cmdhash_lookup(char *name) {
+	Cmdhash *c = *cmdhash_find(name);
+	return c == NULL ? NULL : c->path;
+}
+
+extern void cmdhash_print(int fd) {
+	Cmdhash *c;
+	int i;
+	for (i = 0; i < CMDHASHSIZE; i++)
+		for (c = cmdhash[i]; c != NULL; c = c->n)
+			fprint(fd, "%S %S\n", c->name, c->path);
+}
+
 /* return a full pathname by searching $path, and by checking the status of the file */
 
 extern char *which(char *name, bool verbose) {
 	static char *test = NULL;
 	static size_t testlen = 0;
 	List *path;
-	int len;
+	int i, len;
 	struct stat st;
+	char *cached, *p;
 	if (name == NULL)	/* no filename? can happen with "> foo" as a command */
 		return NULL;
-	if (!initialized) {
-		initialized = TRUE;
-		uid = geteuid();
-		gid = getegid();
-#if HAVE_GETGROUPS
-#if HAVE_POSIX_GETGROUPS
-		ngroups = getgroups(0, (GETGROUPS_T *)0);
-		if (ngroups < 0) {
-			uerror("getgroups");
-			rc_exit(1);
-		}
-#else
-		ngroups = NGROUPS;
-#endif
-		if (ngroups) {	
-			gidset = ealloc(ngroups * sizeof(GETGROUPS_T));
-			getgroups(ngroups, gidset);
-		}
-#endif
+	idinit();
+	if (isabsolute(name)) { /* absolute pathname? */
+		for (i = 0; (p = ns_try(name, i)) != NULL; i++)
+			if (rc_access(p, FALSE, &st)) {
+				if (p == name)
+					return name;
+				if (testlen < strlen(p) + 1) {
+					efree(test);
+					test = ealloc(testlen = strlen(p) + 1);
+				}
+				return strcpy(test, p); /* ns_try()'s buffer is not ours to keep */
+			}
+		if (verbose)
+			(void) rc_access(name, TRUE, &st); /* for the message */
+		return NULL;
+	}
+	if ((cached = cmdhash_lookup(name)) != NULL) {
+		if (rc_access(cached, FALSE, &st))
+			return cached;
+		cmdhash_forget(name); /* stale entry; search $path again */
 	}
-	if (isabsolute(name)) /* absolute pathname? */
-		return rc_access(name, verbose, &st) ? name : NULL;
 	len = strlen(name);
 	for (path = varlookup("path"); path != NULL; path = path->n) {
 		size_t need = strlen(path->w) + len + 2; /* one for null terminator, one for the '/' */
@@ -117,8 +481,11 @@ extern char *which(char *name, bool verbose) {
 				strcat(test, "/");
 			strcat(test, name);
 		}
-		if (rc_access(test, FALSE, &st))
-			return test;
+		for (i = 0; (p = ns_try(test, i)) != NULL; i++)
+			if (rc_access(p, FALSE, &st)) {
+				cmdhash_enter(name, p);
+				return cmdhash_lookup(name);
+			}
 	}
 	if (verbose)
 		fprint(2, RC "cannot find `%s'\n", name);